@@ -10,6 +10,7 @@
 #include <functional>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace cblend
 {
@@ -19,10 +20,21 @@ struct TypeDatabase
     using TypeMap = std::unordered_map<std::string_view, usize>;
     using StructMap = std::unordered_map<usize, usize>;
 
+    // Owns the types, type_list only refers to them
+    TypeArena type_arena;
     TypeList type_list;
     TypeMap type_map;
     StructMap struct_map;
     StructMap index_map;
+    // Parallel to type_list
+    std::vector<TypeDescriptor> type_descriptors;
+    std::vector<FieldDescriptor> field_descriptors;
+    std::vector<u32> field_lookup_slots;
+    std::vector<u16> field_lookup_seeds;
+    std::unordered_set<std::string_view> field_names;
+    u64 sdna_hash = 0U;
+
+    [[nodiscard]] TypeDescriptorTable GetDescriptorTable() const;
 };
 
 struct MemoryRange
@@ -30,6 +42,7 @@ struct MemoryRange
     u64 head = 0;
     u64 tail = 0;
     MemorySpan span;
+    usize block_index = 0;
 };
 
 class MemoryTable final
@@ -39,6 +52,8 @@ public:
     explicit MemoryTable(std::vector<MemoryRange>& ranges);
 
     [[nodiscard]] MemorySpan GetMemory(u64 address, usize size) const;
+    [[nodiscard]] MemorySpan GetRemainingMemory(u64 address) const;
+    [[nodiscard]] Option<const MemoryRange&> GetRange(u64 address) const;
     template<class T>
     Option<T> GetMemory(u64 address) const;
 
@@ -73,7 +88,7 @@ class BlendFieldInfo;
 class BlendType
 {
 public:
-    BlendType(const MemoryTable& memory_table, const Type& type);
+    BlendType(const MemoryTable& memory_table, const TypeDescriptorTable& descriptor_table, u32 type_index);
 
     bool operator==(const BlendType& other) const;
 
@@ -83,6 +98,10 @@ public:
     [[nodiscard]] bool IsStruct() const;
 
     [[nodiscard]] usize GetSize() const;
+    [[nodiscard]] const TypeDescriptor& GetDescriptor() const;
+    [[nodiscard]] const Type& GetType() const;
+    // Name of structs and primitives, empty for derived types
+    [[nodiscard]] std::string_view GetName() const;
 
     [[nodiscard]] bool HasElementType() const;
     [[nodiscard]] Option<BlendType> GetElementType() const;
@@ -122,27 +141,35 @@ public:
 
 private:
     const MemoryTable& m_MemoryTable;
-    const Type& m_Type;
-    const Type* m_ElementType = nullptr;
-    usize m_ArrayRank = 0U;
-    std::vector<const AggregateType::Field*> m_Fields;
-    std::unordered_map<std::string_view, const AggregateType::Field*> m_FieldsByName;
+    TypeDescriptorTable m_DescriptorTable;
+    const TypeDescriptor* m_Descriptor;
 };
 
 class BlendFieldInfo
 {
 public:
-    BlendFieldInfo(const MemoryTable& memory_table, const AggregateType::Field& field, const BlendType& declaring_type);
+    BlendFieldInfo(
+        const MemoryTable& memory_table,
+        const TypeDescriptorTable& descriptor_table,
+        const FieldDescriptor& field,
+        const BlendType& declaring_type
+    );
 
     [[nodiscard]] std::string_view GetName() const;
     [[nodiscard]] const BlendType& GetDeclaringType() const;
     [[nodiscard]] const BlendType& GetFieldType() const;
+    [[nodiscard]] usize GetOffset() const;
+    [[nodiscard]] usize GetSize() const;
 
     [[nodiscard]] MemorySpan GetData(MemorySpan span) const;
     [[nodiscard]] MemorySpan GetData(const Block& block) const;
 
+    [[nodiscard]] Option<u64> GetPointerAddress(MemorySpan span) const;
     [[nodiscard]] MemorySpan GetPointerData(MemorySpan span) const;
+    [[nodiscard]] MemorySpan GetPointerData(MemorySpan span, usize size) const;
     [[nodiscard]] MemorySpan GetPointerData(const Block& block) const;
+    [[nodiscard]] std::string_view GetString(MemorySpan span) const;
+    [[nodiscard]] std::string_view GetPointerString(MemorySpan span) const;
 
     template<class T>
     [[nodiscard]] Option<T> GetValue(MemorySpan span) const;
@@ -168,6 +195,16 @@ private:
     usize m_Size;
 };
 
+// Selects the roots of reachable loading, an empty name selects every block with the code
+struct BlockRoot
+{
+    BlockCode code = {};
+    std::string_view name = {};
+};
+
+// The block and its type are only valid during the call. No other block is retained, so pointers cannot be followed.
+using BlockVisitor = std::function<void(const Block& block, const Option<BlendType>& type)>;
+
 class Blend final
 {
 public:
@@ -177,23 +214,42 @@ public:
     Blend& operator=(Blend&&) = default;
     ~Blend() = default;
 
-    static Result<Blend, BlendError> Open(std::string_view path);
-    static Result<Blend, BlendError> Read(MemorySpan buffer);
+    static Result<Blend, BlendError> Open(std::string_view path, const BlockCodeFilter& filter = {});
+    static Result<Blend, BlendError> Read(MemorySpan buffer, const BlockCodeFilter& filter = {});
+
+    // Reads all block headers, then only the bodies reachable through SDNA pointers from the root blocks
+    static Result<Blend, BlendError> OpenReachable(std::string_view path, std::span<const BlockRoot> roots);
+    static Result<Blend, BlendError> ReadReachable(MemorySpan buffer, std::span<const BlockRoot> roots);
+
+    // Parses DNA1 first, then streams the blocks in file order through one buffer sized by the largest block
+    static Result<void, BlendError> VisitFile(std::string_view path, const BlockVisitor& visitor);
+    static Result<void, BlendError> VisitBuffer(MemorySpan buffer, const BlockVisitor& visitor);
+
+    // Reads only the file header and the blocks preceding the thumbnail instead of the whole file
+    static Result<Thumbnail, BlendError> OpenThumbnail(std::string_view path);
+    static Result<Thumbnail, BlendError> ReadThumbnail(MemorySpan buffer);
 
     [[nodiscard]] Endian GetEndian() const;
     [[nodiscard]] Pointer GetPointer() const;
+    // Fingerprint of the DNA1 block, see Sdna::hash
+    [[nodiscard]] u64 GetSdnaHash() const;
 
     [[nodiscard]] usize GetBlockCount() const;
     [[nodiscard]] usize GetBlockCount(const BlockCode& code) const;
 
+    [[nodiscard]] std::span<const Block> GetBlocks() const;
     [[nodiscard]] auto GetBlocks(const BlockCode& code) const;
     [[nodiscard]] Option<const Block&> GetBlock(const BlockCode& code) const;
 
     [[nodiscard]] auto GetBlocks(const BlendType& type) const;
     [[nodiscard]] Option<const Block&> GetBlock(const BlendType& type) const;
+    // Block whose body holds the given old memory address
+    [[nodiscard]] Option<const Block&> GetBlockAt(u64 address) const;
 
     [[nodiscard]] Option<BlendType> GetType(std::string_view name) const;
     [[nodiscard]] Option<BlendType> GetBlockType(const Block& block) const;
+    // Every SDNA struct in struct index order
+    [[nodiscard]] std::vector<BlendType> GetStructTypes() const;
 
 private:
     File m_File = {};
@@ -203,6 +259,18 @@ private:
     Blend(File& file, TypeDatabase& type_database, MemoryTable& memory_table);
 };
 
+// Location of a pointer inside a struct, is_pointer_array is set when the pointee is itself an array of pointers
+struct PointerSlot
+{
+    usize offset = 0;
+    bool is_pointer_array = false;
+};
+
+// Pointers of a type including nested structs and arrays. The ID list links (next, prev, newid, orig_id) are left out,
+// following them would reach every other ID of the same type.
+[[nodiscard]] std::vector<PointerSlot> GetPointerSlots(const BlendType& type, const BlendType& id_type);
+[[nodiscard]] u64 ReadPointerSlot(MemorySpan data, usize offset, Pointer pointer);
+
 template<class T>
 inline Option<T> MemoryTable::GetMemory(u64 address) const
 {
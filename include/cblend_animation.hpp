@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cblend.hpp>
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace cblend
+{
+enum class KeyframeInterpolation : u8
+{
+    Constant = 0,
+    Linear = 1,
+    Bezier = 2,
+};
+
+enum class CurveExtrapolation : u8
+{
+    Constant = 0,
+    Linear = 1,
+};
+
+// Every FCurve of an action, keyframes of channel c are [key_offsets[c], key_offsets[c + 1])
+struct ActionCurves
+{
+    std::vector<std::string_view> paths = {};
+    std::vector<s32> array_indices = {};
+    std::vector<CurveExtrapolation> extrapolations = {};
+    std::vector<u32> key_offsets = {};
+
+    std::vector<f32> frames = {};
+    std::vector<f32> values = {};
+    std::vector<f32> left_frames = {};
+    std::vector<f32> left_values = {};
+    std::vector<f32> right_frames = {};
+    std::vector<f32> right_values = {};
+    std::vector<KeyframeInterpolation> interpolations = {};
+
+    [[nodiscard]] usize GetChannelCount() const;
+    [[nodiscard]] usize GetKeyCount() const;
+    [[nodiscard]] Option<usize> FindChannel(std::string_view path, s32 array_index) const;
+};
+
+// Dense samples stored channel after channel, sample i of a channel is taken at start_frame + i * frame_step
+struct BakedChannels
+{
+    f32 start_frame = 0.F;
+    f32 frame_step = 1.F;
+    usize sample_count = 0;
+    std::vector<f32> samples = {};
+
+    [[nodiscard]] usize GetChannelCount() const;
+    [[nodiscard]] std::span<const f32> GetChannel(usize channel) const;
+};
+
+enum class AnimationError : u8
+{
+    InvalidActionType,
+    InvalidCurveType,
+    InvalidKeyframeType,
+    InvalidCurveList,
+    InvalidSampleRange,
+};
+
+[[nodiscard]] Option<const Block&> GetAction(const Blend& blend, const Block& owner);
+[[nodiscard]] Result<ActionCurves, AnimationError> ExtractActionCurves(const Blend& blend, const Block& action);
+
+[[nodiscard]] f32 EvaluateChannel(const ActionCurves& curves, usize channel, f32 frame);
+[[nodiscard]] Result<BakedChannels, AnimationError>
+BakeActionCurves(const ActionCurves& curves, f32 start_frame, f32 end_frame, f32 frame_step);
+} // namespace cblend
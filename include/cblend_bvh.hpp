@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cblend_math.hpp>
+#include <cblend_types.hpp>
+
+#include <array>
+#include <new>
+#include <span>
+#include <vector>
+
+namespace cblend
+{
+static constexpr usize CACHE_LINE_SIZE = 64;
+
+template<class T>
+struct CacheAlignedAllocator
+{
+    using value_type = T;
+
+    CacheAlignedAllocator() = default;
+    template<class U>
+    explicit CacheAlignedAllocator(const CacheAlignedAllocator<U>& /*other*/)
+    {
+    }
+
+    [[nodiscard]] T* allocate(usize count)
+    {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(CACHE_LINE_SIZE)));
+    }
+
+    void deallocate(T* data, usize /*count*/)
+    {
+        ::operator delete(data, std::align_val_t(CACHE_LINE_SIZE));
+    }
+
+    template<class U>
+    bool operator==(const CacheAlignedAllocator<U>& /*other*/) const
+    {
+        return true;
+    }
+};
+
+// Children of an interior node are stored next to each other starting at an even index, so with the root at index 0 and
+// index 1 left unused every sibling pair fills exactly one cache line.
+struct alignas(32) BvhNode
+{
+    Float3 min = {};
+    // First primitive of a leaf, first child of an interior node
+    u32 index = 0;
+    Float3 max = {};
+    // Number of primitives of a leaf, zero for interior nodes
+    u32 count = 0;
+
+    [[nodiscard]] bool IsLeaf() const;
+};
+
+static_assert(sizeof(BvhNode) * 2 == CACHE_LINE_SIZE);
+
+struct Bvh
+{
+    std::vector<BvhNode, CacheAlignedAllocator<BvhNode>> nodes = {};
+    // Triangle indices in leaf order, leaves reference ranges of this array
+    std::vector<u32> primitive_indices = {};
+
+    [[nodiscard]] usize GetNodeCount() const;
+    [[nodiscard]] usize GetPrimitiveCount() const;
+};
+
+struct BvhSettings
+{
+    u32 max_leaf_size = 4;
+    f32 traversal_cost = 1.F;
+    f32 intersection_cost = 1.F;
+};
+
+enum class BvhError : u8
+{
+    InvalidTriangle,
+    TooManyPrimitives,
+    InvalidHeader,
+    UnsupportedVersion,
+    TruncatedData,
+    InvalidNode,
+};
+
+[[nodiscard]] Result<Bvh, BvhError>
+BuildBvh(std::span<const Float3> positions, std::span<const std::array<u32, 3>> triangles, const BvhSettings& settings = {});
+
+// Native endian image of the nodes and primitive indices behind a small versioned header
+[[nodiscard]] std::vector<u8> SerializeBvh(const Bvh& bvh);
+[[nodiscard]] Result<Bvh, BvhError> DeserializeBvh(MemorySpan data);
+} // namespace cblend
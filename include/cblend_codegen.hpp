@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cblend.hpp>
+
+#include <bit>
+#include <concepts>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace cblend
+{
+struct CodegenSettings
+{
+    std::string_view namespace_name = "blender";
+    // Structs to emit along with the structs they embed, empty emits every struct
+    std::vector<std::string_view> struct_names = {};
+};
+
+enum class CodegenError : u8
+{
+    StructNotFound,
+    InvalidNamespace,
+};
+
+// Emits a header with every struct as laid out in this file, static_asserts on their sizes and field offsets and the
+// SDNA hash they were generated from. Pointers are emitted as integers holding the old address.
+[[nodiscard]] Result<std::string, CodegenError> GenerateHeader(const Blend& blend, const CodegenSettings& settings = {});
+
+// Structs emitted by GenerateHeader
+template<class T>
+concept GeneratedStruct = std::is_trivially_copyable_v<T> && requires {
+    {
+        T::SDNA_HASH
+    } -> std::convertible_to<u64>;
+    {
+        T::SDNA_NAME
+    } -> std::convertible_to<std::string_view>;
+};
+
+// Views a block body as generated structs, only if the file has the layouts the header was generated from
+template<GeneratedStruct T>
+[[nodiscard]] Option<std::span<const T>> ViewBlock(const Blend& blend, const Block& block)
+{
+    const bool is_native_endian = (blend.GetEndian() == Endian::Little) == (std::endian::native == std::endian::little);
+    if (blend.GetSdnaHash() != T::SDNA_HASH || !is_native_endian || block.body.size() % sizeof(T) != 0)
+    {
+        return NULL_OPTION;
+    }
+
+    const auto type = blend.GetBlockType(block);
+    if (!type || type->GetSize() != sizeof(T) || type->GetName() != T::SDNA_NAME)
+    {
+        return NULL_OPTION;
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return std::span{ reinterpret_cast<const T*>(block.body.data()), block.body.size() / sizeof(T) };
+}
+} // namespace cblend
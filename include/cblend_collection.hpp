@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cblend.hpp>
+#include <cblend_math.hpp>
+#include <cblend_object.hpp>
+
+#include <vector>
+
+namespace cblend
+{
+// Every renderable placement of one mesh, source objects index into the ObjectHierarchy used for flattening
+struct MeshInstances
+{
+    const Block* mesh = nullptr;
+    std::vector<u32> source_objects = {};
+    std::vector<Float4x4> world_matrices = {};
+};
+
+struct FlattenedInstances
+{
+    std::vector<MeshInstances> meshes = {};
+
+    [[nodiscard]] usize GetInstanceCount() const;
+};
+
+enum class CollectionError : u8
+{
+    InvalidSceneType,
+    InvalidCollectionType,
+    InvalidObjectType,
+    CyclicCollection,
+};
+
+[[nodiscard]] Result<FlattenedInstances, CollectionError>
+FlattenSceneInstances(const Blend& blend, const ObjectHierarchy& hierarchy, const Block& scene);
+[[nodiscard]] Result<FlattenedInstances, CollectionError>
+FlattenCollectionInstances(const Blend& blend, const ObjectHierarchy& hierarchy, const Block& collection);
+} // namespace cblend
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cblend.hpp>
+#include <cblend_math.hpp>
+
+#include <span>
+#include <vector>
+
+namespace cblend
+{
+// Values match the curve_type attribute of Curves data-blocks
+enum class SplineType : u8
+{
+    CatmullRom = 0,
+    Poly = 1,
+    Bezier = 2,
+    Nurbs = 3,
+};
+
+enum class KnotsMode : u8
+{
+    Normal = 0,
+    Endpoint = 1,
+    Bezier = 2,
+    EndpointBezier = 3,
+};
+
+// Control points of all splines of a curve, points of spline s are [point_offsets[s], point_offsets[s + 1]).
+// Handles are only filled when a spline is a bezier, weights and radii default to one when empty.
+struct Splines
+{
+    std::vector<SplineType> types = {};
+    std::vector<u8> cyclic = {};
+    std::vector<u32> resolutions = {};
+    std::vector<u8> orders = {};
+    std::vector<KnotsMode> knots_modes = {};
+    std::vector<u32> point_offsets = {};
+    std::vector<Float3> positions = {};
+    std::vector<Float3> handles_left = {};
+    std::vector<Float3> handles_right = {};
+    std::vector<f32> weights = {};
+    std::vector<f32> radii = {};
+
+    [[nodiscard]] usize GetSplineCount() const;
+    [[nodiscard]] usize GetPointCount() const;
+};
+
+enum class ResolutionMode : u8
+{
+    // Per spline resolution stored in the file
+    Spline,
+    Fixed,
+    // Segments are subdivided until the chord error of their control polygon is below the tolerance
+    Adaptive,
+};
+
+struct TessellationSettings
+{
+    ResolutionMode mode = ResolutionMode::Spline;
+    u32 resolution = 12;
+    f32 tolerance = 1e-3F;
+    u32 max_resolution = 64;
+};
+
+// Evaluated polylines, points of spline s are [offsets[s], offsets[s + 1])
+struct TessellatedSplines
+{
+    std::vector<u32> offsets = {};
+    std::vector<Float3> positions = {};
+    std::vector<f32> radii = {};
+};
+
+enum class CurveError : u8
+{
+    InvalidCurveType,
+    InvalidSplineType,
+    InvalidSplineList,
+    InvalidCurvesGeometry,
+    MismatchedPointCount,
+    InvalidOutputSize,
+};
+
+// Reads legacy curves (CU blocks with Nurb lists) and the Curves data-block (CV blocks)
+[[nodiscard]] Result<Splines, CurveError> ExtractCurveSplines(const Blend& blend, const Block& curve);
+[[nodiscard]] Result<Splines, CurveError> ExtractCurvesSplines(const Blend& blend, const Block& curves);
+
+// Computes the evaluated point offsets so callers can size their own buffers before tessellating into them
+[[nodiscard]] std::vector<u32> ComputeEvaluatedOffsets(const Splines& splines, const TessellationSettings& settings);
+[[nodiscard]] Result<void, CurveError> TessellateSplines(
+    const Splines& splines,
+    const TessellationSettings& settings,
+    std::span<const u32> offsets,
+    std::span<Float3> positions,
+    std::span<f32> radii
+);
+[[nodiscard]] TessellatedSplines TessellateSplines(const Splines& splines, const TessellationSettings& settings);
+} // namespace cblend
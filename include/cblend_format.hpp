@@ -5,6 +5,7 @@
 #include <array>
 #include <bit>
 #include <compare>
+#include <functional>
 #include <string_view>
 #include <vector>
 
@@ -28,16 +29,25 @@ static constexpr usize HEADER_MAGIC_LENGTH = 7U;
 using HeaderMagic = std::array<u8, HEADER_MAGIC_LENGTH>;
 static constexpr HeaderMagic HEADER_MAGIC = { 'B', 'L', 'E', 'N', 'D', 'E', 'R' };
 
-static constexpr usize HEADER_VERSION_LENGTH = 3U;
-using HeaderVersion = std::array<u8, HEADER_VERSION_LENGTH>;
-static constexpr HeaderVersion HEADER_VERSION = { '1', '0', '0' };
+// Legacy: "BLENDER_v300", 32 bit block lengths with 4 or 8 byte pointers
+// Large: "BLENDER17-01v0500", written since 5.0 with 64 bit pointers, block lengths and counts
+enum class HeaderLayout : u8
+{
+    Legacy,
+    Large,
+};
+
+static constexpr u16 LARGE_HEADER_SIZE = 17U;
+static constexpr u16 LARGE_HEADER_FORMAT_VERSION = 1U;
 
 struct Header
 {
     HeaderMagic magic = HEADER_MAGIC;
+    HeaderLayout layout = HeaderLayout::Legacy;
     Pointer pointer = Pointer::U64;
     Endian endian = Endian::Little;
-    HeaderVersion version = HEADER_VERSION;
+    // Blender version that wrote the file, 300 for 3.0
+    u16 version = 0U;
 };
 
 class BlockCode
@@ -73,7 +83,7 @@ private:
 struct BlockHeader
 {
     BlockCode code = {};
-    u32 length = 0U;
+    u64 length = 0U;
     u64 address = 0U;
     u32 struct_index = 0U;
     u32 count = 0U;
@@ -83,6 +93,23 @@ struct Block
 {
     BlockHeader header = {};
     std::vector<u8> body = {};
+    // Position of the body in the file
+    u64 offset = 0U;
+};
+
+enum class BlockFilterMode : u8
+{
+    Allow,
+    Deny,
+};
+
+// Selects the blocks to load by code. DATA blocks follow the block they belong to, DNA1 and ENDB are always loaded.
+struct BlockCodeFilter
+{
+    BlockFilterMode mode = BlockFilterMode::Deny;
+    std::vector<BlockCode> codes = {};
+
+    [[nodiscard]] bool Accepts(const BlockCode& code) const;
 };
 
 struct File
@@ -91,6 +118,14 @@ struct File
     std::vector<Block> blocks = {};
 };
 
+// Preview stored in the TEST block, RGBA8 rows from bottom to top
+struct Thumbnail
+{
+    u32 width = 0U;
+    u32 height = 0U;
+    std::vector<u8> pixels = {};
+};
+
 struct SdnaField
 {
     u16 type_index = 0U;
@@ -109,6 +144,8 @@ struct Sdna
     std::vector<std::string_view> type_names = {};
     std::vector<u16> type_lengths = {};
     std::vector<SdnaStruct> structs = {};
+    // Fingerprint of the DNA1 block, files with equal hashes share every struct layout
+    u64 hash = 0U;
 };
 
 enum class FormatError : u8
@@ -121,11 +158,24 @@ enum class FormatError : u8
     InvalidSdnaHeader,
     UnexpectedEndOfSdna,
     SdnaNotExhausted,
+    ThumbnailNotFound,
+    InvalidThumbnail,
+    BlockNotFound,
 };
 
 [[nodiscard]] Result<Header, FormatError> ReadHeader(Stream& stream);
-[[nodiscard]] Result<File, FormatError> ReadFile(Stream& stream, const Header& header);
+// Bodies of filtered blocks are skipped in the stream and the blocks are left out of the file
+[[nodiscard]] Result<File, FormatError> ReadFile(Stream& stream, const Header& header, const BlockCodeFilter& filter = {});
+// Reads every block header but only the DNA1 body, other bodies stay empty and can be read later from their offset
+[[nodiscard]] Result<File, FormatError> ReadFileHeaders(Stream& stream, const Header& header);
+[[nodiscard]] Result<void, FormatError> ReadBlockBody(Stream& stream, Block& block);
+// Skips bodies from the current position until the first block with the code and reads only its body
+[[nodiscard]] Result<Block, FormatError> FindBlock(Stream& stream, const Header& header, const BlockCode& code);
+// Reads the blocks one by one into the same block, which is only valid during the visitor call
+[[nodiscard]] Result<void, FormatError> VisitFile(Stream& stream, const Header& header, const std::function<void(const Block&)>& visitor);
 [[nodiscard]] Result<Sdna, FormatError> ReadSdna(const File& file);
+// Reads block headers only up to the thumbnail, skipping bodies, and leaves the rest of the stream untouched
+[[nodiscard]] Result<Thumbnail, FormatError> ReadThumbnail(Stream& stream, const Header& header);
 
 static constexpr BlockCode BLOCK_CODE_DATA({ 'D', 'A', 'T', 'A' }); // Arbitrary data
 static constexpr BlockCode BLOCK_CODE_GLOB({ 'G', 'L', 'O', 'B' }); // Global struct
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cblend.hpp>
+
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace cblend
+{
+// Names include the two letter type code, e.g. "OBCube", and view the block bodies of the indexed blend
+struct IdEntry
+{
+    std::string_view name = {};
+    const Block* block = nullptr;
+};
+
+// Entries are sorted by name, so every ID type forms one contiguous range keyed by its code prefix
+class IdIndex final
+{
+public:
+    IdIndex() = default;
+    explicit IdIndex(std::vector<IdEntry> entries);
+
+    [[nodiscard]] usize GetIdCount() const;
+    [[nodiscard]] std::span<const IdEntry> GetIds() const;
+    [[nodiscard]] std::span<const IdEntry> GetIds(std::string_view prefix) const;
+
+    // Linked IDs from different libraries may share a name, the first one in file order is returned
+    [[nodiscard]] Option<const Block&> FindId(std::string_view name) const;
+
+private:
+    std::vector<IdEntry> m_Entries;
+    std::unordered_map<std::string_view, const Block*> m_Names;
+};
+
+enum class IdIndexError : u8
+{
+    InvalidIdType,
+};
+
+// Indexes every block whose struct starts with an ID
+[[nodiscard]] Result<IdIndex, IdIndexError> CreateIdIndex(const Blend& blend);
+
+// Whether the struct of a non DATA block starts with an ID. Checking collects the fields of the struct, so the answer is
+// memoized per struct index in id_structs.
+[[nodiscard]] bool
+IsIdBlock(const Blend& blend, const Block& block, const BlendType& id_type, std::unordered_map<u32, bool>& id_structs);
+} // namespace cblend
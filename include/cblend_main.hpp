@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cblend.hpp>
+
+#include <deque>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace cblend
+{
+struct MainEntry
+{
+    const Block* block = nullptr;
+    // Shared by every entry of the same struct and owned by the database
+    const BlendType* type = nullptr;
+    std::string_view name = {};
+};
+
+// Mirrors Blender's Main, the IDs of each block code form one contiguous range in file order
+class MainDatabase final
+{
+public:
+    MainDatabase() = default;
+    MainDatabase(std::deque<BlendType> types, std::vector<MainEntry> entries);
+    MainDatabase(const MainDatabase&) = delete;
+    MainDatabase(MainDatabase&&) = default;
+    MainDatabase& operator=(const MainDatabase&) = delete;
+    MainDatabase& operator=(MainDatabase&&) = default;
+    ~MainDatabase() = default;
+
+    [[nodiscard]] usize GetIdCount() const;
+    [[nodiscard]] std::span<const BlockCode> GetCodes() const;
+    [[nodiscard]] std::span<const MainEntry> GetIds(const BlockCode& code) const;
+
+private:
+    std::deque<BlendType> m_Types;
+    std::vector<MainEntry> m_Entries;
+    // Sorted codes, the entries of m_Codes[i] are [m_Offsets[i], m_Offsets[i + 1])
+    std::vector<BlockCode> m_Codes;
+    std::vector<usize> m_Offsets;
+};
+
+enum class MainDatabaseError : u8
+{
+    InvalidIdType,
+};
+
+// Classifies every block whose struct starts with an ID by its block code, in parallel over the blocks
+[[nodiscard]] Result<MainDatabase, MainDatabaseError> CreateMainDatabase(const Blend& blend);
+} // namespace cblend
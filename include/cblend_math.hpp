@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cblend_simd.hpp>
+#include <cblend_types.hpp>
+
+#include <array>
+#include <cmath>
+
+namespace cblend
+{
+using Float2 = std::array<f32, 2>;
+using Float3 = std::array<f32, 3>;
+using Float4 = std::array<f32, 4>;
+// Column major, matching Blender's float[4][4] layout where the last column holds the translation
+using Float4x4 = std::array<Float4, 4>;
+
+static constexpr Float4x4 IDENTITY_MATRIX = {
+    Float4{ 1.F, 0.F, 0.F, 0.F },
+    Float4{ 0.F, 1.F, 0.F, 0.F },
+    Float4{ 0.F, 0.F, 1.F, 0.F },
+    Float4{ 0.F, 0.F, 0.F, 1.F },
+};
+
+enum class RotationOrder : u8
+{
+    XYZ,
+    XZY,
+    YXZ,
+    YZX,
+    ZXY,
+    ZYX,
+};
+
+[[nodiscard]] constexpr Float3 Add(const Float3& lhs, const Float3& rhs)
+{
+    return { lhs[0] + rhs[0], lhs[1] + rhs[1], lhs[2] + rhs[2] };
+}
+
+[[nodiscard]] constexpr Float3 Subtract(const Float3& lhs, const Float3& rhs)
+{
+    return { lhs[0] - rhs[0], lhs[1] - rhs[1], lhs[2] - rhs[2] };
+}
+
+[[nodiscard]] constexpr Float3 Scale(const Float3& value, f32 scale)
+{
+    return { value[0] * scale, value[1] * scale, value[2] * scale };
+}
+
+[[nodiscard]] constexpr f32 Dot(const Float3& lhs, const Float3& rhs)
+{
+    return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2];
+}
+
+[[nodiscard]] constexpr Float3 Cross(const Float3& lhs, const Float3& rhs)
+{
+    return { lhs[1] * rhs[2] - lhs[2] * rhs[1], lhs[2] * rhs[0] - lhs[0] * rhs[2], lhs[0] * rhs[1] - lhs[1] * rhs[0] };
+}
+
+[[nodiscard]] inline f32 Length(const Float3& value)
+{
+    return std::sqrt(Dot(value, value));
+}
+
+[[nodiscard]] inline Float3 Normalize(const Float3& value)
+{
+    const f32 length = Length(value);
+    return length > 0.F ? Scale(value, 1.F / length) : Float3{};
+}
+
+[[nodiscard]] inline Float4x4 Multiply(const Float4x4& lhs, const Float4x4& rhs)
+{
+    const auto column_0 = simd::Float4::Load(lhs[0].data());
+    const auto column_1 = simd::Float4::Load(lhs[1].data());
+    const auto column_2 = simd::Float4::Load(lhs[2].data());
+    const auto column_3 = simd::Float4::Load(lhs[3].data());
+
+    Float4x4 result;
+    for (usize column = 0; column < 4; ++column)
+    {
+        const auto value = simd::Float4::Load(rhs[column].data());
+        auto product = column_0 * value.Splat<0>();
+        product = simd::Float4::MulAdd(column_1, value.Splat<1>(), product);
+        product = simd::Float4::MulAdd(column_2, value.Splat<2>(), product);
+        product = simd::Float4::MulAdd(column_3, value.Splat<3>(), product);
+        product.Store(result[column].data());
+    }
+    return result;
+}
+
+[[nodiscard]] inline Float3 TransformPoint(const Float4x4& matrix, const Float3& point)
+{
+    const auto column_0 = simd::Float4::Load(matrix[0].data());
+    const auto column_1 = simd::Float4::Load(matrix[1].data());
+    const auto column_2 = simd::Float4::Load(matrix[2].data());
+    const auto column_3 = simd::Float4::Load(matrix[3].data());
+
+    auto product = simd::Float4::MulAdd(column_0, simd::Float4::Broadcast(point[0]), column_3);
+    product = simd::Float4::MulAdd(column_1, simd::Float4::Broadcast(point[1]), product);
+    product = simd::Float4::MulAdd(column_2, simd::Float4::Broadcast(point[2]), product);
+
+    const auto result = product.ToArray();
+    return { result[0], result[1], result[2] };
+}
+
+[[nodiscard]] Option<Float4x4> Invert(const Float4x4& matrix);
+[[nodiscard]] Float4x4 EulerToMatrix(const Float3& euler, RotationOrder order);
+// Quaternions are stored as w, x, y, z and are normalized before conversion
+[[nodiscard]] Float4x4 QuaternionToMatrix(const Float4& quaternion);
+[[nodiscard]] Float4x4 AxisAngleToMatrix(const Float3& axis, f32 angle);
+// Dispatches on Blender's rotmode: 0 uses the quaternion, -1 the axis angle and 1 to 6 the euler orders XYZ to ZYX
+[[nodiscard]] Float4x4 RotationToMatrix(s16 mode, const Float3& euler, const Float4& quaternion, const Float3& axis, f32 angle);
+// Builds translation * rotation * scale, only the upper 3x3 of rotation is used
+[[nodiscard]] Float4x4 ComposeTransform(const Float3& translation, const Float4x4& rotation, const Float3& scale);
+} // namespace cblend
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cblend.hpp>
+#include <cblend_math.hpp>
+
+#include <string_view>
+#include <vector>
+
+namespace cblend
+{
+enum class CustomDataType : s32
+{
+    MVert = 0,
+    MEdge = 3,
+    PropFloat = 10,
+    PropInt32 = 11,
+    MLoopUV = 16,
+    PropByteColor = 17,
+    MPoly = 25,
+    MLoop = 26,
+    PropInt8 = 45,
+    PropColor = 47,
+    PropFloat3 = 48,
+    PropFloat2 = 49,
+    PropBool = 50,
+    PropInt32_2D = 53,
+};
+
+struct CustomDataLayer
+{
+    CustomDataType type = {};
+    std::string_view name = {};
+    MemorySpan data = {};
+};
+
+struct Mesh
+{
+    std::vector<Float3> positions = {};
+    std::vector<std::array<u32, 2>> edges = {};
+    std::vector<u32> face_offsets = {};
+    std::vector<u32> corner_verts = {};
+    std::vector<u32> corner_edges = {};
+    std::vector<u8> sharp_edges = {};
+    std::vector<u8> sharp_faces = {};
+    Option<f32> auto_smooth_angle = NULL_OPTION;
+
+    [[nodiscard]] usize GetVertexCount() const;
+    [[nodiscard]] usize GetFaceCount() const;
+    [[nodiscard]] usize GetCornerCount() const;
+};
+
+struct MeshNormals
+{
+    std::vector<Float3> face_normals = {};
+    std::vector<Float3> vertex_normals = {};
+    std::vector<Float3> corner_normals = {};
+};
+
+enum class MeshError : u8
+{
+    InvalidMeshType,
+    InvalidCustomData,
+    MissingPositions,
+    MissingCorners,
+    MissingFaces,
+    InvalidTopology,
+};
+
+[[nodiscard]] Result<std::vector<CustomDataLayer>, MeshError>
+GetCustomDataLayers(const Blend& blend, const Block& block, std::string_view field_name, usize element_count);
+// Reads the layers of a CustomData field nested in a struct that is not a block of its own
+[[nodiscard]] Result<std::vector<CustomDataLayer>, MeshError> GetCustomDataLayers(
+    const Blend& blend,
+    const BlendType& owner_type,
+    MemorySpan owner_data,
+    std::string_view field_name,
+    usize element_count
+);
+[[nodiscard]] Result<Mesh, MeshError> ExtractMesh(const Blend& blend, const Block& block);
+
+[[nodiscard]] std::vector<Float3> ComputeFaceNormals(const Mesh& mesh);
+[[nodiscard]] std::vector<f32> ComputeCornerAngles(const Mesh& mesh);
+[[nodiscard]] std::vector<Float3> ComputeVertexNormals(const Mesh& mesh, std::span<const Float3> face_normals);
+[[nodiscard]] std::vector<Float3> ComputeCornerNormals(const Mesh& mesh, std::span<const Float3> face_normals);
+[[nodiscard]] MeshNormals ComputeNormals(const Mesh& mesh);
+// Fans every face around its first corner, face f owns triangles [face_offsets[f] - 2 * f, face_offsets[f + 1] - 2 * (f + 1))
+[[nodiscard]] std::vector<std::array<u32, 3>> TriangulateFaces(const Mesh& mesh);
+} // namespace cblend
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cblend.hpp>
+
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace cblend
+{
+enum class NativeType : u8
+{
+    S8,
+    U8,
+    S16,
+    U16,
+    S32,
+    U32,
+    S64,
+    U64,
+    F32,
+    F64,
+};
+
+template<class T>
+[[nodiscard]] constexpr NativeType GetNativeType()
+{
+    if constexpr (std::is_same_v<T, s8> || std::is_same_v<T, char>)
+    {
+        return NativeType::S8;
+    }
+    else if constexpr (std::is_same_v<T, u8>)
+    {
+        return NativeType::U8;
+    }
+    else if constexpr (std::is_same_v<T, s16>)
+    {
+        return NativeType::S16;
+    }
+    else if constexpr (std::is_same_v<T, u16>)
+    {
+        return NativeType::U16;
+    }
+    else if constexpr (std::is_same_v<T, s32>)
+    {
+        return NativeType::S32;
+    }
+    else if constexpr (std::is_same_v<T, u32>)
+    {
+        return NativeType::U32;
+    }
+    else if constexpr (std::is_same_v<T, s64>)
+    {
+        return NativeType::S64;
+    }
+    else if constexpr (std::is_same_v<T, u64>)
+    {
+        return NativeType::U64;
+    }
+    else if constexpr (std::is_same_v<T, f32>)
+    {
+        return NativeType::F32;
+    }
+    else
+    {
+        static_assert(std::is_same_v<T, f64>, "Unsupported native type");
+        return NativeType::F64;
+    }
+}
+
+[[nodiscard]] usize GetNativeTypeSize(NativeType type);
+
+// A field of an engine side mirror of a Blender struct, matched to the SDNA field of the same name. Pointers read as
+// their old address, so declare them as U64.
+struct NativeField
+{
+    std::string_view name = {};
+    usize offset = 0;
+    NativeType type = NativeType::U8;
+    usize count = 1;
+};
+
+struct NativeStruct
+{
+    // SDNA struct name
+    std::string_view name = {};
+    usize size = 0;
+    std::vector<NativeField> fields = {};
+};
+
+enum class CopyOperation : u8
+{
+    Copy,
+    Convert,
+    Zero,
+};
+
+struct CopyStep
+{
+    CopyOperation operation = CopyOperation::Copy;
+    NativeType source_type = NativeType::U8;
+    NativeType target_type = NativeType::U8;
+    bool is_byte_swapped = false;
+    u32 source_offset = 0;
+    u32 target_offset = 0;
+    // Bytes for Copy and Zero, elements for Convert
+    u32 count = 0;
+};
+
+// Rebuilds native structs from file structs like Blender's DNA reconstruction: matching fields become merged copies,
+// differing scalar types are converted and fields missing from the file are zeroed. Native padding is left untouched.
+struct CopyPlan
+{
+    usize source_size = 0;
+    usize target_size = 0;
+    std::vector<CopyStep> steps = {};
+};
+
+enum class NativeStructError : u8
+{
+    StructNotFound,
+    InvalidNativeField,
+    InvalidTargetSize,
+};
+
+[[nodiscard]] Result<CopyPlan, NativeStructError> CompileCopyPlan(const Blend& blend, const NativeStruct& native);
+
+// Converts every whole file struct in source into the matching native struct in target
+[[nodiscard]] Result<void, NativeStructError> ConvertStructs(const CopyPlan& plan, MemorySpan source, std::span<u8> target);
+template<class T>
+requires std::is_trivially_copyable_v<T>
+[[nodiscard]] Result<std::vector<T>, NativeStructError> ConvertStructs(const CopyPlan& plan, MemorySpan source);
+
+// Compiles each plan once per SDNA layout. Plans are keyed by the contents of the description rather than its address, so
+// descriptions may be temporaries and identical ones share a plan.
+class CopyPlanCache final
+{
+public:
+    [[nodiscard]] Result<const CopyPlan*, NativeStructError> GetPlan(const Blend& blend, const NativeStruct& native);
+    [[nodiscard]] usize GetPlanCount() const;
+
+private:
+    struct Key
+    {
+        u64 sdna_hash = 0;
+        std::string native = {};
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash
+    {
+        usize operator()(const Key& key) const;
+    };
+
+    mutable std::mutex m_Mutex;
+    std::unordered_map<Key, std::unique_ptr<const CopyPlan>, KeyHash> m_Plans;
+};
+
+template<class T>
+requires std::is_trivially_copyable_v<T>
+inline Result<std::vector<T>, NativeStructError> ConvertStructs(const CopyPlan& plan, MemorySpan source)
+{
+    if (plan.target_size != sizeof(T) || plan.source_size == 0)
+    {
+        return MakeError(NativeStructError::InvalidTargetSize);
+    }
+
+    std::vector<T> result(source.size() / plan.source_size);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const std::span<u8> target = { reinterpret_cast<u8*>(result.data()), result.size() * sizeof(T) };
+    if (auto converted = ConvertStructs(plan, source, target); !converted)
+    {
+        return MakeError(converted.error());
+    }
+
+    return result;
+}
+} // namespace cblend
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cblend.hpp>
+#include <cblend_math.hpp>
+
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace cblend
+{
+static constexpr u32 NO_PARENT = std::numeric_limits<u32>::max();
+
+// Objects ordered by depth so every parent precedes its children, level_offsets delimits each depth level
+struct ObjectHierarchy
+{
+    std::vector<const Block*> objects = {};
+    std::vector<std::string_view> names = {};
+    std::vector<u32> parents = {};
+    std::vector<Float4x4> local_matrices = {};
+    std::vector<Float4x4> world_matrices = {};
+    std::vector<u32> level_offsets = {};
+
+    [[nodiscard]] usize GetObjectCount() const;
+    [[nodiscard]] usize GetLevelCount() const;
+    [[nodiscard]] Option<u32> FindObject(std::string_view name) const;
+};
+
+enum class ObjectError : u8
+{
+    InvalidObjectType,
+    MissingTransform,
+    CyclicParent,
+};
+
+[[nodiscard]] Result<ObjectHierarchy, ObjectError> ExtractObjectHierarchy(const Blend& blend);
+void ComputeWorldMatrices(ObjectHierarchy& hierarchy);
+} // namespace cblend
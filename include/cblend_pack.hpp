@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cblend_math.hpp>
+#include <cblend_mesh.hpp>
+#include <cblend_types.hpp>
+
+#include <span>
+#include <vector>
+
+namespace cblend
+{
+enum class SourceFormat : u8
+{
+    Float32,
+    Unorm8,
+};
+
+// Strided view over an attribute, read in place. When indices are set, element i reads source element indices[i],
+// which lets per-vertex layers be packed per corner without expanding them first.
+struct AttributeSource
+{
+    MemorySpan data = {};
+    usize stride = 0;
+    u32 component_count = 0;
+    SourceFormat format = SourceFormat::Float32;
+    std::span<const u32> indices = {};
+
+    [[nodiscard]] usize GetElementCount() const;
+};
+
+enum class PackedFormat : u8
+{
+    Float32,
+    Float16,
+    Unorm8,
+    Snorm16,
+    // Each component remapped from [min, max] of its bounds to [-1, 1]
+    BoundedSnorm16,
+    // Unit vectors folded onto the octahedron, stored as two snorm16 components
+    OctahedralSnorm16,
+};
+
+struct AttributeBounds
+{
+    Float4 min = {};
+    Float4 max = {};
+};
+
+struct PackedAttribute
+{
+    AttributeSource source = {};
+    PackedFormat format = PackedFormat::Float32;
+    // Required by BoundedSnorm16, computed from the source when missing
+    Option<AttributeBounds> bounds = NULL_OPTION;
+};
+
+enum class PackLayout : u8
+{
+    Interleaved,
+    Planar,
+};
+
+struct PackedStream
+{
+    std::vector<u8> data = {};
+    usize stride = 0;
+};
+
+struct PackedAttributeLayout
+{
+    u32 stream = 0;
+    u32 offset = 0;
+    PackedFormat format = PackedFormat::Float32;
+    u32 component_count = 0;
+    AttributeBounds bounds = {};
+};
+
+struct PackedVertices
+{
+    usize vertex_count = 0;
+    std::vector<PackedStream> streams = {};
+    std::vector<PackedAttributeLayout> attributes = {};
+};
+
+enum class PackError : u8
+{
+    InvalidSource,
+    UnsupportedLayerType,
+    InvalidComponentCount,
+    MismatchedElementCount,
+};
+
+[[nodiscard]] Result<AttributeSource, PackError> MakeAttributeSource(const CustomDataLayer& layer, usize element_count);
+[[nodiscard]] AttributeBounds ComputeBounds(const AttributeSource& source);
+// Component count of the attribute once packed, attribute sizes are padded to four bytes inside a stream
+[[nodiscard]] u32 GetPackedComponentCount(PackedFormat format, u32 source_component_count);
+[[nodiscard]] u32 GetPackedSize(PackedFormat format, u32 source_component_count);
+
+[[nodiscard]] Result<PackedVertices, PackError> PackAttributes(std::span<const PackedAttribute> attributes, PackLayout layout);
+} // namespace cblend
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cblend.hpp>
+
+#include <string_view>
+#include <vector>
+
+namespace cblend
+{
+// A file embedded in the .blend. Data views the block that stores the packed bytes without copying them, and file_offset
+// locates the same bytes in the .blend so large payloads can be streamed straight from disk.
+struct PackedFileEntry
+{
+    const Block* owner = nullptr;
+    std::string_view owner_name = {};
+    std::string_view file_path = {};
+    MemorySpan data = {};
+    u64 file_offset = 0;
+
+    [[nodiscard]] usize GetSize() const;
+};
+
+enum class PackedFileError : u8
+{
+    InvalidPackedFileType,
+    InvalidOwnerType,
+    MissingData,
+};
+
+// Enumerates the packed files of all images (IM), then sounds (SO), then fonts (VF), each in block order, skipping packed
+// files whose header or payload is missing from the file
+[[nodiscard]] Result<std::vector<PackedFileEntry>, PackedFileError> GetPackedFiles(const Blend& blend);
+[[nodiscard]] Result<std::vector<PackedFileEntry>, PackedFileError> GetPackedFiles(const Blend& blend, const Block& owner);
+} // namespace cblend
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cblend_types.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace cblend
+{
+[[nodiscard]] inline usize GetWorkerCount()
+{
+    return std::max<usize>(std::thread::hardware_concurrency(), 1U);
+}
+
+// Splits [0, count) into contiguous chunks of at least min_chunk_size and invokes function(begin, end) for each chunk,
+// using the calling thread for the first chunk. Chunks never overlap, so writes to per-index outputs need no synchronization.
+template<class F>
+void ParallelFor(usize count, usize min_chunk_size, F&& function)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const usize max_chunks = (count + std::max<usize>(min_chunk_size, 1U) - 1) / std::max<usize>(min_chunk_size, 1U);
+    const usize chunk_count = std::min(GetWorkerCount(), max_chunks);
+
+    if (chunk_count <= 1)
+    {
+        function(usize(0), count);
+        return;
+    }
+
+    const usize chunk_size = (count + chunk_count - 1) / chunk_count;
+    std::vector<std::jthread> workers;
+    workers.reserve(chunk_count - 1);
+
+    for (usize chunk = 1; chunk < chunk_count; ++chunk)
+    {
+        const usize begin = chunk * chunk_size;
+        const usize end = std::min(begin + chunk_size, count);
+
+        if (begin >= end)
+        {
+            break;
+        }
+
+        workers.emplace_back([&function, begin, end]() { function(begin, end); });
+    }
+
+    function(usize(0), std::min(chunk_size, count));
+}
+
+// Runs both tasks and returns once they finished. With spawn set the second task runs on its own worker while the calling
+// thread runs the first, which lets recursive algorithms fork their upper levels and stay serial below.
+template<class F, class G>
+void ParallelInvoke(bool spawn, F&& first, G&& second)
+{
+    if (!spawn)
+    {
+        first();
+        second();
+        return;
+    }
+
+    std::jthread worker([&second]() { second(); });
+    first();
+}
+} // namespace cblend
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cblend.hpp>
+
+#include <span>
+#include <vector>
+
+namespace cblend
+{
+// One node per ID block, plus typed file level blocks like GLOB, in file order. DATA blocks belong to the preceding
+// node the way Blender reads them, so a pointer into them references their owner. Both adjacencies are compressed
+// rows: the references of node i are references[reference_offsets[i], reference_offsets[i + 1]).
+struct ReferenceGraph
+{
+    std::vector<const Block*> nodes = {};
+    std::vector<u32> reference_offsets = {};
+    std::vector<u32> references = {};
+    std::vector<u32> referrer_offsets = {};
+    std::vector<u32> referrers = {};
+    // Nodes grouped by wave, every node comes after the nodes it references so each wave can be processed in parallel.
+    // Nodes referencing each other in a cycle, like a shape key and its mesh, share a wave.
+    std::vector<u32> order = {};
+    std::vector<u32> wave_offsets = {};
+
+    [[nodiscard]] usize GetNodeCount() const;
+    [[nodiscard]] Option<u32> FindNode(const Block& block) const;
+    [[nodiscard]] std::span<const u32> GetReferences(u32 node) const;
+    [[nodiscard]] std::span<const u32> GetReferrers(u32 node) const;
+
+    [[nodiscard]] usize GetWaveCount() const;
+    [[nodiscard]] std::span<const u32> GetWave(usize wave) const;
+};
+
+enum class ReferenceGraphError : u8
+{
+    InvalidIdType,
+    TooManyNodes,
+};
+
+// Scans every pointer field of every block in parallel, pointer to pointer fields also scan the pointer array they
+// reference. ID list links (next, prev) are ignored since they only chain IDs of the same type.
+[[nodiscard]] Result<ReferenceGraph, ReferenceGraphError> BuildReferenceGraph(const Blend& blend);
+} // namespace cblend
@@ -2,7 +2,11 @@
 
 #include <cblend_types.hpp>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <new>
+#include <span>
 #include <string_view>
 #include <vector>
 
@@ -38,11 +42,55 @@ protected:
     [[nodiscard]] virtual CanonicalType GetCanonicalType() const = 0;
 };
 
+// Bump allocator owning the types of a TypeDatabase. Types never move and are destroyed together with the arena.
+class TypeArena final
+{
+public:
+    TypeArena() = default;
+    TypeArena(const TypeArena&) = delete;
+    TypeArena(TypeArena&& other) noexcept;
+    TypeArena& operator=(const TypeArena&) = delete;
+    TypeArena& operator=(TypeArena&& other) noexcept;
+    ~TypeArena();
+
+    template<class T, class... Args>
+    requires std::is_base_of_v<Type, T>
+    [[nodiscard]] T& Create(Args&&... args);
+    [[nodiscard]] usize GetTypeCount() const;
+
+private:
+    static constexpr usize CHUNK_SIZE = 16384;
+    static constexpr usize MIN_TYPE_CAPACITY = 256;
+
+    // NOLINTNEXTLINE(*-avoid-c-arrays)
+    std::vector<std::unique_ptr<std::byte[]>> m_Chunks;
+    std::vector<Type*> m_Types;
+    std::byte* m_Cursor = nullptr;
+    usize m_Remaining = 0;
+
+    [[nodiscard]] void* Allocate(usize size, usize alignment);
+};
+
+template<class T, class... Args>
+requires std::is_base_of_v<Type, T>
+inline T& TypeArena::Create(Args&&... args)
+{
+    // Grow before constructing so push_back can not throw and leak the type, geometrically to keep interning linear
+    if (m_Types.size() == m_Types.capacity())
+    {
+        m_Types.reserve(std::max(m_Types.capacity() * 2, MIN_TYPE_CAPACITY));
+    }
+
+    T* type = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    m_Types.push_back(type);
+    return *type;
+}
+
 class TypeContainer final
 {
 public:
     TypeContainer() = default;
-    explicit TypeContainer(std::unique_ptr<Type> contained);
+    explicit TypeContainer(const Type& contained);
     TypeContainer(const TypeContainer&) = delete;
     TypeContainer(TypeContainer&& other) noexcept = default;
     TypeContainer& operator=(const TypeContainer&) = delete;
@@ -54,14 +102,13 @@ public:
 
 private:
     const Type* m_Pointer = nullptr;
-    std::unique_ptr<const Type> m_Contained = nullptr;
 };
 
 template<class T, class... Args>
 requires std::is_base_of_v<Type, T>
-[[nodiscard]] inline TypeContainer MakeContainer(Args&&... args)
+[[nodiscard]] inline TypeContainer MakeContainer(TypeArena& arena, Args&&... args)
 {
-    return TypeContainer(std::make_unique<T>(std::forward<Args>(args)...));
+    return TypeContainer(arena.Create<T>(std::forward<Args>(args)...));
 }
 
 class AggregateType final : public Type
@@ -174,4 +221,55 @@ private:
 
     [[nodiscard]] CanonicalType GetCanonicalType() const final;
 };
+
+static constexpr u32 INVALID_TYPE_INDEX = std::numeric_limits<u32>::max();
+
+// Plain data mirror of a Type, so the hot paths read kinds and sizes without virtual calls. Indices refer to the
+// descriptor tables of the same TypeDatabase.
+struct TypeDescriptor
+{
+    CanonicalType kind = CanonicalType::Fundamental;
+    // Pointee of pointers, element of arrays
+    u32 element_index = INVALID_TYPE_INDEX;
+    // Element count of arrays
+    u32 rank = 0;
+    // Fields of aggregates
+    u32 field_begin = 0;
+    u32 field_count = 0;
+    // Perfect hash over the field names of aggregates, see TypeDescriptorTable::FindField
+    u32 lookup_slot_begin = 0;
+    u32 lookup_slot_mask = 0;
+    u32 lookup_seed_begin = 0;
+    u32 lookup_bucket_mask = 0;
+    usize size = 0;
+    const Type* type = nullptr;
+};
+
+static constexpr u32 INVALID_FIELD_INDEX = std::numeric_limits<u32>::max();
+
+struct FieldDescriptor
+{
+    usize offset = 0;
+    // Interned, equal names share their storage across all types of a database
+    std::string_view name = {};
+    u32 type_index = INVALID_TYPE_INDEX;
+};
+
+// Views the descriptor storage, which does not move with the TypeDatabase owning it
+struct TypeDescriptorTable
+{
+    std::span<const TypeDescriptor> types = {};
+    std::span<const FieldDescriptor> fields = {};
+    // Field indices, INVALID_FIELD_INDEX for empty slots
+    std::span<const u32> lookup_slots = {};
+    std::span<const u16> lookup_seeds = {};
+
+    // One hash and one name comparison
+    [[nodiscard]] Option<const FieldDescriptor&> FindField(const TypeDescriptor& type, std::string_view name) const;
+};
+
+// Fields hash into buckets, and the seed of their bucket moves them to distinct slots
+[[nodiscard]] u64 HashFieldName(std::string_view name);
+[[nodiscard]] u32 GetFieldLookupBucket(u64 hash, u32 bucket_mask);
+[[nodiscard]] u32 GetFieldLookupSlot(u64 hash, u16 seed, u32 slot_mask);
 } // namespace cblend
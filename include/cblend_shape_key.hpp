@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cblend.hpp>
+#include <cblend_math.hpp>
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace cblend
+{
+// Key blocks in file order, deltas of key k are [delta_offsets[k], delta_offsets[k + 1]) and only hold
+// vertices that move further than the extraction threshold from the key they are relative to
+struct ShapeKeys
+{
+    std::vector<Float3> basis = {};
+    std::vector<std::string_view> names = {};
+    std::vector<f32> values = {};
+    std::vector<u32> relative_keys = {};
+    std::vector<u32> delta_offsets = {};
+    std::vector<u32> delta_indices = {};
+    std::vector<Float3> deltas = {};
+
+    [[nodiscard]] usize GetKeyCount() const;
+    [[nodiscard]] usize GetVertexCount() const;
+    [[nodiscard]] Option<u32> FindKey(std::string_view name) const;
+};
+
+enum class ShapeKeyError : u8
+{
+    InvalidKeyType,
+    InvalidKeyBlockType,
+    InvalidKeyBlockList,
+    InvalidElementSize,
+    MismatchedElementCount,
+};
+
+[[nodiscard]] Option<const Block&> GetShapeKey(const Blend& blend, const Block& owner);
+[[nodiscard]] Result<ShapeKeys, ShapeKeyError> ExtractShapeKeys(const Blend& blend, const Block& key, f32 threshold = 0.F);
+void EncodeShapeKeyDeltas(
+    std::span<const Float3> reference,
+    std::span<const Float3> positions,
+    f32 threshold,
+    std::vector<u32>& indices,
+    std::vector<Float3>& deltas
+);
+} // namespace cblend
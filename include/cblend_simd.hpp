@@ -0,0 +1,470 @@
+#pragma once
+
+#include <cblend_types.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+
+#if defined(__AVX2__)
+#define CBLEND_SIMD_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CBLEND_SIMD_SSE 1
+#endif
+
+#if defined(CBLEND_SIMD_AVX2) || defined(CBLEND_SIMD_SSE)
+#include <immintrin.h>
+#endif
+
+namespace cblend::simd
+{
+// IEEE 754 binary16 conversion with round to nearest even, used when F16C is unavailable
+[[nodiscard]] inline u16 FloatToHalf(f32 value)
+{
+    const u32 bits = std::bit_cast<u32>(value);
+    const u32 sign = (bits >> 16U) & 0x8000U;
+    const u32 mantissa = bits & 0x7FFFFFU;
+    const s32 exponent = s32((bits >> 23U) & 0xFFU) - 127 + 15;
+
+    if ((bits & 0x7FFFFFFFU) >= 0x7F800000U)
+    {
+        return u16(sign | 0x7C00U | (mantissa != 0 ? 0x200U : 0U));
+    }
+
+    if (exponent >= 31)
+    {
+        return u16(sign | 0x7C00U);
+    }
+
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+        {
+            return u16(sign);
+        }
+
+        const u32 shift = u32(14 - exponent);
+        const u32 full_mantissa = mantissa | 0x800000U;
+        u32 half = full_mantissa >> shift;
+        const u32 remainder = full_mantissa & ((1U << shift) - 1U);
+        const u32 halfway = 1U << (shift - 1U);
+        half += u32(remainder > halfway || (remainder == halfway && (half & 1U) != 0));
+        return u16(sign | half);
+    }
+
+    // A carry out of the mantissa correctly bumps the exponent, up to infinity
+    u32 half = (u32(exponent) << 10U) | (mantissa >> 13U);
+    const u32 remainder = mantissa & 0x1FFFU;
+    half += u32(remainder > 0x1000U || (remainder == 0x1000U && (half & 1U) != 0));
+    return u16(sign | half);
+}
+
+// Fixed four lane vector, used for AoS math such as matrix rows
+class Float4
+{
+public:
+#if defined(CBLEND_SIMD_SSE)
+    using Register = __m128;
+#else
+    using Register = std::array<f32, 4>;
+#endif
+
+    Float4() = default;
+    explicit Float4(Register value) : m_Value(value) {}
+
+    [[nodiscard]] static Float4 Load(const f32* data)
+    {
+#if defined(CBLEND_SIMD_SSE)
+        return Float4(_mm_loadu_ps(data));
+#else
+        return Float4(Register{ data[0], data[1], data[2], data[3] });
+#endif
+    }
+
+    [[nodiscard]] static Float4 Set(f32 x, f32 y, f32 z, f32 w)
+    {
+#if defined(CBLEND_SIMD_SSE)
+        return Float4(_mm_setr_ps(x, y, z, w));
+#else
+        return Float4(Register{ x, y, z, w });
+#endif
+    }
+
+    [[nodiscard]] static Float4 Broadcast(f32 value)
+    {
+#if defined(CBLEND_SIMD_SSE)
+        return Float4(_mm_set1_ps(value));
+#else
+        return Float4(Register{ value, value, value, value });
+#endif
+    }
+
+    void Store(f32* data) const
+    {
+#if defined(CBLEND_SIMD_SSE)
+        _mm_storeu_ps(data, m_Value);
+#else
+        std::copy(m_Value.begin(), m_Value.end(), data);
+#endif
+    }
+
+    template<usize Lane>
+    [[nodiscard]] Float4 Splat() const
+    {
+        static_assert(Lane < 4, "Lane out of range");
+#if defined(CBLEND_SIMD_SSE)
+        return Float4(_mm_shuffle_ps(m_Value, m_Value, _MM_SHUFFLE(Lane, Lane, Lane, Lane)));
+#else
+        return Broadcast(m_Value[Lane]);
+#endif
+    }
+
+    [[nodiscard]] std::array<f32, 4> ToArray() const
+    {
+        std::array<f32, 4> result = {};
+        Store(result.data());
+        return result;
+    }
+
+    friend Float4 operator+(Float4 lhs, Float4 rhs)
+    {
+#if defined(CBLEND_SIMD_SSE)
+        return Float4(_mm_add_ps(lhs.m_Value, rhs.m_Value));
+#else
+        return Apply(lhs, rhs, [](f32 a, f32 b) { return a + b; });
+#endif
+    }
+
+    friend Float4 operator-(Float4 lhs, Float4 rhs)
+    {
+#if defined(CBLEND_SIMD_SSE)
+        return Float4(_mm_sub_ps(lhs.m_Value, rhs.m_Value));
+#else
+        return Apply(lhs, rhs, [](f32 a, f32 b) { return a - b; });
+#endif
+    }
+
+    friend Float4 operator*(Float4 lhs, Float4 rhs)
+    {
+#if defined(CBLEND_SIMD_SSE)
+        return Float4(_mm_mul_ps(lhs.m_Value, rhs.m_Value));
+#else
+        return Apply(lhs, rhs, [](f32 a, f32 b) { return a * b; });
+#endif
+    }
+
+    [[nodiscard]] static Float4 MulAdd(Float4 lhs, Float4 rhs, Float4 add)
+    {
+#if defined(CBLEND_SIMD_SSE) && defined(__FMA__)
+        return Float4(_mm_fmadd_ps(lhs.m_Value, rhs.m_Value, add.m_Value));
+#else
+        return lhs * rhs + add;
+#endif
+    }
+
+private:
+    Register m_Value;
+
+#if !defined(CBLEND_SIMD_SSE)
+    template<class F>
+    static Float4 Apply(Float4 lhs, Float4 rhs, F&& function)
+    {
+        return Float4(Register{
+            function(lhs.m_Value[0], rhs.m_Value[0]),
+            function(lhs.m_Value[1], rhs.m_Value[1]),
+            function(lhs.m_Value[2], rhs.m_Value[2]),
+            function(lhs.m_Value[3], rhs.m_Value[3]),
+        });
+    }
+#endif
+};
+
+// Widest available vector, used for SoA batches: 8 lanes with AVX2, 4 with SSE and 1 otherwise
+class FloatN
+{
+public:
+#if defined(CBLEND_SIMD_AVX2)
+    using Register = __m256;
+    static constexpr usize WIDTH = 8U;
+#elif defined(CBLEND_SIMD_SSE)
+    using Register = __m128;
+    static constexpr usize WIDTH = 4U;
+#else
+    using Register = f32;
+    static constexpr usize WIDTH = 1U;
+#endif
+
+    FloatN() = default;
+    explicit FloatN(Register value) : m_Value(value) {}
+
+    [[nodiscard]] static FloatN Load(const f32* data)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return FloatN(_mm256_loadu_ps(data));
+#elif defined(CBLEND_SIMD_SSE)
+        return FloatN(_mm_loadu_ps(data));
+#else
+        return FloatN(*data);
+#endif
+    }
+
+    [[nodiscard]] static FloatN Broadcast(f32 value)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return FloatN(_mm256_set1_ps(value));
+#elif defined(CBLEND_SIMD_SSE)
+        return FloatN(_mm_set1_ps(value));
+#else
+        return FloatN(value);
+#endif
+    }
+
+    void Store(f32* data) const
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        _mm256_storeu_ps(data, m_Value);
+#elif defined(CBLEND_SIMD_SSE)
+        _mm_storeu_ps(data, m_Value);
+#else
+        *data = m_Value;
+#endif
+    }
+
+    friend FloatN operator+(FloatN lhs, FloatN rhs)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return FloatN(_mm256_add_ps(lhs.m_Value, rhs.m_Value));
+#elif defined(CBLEND_SIMD_SSE)
+        return FloatN(_mm_add_ps(lhs.m_Value, rhs.m_Value));
+#else
+        return FloatN(lhs.m_Value + rhs.m_Value);
+#endif
+    }
+
+    friend FloatN operator-(FloatN lhs, FloatN rhs)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return FloatN(_mm256_sub_ps(lhs.m_Value, rhs.m_Value));
+#elif defined(CBLEND_SIMD_SSE)
+        return FloatN(_mm_sub_ps(lhs.m_Value, rhs.m_Value));
+#else
+        return FloatN(lhs.m_Value - rhs.m_Value);
+#endif
+    }
+
+    friend FloatN operator*(FloatN lhs, FloatN rhs)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return FloatN(_mm256_mul_ps(lhs.m_Value, rhs.m_Value));
+#elif defined(CBLEND_SIMD_SSE)
+        return FloatN(_mm_mul_ps(lhs.m_Value, rhs.m_Value));
+#else
+        return FloatN(lhs.m_Value * rhs.m_Value);
+#endif
+    }
+
+    friend FloatN operator/(FloatN lhs, FloatN rhs)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return FloatN(_mm256_div_ps(lhs.m_Value, rhs.m_Value));
+#elif defined(CBLEND_SIMD_SSE)
+        return FloatN(_mm_div_ps(lhs.m_Value, rhs.m_Value));
+#else
+        return FloatN(lhs.m_Value / rhs.m_Value);
+#endif
+    }
+
+    [[nodiscard]] static FloatN MulAdd(FloatN lhs, FloatN rhs, FloatN add)
+    {
+#if defined(CBLEND_SIMD_AVX2) && defined(__FMA__)
+        return FloatN(_mm256_fmadd_ps(lhs.m_Value, rhs.m_Value, add.m_Value));
+#elif defined(CBLEND_SIMD_SSE) && defined(__FMA__)
+        return FloatN(_mm_fmadd_ps(lhs.m_Value, rhs.m_Value, add.m_Value));
+#else
+        return lhs * rhs + add;
+#endif
+    }
+
+    [[nodiscard]] static FloatN Min(FloatN lhs, FloatN rhs)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return FloatN(_mm256_min_ps(lhs.m_Value, rhs.m_Value));
+#elif defined(CBLEND_SIMD_SSE)
+        return FloatN(_mm_min_ps(lhs.m_Value, rhs.m_Value));
+#else
+        return FloatN(rhs.m_Value < lhs.m_Value ? rhs.m_Value : lhs.m_Value);
+#endif
+    }
+
+    [[nodiscard]] static FloatN Max(FloatN lhs, FloatN rhs)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return FloatN(_mm256_max_ps(lhs.m_Value, rhs.m_Value));
+#elif defined(CBLEND_SIMD_SSE)
+        return FloatN(_mm_max_ps(lhs.m_Value, rhs.m_Value));
+#else
+        return FloatN(lhs.m_Value < rhs.m_Value ? rhs.m_Value : lhs.m_Value);
+#endif
+    }
+
+    [[nodiscard]] static FloatN Sqrt(FloatN value)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return FloatN(_mm256_sqrt_ps(value.m_Value));
+#elif defined(CBLEND_SIMD_SSE)
+        return FloatN(_mm_sqrt_ps(value.m_Value));
+#else
+        return FloatN(std::sqrt(value.m_Value));
+#endif
+    }
+
+    // Lanes where the mask is greater than zero take the first value, all other lanes take the second
+    [[nodiscard]] static FloatN SelectPositive(FloatN mask, FloatN positive, FloatN other)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        const __m256 condition = _mm256_cmp_ps(mask.m_Value, _mm256_setzero_ps(), _CMP_GT_OQ);
+        return FloatN(_mm256_blendv_ps(other.m_Value, positive.m_Value, condition));
+#elif defined(CBLEND_SIMD_SSE)
+        const __m128 condition = _mm_cmpgt_ps(mask.m_Value, _mm_setzero_ps());
+        return FloatN(_mm_or_ps(_mm_and_ps(condition, positive.m_Value), _mm_andnot_ps(condition, other.m_Value)));
+#else
+        return mask.m_Value > 0.F ? positive : other;
+#endif
+    }
+
+    // Rounds halfway cases to even, matching the default floating point environment
+    [[nodiscard]] static FloatN Round(FloatN value)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return FloatN(_mm256_round_ps(value.m_Value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+#elif defined(CBLEND_SIMD_SSE) && defined(__SSE4_1__)
+        return FloatN(_mm_round_ps(value.m_Value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+#elif defined(CBLEND_SIMD_SSE)
+        return FloatN(_mm_cvtepi32_ps(_mm_cvtps_epi32(value.m_Value)));
+#else
+        return FloatN(std::nearbyint(value.m_Value));
+#endif
+    }
+
+    void StoreHalf(u16* data) const
+    {
+#if defined(CBLEND_SIMD_AVX2) && defined(__F16C__)
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data), _mm256_cvtps_ph(m_Value, _MM_FROUND_TO_NEAREST_INT));
+#elif defined(CBLEND_SIMD_SSE) && defined(__F16C__)
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(data), _mm_cvtps_ph(m_Value, _MM_FROUND_TO_NEAREST_INT));
+#else
+        std::array<f32, WIDTH> values = {};
+        Store(values.data());
+        std::transform(values.begin(), values.end(), data, FloatToHalf);
+#endif
+    }
+
+private:
+    Register m_Value;
+};
+
+// Integer counterpart of FloatN with the same lane count, used for hashing
+class UInt32N
+{
+public:
+#if defined(CBLEND_SIMD_AVX2)
+    using Register = __m256i;
+#elif defined(CBLEND_SIMD_SSE)
+    using Register = __m128i;
+#else
+    using Register = u32;
+#endif
+    static constexpr usize WIDTH = FloatN::WIDTH;
+
+    UInt32N() = default;
+    explicit UInt32N(Register value) : m_Value(value) {}
+
+    [[nodiscard]] static UInt32N Load(const u32* data)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return UInt32N(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)));
+#elif defined(CBLEND_SIMD_SSE)
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return UInt32N(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+#else
+        return UInt32N(*data);
+#endif
+    }
+
+    [[nodiscard]] static UInt32N Broadcast(u32 value)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return UInt32N(_mm256_set1_epi32(s32(value)));
+#elif defined(CBLEND_SIMD_SSE)
+        return UInt32N(_mm_set1_epi32(s32(value)));
+#else
+        return UInt32N(value);
+#endif
+    }
+
+    void Store(u32* data) const
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), m_Value);
+#elif defined(CBLEND_SIMD_SSE)
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data), m_Value);
+#else
+        *data = m_Value;
+#endif
+    }
+
+    friend UInt32N operator^(UInt32N lhs, UInt32N rhs)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return UInt32N(_mm256_xor_si256(lhs.m_Value, rhs.m_Value));
+#elif defined(CBLEND_SIMD_SSE)
+        return UInt32N(_mm_xor_si128(lhs.m_Value, rhs.m_Value));
+#else
+        return UInt32N(lhs.m_Value ^ rhs.m_Value);
+#endif
+    }
+
+    // Wrapping multiply of each lane, keeping the low 32 bits
+    friend UInt32N operator*(UInt32N lhs, UInt32N rhs)
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return UInt32N(_mm256_mullo_epi32(lhs.m_Value, rhs.m_Value));
+#elif defined(CBLEND_SIMD_SSE) && defined(__SSE4_1__)
+        return UInt32N(_mm_mullo_epi32(lhs.m_Value, rhs.m_Value));
+#elif defined(CBLEND_SIMD_SSE)
+        // NOLINTBEGIN(hicpp-signed-bitwise)
+        const __m128i even = _mm_mul_epu32(lhs.m_Value, rhs.m_Value);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_si128(lhs.m_Value, 4), _mm_srli_si128(rhs.m_Value, 4));
+        return UInt32N(
+            _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)))
+        );
+        // NOLINTEND(hicpp-signed-bitwise)
+#else
+        return UInt32N(lhs.m_Value * rhs.m_Value);
+#endif
+    }
+
+    template<s32 Bits>
+    [[nodiscard]] UInt32N ShiftRight() const
+    {
+#if defined(CBLEND_SIMD_AVX2)
+        return UInt32N(_mm256_srli_epi32(m_Value, Bits));
+#elif defined(CBLEND_SIMD_SSE)
+        return UInt32N(_mm_srli_epi32(m_Value, Bits));
+#else
+        return UInt32N(m_Value >> u32(Bits));
+#endif
+    }
+
+private:
+    Register m_Value;
+};
+} // namespace cblend::simd
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cblend.hpp>
+#include <cblend_math.hpp>
+#include <cblend_object.hpp>
+
+#include <string_view>
+#include <vector>
+
+namespace cblend
+{
+// Bones in depth first order, so every parent precedes its children. Rest and pose matrices are in armature space,
+// pose_local_matrices hold the pose channel loc/rot/scale relative to the rest pose.
+struct Skeleton
+{
+    std::vector<std::string_view> names = {};
+    std::vector<u32> parents = {};
+    std::vector<Float4x4> rest_matrices = {};
+    std::vector<Float4x4> pose_local_matrices = {};
+    std::vector<Float4x4> pose_matrices = {};
+
+    [[nodiscard]] usize GetBoneCount() const;
+    [[nodiscard]] Option<u32> FindBone(std::string_view name) const;
+};
+
+enum class SkeletonError : u8
+{
+    InvalidObjectType,
+    InvalidArmatureType,
+    InvalidBoneType,
+    InvalidPoseType,
+    InvalidBoneList,
+};
+
+// Accepts an armature object, whose pose is applied when present, or an AR block for the rest pose alone
+[[nodiscard]] Result<Skeleton, SkeletonError> ExtractSkeleton(const Blend& blend, const Block& block);
+void ComputePoseMatrices(Skeleton& skeleton);
+} // namespace cblend
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cblend.hpp>
+
+#include <array>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace cblend
+{
+// Location of a field path inside a struct, resolved against the SDNA of one file
+struct ViewField
+{
+    usize offset = 0;
+    usize size = 0;
+    bool is_pointer = false;
+};
+
+// Resolves a path of field names and array indices without leaving the struct, pointers can only end a path
+[[nodiscard]] Result<ViewField, QueryValueError> ResolveViewField(const BlendType& type, const Query& query);
+
+// Typed access to a few fields of one struct. Binding resolves every path once, after which each access is a bounds
+// checked load at the cached offset. Paths missing from a file stay unresolved and read as NULL_OPTION.
+template<QueryString StructName, QueryString... Fields>
+class StructView final
+{
+public:
+    static constexpr usize FIELD_COUNT = sizeof...(Fields);
+
+    [[nodiscard]] static Result<StructView, QueryValueError> Bind(const Blend& blend);
+
+    [[nodiscard]] usize GetSize() const { return m_Size; }
+
+    template<usize Index>
+    requires(Index < FIELD_COUNT)
+    [[nodiscard]] const Option<ViewField>& GetField() const
+    {
+        return m_Fields[Index];
+    }
+
+    template<usize Index, class T>
+    requires(Index < FIELD_COUNT && std::is_trivially_copyable_v<T>)
+    [[nodiscard]] Option<T> Get(MemorySpan data) const
+    {
+        const auto& field = m_Fields[Index];
+        if (!field || field->size != sizeof(T) || field->offset + sizeof(T) > data.size())
+        {
+            return NULL_OPTION;
+        }
+
+        T value;
+        std::memcpy(&value, data.data() + field->offset, sizeof(T));
+        return value;
+    }
+
+    template<usize Index, class T>
+    requires(Index < FIELD_COUNT && std::is_trivially_copyable_v<T>)
+    [[nodiscard]] Option<T> Get(const Block& block) const
+    {
+        return Get<Index, T>(block.body);
+    }
+
+    // Old address stored in a pointer field, widened for 32-bit files
+    template<usize Index>
+    requires(Index < FIELD_COUNT)
+    [[nodiscard]] Option<u64> GetPointerAddress(MemorySpan data) const
+    {
+        const auto& field = m_Fields[Index];
+        if (!field || !field->is_pointer)
+        {
+            return NULL_OPTION;
+        }
+
+        if (field->size == sizeof(u32))
+        {
+            if (const auto address = Get<Index, u32>(data))
+            {
+                return u64(*address);
+            }
+            return NULL_OPTION;
+        }
+        return Get<Index, u64>(data);
+    }
+
+private:
+    usize m_Size = 0;
+    std::array<Option<ViewField>, FIELD_COUNT> m_Fields = {};
+};
+
+template<QueryString StructName, QueryString... Fields>
+inline Result<StructView<StructName, Fields...>, QueryValueError> StructView<StructName, Fields...>::Bind(const Blend& blend)
+{
+    const auto type = blend.GetType(std::string_view(StructName.string));
+    if (!type || !type->IsStruct())
+    {
+        return MakeError(QueryValueError::InvalidType);
+    }
+
+    const std::array<Result<Query, QueryError>, FIELD_COUNT> queries = { Query::Create<Fields>()... };
+
+    StructView view;
+    view.m_Size = type->GetSize();
+    for (usize index = 0; index < FIELD_COUNT; ++index)
+    {
+        if (!queries[index])
+        {
+            return MakeError(QueryValueError::InvalidQuery);
+        }
+
+        // Fields renamed or removed in this version of the file are left unresolved
+        if (auto field = ResolveViewField(*type, *queries[index]))
+        {
+            view.m_Fields[index] = *field;
+        }
+    }
+
+    return view;
+}
+} // namespace cblend
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cblend_types.hpp>
+
+#include <span>
+#include <vector>
+
+namespace cblend
+{
+// One attribute of the welded tuple, stored as element_size bytes per corner
+struct AttributeStream
+{
+    MemorySpan data = {};
+    usize element_size = 0;
+};
+
+struct WeldResult
+{
+    std::vector<u32> indices = {};
+    std::vector<u32> source_corners = {};
+
+    [[nodiscard]] usize GetCornerCount() const;
+    [[nodiscard]] usize GetVertexCount() const;
+    // Average number of corners sharing each unique vertex
+    [[nodiscard]] f32 GetReuseRatio() const;
+};
+
+enum class WeldError : u8
+{
+    InvalidStream,
+    StreamTooSmall,
+    TooManyCorners,
+};
+
+// Assigns every corner the index of the first corner with a bitwise identical tuple across all streams,
+// numbering unique vertices in order of first appearance.
+[[nodiscard]] Result<WeldResult, WeldError> WeldCorners(std::span<const AttributeStream> streams, usize corner_count);
+[[nodiscard]] std::vector<u8> GatherVertices(const AttributeStream& stream, const WeldResult& result);
+} // namespace cblend
@@ -1,11 +1,16 @@
 #include <cblend.hpp>
 #include <range/v3/algorithm/all_of.hpp>
 #include <range/v3/algorithm/count_if.hpp>
+#include <range/v3/algorithm/find.hpp>
 #include <range/v3/algorithm/find_if.hpp>
 #include <range/v3/algorithm/sort.hpp>
 
+#include <algorithm>
+#include <bit>
 #include <cctype>
 #include <charconv>
+#include <cstring>
+#include <numeric>
 
 using namespace cblend;
 
@@ -29,90 +34,121 @@ MemorySpan MemoryTable::GetMemory(u64 address, usize size) const
     return {};
 }
 
-BlendType::BlendType(const MemoryTable& memory_table, const Type& type) : m_MemoryTable(memory_table), m_Type(type)
+Option<const MemoryRange&> MemoryTable::GetRange(u64 address) const
 {
-    if (IsPointer())
+    const auto range
+        = std::partition_point(m_Ranges.begin(), m_Ranges.end(), [address](const MemoryRange& current) { return current.head <= address; });
+    if (range != m_Ranges.begin() && std::prev(range)->tail > address)
     {
-        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-        m_ElementType = &reinterpret_cast<const PointerType&>(type).GetPointeeType();
-    }
-    else if (IsArray())
-    {
-        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-        const auto& array = reinterpret_cast<const ArrayType&>(type);
-        m_ElementType = &array.GetElementType();
-        m_ArrayRank = array.GetElementCount();
+        return *std::prev(range);
     }
-    else if (IsStruct())
+
+    return NULL_OPTION;
+}
+
+MemorySpan MemoryTable::GetRemainingMemory(u64 address) const
+{
+    auto range_contains = [address](const MemoryRange& range)
     {
-        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-        auto fields = reinterpret_cast<const AggregateType&>(type).GetFields();
-        m_Fields.reserve(fields.size());
-        m_FieldsByName.reserve(fields.size());
+        return range.head <= address && range.tail > address;
+    };
 
-        for (const auto& field : fields)
-        {
-            m_Fields.emplace_back(&field);
-            m_FieldsByName.emplace(field.name, &field);
-        }
+    if (auto result = ranges::find_if(m_Ranges, range_contains); result != m_Ranges.end())
+    {
+        return result->span.subspan(address - result->head);
     }
+
+    return {};
+}
+
+BlendType::BlendType(const MemoryTable& memory_table, const TypeDescriptorTable& descriptor_table, u32 type_index)
+    : m_MemoryTable(memory_table)
+    , m_DescriptorTable(descriptor_table)
+    , m_Descriptor(&descriptor_table.types[type_index])
+{
 }
 
 bool cblend::BlendType::operator==(const BlendType& other) const
 {
-    return &m_Type == &other.m_Type;
+    return m_Descriptor == other.m_Descriptor;
 }
 
 [[nodiscard]] bool BlendType::IsArray() const
 {
-    return m_Type.IsArrayType();
+    return m_Descriptor->kind == CanonicalType::Array;
 }
 
 [[nodiscard]] bool BlendType::IsPointer() const
 {
-    return m_Type.IsPointerType();
+    return m_Descriptor->kind == CanonicalType::Pointer;
 }
 
 [[nodiscard]] bool BlendType::IsPrimitive() const
 {
-    return m_Type.IsFundamentalType();
+    return m_Descriptor->kind == CanonicalType::Fundamental;
 }
 
 [[nodiscard]] bool BlendType::IsStruct() const
 {
-    return m_Type.IsAggregateType();
+    return m_Descriptor->kind == CanonicalType::Aggregate;
 }
 
 [[nodiscard]] usize BlendType::GetSize() const
 {
-    return m_Type.GetSize();
+    return m_Descriptor->size;
+}
+
+[[nodiscard]] const TypeDescriptor& BlendType::GetDescriptor() const
+{
+    return *m_Descriptor;
+}
+
+[[nodiscard]] const Type& BlendType::GetType() const
+{
+    return *m_Descriptor->type;
+}
+
+[[nodiscard]] std::string_view BlendType::GetName() const
+{
+    if (IsStruct())
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return reinterpret_cast<const AggregateType&>(GetType()).GetName();
+    }
+
+    if (IsPrimitive())
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return reinterpret_cast<const FundamentalType&>(GetType()).GetName();
+    }
+
+    return {};
 }
 
 [[nodiscard]] bool BlendType::HasElementType() const
 {
-    return m_ElementType != nullptr;
+    return m_Descriptor->element_index != INVALID_TYPE_INDEX;
 }
 
 [[nodiscard]] Option<BlendType> BlendType::GetElementType() const
 {
-    if (m_ElementType != nullptr)
+    if (m_Descriptor->element_index != INVALID_TYPE_INDEX)
     {
-        const Type& type = *m_ElementType;
-        return BlendType(m_MemoryTable, type);
+        return BlendType(m_MemoryTable, m_DescriptorTable, m_Descriptor->element_index);
     }
     return NULL_OPTION;
 }
 
 [[nodiscard]] usize BlendType::GetArrayRank() const
 {
-    return m_ArrayRank;
+    return m_Descriptor->rank;
 }
 
 [[nodiscard]] Option<BlendFieldInfo> BlendType::GetField(std::string_view field_name) const
 {
-    if (const auto& field = m_FieldsByName.find(field_name); field != m_FieldsByName.end())
+    if (const auto field = m_DescriptorTable.FindField(*m_Descriptor, field_name))
     {
-        return BlendFieldInfo(m_MemoryTable, *field->second, *this);
+        return BlendFieldInfo(m_MemoryTable, m_DescriptorTable, *field, *this);
     }
     return NULL_OPTION;
 }
@@ -120,10 +156,10 @@ bool cblend::BlendType::operator==(const BlendType& other) const
 [[nodiscard]] std::vector<BlendFieldInfo> BlendType::GetFields() const
 {
     std::vector<BlendFieldInfo> results;
-    results.reserve(m_Fields.size());
-    for (const auto& field : m_Fields)
+    results.reserve(m_Descriptor->field_count);
+    for (const auto& field : m_DescriptorTable.fields.subspan(m_Descriptor->field_begin, m_Descriptor->field_count))
     {
-        results.emplace_back(m_MemoryTable, *field, *this);
+        results.emplace_back(m_MemoryTable, m_DescriptorTable, field, *this);
     }
     return results;
 }
@@ -246,13 +282,18 @@ BlendType::QueryEachValue(MemorySpan data, const Query& query, const std::functi
     return {};
 }
 
-BlendFieldInfo::BlendFieldInfo(const MemoryTable& memory_table, const AggregateType::Field& field, const BlendType& declaring_type)
+BlendFieldInfo::BlendFieldInfo(
+    const MemoryTable& memory_table,
+    const TypeDescriptorTable& descriptor_table,
+    const FieldDescriptor& field,
+    const BlendType& declaring_type
+)
     : m_MemoryTable(memory_table)
     , m_Offset(field.offset)
     , m_Name(field.name)
     , m_DeclaringType(declaring_type)
-    , m_FieldType(m_MemoryTable, **field.type)
-    , m_Size((*field.type)->GetSize())
+    , m_FieldType(m_MemoryTable, descriptor_table, field.type_index)
+    , m_Size(m_FieldType.GetSize())
 {
 }
 
@@ -286,11 +327,21 @@ BlendFieldInfo::BlendFieldInfo(const MemoryTable& memory_table, const AggregateT
     return GetData(block.body);
 }
 
-MemorySpan BlendFieldInfo::GetPointerData(MemorySpan span) const
+[[nodiscard]] usize BlendFieldInfo::GetOffset() const
+{
+    return m_Offset;
+}
+
+[[nodiscard]] usize BlendFieldInfo::GetSize() const
+{
+    return m_Size;
+}
+
+Option<u64> BlendFieldInfo::GetPointerAddress(MemorySpan span) const
 {
     if (!m_FieldType.IsPointer())
     {
-        return {};
+        return NULL_OPTION;
     }
 
     if (auto value = GetData(span); value.size() == m_Size)
@@ -299,17 +350,37 @@ MemorySpan BlendFieldInfo::GetPointerData(MemorySpan span) const
         {
             std::array<u8, sizeof(u64)> result = {};
             std::copy(value.begin(), value.end(), result.data());
-            return m_MemoryTable.GetMemory(std::bit_cast<u64>(result), m_FieldType.GetElementType()->GetSize());
+            return std::bit_cast<u64>(result);
         }
 
         if (m_Size == sizeof(u32))
         {
             std::array<u8, sizeof(u32)> result = {};
             std::copy(value.begin(), value.end(), result.data());
-            return m_MemoryTable.GetMemory(std::bit_cast<u32>(result), m_FieldType.GetElementType()->GetSize());
+            return u64(std::bit_cast<u32>(result));
         }
     }
 
+    return NULL_OPTION;
+}
+
+MemorySpan BlendFieldInfo::GetPointerData(MemorySpan span) const
+{
+    if (!m_FieldType.IsPointer())
+    {
+        return {};
+    }
+
+    return GetPointerData(span, m_FieldType.GetElementType()->GetSize());
+}
+
+MemorySpan BlendFieldInfo::GetPointerData(MemorySpan span, usize size) const
+{
+    if (const auto address = GetPointerAddress(span); address && *address != 0)
+    {
+        return m_MemoryTable.GetMemory(*address, size);
+    }
+
     return {};
 }
 
@@ -318,6 +389,32 @@ MemorySpan BlendFieldInfo::GetPointerData(const Block& block) const
     return GetPointerData(block.body);
 }
 
+std::string_view BlendFieldInfo::GetString(MemorySpan span) const
+{
+    const auto data = GetData(span);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* chars = reinterpret_cast<const char*>(data.data());
+    return { chars, strnlen(chars, data.size()) };
+}
+
+std::string_view BlendFieldInfo::GetPointerString(MemorySpan span) const
+{
+    if (const auto address = GetPointerAddress(span); address && *address != 0)
+    {
+        const auto data = m_MemoryTable.GetRemainingMemory(*address);
+        if (data.empty())
+        {
+            return {};
+        }
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        const auto* chars = reinterpret_cast<const char*>(data.data());
+        return { chars, strnlen(chars, data.size()) };
+    }
+
+    return {};
+}
+
 bool IsValidName(std::string_view name)
 {
     // Must not be empty
@@ -336,8 +433,80 @@ bool IsValidName(std::string_view name)
     return ranges::all_of(name, [](const char chr) { return std::isalpha(chr) != 0 || std::isdigit(chr) != 0 || chr == '_'; });
 }
 
+// Hash-conses the derived types of a TypeDatabase, so every field spelling the same pointer or array shares one type.
+// Types are keyed by their slot in the type list, which stays valid when the second pass turns a fundamental into an aggregate.
+class TypeInterner
+{
+public:
+    TypeInterner(TypeDatabase& type_database, usize pointer_size) : m_TypeDatabase(type_database), m_PointerSize(pointer_size) {}
+
+    [[nodiscard]] const Type* const* GetFunctionType(std::string_view name)
+    {
+        auto [type, is_new] = m_FunctionTypes.try_emplace(name, nullptr);
+        if (is_new)
+        {
+            type->second = AddType<FunctionType>(name);
+        }
+
+        return type->second;
+    }
+
+    [[nodiscard]] const Type* const* GetPointerType(const Type* const* pointee_type)
+    {
+        auto [type, is_new] = m_PointerTypes.try_emplace(pointee_type, nullptr);
+        if (is_new)
+        {
+            type->second = AddType<PointerType>(pointee_type, m_PointerSize);
+        }
+
+        return type->second;
+    }
+
+    [[nodiscard]] const Type* const* GetArrayType(const Type* const* element_type, usize element_count)
+    {
+        auto [type, is_new] = m_ArrayTypes.try_emplace(ArrayKey{ element_type, element_count }, nullptr);
+        if (is_new)
+        {
+            type->second = AddType<ArrayType>(element_count, element_type);
+        }
+
+        return type->second;
+    }
+
+private:
+    struct ArrayKey
+    {
+        const Type* const* element_type = nullptr;
+        usize element_count = 0;
+
+        bool operator==(const ArrayKey& other) const = default;
+    };
+
+    struct ArrayKeyHash
+    {
+        usize operator()(const ArrayKey& key) const
+        {
+            // NOLINTNEXTLINE(*-magic-numbers)
+            return std::hash<const Type* const*>()(key.element_type) ^ (std::hash<usize>()(key.element_count) * 0x9E3779B97F4A7C15U);
+        }
+    };
+
+    TypeDatabase& m_TypeDatabase;
+    usize m_PointerSize;
+    std::unordered_map<std::string_view, const Type* const*> m_FunctionTypes;
+    std::unordered_map<const Type* const*, const Type* const*> m_PointerTypes;
+    std::unordered_map<ArrayKey, const Type* const*, ArrayKeyHash> m_ArrayTypes;
+
+    template<class T, class... Args>
+    [[nodiscard]] const Type* const* AddType(Args&&... args)
+    {
+        m_TypeDatabase.type_list.push_back(MakeContainer<T>(m_TypeDatabase.type_arena, std::forward<Args>(args)...));
+        return &m_TypeDatabase.type_list.back();
+    }
+};
+
 Result<Option<AggregateType::Field>, ReflectionError>
-ProcessFunctionPointerField(usize field_offset, std::string_view field_name, usize pointer_size, TypeDatabase::TypeList& types)
+ProcessFunctionPointerField(usize field_offset, std::string_view field_name, TypeInterner& types)
 {
     if (!field_name.starts_with('('))
     {
@@ -358,10 +527,7 @@ ProcessFunctionPointerField(usize field_offset, std::string_view field_name, usi
         return MakeError(ReflectionError::InvalidSdnaFieldName);
     }
 
-    types.push_back(MakeContainer<FunctionType>(name));
-    types.push_back(MakeContainer<PointerType>(&types.back(), pointer_size));
-
-    return AggregateType::Field{ .offset = field_offset, .name = name, .type = &types.back() };
+    return AggregateType::Field{ .offset = field_offset, .name = name, .type = types.GetPointerType(types.GetFunctionType(name)) };
 }
 
 usize CountPointers(std::string_view field_name)
@@ -386,12 +552,11 @@ usize CalculateNameLength(std::string_view field_name, usize pointer_count)
     return index - pointer_count;
 }
 
-const Type* const* AddPointers(usize pointer_count, const Type* const* type, usize pointer_size, TypeDatabase::TypeList& types)
+const Type* const* AddPointers(usize pointer_count, const Type* const* type, TypeInterner& types)
 {
     while (pointer_count > 0)
     {
-        types.push_back(MakeContainer<PointerType>(type, pointer_size));
-        type = &types.back();
+        type = types.GetPointerType(type);
         --pointer_count;
     }
     return type;
@@ -400,9 +565,8 @@ const Type* const* AddPointers(usize pointer_count, const Type* const* type, usi
 Result<Option<AggregateType::Field>, ReflectionError> ProcessField(
     usize field_offset,
     std::string_view field_name,
-    usize pointer_size,
     const Type* const* field_type,
-    TypeDatabase::TypeList& types
+    TypeInterner& types
 )
 {
     const usize pointer_count = CountPointers(field_name);
@@ -416,63 +580,218 @@ Result<Option<AggregateType::Field>, ReflectionError> ProcessField(
     }
 
     usize name_end = pointer_count + name_length;
+    std::vector<usize> counts;
 
     // Handle arrays such as: field_name[0][1]
-    while (name_end + 1 < field_name.size())
+    while (name_end < field_name.size())
     {
-        auto array_begin = name_end + 1;
-
         // First character must be '['
         if (field_name[name_end] != '[')
         {
             return MakeError(ReflectionError::InvalidSdnaFieldName);
         }
 
-        while (name_end + 1 < field_name.size())
+        const usize array_begin = name_end + 1;
+        const usize array_end = field_name.find(']', array_begin);
+
+        // Last character must be ']'
+        if (array_end == std::string_view::npos)
         {
-            ++name_end;
-            // Handle the ending of an array
-            if (field_name[name_end] == ']')
-            {
-                if (name_end + 1 >= field_name.size())
+            return MakeError(ReflectionError::InvalidSdnaFieldName);
+        }
+
+        usize count = 0;
+        auto result = std::from_chars(field_name.data() + array_begin, field_name.data() + array_end, count);
+
+        if (result.ec != std::errc() || result.ptr != field_name.data() + array_end)
+        {
+            return MakeError(ReflectionError::InvalidSdnaFieldName);
+        }
+
+        counts.push_back(count);
+        name_end = array_end + 1;
+    }
+
+    // Pointers bind to the element type, and the last dimension is the innermost one
+    type = AddPointers(pointer_count, type, types);
+    for (auto count = counts.rbegin(); count != counts.rend(); ++count)
+    {
+        type = types.GetArrayType(type, *count);
+    }
+
+    return AggregateType::Field{ .offset = field_offset, .name = name, .type = type };
+}
+
+[[nodiscard]] bool
+PlaceFieldBuckets(std::span<const u64> hashes, u32 slot_mask, u32 bucket_mask, std::vector<u32>& slots, std::vector<u16>& seeds)
+{
+    std::vector<std::vector<u32>> buckets(bucket_mask + 1);
+    for (u32 field = 0; field < hashes.size(); ++field)
+    {
+        buckets[GetFieldLookupBucket(hashes[field], bucket_mask)].push_back(field);
+    }
+
+    std::vector<u32> order(buckets.size());
+    std::iota(order.begin(), order.end(), 0U);
+    std::stable_sort(order.begin(), order.end(), [&](u32 first, u32 second) { return buckets[first].size() > buckets[second].size(); });
+
+    slots.assign(slot_mask + 1, INVALID_FIELD_INDEX);
+    seeds.assign(bucket_mask + 1, 0U);
+    std::vector<u32> bucket_slots;
+
+    // Largest buckets first, while most slots are still free
+    for (const u32 bucket : order)
+    {
+        bool is_placed = buckets[bucket].empty();
+        for (u32 seed = 0; seed <= std::numeric_limits<u16>::max() && !is_placed; ++seed)
+        {
+            bucket_slots.clear();
+            is_placed = ranges::all_of(
+                buckets[bucket],
+                [&](u32 field)
                 {
-                    continue;
+                    const u32 slot = GetFieldLookupSlot(hashes[field], u16(seed), slot_mask);
+                    if (slots[slot] != INVALID_FIELD_INDEX || ranges::find(bucket_slots, slot) != bucket_slots.end())
+                    {
+                        return false;
+                    }
+                    bucket_slots.push_back(slot);
+                    return true;
                 }
+            );
 
-                // Next character must be '['
-                if (field_name[++name_end] != '[')
+            if (is_placed)
+            {
+                seeds[bucket] = u16(seed);
+                for (usize index = 0; index < bucket_slots.size(); ++index)
                 {
-                    return MakeError(ReflectionError::InvalidSdnaFieldName);
+                    slots[bucket_slots[index]] = buckets[bucket][index];
                 }
             }
-            // We encountered a non-digit
-            else if (std::isdigit(field_name[name_end]) == 0)
-            {
-                return MakeError(ReflectionError::InvalidSdnaFieldName);
-            }
         }
 
-        auto array_end = name_end;
+        if (!is_placed)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
 
-        // Last character must be ']'
-        if (field_name[name_end] != ']')
+// Hash and displace over the field names of one aggregate, growing the table when a bucket cannot be placed
+[[nodiscard]] bool BuildFieldLookup(TypeDatabase& type_database, TypeDescriptor& descriptor)
+{
+    const auto fields = std::span{ type_database.field_descriptors }.subspan(descriptor.field_begin, descriptor.field_count);
+    std::vector<u64> hashes;
+    std::vector<u32> field_indices;
+    hashes.reserve(fields.size());
+    field_indices.reserve(fields.size());
+
+    for (auto field = fields.begin(); field != fields.end(); ++field)
+    {
+        // Like a name map, only the first of duplicated names can be found
+        if (std::any_of(fields.begin(), field, [&](const FieldDescriptor& other) { return other.name.data() == field->name.data(); }))
         {
-            return MakeError(ReflectionError::InvalidSdnaFieldName);
+            continue;
         }
 
-        usize count = 0;
-        auto result = std::from_chars(field_name.data() + array_begin, field_name.data() + array_end, count);
+        hashes.push_back(HashFieldName(field->name));
+        field_indices.push_back(descriptor.field_begin + u32(field - fields.begin()));
+    }
 
-        if (result.ec != std::errc())
+    const u32 field_count = u32(hashes.size());
+    std::vector<u32> slots;
+    std::vector<u16> seeds;
+    static constexpr u32 MAX_GROWTH = 4;
+
+    for (u32 growth = 0; growth <= MAX_GROWTH; ++growth)
+    {
+        const u32 slot_mask = (std::bit_ceil(std::max(field_count, 1U)) << growth) - 1;
+        const u32 bucket_mask = std::bit_ceil(std::max(field_count / 2, 1U)) - 1;
+        if (!PlaceFieldBuckets(hashes, slot_mask, bucket_mask, slots, seeds))
         {
-            return MakeError(ReflectionError::InvalidSdnaFieldName);
+            continue;
         }
 
-        types.push_back(MakeContainer<ArrayType>(count, type));
-        type = &types.back();
+        for (auto& slot : slots)
+        {
+            slot = slot != INVALID_FIELD_INDEX ? field_indices[slot] : INVALID_FIELD_INDEX;
+        }
+
+        descriptor.lookup_slot_begin = u32(type_database.field_lookup_slots.size());
+        descriptor.lookup_slot_mask = slot_mask;
+        descriptor.lookup_seed_begin = u32(type_database.field_lookup_seeds.size());
+        descriptor.lookup_bucket_mask = bucket_mask;
+        type_database.field_lookup_slots.insert(type_database.field_lookup_slots.end(), slots.begin(), slots.end());
+        type_database.field_lookup_seeds.insert(type_database.field_lookup_seeds.end(), seeds.begin(), seeds.end());
+        return true;
+    }
+
+    return false;
+}
+
+[[nodiscard]] Result<void, ReflectionError> BuildTypeDescriptors(TypeDatabase& type_database)
+{
+    const auto& types = type_database.type_list;
+    std::unordered_map<const Type*, u32> type_indices;
+    type_indices.reserve(types.size());
+    for (usize type_index = 0; type_index < types.size(); ++type_index)
+    {
+        const Type& type(types[type_index]);
+        type_indices.emplace(&type, u32(type_index));
+    }
+
+    type_database.type_descriptors.resize(types.size());
+    for (usize type_index = 0; type_index < types.size(); ++type_index)
+    {
+        const Type& type(types[type_index]);
+        auto& descriptor = type_database.type_descriptors[type_index];
+        descriptor.size = type.GetSize();
+        descriptor.type = &type;
+
+        if (type.IsPointerType())
+        {
+            descriptor.kind = CanonicalType::Pointer;
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            descriptor.element_index = type_indices.at(&reinterpret_cast<const PointerType&>(type).GetPointeeType());
+        }
+        else if (type.IsArrayType())
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            const auto& array = reinterpret_cast<const ArrayType&>(type);
+            descriptor.kind = CanonicalType::Array;
+            descriptor.element_index = type_indices.at(&array.GetElementType());
+            descriptor.rank = u32(array.GetElementCount());
+        }
+        else if (type.IsAggregateType())
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            const auto fields = reinterpret_cast<const AggregateType&>(type).GetFields();
+            descriptor.kind = CanonicalType::Aggregate;
+            descriptor.field_begin = u32(type_database.field_descriptors.size());
+            descriptor.field_count = u32(fields.size());
+
+            for (const auto& field : fields)
+            {
+                const auto name = *type_database.field_names.insert(field.name).first;
+                type_database.field_descriptors.push_back(
+                    { .offset = field.offset, .name = name, .type_index = type_indices.at(*field.type) }
+                );
+            }
+
+            if (!BuildFieldLookup(type_database, descriptor))
+            {
+                return MakeError(ReflectionError::InvalidSdnaStruct);
+            }
+        }
+        else if (type.IsFunctionType())
+        {
+            descriptor.kind = CanonicalType::Function;
+        }
     }
 
-    return AggregateType::Field{ .offset = field_offset, .name = name, .type = AddPointers(pointer_count, type, pointer_size, types) };
+    return {};
 }
 
 Result<TypeDatabase, ReflectionError> CreateTypeDatabase(const File& file, const Sdna& sdna)
@@ -484,6 +803,7 @@ Result<TypeDatabase, ReflectionError> CreateTypeDatabase(const File& file, const
 
     // First pass, assumes all types are fundamental
     TypeDatabase type_database;
+    type_database.sdna_hash = sdna.hash;
     type_database.type_list.resize(type_count);
     type_database.type_map.reserve(type_count);
 
@@ -491,11 +811,12 @@ Result<TypeDatabase, ReflectionError> CreateTypeDatabase(const File& file, const
     {
         const auto size = sdna.type_lengths[type_index];
         const auto& name = sdna.type_names[type_index];
-        type_database.type_list[type_index] = MakeContainer<FundamentalType>(name, size);
+        type_database.type_list[type_index] = MakeContainer<FundamentalType>(type_database.type_arena, name, size);
         type_database.type_map.emplace(name, type_index);
     }
 
     // Second pass, construct all aggregrate types
+    TypeInterner types(type_database, pointer_size);
     usize struct_index = 0;
     type_database.struct_map.reserve(struct_count);
 
@@ -523,7 +844,7 @@ Result<TypeDatabase, ReflectionError> CreateTypeDatabase(const File& file, const
             const auto& field_name = sdna.field_names[field_name_index];
 
             // Handle function pointers such as: (*field_name)()
-            if (const auto field = ProcessFunctionPointerField(field_offset, field_name, pointer_size, type_database.type_list);
+            if (const auto field = ProcessFunctionPointerField(field_offset, field_name, types);
                 *field != NULL_OPTION)
             {
                 field_offset += (*(*field)->type)->GetSize();
@@ -539,7 +860,7 @@ Result<TypeDatabase, ReflectionError> CreateTypeDatabase(const File& file, const
             const auto& field_type = type_database.type_list[field_type_index];
 
             // Handle generic fields such as: **field_name[1][2]
-            if (const auto field = ProcessField(field_offset, field_name, pointer_size, &field_type, type_database.type_list);
+            if (const auto field = ProcessField(field_offset, field_name, &field_type, types);
                 *field != NULL_OPTION)
             {
                 field_offset += (*(*field)->type)->GetSize();
@@ -557,24 +878,41 @@ Result<TypeDatabase, ReflectionError> CreateTypeDatabase(const File& file, const
 
         const auto size = sdna.type_lengths[type_index];
         const auto& name = sdna.type_names[type_index];
-        type_database.type_list[type_index] = MakeContainer<AggregateType>(size, name, aggregate_fields);
+        type_database.type_list[type_index] = MakeContainer<AggregateType>(type_database.type_arena, size, name, aggregate_fields);
+    }
+
+    if (auto result = BuildTypeDescriptors(type_database); !result)
+    {
+        return MakeError(result.error());
     }
 
     return type_database;
 }
 
+TypeDescriptorTable TypeDatabase::GetDescriptorTable() const
+{
+    return TypeDescriptorTable{
+        .types = type_descriptors,
+        .fields = field_descriptors,
+        .lookup_slots = field_lookup_slots,
+        .lookup_seeds = field_lookup_seeds,
+    };
+}
+
 MemoryTable CreateMemoryTable(const File& file)
 {
     std::vector<MemoryRange> ranges;
     ranges.reserve(file.blocks.size());
 
-    for (const auto& [header, body] : file.blocks)
+    for (usize block_index = 0; block_index < file.blocks.size(); ++block_index)
     {
-        if (header.length == 0)
+        const auto& [header, body, offset] = file.blocks[block_index];
+        // Bodies that were not loaded resolve like any unknown address
+        if (header.length == 0 || body.size() != header.length)
         {
             continue;
         }
-        ranges.emplace_back(MemoryRange{ header.address, header.address + header.length, std::span{ body } });
+        ranges.emplace_back(MemoryRange{ header.address, header.address + header.length, std::span{ body }, block_index });
     }
 
     ranges::sort(ranges, [](const MemoryRange& first, const MemoryRange& second) { return first.head < second.head; });
@@ -582,6 +920,26 @@ MemoryTable CreateMemoryTable(const File& file)
     return MemoryTable(ranges);
 }
 
+Option<BlendType> FindNamedType(const TypeDatabase& type_database, const MemoryTable& memory_table, std::string_view name)
+{
+    if (const auto& type_index = type_database.type_map.find(name);
+        type_index != type_database.type_map.end() && type_index->second < type_database.type_list.size() && type_index->second > 0)
+    {
+        return BlendType(memory_table, type_database.GetDescriptorTable(), u32(type_index->second));
+    }
+    return NULL_OPTION;
+}
+
+Option<BlendType> FindStructType(const TypeDatabase& type_database, const MemoryTable& memory_table, u32 struct_index)
+{
+    if (const auto& type_index = type_database.struct_map.find(struct_index);
+        type_index != type_database.struct_map.end() && type_index->second < type_database.type_list.size() && type_index->second > 0)
+    {
+        return BlendType(memory_table, type_database.GetDescriptorTable(), u32(type_index->second));
+    }
+    return NULL_OPTION;
+}
+
 struct BlendData
 {
     File file;
@@ -589,7 +947,7 @@ struct BlendData
     MemoryTable memory_table;
 };
 
-Result<BlendData, BlendError> ReadBlendData(Stream& stream)
+Result<Header, BlendError> ReadStreamHeader(Stream& stream)
 {
     const auto header = ReadHeader(stream);
 
@@ -607,7 +965,19 @@ Result<BlendData, BlendError> ReadBlendData(Stream& stream)
         stream.SetEndian(std::endian::big);
     }
 
-    auto file = ReadFile(stream, *header);
+    return header;
+}
+
+Result<BlendData, BlendError> ReadBlendData(Stream& stream, const BlockCodeFilter& filter)
+{
+    const auto header = ReadStreamHeader(stream);
+
+    if (!header)
+    {
+        return MakeError(header.error());
+    }
+
+    auto file = ReadFile(stream, *header, filter);
 
     if (!file)
     {
@@ -638,7 +1008,7 @@ Result<BlendData, BlendError> ReadBlendData(Stream& stream)
     return BlendData{ .file = std::move(*file), .type_database = std::move(*type_database), .memory_table = std::move(memory_table) };
 }
 
-Result<Blend, BlendError> Blend::Open(std::string_view path)
+Result<Blend, BlendError> Blend::Open(std::string_view path, const BlockCodeFilter& filter)
 {
     auto stream = FileStream::Create(path);
 
@@ -647,7 +1017,7 @@ Result<Blend, BlendError> Blend::Open(std::string_view path)
         return MakeError(BlendError(stream.error()));
     }
 
-    auto data = ReadBlendData(*stream);
+    auto data = ReadBlendData(*stream, filter);
 
     if (!data)
     {
@@ -657,10 +1027,10 @@ Result<Blend, BlendError> Blend::Open(std::string_view path)
     return Blend(data->file, data->type_database, data->memory_table);
 }
 
-Result<Blend, BlendError> Blend::Read(MemorySpan buffer)
+Result<Blend, BlendError> Blend::Read(MemorySpan buffer, const BlockCodeFilter& filter)
 {
     MemoryStream stream(buffer);
-    auto data = ReadBlendData(stream);
+    auto data = ReadBlendData(stream, filter);
 
     if (!data)
     {
@@ -670,6 +1040,391 @@ Result<Blend, BlendError> Blend::Read(MemorySpan buffer)
     return Blend(data->file, data->type_database, data->memory_table);
 }
 
+class ReachableLoader
+{
+public:
+    ReachableLoader(Stream& stream, File& file, const TypeDatabase& type_database, const BlendType& id_type)
+        : m_Stream(stream)
+        , m_File(file)
+        , m_TypeDatabase(type_database)
+        , m_IdType(id_type)
+        , m_Reached(file.blocks.size(), 0)
+    {
+        for (usize block_index = 0; block_index < file.blocks.size(); ++block_index)
+        {
+            if (const auto& header = file.blocks[block_index].header; header.address != 0 && header.length != 0)
+            {
+                m_Ranges.emplace_back(header.address, block_index);
+            }
+        }
+
+        std::sort(m_Ranges.begin(), m_Ranges.end());
+    }
+
+    [[nodiscard]] Result<void, FormatError> AddRoots(std::span<const BlockRoot> roots)
+    {
+        const auto name = m_IdType.GetField("name");
+        for (usize block_index = 0; block_index < m_File.blocks.size(); ++block_index)
+        {
+            auto& block = m_File.blocks[block_index];
+            for (const auto& root : roots)
+            {
+                if (block.header.code != root.code)
+                {
+                    continue;
+                }
+
+                if (!root.name.empty())
+                {
+                    if (auto result = ReadBlockBody(m_Stream, block); !result)
+                    {
+                        return MakeError(result.error());
+                    }
+
+                    if (!name || name->GetString(block.body) != root.name)
+                    {
+                        continue;
+                    }
+                }
+
+                VisitBlock(block_index, false);
+                break;
+            }
+
+            // Drops the bodies only read to compare their name
+            if (m_Reached[block_index] == 0 && block.header.code != BLOCK_CODE_DNA1)
+            {
+                block.body = {};
+            }
+        }
+
+        return {};
+    }
+
+    [[nodiscard]] Result<void, FormatError> Traverse()
+    {
+        const Pointer pointer = m_File.header.pointer;
+        const usize pointer_size = pointer == Pointer::U32 ? sizeof(u32) : sizeof(u64);
+
+        while (!m_Pending.empty())
+        {
+            const auto [block_index, is_pointer_array] = m_Pending.back();
+            m_Pending.pop_back();
+
+            auto& block = m_File.blocks[block_index];
+            if (auto result = ReadBlockBody(m_Stream, block); !result)
+            {
+                return MakeError(result.error());
+            }
+
+            if (is_pointer_array)
+            {
+                for (usize offset = 0; offset + pointer_size <= block.body.size(); offset += pointer_size)
+                {
+                    VisitAddress(ReadPointerSlot(block.body, offset, pointer), false);
+                }
+                continue;
+            }
+
+            // Struct zero marks raw data
+            const auto type = block.header.struct_index != 0 ? FindStructType(m_TypeDatabase, m_LayoutTable, block.header.struct_index)
+                                                             : NULL_OPTION;
+            if (!type || type->GetSize() == 0)
+            {
+                continue;
+            }
+
+            auto slots = m_Slots.find(block.header.struct_index);
+            if (slots == m_Slots.end())
+            {
+                slots = m_Slots.emplace(block.header.struct_index, GetPointerSlots(*type, m_IdType)).first;
+            }
+
+            for (usize element = 0; (element + 1) * type->GetSize() <= block.body.size(); ++element)
+            {
+                for (const auto& [offset, points_to_array] : slots->second)
+                {
+                    VisitAddress(ReadPointerSlot(block.body, element * type->GetSize() + offset, pointer), points_to_array);
+                }
+            }
+        }
+
+        return {};
+    }
+
+    // Keeps the reached blocks in file order, with DNA1 and ENDB
+    void Compact()
+    {
+        std::vector<Block> blocks;
+        for (usize block_index = 0; block_index < m_File.blocks.size(); ++block_index)
+        {
+            const auto& code = m_File.blocks[block_index].header.code;
+            if (m_Reached[block_index] != 0 || code == BLOCK_CODE_DNA1 || code == BLOCK_CODE_ENDB)
+            {
+                blocks.push_back(std::move(m_File.blocks[block_index]));
+            }
+        }
+
+        m_File.blocks = std::move(blocks);
+    }
+
+private:
+    static constexpr u8 REACHED = 1U;
+    static constexpr u8 SCANNED_AS_POINTER_ARRAY = 2U;
+
+    Stream& m_Stream;
+    File& m_File;
+    const TypeDatabase& m_TypeDatabase;
+    const BlendType& m_IdType;
+    // Pointer slots only depend on the layout, so types are resolved against an empty memory table
+    MemoryTable m_LayoutTable;
+    std::vector<std::pair<u64, usize>> m_Ranges;
+    std::vector<u8> m_Reached;
+    std::vector<std::pair<usize, bool>> m_Pending;
+    std::unordered_map<u32, std::vector<PointerSlot>> m_Slots;
+
+    void VisitAddress(u64 address, bool is_pointer_array)
+    {
+        if (address == 0)
+        {
+            return;
+        }
+
+        const auto range = std::partition_point(
+            m_Ranges.begin(),
+            m_Ranges.end(),
+            [address](const std::pair<u64, usize>& current) { return current.first <= address; }
+        );
+        if (range == m_Ranges.begin())
+        {
+            return;
+        }
+
+        const auto& [head, block_index] = *std::prev(range);
+        if (address - head < m_File.blocks[block_index].header.length)
+        {
+            VisitBlock(block_index, is_pointer_array);
+        }
+    }
+
+    void VisitBlock(usize block_index, bool is_pointer_array)
+    {
+        const u8 state = is_pointer_array ? REACHED | SCANNED_AS_POINTER_ARRAY : REACHED;
+        if ((m_Reached[block_index] & state) != state)
+        {
+            m_Reached[block_index] |= state;
+            m_Pending.emplace_back(block_index, is_pointer_array);
+        }
+    }
+};
+
+Result<BlendData, BlendError> ReadReachableBlendData(Stream& stream, std::span<const BlockRoot> roots)
+{
+    const auto header = ReadStreamHeader(stream);
+
+    if (!header)
+    {
+        return MakeError(header.error());
+    }
+
+    auto file = ReadFileHeaders(stream, *header);
+
+    if (!file)
+    {
+        return MakeError(BlendError(file.error()));
+    }
+
+    auto sdna = ReadSdna(*file);
+
+    if (!sdna)
+    {
+        return MakeError(BlendError(sdna.error()));
+    }
+
+    auto type_database = CreateTypeDatabase(*file, *sdna);
+
+    if (!type_database)
+    {
+        return MakeError(BlendError(type_database.error()));
+    }
+
+    const MemoryTable layout_table;
+    const auto id_type = FindNamedType(*type_database, layout_table, "ID");
+
+    if (!id_type)
+    {
+        return MakeError(BlendError(ReflectionError::InvalidSdnaStruct));
+    }
+
+    ReachableLoader loader(stream, *file, *type_database, *id_type);
+
+    if (auto result = loader.AddRoots(roots); !result)
+    {
+        return MakeError(BlendError(result.error()));
+    }
+
+    if (auto result = loader.Traverse(); !result)
+    {
+        return MakeError(BlendError(result.error()));
+    }
+
+    loader.Compact();
+    auto memory_table = CreateMemoryTable(*file);
+
+    return BlendData{ .file = std::move(*file), .type_database = std::move(*type_database), .memory_table = std::move(memory_table) };
+}
+
+Result<Blend, BlendError> Blend::OpenReachable(std::string_view path, std::span<const BlockRoot> roots)
+{
+    auto stream = FileStream::Create(path);
+
+    if (!stream)
+    {
+        return MakeError(BlendError(stream.error()));
+    }
+
+    auto data = ReadReachableBlendData(*stream, roots);
+
+    if (!data)
+    {
+        return MakeError(BlendError(data.error()));
+    }
+
+    return Blend(data->file, data->type_database, data->memory_table);
+}
+
+Result<Blend, BlendError> Blend::ReadReachable(MemorySpan buffer, std::span<const BlockRoot> roots)
+{
+    MemoryStream stream(buffer);
+    auto data = ReadReachableBlendData(stream, roots);
+
+    if (!data)
+    {
+        return MakeError(BlendError(data.error()));
+    }
+
+    return Blend(data->file, data->type_database, data->memory_table);
+}
+
+Result<void, BlendError> VisitStreamBlocks(Stream& stream, const BlockVisitor& visitor)
+{
+    const auto header = ReadStreamHeader(stream);
+
+    if (!header)
+    {
+        return MakeError(header.error());
+    }
+
+    const usize blocks_position = stream.GetPosition();
+    auto sdna_block = FindBlock(stream, *header, BLOCK_CODE_DNA1);
+
+    if (!sdna_block)
+    {
+        return MakeError(BlendError(sdna_block.error() == FormatError::BlockNotFound ? FormatError::SdnaNotFound : sdna_block.error()));
+    }
+
+    File sdna_file = { .header = *header };
+    sdna_file.blocks.push_back(std::move(*sdna_block));
+    auto sdna = ReadSdna(sdna_file);
+
+    if (!sdna)
+    {
+        return MakeError(BlendError(sdna.error()));
+    }
+
+    auto type_database = CreateTypeDatabase(sdna_file, *sdna);
+
+    if (!type_database)
+    {
+        return MakeError(BlendError(type_database.error()));
+    }
+
+    if (!stream.Seek(blocks_position))
+    {
+        return MakeError(BlendError(FormatError::UnexpectedEndOfFile));
+    }
+
+    const MemoryTable memory_table;
+    std::unordered_map<u32, Option<BlendType>> struct_types;
+    auto result = VisitFile(
+        stream,
+        *header,
+        [&](const Block& block)
+        {
+            const u32 struct_index = block.header.struct_index;
+            auto type = struct_types.find(struct_index);
+            if (type == struct_types.end())
+            {
+                type = struct_types.emplace(struct_index, FindStructType(*type_database, memory_table, struct_index)).first;
+            }
+
+            visitor(block, type->second);
+        }
+    );
+
+    if (!result)
+    {
+        return MakeError(BlendError(result.error()));
+    }
+
+    return {};
+}
+
+Result<void, BlendError> Blend::VisitFile(std::string_view path, const BlockVisitor& visitor)
+{
+    auto stream = FileStream::Create(path);
+
+    if (!stream)
+    {
+        return MakeError(BlendError(stream.error()));
+    }
+
+    return VisitStreamBlocks(*stream, visitor);
+}
+
+Result<void, BlendError> Blend::VisitBuffer(MemorySpan buffer, const BlockVisitor& visitor)
+{
+    MemoryStream stream(buffer);
+    return VisitStreamBlocks(stream, visitor);
+}
+
+Result<Thumbnail, BlendError> ReadStreamThumbnail(Stream& stream)
+{
+    const auto header = ReadStreamHeader(stream);
+
+    if (!header)
+    {
+        return MakeError(header.error());
+    }
+
+    auto thumbnail = ReadThumbnail(stream, *header);
+
+    if (!thumbnail)
+    {
+        return MakeError(BlendError(thumbnail.error()));
+    }
+
+    return std::move(*thumbnail);
+}
+
+Result<Thumbnail, BlendError> Blend::OpenThumbnail(std::string_view path)
+{
+    auto stream = FileStream::Create(path);
+
+    if (!stream)
+    {
+        return MakeError(BlendError(stream.error()));
+    }
+
+    return ReadStreamThumbnail(*stream);
+}
+
+Result<Thumbnail, BlendError> Blend::ReadThumbnail(MemorySpan buffer)
+{
+    MemoryStream stream(buffer);
+    return ReadStreamThumbnail(stream);
+}
+
 [[nodiscard]] Endian Blend::GetEndian() const
 {
     return m_File.header.endian;
@@ -680,11 +1435,21 @@ Result<Blend, BlendError> Blend::Read(MemorySpan buffer)
     return m_File.header.pointer;
 }
 
+[[nodiscard]] u64 Blend::GetSdnaHash() const
+{
+    return m_TypeDatabase.sdna_hash;
+}
+
 [[nodiscard]] usize Blend::GetBlockCount() const
 {
     return m_File.blocks.size();
 }
 
+[[nodiscard]] std::span<const Block> Blend::GetBlocks() const
+{
+    return m_File.blocks;
+}
+
 [[nodiscard]] usize Blend::GetBlockCount(const BlockCode& code) const
 {
     return ranges::count_if(m_File.blocks, BlockFilter(code));
@@ -699,6 +1464,15 @@ Result<Blend, BlendError> Blend::Read(MemorySpan buffer)
     return NULL_OPTION;
 }
 
+[[nodiscard]] Option<const Block&> Blend::GetBlockAt(u64 address) const
+{
+    if (const auto range = m_MemoryTable.GetRange(address))
+    {
+        return m_File.blocks[range->block_index];
+    }
+    return NULL_OPTION;
+}
+
 [[nodiscard]] Option<const Block&> Blend::GetBlock(const BlendType& type) const
 {
     if (auto blocks = GetBlocks(type); blocks.begin() != blocks.end())
@@ -710,24 +1484,26 @@ Result<Blend, BlendError> Blend::Read(MemorySpan buffer)
 
 Option<BlendType> cblend::Blend::GetType(std::string_view name) const
 {
-    if (const auto& type_index = m_TypeDatabase.type_map.find(name);
-        type_index != m_TypeDatabase.type_map.end() && type_index->second < m_TypeDatabase.type_list.size() && type_index->second > 0)
-    {
-        const Type& result(m_TypeDatabase.type_list[type_index->second]);
-        return BlendType(m_MemoryTable, result);
-    }
-    return NULL_OPTION;
+    return FindNamedType(m_TypeDatabase, m_MemoryTable, name);
 }
 
 Option<BlendType> cblend::Blend::GetBlockType(const Block& block) const
 {
-    if (const auto& type_index = m_TypeDatabase.struct_map.find(block.header.struct_index);
-        type_index != m_TypeDatabase.struct_map.end() && type_index->second < m_TypeDatabase.type_list.size() && type_index->second > 0)
+    return FindStructType(m_TypeDatabase, m_MemoryTable, block.header.struct_index);
+}
+
+std::vector<BlendType> cblend::Blend::GetStructTypes() const
+{
+    std::vector<BlendType> types;
+    types.reserve(m_TypeDatabase.struct_map.size());
+    for (u32 struct_index = 0; struct_index < m_TypeDatabase.struct_map.size(); ++struct_index)
     {
-        const Type& result(m_TypeDatabase.type_list[type_index->second]);
-        return BlendType(m_MemoryTable, result);
+        if (auto type = FindStructType(m_TypeDatabase, m_MemoryTable, struct_index))
+        {
+            types.push_back(*type);
+        }
     }
-    return NULL_OPTION;
+    return types;
 }
 
 Blend::Blend(File& file, TypeDatabase& type_database, MemoryTable& memory_table)
@@ -736,3 +1512,63 @@ Blend::Blend(File& file, TypeDatabase& type_database, MemoryTable& memory_table)
     , m_MemoryTable(memory_table)
 {
 }
+
+void CollectPointerSlots(const BlendType& type, usize offset, const BlendType& id_type, std::vector<PointerSlot>& slots)
+{
+    if (type.IsPointer())
+    {
+        const auto element_type = type.GetElementType();
+        slots.push_back({ .offset = offset, .is_pointer_array = element_type && element_type->IsPointer() });
+        return;
+    }
+
+    if (type.IsArray())
+    {
+        if (const auto element_type = type.GetElementType(); element_type && !element_type->IsPrimitive())
+        {
+            for (usize element = 0; element < type.GetArrayRank(); ++element)
+            {
+                CollectPointerSlots(*element_type, offset + element * element_type->GetSize(), id_type, slots);
+            }
+        }
+        return;
+    }
+
+    if (!type.IsStruct())
+    {
+        return;
+    }
+
+    const bool is_id = type == id_type;
+    for (const auto& field : type.GetFields())
+    {
+        const auto name = field.GetName();
+        if (is_id && (name == "next" || name == "prev" || name == "newid" || name == "orig_id"))
+        {
+            continue;
+        }
+
+        CollectPointerSlots(field.GetFieldType(), offset + field.GetOffset(), id_type, slots);
+    }
+}
+
+std::vector<PointerSlot> cblend::GetPointerSlots(const BlendType& type, const BlendType& id_type)
+{
+    std::vector<PointerSlot> slots;
+    CollectPointerSlots(type, 0, id_type, slots);
+    return slots;
+}
+
+u64 cblend::ReadPointerSlot(MemorySpan data, usize offset, Pointer pointer)
+{
+    if (pointer == Pointer::U32)
+    {
+        u32 value = 0;
+        std::memcpy(&value, data.data() + offset, sizeof(value));
+        return value;
+    }
+
+    u64 value = 0;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
@@ -0,0 +1,427 @@
+#include <cblend_animation.hpp>
+#include <cblend_math.hpp>
+#include <cblend_parallel.hpp>
+#include <cblend_simd.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+using namespace cblend;
+
+static constexpr usize BEZIER_SOLVE_ITERATIONS = 24;
+static constexpr f32 SAMPLE_COUNT_EPSILON = 1e-4F;
+
+usize ActionCurves::GetChannelCount() const
+{
+    return paths.size();
+}
+
+usize ActionCurves::GetKeyCount() const
+{
+    return frames.size();
+}
+
+Option<usize> ActionCurves::FindChannel(std::string_view path, s32 array_index) const
+{
+    for (usize channel = 0; channel < paths.size(); ++channel)
+    {
+        if (paths[channel] == path && array_indices[channel] == array_index)
+        {
+            return channel;
+        }
+    }
+    return NULL_OPTION;
+}
+
+usize BakedChannels::GetChannelCount() const
+{
+    return sample_count == 0 ? 0 : samples.size() / sample_count;
+}
+
+std::span<const f32> BakedChannels::GetChannel(usize channel) const
+{
+    return std::span(samples).subspan(channel * sample_count, sample_count);
+}
+
+Option<const Block&> cblend::GetAction(const Blend& blend, const Block& owner)
+{
+    const auto owner_type = blend.GetBlockType(owner);
+    const auto anim_data_type = blend.GetType("AnimData");
+    if (!owner_type || !anim_data_type)
+    {
+        return NULL_OPTION;
+    }
+
+    const auto anim_data_field = owner_type->GetField("adt");
+    const auto action_field = anim_data_type->GetField("action");
+    if (!anim_data_field || !action_field)
+    {
+        return NULL_OPTION;
+    }
+
+    const auto anim_data = anim_data_field->GetPointerData(owner.body, anim_data_type->GetSize());
+    const auto address = action_field->GetPointerAddress(anim_data);
+    if (anim_data.empty() || !address || *address == 0)
+    {
+        return NULL_OPTION;
+    }
+
+    for (const auto& block : blend.GetBlocks(BLOCK_CODE_AC))
+    {
+        if (block.header.address == *address)
+        {
+            return block;
+        }
+    }
+    return NULL_OPTION;
+}
+
+// Matches Blender's BKE_fcurve_correct_bezpart, shortening handles so the curve never runs backwards in time
+void CorrectBezierHandles(const Float2& key, Float2& right, Float2& left, const Float2& next_key)
+{
+    const Float2 right_handle = { key[0] - right[0], key[1] - right[1] };
+    const Float2 left_handle = { next_key[0] - left[0], next_key[1] - left[1] };
+    const f32 length = next_key[0] - key[0];
+    const f32 handle_length = std::abs(right_handle[0]) + std::abs(left_handle[0]);
+
+    if (handle_length == 0.F || handle_length <= length)
+    {
+        return;
+    }
+
+    const f32 factor = length / handle_length;
+    right = { key[0] - factor * right_handle[0], key[1] - factor * right_handle[1] };
+    left = { next_key[0] - factor * left_handle[0], next_key[1] - factor * left_handle[1] };
+}
+
+// Staging for bezier samples, a full batch solves x(t) = frame for every lane at once and then evaluates y(t)
+class BezierBatch
+{
+public:
+    static constexpr usize WIDTH = simd::FloatN::WIDTH;
+
+    void Push(const ActionCurves& curves, usize key, f32 frame, f32* output)
+    {
+        Float2 point_0 = { curves.frames[key], curves.values[key] };
+        Float2 point_1 = { curves.right_frames[key], curves.right_values[key] };
+        Float2 point_2 = { curves.left_frames[key + 1], curves.left_values[key + 1] };
+        Float2 point_3 = { curves.frames[key + 1], curves.values[key + 1] };
+        CorrectBezierHandles(point_0, point_1, point_2, point_3);
+
+        for (usize axis = 0; axis < 2; ++axis)
+        {
+            m_Coefficients[axis][0][m_Count] = point_3[axis] - point_0[axis] + 3.F * (point_1[axis] - point_2[axis]);
+            m_Coefficients[axis][1][m_Count] = 3.F * (point_0[axis] - 2.F * point_1[axis] + point_2[axis]);
+            m_Coefficients[axis][2][m_Count] = 3.F * (point_1[axis] - point_0[axis]);
+            m_Coefficients[axis][3][m_Count] = point_0[axis];
+        }
+
+        m_Frames[m_Count] = frame;
+        m_Outputs[m_Count] = output;
+
+        if (++m_Count == WIDTH)
+        {
+            Flush();
+        }
+    }
+
+    void Flush()
+    {
+        if (m_Count == 0)
+        {
+            return;
+        }
+
+        for (usize lane = m_Count; lane < WIDTH; ++lane)
+        {
+            for (auto& axis : m_Coefficients)
+            {
+                for (auto& coefficient : axis)
+                {
+                    coefficient[lane] = coefficient[0];
+                }
+            }
+            m_Frames[lane] = m_Frames[0];
+        }
+
+        const auto frame = simd::FloatN::Load(m_Frames.data());
+        const auto half = simd::FloatN::Broadcast(0.5F);
+        auto lower = simd::FloatN::Broadcast(0.F);
+        auto upper = simd::FloatN::Broadcast(1.F);
+
+        for (usize iteration = 0; iteration < BEZIER_SOLVE_ITERATIONS; ++iteration)
+        {
+            const auto middle = (lower + upper) * half;
+            const auto difference = frame - Evaluate(0, middle);
+            lower = simd::FloatN::SelectPositive(difference, middle, lower);
+            upper = simd::FloatN::SelectPositive(difference, upper, middle);
+        }
+
+        std::array<f32, WIDTH> results = {};
+        Evaluate(1, (lower + upper) * half).Store(results.data());
+
+        for (usize lane = 0; lane < m_Count; ++lane)
+        {
+            *m_Outputs[lane] = results[lane];
+        }
+        m_Count = 0;
+    }
+
+private:
+    std::array<std::array<std::array<f32, WIDTH>, 4>, 2> m_Coefficients = {};
+    std::array<f32, WIDTH> m_Frames = {};
+    std::array<f32*, WIDTH> m_Outputs = {};
+    usize m_Count = 0;
+
+    [[nodiscard]] simd::FloatN Evaluate(usize axis, simd::FloatN parameter) const
+    {
+        const auto& coefficients = m_Coefficients[axis];
+        auto result = simd::FloatN::Load(coefficients[0].data());
+        result = simd::FloatN::MulAdd(result, parameter, simd::FloatN::Load(coefficients[1].data()));
+        result = simd::FloatN::MulAdd(result, parameter, simd::FloatN::Load(coefficients[2].data()));
+        return simd::FloatN::MulAdd(result, parameter, simd::FloatN::Load(coefficients[3].data()));
+    }
+};
+
+[[nodiscard]] f32 ExtrapolateBefore(const ActionCurves& curves, usize channel, usize first, f32 frame)
+{
+    if (curves.extrapolations[channel] == CurveExtrapolation::Constant || curves.interpolations[first] == KeyframeInterpolation::Constant)
+    {
+        return curves.values[first];
+    }
+
+    f32 delta_frame = curves.frames[first + 1] - curves.frames[first];
+    f32 delta_value = curves.values[first + 1] - curves.values[first];
+
+    if (curves.interpolations[first] == KeyframeInterpolation::Bezier)
+    {
+        delta_frame = curves.frames[first] - curves.left_frames[first];
+        delta_value = curves.values[first] - curves.left_values[first];
+    }
+
+    if (delta_frame == 0.F)
+    {
+        return curves.values[first];
+    }
+    return curves.values[first] + (frame - curves.frames[first]) * delta_value / delta_frame;
+}
+
+[[nodiscard]] f32 ExtrapolateAfter(const ActionCurves& curves, usize channel, usize last, f32 frame)
+{
+    if (curves.extrapolations[channel] == CurveExtrapolation::Constant || curves.interpolations[last] == KeyframeInterpolation::Constant)
+    {
+        return curves.values[last];
+    }
+
+    f32 delta_frame = curves.frames[last] - curves.frames[last - 1];
+    f32 delta_value = curves.values[last] - curves.values[last - 1];
+
+    if (curves.interpolations[last] == KeyframeInterpolation::Bezier)
+    {
+        delta_frame = curves.right_frames[last] - curves.frames[last];
+        delta_value = curves.right_values[last] - curves.values[last];
+    }
+
+    if (delta_frame == 0.F)
+    {
+        return curves.values[last];
+    }
+    return curves.values[last] + (frame - curves.frames[last]) * delta_value / delta_frame;
+}
+
+// Samples are taken at increasing frames, so the segment search only ever moves forward
+void SampleChannel(const ActionCurves& curves, usize channel, f32 start_frame, f32 frame_step, std::span<f32> output)
+{
+    const usize first = curves.key_offsets[channel];
+    const usize last = curves.key_offsets[channel + 1];
+
+    if (first == last)
+    {
+        std::fill(output.begin(), output.end(), 0.F);
+        return;
+    }
+
+    if (last - first == 1)
+    {
+        std::fill(output.begin(), output.end(), curves.values[first]);
+        return;
+    }
+
+    const auto frames_begin = curves.frames.begin();
+    usize segment = first;
+    BezierBatch batch;
+
+    for (usize sample = 0; sample < output.size(); ++sample)
+    {
+        const f32 frame = start_frame + f32(sample) * frame_step;
+
+        if (frame <= curves.frames[first])
+        {
+            output[sample] = ExtrapolateBefore(curves, channel, first, frame);
+            continue;
+        }
+
+        if (frame >= curves.frames[last - 1])
+        {
+            output[sample] = ExtrapolateAfter(curves, channel, last - 1, frame);
+            continue;
+        }
+
+        segment = usize(std::upper_bound(frames_begin + s64(segment), frames_begin + s64(last), frame) - frames_begin) - 1;
+
+        switch (curves.interpolations[segment])
+        {
+        case KeyframeInterpolation::Constant: output[sample] = curves.values[segment]; break;
+        case KeyframeInterpolation::Linear:
+        {
+            const f32 factor = (frame - curves.frames[segment]) / (curves.frames[segment + 1] - curves.frames[segment]);
+            output[sample] = curves.values[segment] + factor * (curves.values[segment + 1] - curves.values[segment]);
+            break;
+        }
+        case KeyframeInterpolation::Bezier: batch.Push(curves, segment, frame, &output[sample]); break;
+        }
+    }
+
+    batch.Flush();
+}
+
+[[nodiscard]] KeyframeInterpolation GetInterpolation(s8 mode)
+{
+    // Easing modes have no bezier handles to follow and are approximated linearly
+    switch (mode)
+    {
+    case s8(KeyframeInterpolation::Constant): return KeyframeInterpolation::Constant;
+    case s8(KeyframeInterpolation::Bezier): return KeyframeInterpolation::Bezier;
+    default: return KeyframeInterpolation::Linear;
+    }
+}
+
+Result<ActionCurves, AnimationError> cblend::ExtractActionCurves(const Blend& blend, const Block& action)
+{
+    const auto action_type = blend.GetBlockType(action);
+    if (!action_type)
+    {
+        return MakeError(AnimationError::InvalidActionType);
+    }
+
+    const auto curves_field = action_type->GetField("curves");
+    if (!curves_field)
+    {
+        return MakeError(AnimationError::InvalidActionType);
+    }
+
+    const auto first_field = curves_field->GetFieldType().GetField("first");
+    const auto curve_type = blend.GetType("FCurve");
+    if (!first_field || !curve_type)
+    {
+        return MakeError(AnimationError::InvalidCurveType);
+    }
+
+    const auto next_field = curve_type->GetField("next");
+    const auto keyframes_field = curve_type->GetField("bezt");
+    const auto key_count_field = curve_type->GetField("totvert");
+    const auto extend_field = curve_type->GetField("extend");
+    const auto array_index_field = curve_type->GetField("array_index");
+    const auto path_field = curve_type->GetField("rna_path");
+    if (!next_field || !keyframes_field || !key_count_field || !array_index_field || !path_field)
+    {
+        return MakeError(AnimationError::InvalidCurveType);
+    }
+
+    const auto keyframe_type = blend.GetType("BezTriple");
+    if (!keyframe_type)
+    {
+        return MakeError(AnimationError::InvalidKeyframeType);
+    }
+
+    const auto vector_field = keyframe_type->GetField("vec");
+    const auto interpolation_field = keyframe_type->GetField("ipo");
+    if (!vector_field || vector_field->GetSize() != sizeof(std::array<Float3, 3>) || !interpolation_field)
+    {
+        return MakeError(AnimationError::InvalidKeyframeType);
+    }
+
+    const usize curve_size = curve_type->GetSize();
+    const usize keyframe_size = keyframe_type->GetSize();
+
+    ActionCurves curves;
+    curves.key_offsets.push_back(0);
+
+    MemorySpan curve = first_field->GetPointerData(curves_field->GetData(action), curve_size);
+    while (!curve.empty())
+    {
+        if (curves.GetChannelCount() >= blend.GetBlockCount())
+        {
+            return MakeError(AnimationError::InvalidCurveList);
+        }
+
+        const u32 key_count = key_count_field->GetValue<u32>(curve).value_or(0);
+        const auto keyframes = keyframes_field->GetPointerData(curve, usize(key_count) * keyframe_size);
+        const usize valid_key_count = keyframes.size() == usize(key_count) * keyframe_size ? key_count : 0;
+
+        curves.paths.push_back(path_field->GetPointerString(curve));
+        curves.array_indices.push_back(array_index_field->GetValue<s32>(curve).value_or(0));
+        curves.extrapolations.push_back(
+            extend_field && extend_field->GetValue<s16>(curve).value_or(0) == s16(CurveExtrapolation::Linear) ? CurveExtrapolation::Linear
+                                                                                                              : CurveExtrapolation::Constant
+        );
+
+        for (usize key = 0; key < valid_key_count; ++key)
+        {
+            const auto keyframe = keyframes.subspan(key * keyframe_size, keyframe_size);
+            const auto points = vector_field->GetValue<std::array<Float3, 3>>(keyframe).value_or(std::array<Float3, 3>{});
+
+            curves.left_frames.push_back(points[0][0]);
+            curves.left_values.push_back(points[0][1]);
+            curves.frames.push_back(points[1][0]);
+            curves.values.push_back(points[1][1]);
+            curves.right_frames.push_back(points[2][0]);
+            curves.right_values.push_back(points[2][1]);
+            curves.interpolations.push_back(GetInterpolation(interpolation_field->GetValue<s8>(keyframe).value_or(0)));
+        }
+
+        curves.key_offsets.push_back(u32(curves.frames.size()));
+        curve = next_field->GetPointerData(curve, curve_size);
+    }
+
+    return curves;
+}
+
+f32 cblend::EvaluateChannel(const ActionCurves& curves, usize channel, f32 frame)
+{
+    f32 result = 0.F;
+    SampleChannel(curves, channel, frame, 0.F, std::span(&result, 1));
+    return result;
+}
+
+Result<BakedChannels, AnimationError>
+cblend::BakeActionCurves(const ActionCurves& curves, f32 start_frame, f32 end_frame, f32 frame_step)
+{
+    if (!std::isfinite(start_frame) || !std::isfinite(end_frame) || !(frame_step > 0.F) || end_frame < start_frame)
+    {
+        return MakeError(AnimationError::InvalidSampleRange);
+    }
+
+    BakedChannels baked;
+    baked.start_frame = start_frame;
+    baked.frame_step = frame_step;
+    baked.sample_count = usize(std::floor((end_frame - start_frame) / frame_step + SAMPLE_COUNT_EPSILON)) + 1;
+    baked.samples.resize(curves.GetChannelCount() * baked.sample_count);
+
+    ParallelFor(
+        curves.GetChannelCount(),
+        1,
+        [&curves, &baked](usize begin, usize end)
+        {
+            for (usize channel = begin; channel < end; ++channel)
+            {
+                const auto output = std::span(baked.samples).subspan(channel * baked.sample_count, baked.sample_count);
+                SampleChannel(curves, channel, baked.start_frame, baked.frame_step, output);
+            }
+        }
+    );
+
+    return baked;
+}
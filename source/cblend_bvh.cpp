@@ -0,0 +1,372 @@
+#include <cblend_bvh.hpp>
+#include <cblend_parallel.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+using namespace cblend;
+
+static constexpr usize BVH_BIN_COUNT = 16;
+static constexpr usize BVH_GRAIN_SIZE = 4096;
+static constexpr usize PARALLEL_SUBTREE_SIZE = 4096;
+
+static constexpr std::array<u8, 4> BVH_MAGIC = { 'C', 'B', 'V', 'H' };
+static constexpr u32 BVH_VERSION = 1;
+static constexpr usize BVH_HEADER_SIZE = BVH_MAGIC.size() + 3 * sizeof(u32);
+
+bool BvhNode::IsLeaf() const
+{
+    return count != 0;
+}
+
+usize Bvh::GetNodeCount() const
+{
+    return nodes.size();
+}
+
+usize Bvh::GetPrimitiveCount() const
+{
+    return primitive_indices.size();
+}
+
+struct BvhBounds
+{
+    Float3 min = { std::numeric_limits<f32>::max(), std::numeric_limits<f32>::max(), std::numeric_limits<f32>::max() };
+    Float3 max = { std::numeric_limits<f32>::lowest(), std::numeric_limits<f32>::lowest(), std::numeric_limits<f32>::lowest() };
+
+    void Grow(const Float3& point)
+    {
+        for (usize axis = 0; axis < 3; ++axis)
+        {
+            min[axis] = std::min(min[axis], point[axis]);
+            max[axis] = std::max(max[axis], point[axis]);
+        }
+    }
+
+    void Grow(const BvhBounds& bounds)
+    {
+        Grow(bounds.min);
+        Grow(bounds.max);
+    }
+
+    [[nodiscard]] f32 GetHalfArea() const
+    {
+        const Float3 extent = Subtract(max, min);
+        if (extent[0] < 0.F)
+        {
+            return 0.F;
+        }
+
+        return extent[0] * extent[1] + extent[1] * extent[2] + extent[2] * extent[0];
+    }
+};
+
+struct BvhSplit
+{
+    usize axis = 0;
+    usize bin = 0;
+    f32 cost = std::numeric_limits<f32>::max();
+};
+
+class BvhBuilder
+{
+public:
+    BvhBuilder(
+        const BvhSettings& settings,
+        std::span<const BvhBounds> primitive_bounds,
+        std::span<const Float3> centroids,
+        std::span<u32> indices,
+        std::span<BvhNode> nodes
+    )
+        : m_Settings(settings)
+        , m_PrimitiveBounds(primitive_bounds)
+        , m_Centroids(centroids)
+        , m_Indices(indices)
+        , m_Nodes(nodes)
+        , m_SpawnDepth(std::bit_width(GetWorkerCount()) + 1)
+    {
+    }
+
+    // Descendants of a subtree with n primitives use at most 2n - 2 slots starting at slot, which lets both halves of every
+    // split build concurrently into disjoint node ranges and keeps the layout independent of scheduling
+    void Build(usize node, usize begin, usize end, usize slot, usize depth)
+    {
+        BvhBounds bounds;
+        BvhBounds centroid_bounds;
+        for (usize primitive = begin; primitive < end; ++primitive)
+        {
+            bounds.Grow(m_PrimitiveBounds[m_Indices[primitive]]);
+            centroid_bounds.Grow(m_Centroids[m_Indices[primitive]]);
+        }
+
+        const usize count = end - begin;
+        m_Nodes[node].min = bounds.min;
+        m_Nodes[node].max = bounds.max;
+
+        const BvhSplit split = FindSplit(begin, end, bounds, centroid_bounds);
+        const f32 leaf_cost = m_Settings.intersection_cost * f32(count);
+        if (count <= 1 || (count <= m_Settings.max_leaf_size && split.cost >= leaf_cost))
+        {
+            m_Nodes[node].index = u32(begin);
+            m_Nodes[node].count = u32(count);
+            return;
+        }
+
+        usize middle = begin + count / 2;
+        if (split.cost < std::numeric_limits<f32>::max())
+        {
+            const f32 bin_min = centroid_bounds.min[split.axis];
+            const f32 scale = f32(BVH_BIN_COUNT) / (centroid_bounds.max[split.axis] - bin_min);
+            const auto partition = std::partition(
+                m_Indices.begin() + std::ptrdiff_t(begin),
+                m_Indices.begin() + std::ptrdiff_t(end),
+                [&](u32 primitive) { return GetBin(m_Centroids[primitive][split.axis], bin_min, scale) <= split.bin; }
+            );
+            middle = usize(partition - m_Indices.begin());
+        }
+
+        if (middle == begin || middle == end)
+        {
+            middle = begin + count / 2;
+        }
+
+        m_Nodes[node].index = u32(slot);
+        m_Nodes[node].count = 0;
+
+        const usize left_count = middle - begin;
+        ParallelInvoke(
+            count >= PARALLEL_SUBTREE_SIZE && depth < m_SpawnDepth,
+            [&]() { Build(slot, begin, middle, slot + 2, depth + 1); },
+            [&]() { Build(slot + 1, middle, end, slot + 2 * left_count, depth + 1); }
+        );
+    }
+
+private:
+    [[nodiscard]] static usize GetBin(f32 centroid, f32 bin_min, f32 scale)
+    {
+        return std::min(usize(std::max((centroid - bin_min) * scale, 0.F)), BVH_BIN_COUNT - 1);
+    }
+
+    [[nodiscard]] BvhSplit FindSplit(usize begin, usize end, const BvhBounds& bounds, const BvhBounds& centroid_bounds) const
+    {
+        BvhSplit best;
+        const f32 parent_area = bounds.GetHalfArea();
+
+        for (usize axis = 0; axis < 3; ++axis)
+        {
+            const f32 extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+            if (!(extent > 0.F))
+            {
+                continue;
+            }
+
+            std::array<BvhBounds, BVH_BIN_COUNT> bin_bounds = {};
+            std::array<usize, BVH_BIN_COUNT> bin_counts = {};
+            const f32 scale = f32(BVH_BIN_COUNT) / extent;
+            for (usize primitive = begin; primitive < end; ++primitive)
+            {
+                const u32 index = m_Indices[primitive];
+                const usize bin = GetBin(m_Centroids[index][axis], centroid_bounds.min[axis], scale);
+                bin_bounds[bin].Grow(m_PrimitiveBounds[index]);
+                ++bin_counts[bin];
+            }
+
+            // Right to left sweep first, so the left to right sweep can price each split in one pass
+            std::array<f32, BVH_BIN_COUNT> right_costs = {};
+            BvhBounds right_bounds;
+            usize right_count = 0;
+            for (usize bin = BVH_BIN_COUNT - 1; bin > 0; --bin)
+            {
+                right_bounds.Grow(bin_bounds[bin]);
+                right_count += bin_counts[bin];
+                right_costs[bin - 1] = right_bounds.GetHalfArea() * f32(right_count);
+            }
+
+            BvhBounds left_bounds;
+            usize left_count = 0;
+            for (usize bin = 0; bin + 1 < BVH_BIN_COUNT; ++bin)
+            {
+                left_bounds.Grow(bin_bounds[bin]);
+                left_count += bin_counts[bin];
+                if (left_count == 0 || left_count == end - begin)
+                {
+                    continue;
+                }
+
+                const f32 cost = m_Settings.traversal_cost
+                               + m_Settings.intersection_cost * (left_bounds.GetHalfArea() * f32(left_count) + right_costs[bin])
+                                     / std::max(parent_area, std::numeric_limits<f32>::min());
+                if (cost < best.cost)
+                {
+                    best = { .axis = axis, .bin = bin, .cost = cost };
+                }
+            }
+        }
+
+        return best;
+    }
+
+    const BvhSettings& m_Settings;
+    std::span<const BvhBounds> m_PrimitiveBounds;
+    std::span<const Float3> m_Centroids;
+    std::span<u32> m_Indices;
+    std::span<BvhNode> m_Nodes;
+    usize m_SpawnDepth;
+};
+
+// Renumbers the sparse build slots breadth first, keeping siblings adjacent on even indices
+void CompactBvhNodes(std::span<const BvhNode> scratch, Bvh& bvh)
+{
+    bvh.nodes.reserve(scratch.size());
+    bvh.nodes.push_back(scratch[0]);
+    bvh.nodes.push_back({});
+
+    for (usize node = 0; node < bvh.nodes.size(); node += node == 0 ? 2 : 1)
+    {
+        if (bvh.nodes[node].IsLeaf())
+        {
+            continue;
+        }
+
+        const u32 first_child = bvh.nodes[node].index;
+        bvh.nodes[node].index = u32(bvh.nodes.size());
+        bvh.nodes.push_back(scratch[first_child]);
+        bvh.nodes.push_back(scratch[first_child + 1]);
+    }
+}
+
+Result<Bvh, BvhError>
+cblend::BuildBvh(std::span<const Float3> positions, std::span<const std::array<u32, 3>> triangles, const BvhSettings& settings)
+{
+    Bvh bvh;
+    if (triangles.empty())
+    {
+        return bvh;
+    }
+
+    if (triangles.size() > std::numeric_limits<u32>::max() / 2)
+    {
+        return MakeError(BvhError::TooManyPrimitives);
+    }
+
+    const bool valid = std::all_of(
+        triangles.begin(),
+        triangles.end(),
+        [&positions](const std::array<u32, 3>& triangle)
+        { return std::all_of(triangle.begin(), triangle.end(), [&positions](u32 vertex) { return vertex < positions.size(); }); }
+    );
+    if (!valid)
+    {
+        return MakeError(BvhError::InvalidTriangle);
+    }
+
+    std::vector<BvhBounds> primitive_bounds(triangles.size());
+    std::vector<Float3> centroids(triangles.size());
+    ParallelFor(
+        triangles.size(),
+        BVH_GRAIN_SIZE,
+        [&](usize begin, usize end)
+        {
+            for (usize triangle = begin; triangle < end; ++triangle)
+            {
+                BvhBounds bounds;
+                for (const u32 vertex : triangles[triangle])
+                {
+                    bounds.Grow(positions[vertex]);
+                }
+                primitive_bounds[triangle] = bounds;
+                centroids[triangle] = Scale(Add(bounds.min, bounds.max), 0.5F);
+            }
+        }
+    );
+
+    bvh.primitive_indices.resize(triangles.size());
+    for (usize triangle = 0; triangle < triangles.size(); ++triangle)
+    {
+        bvh.primitive_indices[triangle] = u32(triangle);
+    }
+
+    std::vector<BvhNode> scratch(2 * triangles.size());
+    BvhBuilder builder(settings, primitive_bounds, centroids, bvh.primitive_indices, scratch);
+    builder.Build(0, 0, triangles.size(), 2, 0);
+
+    CompactBvhNodes(scratch, bvh);
+    return bvh;
+}
+
+template<class T>
+void AppendBvhData(std::vector<u8>& output, std::span<const T> values)
+{
+    const usize offset = output.size();
+    output.resize(offset + values.size_bytes());
+    std::memcpy(output.data() + offset, values.data(), values.size_bytes());
+}
+
+std::vector<u8> cblend::SerializeBvh(const Bvh& bvh)
+{
+    const std::array<u32, 3> header = { BVH_VERSION, u32(bvh.nodes.size()), u32(bvh.primitive_indices.size()) };
+
+    std::vector<u8> output;
+    output.reserve(BVH_HEADER_SIZE + bvh.nodes.size() * sizeof(BvhNode) + bvh.primitive_indices.size() * sizeof(u32));
+    AppendBvhData(output, std::span<const u8>(BVH_MAGIC));
+    AppendBvhData(output, std::span<const u32>(header));
+    AppendBvhData(output, std::span<const BvhNode>(bvh.nodes));
+    AppendBvhData(output, std::span<const u32>(bvh.primitive_indices));
+    return output;
+}
+
+Result<Bvh, BvhError> cblend::DeserializeBvh(MemorySpan data)
+{
+    if (data.size() < BVH_HEADER_SIZE || !std::equal(BVH_MAGIC.begin(), BVH_MAGIC.end(), data.begin()))
+    {
+        return MakeError(BvhError::InvalidHeader);
+    }
+
+    std::array<u32, 3> header = {};
+    std::memcpy(header.data(), data.data() + BVH_MAGIC.size(), sizeof(header));
+    const auto [version, node_count, primitive_count] = header;
+    if (version != BVH_VERSION)
+    {
+        return MakeError(BvhError::UnsupportedVersion);
+    }
+
+    const usize node_bytes = usize(node_count) * sizeof(BvhNode);
+    const usize primitive_bytes = usize(primitive_count) * sizeof(u32);
+    if (data.size() != BVH_HEADER_SIZE + node_bytes + primitive_bytes)
+    {
+        return MakeError(BvhError::TruncatedData);
+    }
+
+    Bvh bvh;
+    bvh.nodes.resize(node_count);
+    bvh.primitive_indices.resize(primitive_count);
+    std::memcpy(bvh.nodes.data(), data.data() + BVH_HEADER_SIZE, node_bytes);
+    std::memcpy(bvh.primitive_indices.data(), data.data() + BVH_HEADER_SIZE + node_bytes, primitive_bytes);
+
+    if ((node_count == 0) != (primitive_count == 0) || node_count == 1)
+    {
+        return MakeError(BvhError::InvalidNode);
+    }
+
+    // Children always follow their parent, which rules out cycles in untrusted input
+    for (usize node = 0; node < bvh.nodes.size(); node += node == 0 ? 2 : 1)
+    {
+        const BvhNode& current = bvh.nodes[node];
+        const bool valid = current.IsLeaf() ? usize(current.index) + current.count <= primitive_count
+                                            : current.index > node && current.index % 2 == 0 && usize(current.index) + 1 < node_count;
+        if (!valid)
+        {
+            return MakeError(BvhError::InvalidNode);
+        }
+    }
+
+    const auto out_of_range = [primitive_count](u32 index) { return index >= primitive_count; };
+    if (std::any_of(bvh.primitive_indices.begin(), bvh.primitive_indices.end(), out_of_range))
+    {
+        return MakeError(BvhError::InvalidNode);
+    }
+
+    return bvh;
+}
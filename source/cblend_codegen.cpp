@@ -0,0 +1,260 @@
+#include <cblend_codegen.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace cblend;
+
+[[nodiscard]] Option<std::string_view> GetPrimitiveCodegenType(std::string_view name)
+{
+    static constexpr std::array<std::pair<std::string_view, std::string_view>, 17> PRIMITIVE_TYPES = { {
+        { "char", "char" },
+        { "uchar", "cblend::u8" },
+        { "short", "cblend::s16" },
+        { "ushort", "cblend::u16" },
+        { "int", "cblend::s32" },
+        { "long", "cblend::s32" },
+        { "ulong", "cblend::u32" },
+        { "float", "cblend::f32" },
+        { "double", "cblend::f64" },
+        { "int8_t", "cblend::s8" },
+        { "uint8_t", "cblend::u8" },
+        { "int16_t", "cblend::s16" },
+        { "uint16_t", "cblend::u16" },
+        { "int32_t", "cblend::s32" },
+        { "uint32_t", "cblend::u32" },
+        { "int64_t", "cblend::s64" },
+        { "uint64_t", "cblend::u64" },
+    } };
+
+    const auto type
+        = std::find_if(PRIMITIVE_TYPES.begin(), PRIMITIVE_TYPES.end(), [name](const auto& entry) { return entry.first == name; });
+    if (type == PRIMITIVE_TYPES.end())
+    {
+        return NULL_OPTION;
+    }
+    return type->second;
+}
+
+[[nodiscard]] bool IsCodegenKeyword(std::string_view name)
+{
+    static const std::unordered_set<std::string_view> KEYWORDS = {
+        "alignas", "alignof",  "and",      "auto",     "bool",     "break",   "case",     "catch",  "char",    "class",
+        "const",   "continue", "default",  "delete",   "do",       "double",  "else",     "enum",   "explicit", "export",
+        "extern",  "false",    "float",    "for",      "friend",   "goto",    "if",       "inline", "int",     "long",
+        "mutable", "new",      "not",      "operator", "or",       "private", "protected", "public", "register", "return",
+        "short",   "signed",   "sizeof",   "static",   "struct",   "switch",  "template", "this",   "throw",   "true",
+        "try",     "typedef",  "typename", "union",    "unsigned", "using",   "virtual",  "void",   "volatile", "while",
+    };
+    return KEYWORDS.contains(name);
+}
+
+[[nodiscard]] bool IsValidCodegenNamespace(std::string_view name)
+{
+    usize begin = 0;
+    while (begin <= name.size())
+    {
+        const usize end = std::min(name.find("::", begin), name.size());
+        const auto part = name.substr(begin, end - begin);
+        if (part.empty() || std::isdigit(part.front()) != 0 || IsCodegenKeyword(part))
+        {
+            return false;
+        }
+
+        if (!std::all_of(part.begin(), part.end(), [](char chr) { return std::isalnum(chr) != 0 || chr == '_'; }))
+        {
+            return false;
+        }
+
+        begin = end + 2;
+    }
+    return true;
+}
+
+struct CodegenDeclarator
+{
+    std::string type = {};
+    std::string suffix = {};
+    usize alignment = 1;
+};
+
+class HeaderGenerator
+{
+public:
+    HeaderGenerator(const Blend& blend, std::string_view namespace_name)
+        : m_PointerType(blend.GetPointer() == Pointer::U32 ? "cblend::u32" : "cblend::u64")
+        , m_PointerSize(blend.GetPointer() == Pointer::U32 ? sizeof(u32) : sizeof(u64))
+        , m_NamespaceName(namespace_name)
+    {
+        for (const auto& type : blend.GetStructTypes())
+        {
+            m_Types.emplace(type.GetName(), type);
+        }
+    }
+
+    [[nodiscard]] bool Add(std::string_view name)
+    {
+        const auto type = m_Types.find(name);
+        if (type == m_Types.end())
+        {
+            return false;
+        }
+
+        Emit(type->second);
+        return true;
+    }
+
+    void AddAll(const Blend& blend)
+    {
+        for (const auto& type : blend.GetStructTypes())
+        {
+            Emit(type);
+        }
+    }
+
+    [[nodiscard]] std::string Finish(u64 sdna_hash) const
+    {
+        std::array<char, 2 * sizeof(u64)> hash = {};
+        const auto hash_end = std::to_chars(hash.data(), hash.data() + hash.size(), sdna_hash, 16).ptr;
+
+        std::string header = "// Generated by cblend-codegen, do not edit\n#pragma once\n\n#include <cblend_types.hpp>\n\n";
+        header += "#include <cstddef>\n#include <string_view>\n\nnamespace ";
+        header.append(m_NamespaceName).append("\n{\n// Fingerprint of the DNA1 block, see cblend::Blend::GetSdnaHash\n");
+        header.append("static constexpr cblend::u64 SDNA_HASH = 0x").append(hash.data(), hash_end).append("U;\n");
+        header.append(m_Body).append("} // namespace ").append(m_NamespaceName).append("\n");
+        return header;
+    }
+
+private:
+    std::string_view m_PointerType;
+    usize m_PointerSize;
+    std::string_view m_NamespaceName;
+    std::unordered_map<std::string_view, BlendType> m_Types;
+    // Alignment of every emitted struct, one when it had to be packed
+    std::unordered_map<std::string_view, usize> m_Alignments;
+    std::string m_Body;
+
+    [[nodiscard]] Option<CodegenDeclarator> Describe(const BlendType& type)
+    {
+        if (type.IsArray())
+        {
+            auto element = type.GetElementType() ? Describe(*type.GetElementType()) : NULL_OPTION;
+            if (element)
+            {
+                element->suffix = "[" + std::to_string(type.GetArrayRank()) + "]" + element->suffix;
+            }
+            return element;
+        }
+
+        if (type.IsPointer())
+        {
+            return CodegenDeclarator{ .type = std::string(m_PointerType), .alignment = m_PointerSize };
+        }
+
+        if (type.IsStruct())
+        {
+            Emit(type);
+            const auto alignment = m_Alignments.find(type.GetName());
+            if (alignment == m_Alignments.end())
+            {
+                return NULL_OPTION;
+            }
+            return CodegenDeclarator{ .type = "struct " + std::string(type.GetName()), .alignment = alignment->second };
+        }
+
+        if (type.IsPrimitive() && type.GetSize() != 0)
+        {
+            if (const auto primitive = GetPrimitiveCodegenType(type.GetName()))
+            {
+                return CodegenDeclarator{ .type = std::string(*primitive), .alignment = type.GetSize() };
+            }
+
+            // Unknown primitives keep their size
+            return CodegenDeclarator{ .type = "cblend::u8", .suffix = "[" + std::to_string(type.GetSize()) + "]" };
+        }
+
+        return NULL_OPTION;
+    }
+
+    void Emit(const BlendType& type)
+    {
+        const std::string_view name = type.GetName();
+        if (m_Alignments.contains(name) || type.GetSize() == 0)
+        {
+            return;
+        }
+
+        // Embedded structs are emitted first, and a struct can not embed itself
+        m_Alignments.emplace(name, 1);
+
+        std::string fields;
+        std::string asserts;
+        std::unordered_set<std::string> field_names;
+        usize alignment = 1;
+        bool is_packed = false;
+
+        for (const auto& field : type.GetFields())
+        {
+            auto declarator = Describe(field.GetFieldType());
+            if (!declarator)
+            {
+                // Only void remains, which SDNA never stores by value
+                declarator = CodegenDeclarator{ .type = "cblend::u8", .suffix = "[" + std::to_string(field.GetSize()) + "]" };
+            }
+
+            std::string field_name(field.GetName());
+            if (IsCodegenKeyword(field_name) || field_name == name)
+            {
+                field_name += '_';
+            }
+            while (!field_names.insert(field_name).second)
+            {
+                field_name += '_';
+            }
+
+            alignment = std::max(alignment, declarator->alignment);
+            is_packed = is_packed || field.GetOffset() % declarator->alignment != 0;
+            fields.append("    ").append(declarator->type).append(" ").append(field_name).append(declarator->suffix).append(";\n");
+            asserts.append("static_assert(offsetof(").append(name).append(", ").append(field_name).append(") == ");
+            asserts.append(std::to_string(field.GetOffset())).append(");\n");
+        }
+
+        is_packed = is_packed || type.GetSize() % alignment != 0;
+        m_Alignments[name] = is_packed ? 1 : alignment;
+
+        m_Body.append(is_packed ? "\n#pragma pack(push, 1)\n" : "\n").append("struct ").append(name).append("\n{\n");
+        m_Body.append("    static constexpr cblend::u64 SDNA_HASH = ::").append(m_NamespaceName).append("::SDNA_HASH;\n");
+        m_Body.append("    static constexpr std::string_view SDNA_NAME = \"").append(name).append("\";\n\n");
+        m_Body.append(fields).append(is_packed ? "};\n#pragma pack(pop)\n" : "};\n");
+        m_Body.append("static_assert(sizeof(").append(name).append(") == ").append(std::to_string(type.GetSize())).append(");\n");
+        m_Body.append(asserts);
+    }
+};
+
+Result<std::string, CodegenError> cblend::GenerateHeader(const Blend& blend, const CodegenSettings& settings)
+{
+    if (!IsValidCodegenNamespace(settings.namespace_name))
+    {
+        return MakeError(CodegenError::InvalidNamespace);
+    }
+
+    HeaderGenerator generator(blend, settings.namespace_name);
+    if (settings.struct_names.empty())
+    {
+        generator.AddAll(blend);
+    }
+
+    for (const auto name : settings.struct_names)
+    {
+        if (!generator.Add(name))
+        {
+            return MakeError(CodegenError::StructNotFound);
+        }
+    }
+
+    return generator.Finish(blend.GetSdnaHash());
+}
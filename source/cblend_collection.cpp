@@ -0,0 +1,338 @@
+#include <cblend_collection.hpp>
+#include <cblend_parallel.hpp>
+
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace cblend;
+
+static constexpr s16 OBJECT_TYPE_MESH = 1;
+static constexpr s16 OBJECT_FLAG_INSTANCE_COLLECTION = 1 << 8;
+
+static constexpr usize OBJECT_GRAIN_SIZE = 1024;
+
+usize FlattenedInstances::GetInstanceCount() const
+{
+    usize count = 0;
+    for (const auto& mesh : meshes)
+    {
+        count += mesh.world_matrices.size();
+    }
+    return count;
+}
+
+// Fields renamed in 2.80 are looked up under their legacy name as well
+[[nodiscard]] Option<BlendFieldInfo> GetRenamedField(const BlendType& type, std::string_view name, std::string_view legacy_name)
+{
+    auto field = type.GetField(name);
+    return field ? field : type.GetField(legacy_name);
+}
+
+// The first pointer of a ListBase field, missing when the list or its first member is missing
+[[nodiscard]] Option<BlendFieldInfo> GetListFirstField(const Option<BlendFieldInfo>& list)
+{
+    if (!list)
+    {
+        return NULL_OPTION;
+    }
+
+    return list->GetFieldType().GetField("first");
+}
+
+struct CollectionFields
+{
+    CollectionFields(
+        const BlendType& collection_struct,
+        const BlendType& collection_object_struct,
+        const BlendType& collection_child_struct,
+        const BlendType& object_struct
+    )
+        : collection_type(collection_struct)
+        , collection_object_type(collection_object_struct)
+        , collection_child_type(collection_child_struct)
+        , object_type(object_struct)
+        , objects(collection_type.GetField("gobject"))
+        , children(collection_type.GetField("children"))
+        , instance_offset(GetRenamedField(collection_type, "instance_offset", "dupli_ofs"))
+        , object_next(collection_object_type.GetField("next"))
+        , object(collection_object_type.GetField("ob"))
+        , child_next(collection_child_type.GetField("next"))
+        , child(collection_child_type.GetField("collection"))
+        , type(object_type.GetField("type"))
+        , data(object_type.GetField("data"))
+        , transform_flag(object_type.GetField("transflag"))
+        , instance_collection(GetRenamedField(object_type, "instance_collection", "dup_group"))
+        , objects_first(GetListFirstField(objects))
+        , children_first(GetListFirstField(children))
+    {
+    }
+
+    [[nodiscard]] bool IsValid() const
+    {
+        return objects_first && children_first && object_next && object && child_next && child && type && data && transform_flag
+            && instance_collection;
+    }
+
+    BlendType collection_type;
+    BlendType collection_object_type;
+    BlendType collection_child_type;
+    BlendType object_type;
+    Option<BlendFieldInfo> objects;
+    Option<BlendFieldInfo> children;
+    Option<BlendFieldInfo> instance_offset;
+    Option<BlendFieldInfo> object_next;
+    Option<BlendFieldInfo> object;
+    Option<BlendFieldInfo> child_next;
+    Option<BlendFieldInfo> child;
+    Option<BlendFieldInfo> type;
+    Option<BlendFieldInfo> data;
+    Option<BlendFieldInfo> transform_flag;
+    Option<BlendFieldInfo> instance_collection;
+    Option<BlendFieldInfo> objects_first;
+    Option<BlendFieldInfo> children_first;
+};
+
+struct CollectionEntry
+{
+    u32 object = 0;
+    Float4x4 matrix = IDENTITY_MATRIX;
+};
+
+// Expands collections depth first, each collection is expanded once and reused by every object instancing it
+class CollectionFlattener
+{
+public:
+    CollectionFlattener(const Blend& blend, const ObjectHierarchy& hierarchy, const CollectionFields& fields)
+        : m_Blend(blend)
+        , m_Hierarchy(hierarchy)
+        , m_Fields(fields)
+        , m_MeshAddresses(hierarchy.GetObjectCount(), 0)
+        , m_InstancedCollections(hierarchy.GetObjectCount(), 0)
+    {
+        for (usize object = 0; object < hierarchy.GetObjectCount(); ++object)
+        {
+            m_ObjectIndices.emplace(hierarchy.objects[object]->header.address, u32(object));
+        }
+
+        ParallelFor(
+            hierarchy.GetObjectCount(),
+            OBJECT_GRAIN_SIZE,
+            [this](usize begin, usize end)
+            {
+                for (usize object = begin; object < end; ++object)
+                {
+                    const Block& block = *m_Hierarchy.objects[object];
+                    if (m_Fields.type->GetValue<s16>(block) == OBJECT_TYPE_MESH)
+                    {
+                        m_MeshAddresses[object] = m_Fields.data->GetPointerAddress(block.body).value_or(0);
+                    }
+
+                    if ((m_Fields.transform_flag->GetValue<s16>(block).value_or(0) & OBJECT_FLAG_INSTANCE_COLLECTION) != 0)
+                    {
+                        m_InstancedCollections[object] = m_Fields.instance_collection->GetPointerAddress(block.body).value_or(0);
+                    }
+                }
+            }
+        );
+    }
+
+    [[nodiscard]] Result<const std::vector<CollectionEntry>*, CollectionError> Expand(u64 address, MemorySpan collection)
+    {
+        if (const auto expansion = m_Expansions.find(address); expansion != m_Expansions.end())
+        {
+            return &expansion->second;
+        }
+
+        if (!m_Expanding.insert(address).second)
+        {
+            return MakeError(CollectionError::CyclicCollection);
+        }
+
+        std::vector<u32> objects;
+        std::unordered_set<u64> visited = { address };
+        std::vector<u8> seen(m_Hierarchy.GetObjectCount(), 0);
+        CollectObjects(collection, visited, seen, objects);
+
+        std::vector<CollectionEntry> entries;
+        for (const u32 object : objects)
+        {
+            if (m_MeshAddresses[object] != 0)
+            {
+                entries.push_back({ object, m_Hierarchy.world_matrices[object] });
+            }
+
+            if (m_InstancedCollections[object] == 0)
+            {
+                continue;
+            }
+
+            const auto instanced = m_Fields.instance_collection->GetPointerData(
+                m_Hierarchy.objects[object]->body,
+                m_Fields.collection_type.GetSize()
+            );
+
+            if (instanced.empty())
+            {
+                continue;
+            }
+
+            const auto instanced_entries = Expand(m_InstancedCollections[object], instanced);
+            if (!instanced_entries)
+            {
+                return MakeError(instanced_entries.error());
+            }
+
+            const Float3 offset
+                = m_Fields.instance_offset ? m_Fields.instance_offset->GetValue<Float3>(instanced).value_or(Float3{}) : Float3{};
+            const Float4x4 instance_matrix = Multiply(
+                m_Hierarchy.world_matrices[object],
+                ComposeTransform(Scale(offset, -1.F), IDENTITY_MATRIX, { 1.F, 1.F, 1.F })
+            );
+
+            for (const auto& entry : **instanced_entries)
+            {
+                entries.push_back({ entry.object, Multiply(instance_matrix, entry.matrix) });
+            }
+        }
+
+        m_Expanding.erase(address);
+        return &m_Expansions.emplace(address, std::move(entries)).first->second;
+    }
+
+    [[nodiscard]] FlattenedInstances Group(const std::vector<CollectionEntry>& entries) const
+    {
+        std::unordered_map<u64, const Block*> mesh_blocks;
+        for (const auto& block : m_Blend.GetBlocks(BLOCK_CODE_ME))
+        {
+            mesh_blocks.emplace(block.header.address, &block);
+        }
+
+        FlattenedInstances result;
+        std::unordered_map<u64, usize> mesh_indices;
+        for (const auto& entry : entries)
+        {
+            const auto mesh_block = mesh_blocks.find(m_MeshAddresses[entry.object]);
+            if (mesh_block == mesh_blocks.end())
+            {
+                continue;
+            }
+
+            const auto [mesh_index, inserted] = mesh_indices.emplace(mesh_block->first, result.meshes.size());
+            if (inserted)
+            {
+                result.meshes.push_back({ .mesh = mesh_block->second });
+            }
+
+            auto& mesh = result.meshes[mesh_index->second];
+            mesh.source_objects.push_back(entry.object);
+            mesh.world_matrices.push_back(entry.matrix);
+        }
+        return result;
+    }
+
+private:
+    const Blend& m_Blend;
+    const ObjectHierarchy& m_Hierarchy;
+    const CollectionFields& m_Fields;
+    std::unordered_map<u64, u32> m_ObjectIndices;
+    std::vector<u64> m_MeshAddresses;
+    std::vector<u64> m_InstancedCollections;
+    std::unordered_map<u64, std::vector<CollectionEntry>> m_Expansions;
+    std::unordered_set<u64> m_Expanding;
+
+    // Gathers the unique objects of a collection and its children, the same set Blender's object cache holds
+    void CollectObjects(MemorySpan collection, std::unordered_set<u64>& visited, std::vector<u8>& seen, std::vector<u32>& objects) const
+    {
+        const usize link_limit = m_Blend.GetBlockCount();
+        const usize object_link_size = m_Fields.collection_object_type.GetSize();
+        MemorySpan link = m_Fields.objects_first->GetPointerData(m_Fields.objects->GetData(collection), object_link_size);
+        for (usize count = 0; !link.empty() && count < link_limit; ++count)
+        {
+            const auto address = m_Fields.object->GetPointerAddress(link);
+            if (const auto object = m_ObjectIndices.find(address.value_or(0)); object != m_ObjectIndices.end() && seen[object->second] == 0)
+            {
+                seen[object->second] = 1;
+                objects.push_back(object->second);
+            }
+            link = m_Fields.object_next->GetPointerData(link, object_link_size);
+        }
+
+        const usize child_link_size = m_Fields.collection_child_type.GetSize();
+        link = m_Fields.children_first->GetPointerData(m_Fields.children->GetData(collection), child_link_size);
+        for (usize count = 0; !link.empty() && count < link_limit; ++count)
+        {
+            const auto address = m_Fields.child->GetPointerAddress(link).value_or(0);
+            if (address != 0 && visited.insert(address).second)
+            {
+                CollectObjects(m_Fields.child->GetPointerData(link, m_Fields.collection_type.GetSize()), visited, seen, objects);
+            }
+            link = m_Fields.child_next->GetPointerData(link, child_link_size);
+        }
+    }
+};
+
+[[nodiscard]] Result<FlattenedInstances, CollectionError>
+FlattenInstances(const Blend& blend, const ObjectHierarchy& hierarchy, u64 address, MemorySpan collection)
+{
+    const auto collection_type = blend.GetType("Collection");
+    const auto collection_object_type = blend.GetType("CollectionObject");
+    const auto collection_child_type = blend.GetType("CollectionChild");
+    if (!collection_type || !collection_object_type || !collection_child_type)
+    {
+        return MakeError(CollectionError::InvalidCollectionType);
+    }
+
+    const auto object_type = blend.GetType("Object");
+    if (!object_type)
+    {
+        return MakeError(CollectionError::InvalidObjectType);
+    }
+
+    const CollectionFields fields(*collection_type, *collection_object_type, *collection_child_type, *object_type);
+    if (!fields.IsValid())
+    {
+        return MakeError(CollectionError::InvalidCollectionType);
+    }
+
+    if (collection.size() < collection_type->GetSize())
+    {
+        return MakeError(CollectionError::InvalidCollectionType);
+    }
+
+    CollectionFlattener flattener(blend, hierarchy, fields);
+    const auto entries = flattener.Expand(address, collection);
+    if (!entries)
+    {
+        return MakeError(entries.error());
+    }
+
+    return flattener.Group(**entries);
+}
+
+Result<FlattenedInstances, CollectionError>
+cblend::FlattenSceneInstances(const Blend& blend, const ObjectHierarchy& hierarchy, const Block& scene)
+{
+    const auto scene_type = blend.GetBlockType(scene);
+    const auto collection_type = blend.GetType("Collection");
+    if (!scene_type || !collection_type)
+    {
+        return MakeError(CollectionError::InvalidSceneType);
+    }
+
+    const auto master_collection = scene_type->GetField("master_collection");
+    if (!master_collection)
+    {
+        return MakeError(CollectionError::InvalidSceneType);
+    }
+
+    const auto address = master_collection->GetPointerAddress(scene.body).value_or(0);
+    const auto collection = master_collection->GetPointerData(scene.body, collection_type->GetSize());
+    return FlattenInstances(blend, hierarchy, address, collection);
+}
+
+Result<FlattenedInstances, CollectionError>
+cblend::FlattenCollectionInstances(const Blend& blend, const ObjectHierarchy& hierarchy, const Block& collection)
+{
+    return FlattenInstances(blend, hierarchy, collection.header.address, collection.body);
+}
@@ -0,0 +1,877 @@
+#include <cblend_curve.hpp>
+#include <cblend_mesh.hpp>
+#include <cblend_parallel.hpp>
+#include <cblend_simd.hpp>
+#include <range/v3/algorithm/find_if.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+using namespace cblend;
+
+using CurveLanes = std::array<f32, simd::FloatN::WIDTH>;
+
+static constexpr usize MAX_NURBS_ORDER = 16;
+static constexpr usize SPLINE_GRAIN_SIZE = 64;
+
+// Nurb::type and Nurb::flagu values of legacy curves
+static constexpr s16 NURB_TYPE_MASK = 7;
+static constexpr s16 NURB_TYPE_POLY = 0;
+static constexpr s16 NURB_TYPE_BEZIER = 1;
+static constexpr s16 NURB_TYPE_NURBS = 4;
+static constexpr s16 NURB_FLAG_CYCLIC = 1;
+static constexpr s16 NURB_FLAG_ENDPOINT = 2;
+static constexpr s16 NURB_FLAG_BEZIER = 4;
+
+static constexpr s32 DEFAULT_CURVES_RESOLUTION = 12;
+static constexpr s8 DEFAULT_NURBS_ORDER = 4;
+
+usize Splines::GetSplineCount() const
+{
+    return types.size();
+}
+
+usize Splines::GetPointCount() const
+{
+    return positions.size();
+}
+
+// Same rules as Blender, bezier knots need a full span past the repeated head knots and cyclic ones whole segments
+[[nodiscard]] bool IsValidNurbs(usize point_count, usize order, bool cyclic, KnotsMode mode)
+{
+    if (order < 2 || order > MAX_NURBS_ORDER || point_count < order)
+    {
+        return false;
+    }
+
+    if (mode == KnotsMode::Bezier || mode == KnotsMode::EndpointBezier)
+    {
+        return (mode != KnotsMode::Bezier || point_count > order) && (!cyclic || point_count % (order - 1) == 0);
+    }
+
+    return true;
+}
+
+[[nodiscard]] usize GetSegmentCount(usize point_count, bool cyclic)
+{
+    return cyclic ? point_count : point_count - 1;
+}
+
+// Splines that cannot be evaluated with their own type fall back to their control polygon
+[[nodiscard]] SplineType GetEvaluatedType(const Splines& splines, usize spline)
+{
+    const usize point_count = splines.point_offsets[spline + 1] - splines.point_offsets[spline];
+    const SplineType type = splines.types[spline];
+
+    if (point_count < 2)
+    {
+        return SplineType::Poly;
+    }
+
+    if (type == SplineType::Bezier && (splines.handles_left.empty() || splines.handles_right.empty()))
+    {
+        return SplineType::Poly;
+    }
+
+    if (type == SplineType::Nurbs
+        && !IsValidNurbs(point_count, splines.orders[spline], splines.cyclic[spline] != 0, splines.knots_modes[spline]))
+    {
+        return SplineType::Poly;
+    }
+
+    return type;
+}
+
+// Cubic bezier control points of one segment, catmull-rom segments are converted to the same form
+[[nodiscard]] std::array<Float3, 4> GetCubicSegment(const Splines& splines, usize spline, usize segment)
+{
+    const usize first = splines.point_offsets[spline];
+    const usize point_count = splines.point_offsets[spline + 1] - first;
+    const bool cyclic = splines.cyclic[spline] != 0;
+    const usize start = first + segment;
+    const usize end = first + (segment + 1) % point_count;
+
+    if (splines.types[spline] == SplineType::Bezier)
+    {
+        return { splines.positions[start], splines.handles_right[start], splines.handles_left[end], splines.positions[end] };
+    }
+
+    // Open splines repeat their end points as the outer neighbours
+    const usize before = cyclic ? first + (segment + point_count - 1) % point_count : first + (segment == 0 ? 0 : segment - 1);
+    const usize after = cyclic ? first + (segment + 2) % point_count : first + std::min(segment + 2, point_count - 1);
+    const auto& p0 = splines.positions[before];
+    const auto& p1 = splines.positions[start];
+    const auto& p2 = splines.positions[end];
+    const auto& p3 = splines.positions[after];
+    return { p1, Add(p1, Scale(Subtract(p2, p0), 1.F / 6.F)), Subtract(p2, Scale(Subtract(p3, p1), 1.F / 6.F)), p2 };
+}
+
+[[nodiscard]] f32 GetSecondDifference(const Float3& p0, const Float3& p1, const Float3& p2)
+{
+    return Length(Add(Subtract(p0, Scale(p1, 2.F)), p2));
+}
+
+// Wang's bound on the number of segments that keeps a polynomial of the given degree within the tolerance
+[[nodiscard]] u32 SelectResolution(const TessellationSettings& settings, u32 spline_resolution, f32 second_difference, usize degree)
+{
+    switch (settings.mode)
+    {
+    case ResolutionMode::Spline: return std::max<u32>(spline_resolution, 1);
+    case ResolutionMode::Fixed: return std::max<u32>(settings.resolution, 1);
+    case ResolutionMode::Adaptive:
+    {
+        const f32 factor = f32(degree * (degree - 1)) / 8.F;
+        const f32 segments = std::ceil(std::sqrt(factor * second_difference / std::max(settings.tolerance, 1e-12F)));
+        return std::clamp<u32>(u32(std::min(segments, f32(settings.max_resolution))), 1, std::max<u32>(settings.max_resolution, 1));
+    }
+    }
+
+    return 1;
+}
+
+[[nodiscard]] u32 GetCubicResolution(const TessellationSettings& settings, u32 spline_resolution, const std::array<Float3, 4>& controls)
+{
+    const f32 second_difference = std::max(
+        GetSecondDifference(controls[0], controls[1], controls[2]), GetSecondDifference(controls[1], controls[2], controls[3])
+    );
+    return SelectResolution(settings, spline_resolution, second_difference, 3);
+}
+
+[[nodiscard]] u32 GetNurbsResolution(const Splines& splines, usize spline, const TessellationSettings& settings)
+{
+    const usize first = splines.point_offsets[spline];
+    const usize point_count = splines.point_offsets[spline + 1] - first;
+    const bool cyclic = splines.cyclic[spline] != 0;
+
+    f32 second_difference = 0.F;
+    if (settings.mode == ResolutionMode::Adaptive)
+    {
+        const usize window_count = cyclic ? point_count : point_count - 2;
+        for (usize window = 0; window < window_count; ++window)
+        {
+            second_difference = std::max(
+                second_difference,
+                GetSecondDifference(
+                    splines.positions[first + window],
+                    splines.positions[first + (window + 1) % point_count],
+                    splines.positions[first + (window + 2) % point_count]
+                )
+            );
+        }
+    }
+
+    return SelectResolution(settings, splines.resolutions[spline], second_difference, splines.orders[spline] - 1U);
+}
+
+[[nodiscard]] usize GetEvaluatedCount(const Splines& splines, usize spline, const TessellationSettings& settings)
+{
+    const usize point_count = splines.point_offsets[spline + 1] - splines.point_offsets[spline];
+    const bool cyclic = splines.cyclic[spline] != 0;
+
+    switch (GetEvaluatedType(splines, spline))
+    {
+    case SplineType::Poly: return point_count;
+    case SplineType::Nurbs: return GetNurbsResolution(splines, spline, settings) * GetSegmentCount(point_count, cyclic);
+    case SplineType::CatmullRom:
+    case SplineType::Bezier:
+    {
+        usize count = cyclic ? 0 : 1;
+        for (usize segment = 0; segment < GetSegmentCount(point_count, cyclic); ++segment)
+        {
+            count += GetCubicResolution(settings, splines.resolutions[spline], GetCubicSegment(splines, spline, segment));
+        }
+        return count;
+    }
+    }
+
+    return point_count;
+}
+
+std::vector<u32> cblend::ComputeEvaluatedOffsets(const Splines& splines, const TessellationSettings& settings)
+{
+    const usize spline_count = splines.GetSplineCount();
+    std::vector<u32> offsets(spline_count + 1, 0);
+
+    ParallelFor(
+        spline_count,
+        SPLINE_GRAIN_SIZE,
+        [&](usize begin, usize end)
+        {
+            for (usize spline = begin; spline < end; ++spline)
+            {
+                offsets[spline + 1] = u32(GetEvaluatedCount(splines, spline, settings));
+            }
+        }
+    );
+
+    std::inclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+    return offsets;
+}
+
+// Each spline has to get exactly the points EvaluateSpline writes for it
+[[nodiscard]] bool IsValidEvaluatedOffsets(const Splines& splines, const TessellationSettings& settings, std::span<const u32> offsets)
+{
+    std::atomic<bool> is_valid = true;
+    ParallelFor(
+        splines.GetSplineCount(),
+        SPLINE_GRAIN_SIZE,
+        [&](usize begin, usize end)
+        {
+            for (usize spline = begin; spline < end; ++spline)
+            {
+                if (offsets[spline + 1] < offsets[spline]
+                    || offsets[spline + 1] - offsets[spline] != GetEvaluatedCount(splines, spline, settings))
+                {
+                    is_valid = false;
+                    return;
+                }
+            }
+        }
+    );
+    return is_valid;
+}
+
+[[nodiscard]] f32 GetSplineRadius(const Splines& splines, usize point)
+{
+    return splines.radii.empty() ? 1.F : splines.radii[point];
+}
+
+void WriteCurveLanes(
+    const std::array<simd::FloatN, 3>& position,
+    simd::FloatN radius,
+    usize count,
+    Float3* output_positions,
+    f32* output_radii
+)
+{
+    std::array<CurveLanes, 3> components = {};
+    CurveLanes radius_lanes = {};
+    for (usize axis = 0; axis < 3; ++axis)
+    {
+        position[axis].Store(components[axis].data());
+    }
+    radius.Store(radius_lanes.data());
+
+    for (usize lane = 0; lane < count; ++lane)
+    {
+        output_positions[lane] = { components[0][lane], components[1][lane], components[2][lane] };
+    }
+
+    if (output_radii != nullptr)
+    {
+        std::copy_n(radius_lanes.begin(), count, output_radii);
+    }
+}
+
+// Samples t = k / resolution for k in [0, resolution), a batch of parameters per register
+void EvaluateCubicSegment(
+    const std::array<Float3, 4>& controls,
+    f32 start_radius,
+    f32 end_radius,
+    u32 resolution,
+    Float3* output_positions,
+    f32* output_radii
+)
+{
+    using simd::FloatN;
+
+    const f32 step = 1.F / f32(resolution);
+    const auto three = FloatN::Broadcast(3.F);
+    CurveLanes parameters = {};
+
+    for (usize first = 0; first < resolution; first += FloatN::WIDTH)
+    {
+        const usize count = std::min<usize>(FloatN::WIDTH, resolution - first);
+        for (usize lane = 0; lane < FloatN::WIDTH; ++lane)
+        {
+            parameters[lane] = f32(first + std::min(lane, count - 1)) * step;
+        }
+
+        const auto t = FloatN::Load(parameters.data());
+        const auto s = FloatN::Broadcast(1.F) - t;
+        const std::array<FloatN, 4> basis = { s * s * s, three * s * s * t, three * s * t * t, t * t * t };
+
+        std::array<FloatN, 3> position = {};
+        for (usize axis = 0; axis < 3; ++axis)
+        {
+            position[axis] = basis[0] * FloatN::Broadcast(controls[0][axis]);
+            for (usize control = 1; control < 4; ++control)
+            {
+                position[axis] = FloatN::MulAdd(basis[control], FloatN::Broadcast(controls[control][axis]), position[axis]);
+            }
+        }
+
+        const auto radius = FloatN::MulAdd(t, FloatN::Broadcast(end_radius - start_radius), FloatN::Broadcast(start_radius));
+        WriteCurveLanes(position, radius, count, output_positions + first, output_radii == nullptr ? nullptr : output_radii + first);
+    }
+}
+
+// Knot vectors as laid out by Blender for each knots mode, cyclic splines wrap order - 1 extra points
+void CalculateKnots(usize point_count, usize order, bool cyclic, KnotsMode mode, std::vector<f32>& knots)
+{
+    const bool is_bezier = mode == KnotsMode::Bezier || mode == KnotsMode::EndpointBezier;
+    const bool is_endpoint = mode == KnotsMode::Endpoint || mode == KnotsMode::EndpointBezier;
+    const usize repeat_inner = is_bezier ? order - 1 : 1;
+    const usize head = is_endpoint ? order - (cyclic ? 1 : 0) : (is_bezier ? std::min<usize>(2, repeat_inner) : 1);
+    const usize tail = cyclic ? 2 * order - 1 : (is_endpoint ? order : 0);
+    const usize offset = is_endpoint && cyclic ? 1 : 0;
+
+    knots.resize(cyclic ? point_count + 2 * order - 1 : point_count + order);
+    f32 current = 0.F;
+    if (offset != 0)
+    {
+        knots[0] = current;
+        current += 1.F;
+    }
+
+    usize remaining = head;
+    for (usize knot = offset; knot < knots.size() - tail; ++knot)
+    {
+        knots[knot] = current;
+        if (--remaining == 0)
+        {
+            current += 1.F;
+            remaining = repeat_inner;
+        }
+    }
+
+    const usize tail_start = knots.size() - tail;
+    for (usize knot = 0; knot < tail; ++knot)
+    {
+        knots[tail_start + knot] = current + (knots[knot] - knots[0]);
+    }
+}
+
+// Cox-de Boor recursion for a batch of parameters inside knot span [knots[span], knots[span + 1]]
+void EvaluateNurbsBatch(
+    const Splines& splines,
+    usize spline,
+    std::span<const f32> knots,
+    usize span,
+    const CurveLanes& parameters,
+    usize count,
+    Float3* output_positions,
+    f32* output_radii
+)
+{
+    using simd::FloatN;
+
+    const usize first = splines.point_offsets[spline];
+    const usize point_count = splines.point_offsets[spline + 1] - first;
+    const usize degree = splines.orders[spline] - 1U;
+    const auto u = FloatN::Load(parameters.data());
+
+    std::array<FloatN, MAX_NURBS_ORDER> basis = {};
+    std::array<FloatN, MAX_NURBS_ORDER> left = {};
+    std::array<FloatN, MAX_NURBS_ORDER> right = {};
+    basis[0] = FloatN::Broadcast(1.F);
+
+    for (usize j = 1; j <= degree; ++j)
+    {
+        left[j] = u - FloatN::Broadcast(knots[span + 1 - j]);
+        right[j] = FloatN::Broadcast(knots[span + j]) - u;
+        auto saved = FloatN::Broadcast(0.F);
+        for (usize r = 0; r < j; ++r)
+        {
+            const auto weight = basis[r] / (right[r + 1] + left[j - r]);
+            basis[r] = FloatN::MulAdd(right[r + 1], weight, saved);
+            saved = left[j - r] * weight;
+        }
+        basis[j] = saved;
+    }
+
+    std::array<FloatN, 3> position = {};
+    position.fill(FloatN::Broadcast(0.F));
+    auto radius = FloatN::Broadcast(0.F);
+    auto denominator = FloatN::Broadcast(0.F);
+
+    for (usize r = 0; r <= degree; ++r)
+    {
+        const usize point = first + (span - degree + r) % point_count;
+        const auto weighted = basis[r] * FloatN::Broadcast(splines.weights.empty() ? 1.F : splines.weights[point]);
+        for (usize axis = 0; axis < 3; ++axis)
+        {
+            position[axis] = FloatN::MulAdd(weighted, FloatN::Broadcast(splines.positions[point][axis]), position[axis]);
+        }
+        radius = FloatN::MulAdd(weighted, FloatN::Broadcast(GetSplineRadius(splines, point)), radius);
+        denominator = denominator + weighted;
+    }
+
+    const auto inverse = FloatN::Broadcast(1.F) / denominator;
+    for (auto& axis : position)
+    {
+        axis = axis * inverse;
+    }
+
+    WriteCurveLanes(position, radius * inverse, count, output_positions, output_radii);
+}
+
+void EvaluateNurbsSpline(
+    const Splines& splines,
+    usize spline,
+    usize evaluated_count,
+    std::vector<f32>& knots,
+    Float3* output_positions,
+    f32* output_radii
+)
+{
+    const usize point_count = splines.point_offsets[spline + 1] - splines.point_offsets[spline];
+    const usize order = splines.orders[spline];
+    const usize degree = order - 1;
+    const bool cyclic = splines.cyclic[spline] != 0;
+    CalculateKnots(point_count, order, cyclic, splines.knots_modes[spline], knots);
+
+    const usize last_span = (cyclic ? point_count + degree : point_count) - 1;
+    const f32 start = knots[degree];
+    const f32 end = knots[last_span + 1];
+    const f32 step = (end - start) / f32(std::max<usize>(evaluated_count - (cyclic ? 0 : 1), 1));
+    const auto parameter = [&](usize sample) { return std::min(start + step * f32(sample), end); };
+
+    // Repeated end knots leave zero length spans, parameters at the end belong to the last span that has a length
+    usize end_span = last_span;
+    while (end_span > degree && knots[end_span] == knots[end_span + 1])
+    {
+        --end_span;
+    }
+
+    CurveLanes parameters = {};
+    for (usize sample = 0; sample < evaluated_count;)
+    {
+        // The first knot past the parameter ends its span, so every batch holds at least its first sample
+        const auto span_end = std::upper_bound(
+            knots.begin() + std::ptrdiff_t(degree + 1), knots.begin() + std::ptrdiff_t(end_span + 1), parameter(sample)
+        );
+        const usize span = usize(span_end - knots.begin()) - 1;
+
+        usize count = 0;
+        while (count < simd::FloatN::WIDTH && sample + count < evaluated_count
+               && (span == end_span || parameter(sample + count) < knots[span + 1]))
+        {
+            parameters[count] = parameter(sample + count);
+            ++count;
+        }
+
+        std::fill(parameters.begin() + std::ptrdiff_t(count), parameters.end(), parameters[count - 1]);
+        EvaluateNurbsBatch(
+            splines,
+            spline,
+            knots,
+            span,
+            parameters,
+            count,
+            output_positions + sample,
+            output_radii == nullptr ? nullptr : output_radii + sample
+        );
+        sample += count;
+    }
+}
+
+void EvaluateSpline(
+    const Splines& splines,
+    usize spline,
+    const TessellationSettings& settings,
+    usize evaluated_count,
+    std::vector<f32>& knots,
+    Float3* output_positions,
+    f32* output_radii
+)
+{
+    const usize first = splines.point_offsets[spline];
+    const usize point_count = splines.point_offsets[spline + 1] - first;
+    const bool cyclic = splines.cyclic[spline] != 0;
+
+    switch (GetEvaluatedType(splines, spline))
+    {
+    case SplineType::Poly:
+        std::copy_n(splines.positions.begin() + std::ptrdiff_t(first), point_count, output_positions);
+        if (output_radii != nullptr)
+        {
+            for (usize point = 0; point < point_count; ++point)
+            {
+                output_radii[point] = GetSplineRadius(splines, first + point);
+            }
+        }
+        return;
+    case SplineType::Nurbs: EvaluateNurbsSpline(splines, spline, evaluated_count, knots, output_positions, output_radii); return;
+    case SplineType::CatmullRom:
+    case SplineType::Bezier:
+    {
+        usize written = 0;
+        for (usize segment = 0; segment < GetSegmentCount(point_count, cyclic); ++segment)
+        {
+            const auto controls = GetCubicSegment(splines, spline, segment);
+            const u32 resolution = GetCubicResolution(settings, splines.resolutions[spline], controls);
+            EvaluateCubicSegment(
+                controls,
+                GetSplineRadius(splines, first + segment),
+                GetSplineRadius(splines, first + (segment + 1) % point_count),
+                resolution,
+                output_positions + written,
+                output_radii == nullptr ? nullptr : output_radii + written
+            );
+            written += resolution;
+        }
+
+        if (!cyclic)
+        {
+            output_positions[written] = splines.positions[first + point_count - 1];
+            if (output_radii != nullptr)
+            {
+                output_radii[written] = GetSplineRadius(splines, first + point_count - 1);
+            }
+        }
+        return;
+    }
+    }
+}
+
+Result<void, CurveError> cblend::TessellateSplines(
+    const Splines& splines,
+    const TessellationSettings& settings,
+    std::span<const u32> offsets,
+    std::span<Float3> positions,
+    std::span<f32> radii
+)
+{
+    const usize spline_count = splines.GetSplineCount();
+    if (offsets.size() != spline_count + 1 || !IsValidEvaluatedOffsets(splines, settings, offsets))
+    {
+        return MakeError(CurveError::InvalidOutputSize);
+    }
+
+    if (positions.size() < offsets.back() || (!radii.empty() && radii.size() < offsets.back()))
+    {
+        return MakeError(CurveError::InvalidOutputSize);
+    }
+
+    ParallelFor(
+        spline_count,
+        SPLINE_GRAIN_SIZE,
+        [&](usize begin, usize end)
+        {
+            std::vector<f32> knots;
+            for (usize spline = begin; spline < end; ++spline)
+            {
+                EvaluateSpline(
+                    splines,
+                    spline,
+                    settings,
+                    offsets[spline + 1] - offsets[spline],
+                    knots,
+                    positions.data() + offsets[spline],
+                    radii.empty() ? nullptr : radii.data() + offsets[spline]
+                );
+            }
+        }
+    );
+
+    return {};
+}
+
+TessellatedSplines cblend::TessellateSplines(const Splines& splines, const TessellationSettings& settings)
+{
+    TessellatedSplines result;
+    result.offsets = ComputeEvaluatedOffsets(splines, settings);
+    result.positions.resize(result.offsets.back());
+    result.radii.resize(result.offsets.back());
+
+    // The buffers are sized from the offsets, so tessellation cannot fail here
+    (void)TessellateSplines(splines, settings, result.offsets, result.positions, result.radii);
+    return result;
+}
+
+struct NurbFields
+{
+    BlendType nurb_type;
+    Option<BlendFieldInfo> next;
+    Option<BlendFieldInfo> type;
+    Option<BlendFieldInfo> point_count;
+    Option<BlendFieldInfo> resolution;
+    Option<BlendFieldInfo> order;
+    Option<BlendFieldInfo> flag;
+    Option<BlendFieldInfo> bezier_points;
+    Option<BlendFieldInfo> points;
+
+    explicit NurbFields(const BlendType& nurb_struct)
+        : nurb_type(nurb_struct)
+        , next(nurb_type.GetField("next"))
+        , type(nurb_type.GetField("type"))
+        , point_count(nurb_type.GetField("pntsu"))
+        , resolution(nurb_type.GetField("resolu"))
+        , order(nurb_type.GetField("orderu"))
+        , flag(nurb_type.GetField("flagu"))
+        , bezier_points(nurb_type.GetField("bezt"))
+        , points(nurb_type.GetField("bp"))
+    {
+    }
+
+    [[nodiscard]] bool IsValid() const
+    {
+        return next && type && point_count && bezier_points && points;
+    }
+};
+
+[[nodiscard]] Result<void, CurveError>
+ReadBezierPoints(const Blend& blend, MemorySpan nurb, const NurbFields& fields, usize count, Splines& splines)
+{
+    const auto bezier_type = blend.GetType("BezTriple");
+    const auto vectors = bezier_type ? bezier_type->GetField("vec") : NULL_OPTION;
+    if (!vectors)
+    {
+        return MakeError(CurveError::InvalidSplineType);
+    }
+
+    const auto radius = bezier_type->GetField("radius");
+    const usize stride = bezier_type->GetSize();
+    const MemorySpan data = fields.bezier_points->GetPointerData(nurb, stride * count);
+    if (data.size() != stride * count)
+    {
+        return MakeError(CurveError::MismatchedPointCount);
+    }
+
+    for (usize point = 0; point < count; ++point)
+    {
+        const MemorySpan element = data.subspan(point * stride, stride);
+        const auto handles = vectors->GetValue<std::array<Float3, 3>>(element).value_or(std::array<Float3, 3>{});
+        splines.handles_left.push_back(handles[0]);
+        splines.positions.push_back(handles[1]);
+        splines.handles_right.push_back(handles[2]);
+        splines.weights.push_back(1.F);
+        splines.radii.push_back(radius ? radius->GetValue<f32>(element).value_or(1.F) : 1.F);
+    }
+
+    return {};
+}
+
+[[nodiscard]] Result<void, CurveError>
+ReadNurbPoints(const Blend& blend, MemorySpan nurb, const NurbFields& fields, usize count, Splines& splines)
+{
+    const auto point_type = blend.GetType("BPoint");
+    const auto vector = point_type ? point_type->GetField("vec") : NULL_OPTION;
+    if (!vector)
+    {
+        return MakeError(CurveError::InvalidSplineType);
+    }
+
+    const auto radius = point_type->GetField("radius");
+    const usize stride = point_type->GetSize();
+    const MemorySpan data = fields.points->GetPointerData(nurb, stride * count);
+    if (data.size() != stride * count)
+    {
+        return MakeError(CurveError::MismatchedPointCount);
+    }
+
+    for (usize point = 0; point < count; ++point)
+    {
+        const MemorySpan element = data.subspan(point * stride, stride);
+        const auto position = vector->GetValue<Float4>(element).value_or(Float4{ 0.F, 0.F, 0.F, 1.F });
+        splines.positions.push_back({ position[0], position[1], position[2] });
+        splines.handles_left.push_back(splines.positions.back());
+        splines.handles_right.push_back(splines.positions.back());
+        splines.weights.push_back(position[3]);
+        splines.radii.push_back(radius ? radius->GetValue<f32>(element).value_or(1.F) : 1.F);
+    }
+
+    return {};
+}
+
+Result<Splines, CurveError> cblend::ExtractCurveSplines(const Blend& blend, const Block& curve)
+{
+    const auto curve_type = blend.GetBlockType(curve);
+    const auto nurb_type = blend.GetType("Nurb");
+    const auto nurb_list = curve_type ? curve_type->GetField("nurb") : NULL_OPTION;
+    if (!nurb_type || !nurb_list)
+    {
+        return MakeError(CurveError::InvalidCurveType);
+    }
+
+    const auto list_first = nurb_list->GetFieldType().GetField("first");
+    const NurbFields fields(*nurb_type);
+    if (!list_first || !fields.IsValid())
+    {
+        return MakeError(CurveError::InvalidSplineType);
+    }
+
+    const auto curve_resolution = curve_type->GetField("resolu");
+    const s16 default_resolution = curve_resolution ? curve_resolution->GetValue<s16>(curve).value_or(1) : s16(1);
+    const usize nurb_size = nurb_type->GetSize();
+
+    Splines splines;
+    splines.point_offsets.push_back(0);
+    MemorySpan link = list_first->GetPointerData(nurb_list->GetData(curve), nurb_size);
+
+    while (!link.empty())
+    {
+        if (splines.GetSplineCount() >= blend.GetBlockCount())
+        {
+            return MakeError(CurveError::InvalidSplineList);
+        }
+
+        const s16 type = s16(fields.type->GetValue<s16>(link).value_or(0) & NURB_TYPE_MASK);
+        const usize count = usize(std::max(fields.point_count->GetValue<s32>(link).value_or(0), 0));
+        const s16 flag = fields.flag ? fields.flag->GetValue<s16>(link).value_or(0) : s16(0);
+        const s16 resolution = fields.resolution ? fields.resolution->GetValue<s16>(link).value_or(0) : s16(0);
+        const s16 order = fields.order ? fields.order->GetValue<s16>(link).value_or(0) : s16(0);
+
+        if (type != NURB_TYPE_POLY && type != NURB_TYPE_BEZIER && type != NURB_TYPE_NURBS)
+        {
+            return MakeError(CurveError::InvalidSplineType);
+        }
+
+        const bool bezier = type == NURB_TYPE_BEZIER;
+        splines.types.push_back(bezier ? SplineType::Bezier : (type == NURB_TYPE_POLY ? SplineType::Poly : SplineType::Nurbs));
+        const auto points = bezier ? ReadBezierPoints(blend, link, fields, count, splines)
+                                   : ReadNurbPoints(blend, link, fields, count, splines);
+        if (!points)
+        {
+            return MakeError(points.error());
+        }
+
+        const bool endpoint = (flag & NURB_FLAG_ENDPOINT) != 0;
+        const bool bezier_knots = (flag & NURB_FLAG_BEZIER) != 0;
+        splines.cyclic.push_back(u8((flag & NURB_FLAG_CYCLIC) != 0));
+        splines.resolutions.push_back(u32(std::max<s16>(resolution > 0 ? resolution : default_resolution, 1)));
+        splines.orders.push_back(u8(std::clamp<s16>(order, 0, s16(MAX_NURBS_ORDER))));
+        const KnotsMode endpoint_mode = bezier_knots ? KnotsMode::EndpointBezier : KnotsMode::Endpoint;
+        splines.knots_modes.push_back(endpoint ? endpoint_mode : (bezier_knots ? KnotsMode::Bezier : KnotsMode::Normal));
+        splines.point_offsets.push_back(u32(splines.positions.size()));
+
+        link = fields.next->GetPointerData(link, nurb_size);
+    }
+
+    return splines;
+}
+
+[[nodiscard]] const CustomDataLayer* FindCurvesLayer(std::span<const CustomDataLayer> layers, CustomDataType type, std::string_view name)
+{
+    const auto layer = ranges::find_if(
+        layers,
+        [type, name](const CustomDataLayer& current) { return current.type == type && current.name == name && !current.data.empty(); }
+    );
+    return layer != layers.end() ? &*layer : nullptr;
+}
+
+template<class T>
+void CopyCurvesLayer(
+    std::span<const CustomDataLayer> layers,
+    CustomDataType type,
+    std::string_view name,
+    std::vector<T>& output,
+    usize count,
+    T fallback
+)
+{
+    output.assign(count, fallback);
+    if (const auto* layer = FindCurvesLayer(layers, type, name))
+    {
+        std::memcpy(output.data(), layer->data.data(), std::min(layer->data.size(), count * sizeof(T)));
+    }
+}
+
+Result<Splines, CurveError> cblend::ExtractCurvesSplines(const Blend& blend, const Block& curves)
+{
+    const auto curves_type = blend.GetBlockType(curves);
+    const auto geometry_field = curves_type ? curves_type->GetField("geometry") : NULL_OPTION;
+    if (!geometry_field)
+    {
+        return MakeError(CurveError::InvalidCurveType);
+    }
+
+    const BlendType& geometry_type = geometry_field->GetFieldType();
+    const MemorySpan geometry = geometry_field->GetData(curves);
+    const auto point_count = geometry_type.QueryValue<s32, "point_num">(geometry);
+    const auto curve_count = geometry_type.QueryValue<s32, "curve_num">(geometry);
+    const auto offsets_field = geometry_type.GetField("curve_offsets");
+    if (!point_count || !curve_count || *point_count < 0 || *curve_count < 0 || !offsets_field)
+    {
+        return MakeError(CurveError::InvalidCurvesGeometry);
+    }
+
+    const auto point_layers = GetCustomDataLayers(blend, geometry_type, geometry, "point_data", usize(*point_count));
+    const auto curve_layers = GetCustomDataLayers(blend, geometry_type, geometry, "curve_data", usize(*curve_count));
+    if (!point_layers || !curve_layers)
+    {
+        return MakeError(CurveError::InvalidCurvesGeometry);
+    }
+
+    Splines splines;
+    const usize spline_count = usize(*curve_count);
+    const usize total_points = usize(*point_count);
+
+    splines.point_offsets.resize(spline_count + 1);
+    const MemorySpan offsets = offsets_field->GetPointerData(geometry, (spline_count + 1) * sizeof(s32));
+    if (offsets.size() == (spline_count + 1) * sizeof(s32))
+    {
+        std::memcpy(splines.point_offsets.data(), offsets.data(), offsets.size());
+    }
+    else if (spline_count > 0)
+    {
+        return MakeError(CurveError::InvalidCurvesGeometry);
+    }
+
+    if (splines.point_offsets.front() != 0 || splines.point_offsets.back() != total_points
+        || !std::is_sorted(splines.point_offsets.begin(), splines.point_offsets.end()))
+    {
+        return MakeError(CurveError::MismatchedPointCount);
+    }
+
+    CopyCurvesLayer(*point_layers, CustomDataType::PropFloat3, "position", splines.positions, total_points, Float3{});
+    CopyCurvesLayer(*point_layers, CustomDataType::PropFloat, "radius", splines.radii, total_points, 1.F);
+
+    // Files written before positions and radii became generic attributes store them as plain arrays
+    const bool has_position_layer = FindCurvesLayer(*point_layers, CustomDataType::PropFloat3, "position") != nullptr;
+    if (const auto position = geometry_type.GetField("position"); position && !has_position_layer)
+    {
+        const MemorySpan data = position->GetPointerData(geometry, total_points * sizeof(Float3));
+        std::memcpy(splines.positions.data(), data.data(), std::min(data.size(), total_points * sizeof(Float3)));
+    }
+
+    const bool has_radius_layer = FindCurvesLayer(*point_layers, CustomDataType::PropFloat, "radius") != nullptr;
+    if (const auto radius = geometry_type.GetField("radius"); radius && !has_radius_layer)
+    {
+        const MemorySpan data = radius->GetPointerData(geometry, total_points * sizeof(f32));
+        std::memcpy(splines.radii.data(), data.data(), std::min(data.size(), total_points * sizeof(f32)));
+    }
+
+    CopyCurvesLayer(*point_layers, CustomDataType::PropFloat3, "handle_left", splines.handles_left, total_points, Float3{});
+    CopyCurvesLayer(*point_layers, CustomDataType::PropFloat3, "handle_right", splines.handles_right, total_points, Float3{});
+    CopyCurvesLayer(*point_layers, CustomDataType::PropFloat, "nurbs_weight", splines.weights, total_points, 1.F);
+
+    // Bezier curves without stored handles evaluate as straight segments
+    if (!FindCurvesLayer(*point_layers, CustomDataType::PropFloat3, "handle_left")
+        || !FindCurvesLayer(*point_layers, CustomDataType::PropFloat3, "handle_right"))
+    {
+        splines.handles_left = splines.positions;
+        splines.handles_right = splines.positions;
+    }
+
+    std::vector<s8> types;
+    std::vector<s8> orders;
+    std::vector<s8> knots_modes;
+    std::vector<s32> resolutions;
+    CopyCurvesLayer(*curve_layers, CustomDataType::PropInt8, "curve_type", types, spline_count, s8(SplineType::CatmullRom));
+    CopyCurvesLayer(*curve_layers, CustomDataType::PropBool, "cyclic", splines.cyclic, spline_count, u8(0));
+    CopyCurvesLayer(*curve_layers, CustomDataType::PropInt32, "resolution", resolutions, spline_count, DEFAULT_CURVES_RESOLUTION);
+    CopyCurvesLayer(*curve_layers, CustomDataType::PropInt8, "nurbs_order", orders, spline_count, DEFAULT_NURBS_ORDER);
+    CopyCurvesLayer(*curve_layers, CustomDataType::PropInt8, "knots_mode", knots_modes, spline_count, s8(KnotsMode::Normal));
+
+    for (usize spline = 0; spline < spline_count; ++spline)
+    {
+        if (types[spline] < 0 || types[spline] > s8(SplineType::Nurbs) || knots_modes[spline] < 0
+            || knots_modes[spline] > s8(KnotsMode::EndpointBezier))
+        {
+            return MakeError(CurveError::InvalidSplineType);
+        }
+
+        splines.types.push_back(SplineType(types[spline]));
+        splines.knots_modes.push_back(KnotsMode(knots_modes[spline]));
+        splines.orders.push_back(u8(std::clamp<s8>(orders[spline], 0, s8(MAX_NURBS_ORDER))));
+        splines.resolutions.push_back(u32(std::max(resolutions[spline], 1)));
+    }
+
+    return splines;
+}
@@ -2,11 +2,38 @@
 #include <cblend_stream.hpp>
 #include <range/v3/algorithm/find_if.hpp>
 
+#include <algorithm>
+#include <concepts>
+#include <limits>
+
 using namespace cblend;
 
 template<class T>
 concept PtrType = std::is_same_v<T, u32> || std::is_same_v<T, u64>;
 
+[[nodiscard]] Result<u16, FormatError> ReadHeaderDigits(Stream& stream, usize count, u16 value = 0U)
+{
+    for (usize index = 0; index < count; ++index)
+    {
+        u8 digit = 0U;
+
+        if (!stream.Read(digit))
+        {
+            return MakeError(FormatError::UnexpectedEndOfFile);
+        }
+
+        if (digit < '0' || digit > '9')
+        {
+            return MakeError(FormatError::InvalidFileHeader);
+        }
+
+        // NOLINTNEXTLINE(*-magic-numbers)
+        value = u16(value * 10U + u16(digit - '0'));
+    }
+
+    return value;
+}
+
 [[nodiscard]] Result<Header, FormatError> cblend::ReadHeader(Stream& stream)
 {
     Header header;
@@ -26,9 +53,43 @@ concept PtrType = std::is_same_v<T, u32> || std::is_same_v<T, u64>;
         return MakeError(FormatError::UnexpectedEndOfFile);
     }
 
-    if (header.pointer != Pointer::U32 && header.pointer != Pointer::U64)
+    // The large header starts with its own size where the legacy one stores the pointer size
+    const bool is_large = header.pointer != Pointer::U32 && header.pointer != Pointer::U64;
+
+    if (is_large)
     {
-        return MakeError(FormatError::InvalidFileHeader);
+        const auto digit = u8(header.pointer);
+
+        if (digit < '0' || digit > '9')
+        {
+            return MakeError(FormatError::InvalidFileHeader);
+        }
+
+        const auto size = ReadHeaderDigits(stream, 1, u16(digit - '0'));
+
+        if (!size)
+        {
+            return MakeError(size.error());
+        }
+
+        if (!stream.Read(header.pointer))
+        {
+            return MakeError(FormatError::UnexpectedEndOfFile);
+        }
+
+        const auto format_version = ReadHeaderDigits(stream, 2);
+
+        if (!format_version)
+        {
+            return MakeError(format_version.error());
+        }
+
+        if (*size != LARGE_HEADER_SIZE || header.pointer != Pointer::U64 || *format_version != LARGE_HEADER_FORMAT_VERSION)
+        {
+            return MakeError(FormatError::InvalidFileHeader);
+        }
+
+        header.layout = HeaderLayout::Large;
     }
 
     if (!stream.Read(header.endian))
@@ -41,60 +102,119 @@ concept PtrType = std::is_same_v<T, u32> || std::is_same_v<T, u64>;
         return MakeError(FormatError::InvalidFileHeader);
     }
 
-    if (!stream.Read(header.version))
+    const auto version = ReadHeaderDigits(stream, is_large ? 4 : 3);
+
+    if (!version)
     {
-        return MakeError(FormatError::UnexpectedEndOfFile);
+        return MakeError(version.error());
     }
 
+    header.version = *version;
     return header;
 }
 
+// BHead4 and SmallBHead8, written with the legacy header
 template<PtrType Ptr>
-[[nodiscard]] Result<BlockHeader, FormatError> ReadBlockHeader(Stream& stream)
+struct SmallBlockHeaderLayout
 {
-    BlockHeader header = {};
-
-    if (!stream.Read(header.code))
+    [[nodiscard]] static Result<BlockHeader, FormatError> Read(Stream& stream)
     {
-        return MakeError(FormatError::UnexpectedEndOfFile);
+        BlockHeader header = {};
+        u32 length = 0U;
+        Ptr address = 0U;
+
+        if (!stream.Read(header.code) || !stream.Read(length) || !stream.Read(address))
+        {
+            return MakeError(FormatError::UnexpectedEndOfFile);
+        }
+
+        header.length = u64(length);
+        header.address = u64(address);
+
+        if (!stream.Read(header.struct_index) || !stream.Read(header.count))
+        {
+            return MakeError(FormatError::UnexpectedEndOfFile);
+        }
+
+        return header;
     }
+};
 
-    if (!stream.Read(header.length))
+// LargeBHead8, written with the large header
+struct LargeBlockHeaderLayout
+{
+    [[nodiscard]] static Result<BlockHeader, FormatError> Read(Stream& stream)
     {
-        return MakeError(FormatError::UnexpectedEndOfFile);
+        BlockHeader header = {};
+        s64 length = 0;
+        s64 count = 0;
+
+        if (!stream.Read(header.code) || !stream.Read(header.struct_index) || !stream.Read(header.address))
+        {
+            return MakeError(FormatError::UnexpectedEndOfFile);
+        }
+
+        if (!stream.Read(length) || !stream.Read(count))
+        {
+            return MakeError(FormatError::UnexpectedEndOfFile);
+        }
+
+        if (length < 0 || count < 0 || u64(count) > std::numeric_limits<u32>::max())
+        {
+            return MakeError(FormatError::InvalidBlockHeader);
+        }
+
+        header.length = u64(length);
+        header.count = u32(count);
+        return header;
     }
+};
 
-    Ptr address = 0U;
+template<class T>
+concept BlockHeaderLayout = requires(Stream& stream) {
+    {
+        T::Read(stream)
+    } -> std::same_as<Result<BlockHeader, FormatError>>;
+};
 
-    if (!stream.Read(address))
+// Picks the block header layout once so the block loops are instantiated per layout without branching on it
+template<class Function>
+[[nodiscard]] auto WithBlockHeaderLayout(const Header& header, Function&& function)
+{
+    if (header.layout == HeaderLayout::Large)
     {
-        return MakeError(FormatError::UnexpectedEndOfFile);
+        return std::forward<Function>(function)(LargeBlockHeaderLayout{});
     }
 
-    header.address = u64(address);
-
-    if (!stream.Read(header.struct_index))
+    if (header.pointer == Pointer::U32)
     {
-        return MakeError(FormatError::UnexpectedEndOfFile);
+        return std::forward<Function>(function)(SmallBlockHeaderLayout<u32>{});
     }
 
-    if (!stream.Read(header.count))
+    return std::forward<Function>(function)(SmallBlockHeaderLayout<u64>{});
+}
+
+bool BlockCodeFilter::Accepts(const BlockCode& code) const
+{
+    if (code == BLOCK_CODE_DNA1 || code == BLOCK_CODE_ENDB)
     {
-        return MakeError(FormatError::UnexpectedEndOfFile);
+        return true;
     }
 
-    return header;
+    const bool is_listed = std::find(codes.begin(), codes.end(), code) != codes.end();
+    return mode == BlockFilterMode::Allow ? is_listed : !is_listed;
 }
 
-template<PtrType Ptr>
-[[nodiscard]] Result<File, FormatError> ReadFile(Stream& stream, const Header& header)
+template<BlockHeaderLayout Layout>
+[[nodiscard]] Result<File, FormatError> ReadFile(Stream& stream, const Header& header, const BlockCodeFilter& filter)
 {
     Block block;
     std::vector<Block> blocks;
+    bool is_accepted = true;
 
     while (block.header.code != BLOCK_CODE_ENDB)
     {
-        auto block_header = ReadBlockHeader<Ptr>(stream);
+        auto block_header = Layout::Read(stream);
 
         if (!block_header)
         {
@@ -102,11 +222,33 @@ template<PtrType Ptr>
         }
 
         block.header = *block_header;
+        block.offset = stream.GetPosition();
 
-        if (block.header.length != 0)
+        if (block.header.code != BLOCK_CODE_DATA)
+        {
+            is_accepted = filter.Accepts(block.header.code);
+        }
+
+        if (!is_accepted)
+        {
+            if (block.header.length != 0 && (!stream.CanRead(block.header.length) || !stream.Skip(block.header.length)))
+            {
+                return MakeError(FormatError::UnexpectedEndOfFile);
+            }
+
+            continue;
+        }
+
+        // Corrupt lengths fail on the missing bytes instead of on allocating the body
+        if (block.header.length != 0 && !stream.CanRead(block.header.length))
         {
-            block.body.resize(block.header.length, 0U);
+            return MakeError(FormatError::UnexpectedEndOfFile);
+        }
+
+        block.body.resize(block.header.length, 0U);
 
+        if (block.header.length != 0)
+        {
             if (!stream.Read(std::as_writable_bytes(std::span{ block.body })))
             {
                 return MakeError(FormatError::UnexpectedEndOfFile);
@@ -122,14 +264,234 @@ template<PtrType Ptr>
     };
 }
 
-[[nodiscard]] Result<File, FormatError> cblend::ReadFile(Stream& stream, const Header& header)
+[[nodiscard]] Result<File, FormatError> cblend::ReadFile(Stream& stream, const Header& header, const BlockCodeFilter& filter)
 {
-    if (header.pointer == Pointer::U32)
+    return WithBlockHeaderLayout(
+        header, [&]<BlockHeaderLayout Layout>(Layout /*layout*/) { return ::ReadFile<Layout>(stream, header, filter); }
+    );
+}
+
+template<BlockHeaderLayout Layout>
+[[nodiscard]] Result<File, FormatError> ReadFileHeaders(Stream& stream, const Header& header)
+{
+    std::vector<Block> blocks;
+
+    do
+    {
+        auto block_header = Layout::Read(stream);
+
+        if (!block_header)
+        {
+            return MakeError(block_header.error());
+        }
+
+        auto& block = blocks.emplace_back(Block{ .header = *block_header, .offset = stream.GetPosition() });
+
+        if (block.header.code == BLOCK_CODE_DNA1)
+        {
+            if (auto result = ReadBlockBody(stream, block); !result)
+            {
+                return MakeError(result.error());
+            }
+        }
+        else if (block.header.length != 0 && (!stream.CanRead(block.header.length) || !stream.Skip(block.header.length)))
+        {
+            return MakeError(FormatError::UnexpectedEndOfFile);
+        }
+    } while (blocks.back().header.code != BLOCK_CODE_ENDB);
+
+    return File{
+        .header = header,
+        .blocks = std::move(blocks),
+    };
+}
+
+[[nodiscard]] Result<File, FormatError> cblend::ReadFileHeaders(Stream& stream, const Header& header)
+{
+    return WithBlockHeaderLayout(
+        header, [&]<BlockHeaderLayout Layout>(Layout /*layout*/) { return ::ReadFileHeaders<Layout>(stream, header); }
+    );
+}
+
+[[nodiscard]] Result<void, FormatError> cblend::ReadBlockBody(Stream& stream, Block& block)
+{
+    if (block.body.size() == block.header.length)
+    {
+        return {};
+    }
+
+    if (!stream.Seek(block.offset) || !stream.CanRead(block.header.length))
     {
-        return ::ReadFile<u32>(stream, header);
+        block.body.clear();
+        return MakeError(FormatError::UnexpectedEndOfFile);
     }
 
-    return ::ReadFile<u64>(stream, header);
+    block.body.resize(block.header.length, 0U);
+
+    if (!stream.Read(std::as_writable_bytes(std::span{ block.body })))
+    {
+        block.body.clear();
+        return MakeError(FormatError::UnexpectedEndOfFile);
+    }
+
+    return {};
+}
+
+template<BlockHeaderLayout Layout>
+[[nodiscard]] Result<Block, FormatError> FindBlock(Stream& stream, const BlockCode& code)
+{
+    while (true)
+    {
+        auto block_header = Layout::Read(stream);
+
+        if (!block_header)
+        {
+            return MakeError(block_header.error());
+        }
+
+        Block block = { .header = *block_header, .offset = stream.GetPosition() };
+
+        if (block.header.code == code)
+        {
+            if (auto result = ReadBlockBody(stream, block); !result)
+            {
+                return MakeError(result.error());
+            }
+
+            return block;
+        }
+
+        if (block.header.code == BLOCK_CODE_ENDB)
+        {
+            return MakeError(FormatError::BlockNotFound);
+        }
+
+        if (block.header.length != 0 && (!stream.CanRead(block.header.length) || !stream.Skip(block.header.length)))
+        {
+            return MakeError(FormatError::UnexpectedEndOfFile);
+        }
+    }
+}
+
+[[nodiscard]] Result<Block, FormatError> cblend::FindBlock(Stream& stream, const Header& header, const BlockCode& code)
+{
+    return WithBlockHeaderLayout(
+        header, [&]<BlockHeaderLayout Layout>(Layout /*layout*/) { return ::FindBlock<Layout>(stream, code); }
+    );
+}
+
+template<BlockHeaderLayout Layout>
+[[nodiscard]] Result<void, FormatError> VisitFile(Stream& stream, const std::function<void(const Block&)>& visitor)
+{
+    Block block;
+
+    while (block.header.code != BLOCK_CODE_ENDB)
+    {
+        auto block_header = Layout::Read(stream);
+
+        if (!block_header)
+        {
+            return MakeError(block_header.error());
+        }
+
+        block.header = *block_header;
+        block.offset = stream.GetPosition();
+
+        if (block.header.length != 0 && !stream.CanRead(block.header.length))
+        {
+            return MakeError(FormatError::UnexpectedEndOfFile);
+        }
+
+        // Keeps the capacity, so the buffer only grows up to the largest block
+        block.body.resize(block.header.length, 0U);
+
+        if (block.header.length != 0 && !stream.Read(std::as_writable_bytes(std::span{ block.body })))
+        {
+            return MakeError(FormatError::UnexpectedEndOfFile);
+        }
+
+        visitor(block);
+    }
+
+    return {};
+}
+
+[[nodiscard]] Result<void, FormatError>
+cblend::VisitFile(Stream& stream, const Header& header, const std::function<void(const Block&)>& visitor)
+{
+    return WithBlockHeaderLayout(
+        header, [&]<BlockHeaderLayout Layout>(Layout /*layout*/) { return ::VisitFile<Layout>(stream, visitor); }
+    );
+}
+
+template<BlockHeaderLayout Layout>
+[[nodiscard]] Result<Thumbnail, FormatError> ReadThumbnail(Stream& stream)
+{
+    // Blender writes the thumbnail right after the render info, so like its loader give up on any other block
+    while (true)
+    {
+        const auto block_header = Layout::Read(stream);
+
+        if (!block_header)
+        {
+            return MakeError(block_header.error());
+        }
+
+        if (block_header->code == BLOCK_CODE_TEST)
+        {
+            break;
+        }
+
+        if (block_header->code != BLOCK_CODE_REND)
+        {
+            return MakeError(FormatError::ThumbnailNotFound);
+        }
+
+        if (!stream.Skip(block_header->length))
+        {
+            return MakeError(FormatError::UnexpectedEndOfFile);
+        }
+    }
+
+    s32 width = 0;
+    s32 height = 0;
+
+    if (!stream.Read(width) || !stream.Read(height))
+    {
+        return MakeError(FormatError::UnexpectedEndOfFile);
+    }
+
+    if (width <= 0 || height <= 0)
+    {
+        return MakeError(FormatError::InvalidThumbnail);
+    }
+
+    const usize pixels_size = usize(width) * usize(height) * 4U;
+
+    if (!stream.CanRead(pixels_size))
+    {
+        return MakeError(FormatError::UnexpectedEndOfFile);
+    }
+
+    Thumbnail thumbnail = {
+        .width = u32(width),
+        .height = u32(height),
+        .pixels = std::vector<u8>(pixels_size, 0U),
+    };
+
+    if (!stream.Read(std::as_writable_bytes(std::span{ thumbnail.pixels })))
+    {
+        return MakeError(FormatError::UnexpectedEndOfFile);
+    }
+
+    return thumbnail;
+}
+
+[[nodiscard]] Result<Thumbnail, FormatError> cblend::ReadThumbnail(Stream& stream, const Header& header)
+{
+    return WithBlockHeaderLayout(
+        header, [&]<BlockHeaderLayout Layout>(Layout /*layout*/) { return ::ReadThumbnail<Layout>(stream); }
+    );
 }
 
 [[nodiscard]] Result<std::vector<std::string_view>, FormatError> ReadSdnaStrings(MemoryStream& stream, const BlockCode& code)
@@ -277,6 +639,23 @@ template<PtrType Ptr>
     return result;
 }
 
+// FNV-1a over the DNA1 body, seeded with the pointer size and endianness that decide the layouts together with it
+[[nodiscard]] u64 HashSdnaBlock(const Header& header, MemorySpan body)
+{
+    // NOLINTBEGIN(*-magic-numbers)
+    u64 hash = 0xCBF29CE484222325U;
+    const auto hash_byte = [&hash](u8 value) { hash = (hash ^ value) * 0x100000001B3U; };
+    // NOLINTEND(*-magic-numbers)
+
+    hash_byte(u8(header.pointer));
+    hash_byte(u8(header.endian));
+    for (const u8 value : body)
+    {
+        hash_byte(value);
+    }
+    return hash;
+}
+
 Result<Sdna, FormatError> cblend::ReadSdna(const File& file)
 {
     const auto block = ranges::find_if(file.blocks, [](const auto& block) { return block.header.code == BLOCK_CODE_DNA1; });
@@ -338,5 +717,6 @@ Result<Sdna, FormatError> cblend::ReadSdna(const File& file)
         .type_names = std::move(*type_names),
         .type_lengths = std::move(*type_lengths),
         .structs = std::move(*structs),
+        .hash = HashSdnaBlock(file.header, block->body),
     };
 }
@@ -0,0 +1,93 @@
+#include <cblend_id_index.hpp>
+
+#include <algorithm>
+
+using namespace cblend;
+
+IdIndex::IdIndex(std::vector<IdEntry> entries) : m_Entries(std::move(entries))
+{
+    m_Names.reserve(m_Entries.size());
+    for (const auto& entry : m_Entries)
+    {
+        m_Names.emplace(entry.name, entry.block);
+    }
+
+    std::stable_sort(
+        m_Entries.begin(),
+        m_Entries.end(),
+        [](const IdEntry& first, const IdEntry& second) { return first.name < second.name; }
+    );
+}
+
+usize IdIndex::GetIdCount() const
+{
+    return m_Entries.size();
+}
+
+std::span<const IdEntry> IdIndex::GetIds() const
+{
+    return m_Entries;
+}
+
+std::span<const IdEntry> IdIndex::GetIds(std::string_view prefix) const
+{
+    const auto first
+        = std::partition_point(m_Entries.begin(), m_Entries.end(), [prefix](const IdEntry& entry) { return entry.name < prefix; });
+    const auto last
+        = std::partition_point(first, m_Entries.end(), [prefix](const IdEntry& entry) { return entry.name.starts_with(prefix); });
+    return { first, last };
+}
+
+Option<const Block&> IdIndex::FindId(std::string_view name) const
+{
+    if (const auto entry = m_Names.find(name); entry != m_Names.end())
+    {
+        return *entry->second;
+    }
+
+    return NULL_OPTION;
+}
+
+Result<IdIndex, IdIndexError> cblend::CreateIdIndex(const Blend& blend)
+{
+    const auto id_type = blend.GetType("ID");
+    const auto name = id_type ? id_type->GetField("name") : NULL_OPTION;
+    if (!name)
+    {
+        return MakeError(IdIndexError::InvalidIdType);
+    }
+
+    std::unordered_map<u32, bool> id_structs;
+    std::vector<IdEntry> entries;
+
+    for (const auto& block : blend.GetBlocks())
+    {
+        if (!IsIdBlock(blend, block, *id_type, id_structs) || name->GetOffset() + name->GetSize() > block.body.size())
+        {
+            continue;
+        }
+
+        entries.push_back({ .name = name->GetString(block.body), .block = &block });
+    }
+
+    return IdIndex(std::move(entries));
+}
+
+bool cblend::IsIdBlock(const Blend& blend, const Block& block, const BlendType& id_type, std::unordered_map<u32, bool>& id_structs)
+{
+    if (block.header.code == BLOCK_CODE_DATA || block.header.code == BLOCK_CODE_ENDB)
+    {
+        return false;
+    }
+
+    auto id_struct = id_structs.find(block.header.struct_index);
+    if (id_struct == id_structs.end())
+    {
+        const auto block_type = blend.GetBlockType(block);
+        const auto fields = block_type ? block_type->GetFields() : std::vector<BlendFieldInfo>();
+        const bool is_id = !fields.empty() && fields.front().GetOffset() == 0 && fields.front().GetFieldType() == id_type;
+        id_struct = id_structs.emplace(block.header.struct_index, is_id).first;
+    }
+
+    return id_struct->second;
+}
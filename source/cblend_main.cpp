@@ -0,0 +1,125 @@
+#include <cblend_id_index.hpp>
+#include <cblend_main.hpp>
+#include <cblend_parallel.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+using namespace cblend;
+
+MainDatabase::MainDatabase(std::deque<BlendType> types, std::vector<MainEntry> entries) : m_Types(std::move(types))
+{
+    for (const auto& entry : entries)
+    {
+        m_Codes.push_back(entry.block->header.code);
+    }
+
+    std::sort(m_Codes.begin(), m_Codes.end());
+    m_Codes.erase(std::unique(m_Codes.begin(), m_Codes.end()), m_Codes.end());
+
+    // Counting sort keeps the file order inside each code
+    m_Offsets.assign(m_Codes.size() + 1, 0);
+    std::vector<usize> code_indices(entries.size(), 0);
+    for (usize entry_index = 0; entry_index < entries.size(); ++entry_index)
+    {
+        const auto code = std::lower_bound(m_Codes.begin(), m_Codes.end(), entries[entry_index].block->header.code);
+        code_indices[entry_index] = usize(code - m_Codes.begin());
+        ++m_Offsets[code_indices[entry_index] + 1];
+    }
+
+    std::partial_sum(m_Offsets.begin(), m_Offsets.end(), m_Offsets.begin());
+
+    std::vector<usize> cursors(m_Offsets.begin(), m_Offsets.end() - 1);
+    m_Entries.resize(entries.size());
+    for (usize entry_index = 0; entry_index < entries.size(); ++entry_index)
+    {
+        m_Entries[cursors[code_indices[entry_index]]++] = entries[entry_index];
+    }
+}
+
+usize MainDatabase::GetIdCount() const
+{
+    return m_Entries.size();
+}
+
+std::span<const BlockCode> MainDatabase::GetCodes() const
+{
+    return m_Codes;
+}
+
+std::span<const MainEntry> MainDatabase::GetIds(const BlockCode& code) const
+{
+    const auto found = std::lower_bound(m_Codes.begin(), m_Codes.end(), code);
+    if (found == m_Codes.end() || *found != code)
+    {
+        return {};
+    }
+
+    const auto code_index = usize(found - m_Codes.begin());
+    return std::span{ m_Entries }.subspan(m_Offsets[code_index], m_Offsets[code_index + 1] - m_Offsets[code_index]);
+}
+
+struct MainCandidate
+{
+    const Block* block = nullptr;
+    std::string_view name = {};
+};
+
+Result<MainDatabase, MainDatabaseError> cblend::CreateMainDatabase(const Blend& blend)
+{
+    const auto id_type = blend.GetType("ID");
+    const auto name = id_type ? id_type->GetField("name") : NULL_OPTION;
+    if (!name)
+    {
+        return MakeError(MainDatabaseError::InvalidIdType);
+    }
+
+    static constexpr usize MIN_CHUNK_SIZE = 1024;
+    const auto blocks = blend.GetBlocks();
+    const usize chunk_count = std::min(GetWorkerCount(), std::max<usize>(blocks.size() / MIN_CHUNK_SIZE, 1U));
+    const usize chunk_size = (blocks.size() + chunk_count - 1) / chunk_count;
+    std::vector<std::vector<MainCandidate>> chunk_candidates(chunk_count);
+
+    ParallelFor(
+        chunk_count,
+        1,
+        [&](usize begin, usize end)
+        {
+            // Each chunk checks a struct once, collecting its fields for every block would dominate the scan
+            std::unordered_map<u32, bool> id_structs;
+            for (usize chunk = begin; chunk < end; ++chunk)
+            {
+                const usize last = std::min((chunk + 1) * chunk_size, blocks.size());
+                for (usize block_index = chunk * chunk_size; block_index < last; ++block_index)
+                {
+                    const auto& block = blocks[block_index];
+                    if (IsIdBlock(blend, block, *id_type, id_structs) && name->GetOffset() + name->GetSize() <= block.body.size())
+                    {
+                        chunk_candidates[chunk].push_back({ .block = &block, .name = name->GetString(block.body) });
+                    }
+                }
+            }
+        }
+    );
+
+    std::deque<BlendType> types;
+    std::unordered_map<u32, const BlendType*> struct_types;
+    std::vector<MainEntry> entries;
+    for (const auto& candidates : chunk_candidates)
+    {
+        for (const auto& [block, id_name] : candidates)
+        {
+            auto struct_type = struct_types.find(block->header.struct_index);
+            if (struct_type == struct_types.end())
+            {
+                const BlendType& type = types.emplace_back(*blend.GetBlockType(*block));
+                struct_type = struct_types.emplace(block->header.struct_index, &type).first;
+            }
+
+            entries.push_back({ .block = block, .type = struct_type->second, .name = id_name });
+        }
+    }
+
+    return MainDatabase(std::move(types), std::move(entries));
+}
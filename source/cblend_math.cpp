@@ -0,0 +1,160 @@
+#include <cblend_math.hpp>
+
+#include <algorithm>
+
+using namespace cblend;
+
+static constexpr s16 ROTATION_MODE_QUATERNION = 0;
+static constexpr s16 ROTATION_MODE_AXIS_ANGLE = -1;
+static constexpr s16 ROTATION_MODE_EULER_LAST = 6;
+
+[[nodiscard]] Float4x4 AxisRotation(usize axis, f32 angle)
+{
+    const f32 cosine = std::cos(angle);
+    const f32 sine = std::sin(angle);
+    const usize next = (axis + 1) % 3;
+    const usize last = (axis + 2) % 3;
+
+    Float4x4 result = IDENTITY_MATRIX;
+    result[next][next] = cosine;
+    result[next][last] = sine;
+    result[last][next] = -sine;
+    result[last][last] = cosine;
+    return result;
+}
+
+Option<Float4x4> cblend::Invert(const Float4x4& matrix)
+{
+    // NOLINTBEGIN(readability-identifier-length)
+    const auto& m = matrix;
+    Float4x4 r;
+
+    r[0][0] = m[1][1] * m[2][2] * m[3][3] - m[1][1] * m[2][3] * m[3][2] - m[2][1] * m[1][2] * m[3][3] + m[2][1] * m[1][3] * m[3][2]
+        + m[3][1] * m[1][2] * m[2][3] - m[3][1] * m[1][3] * m[2][2];
+    r[1][0] = -m[1][0] * m[2][2] * m[3][3] + m[1][0] * m[2][3] * m[3][2] + m[2][0] * m[1][2] * m[3][3] - m[2][0] * m[1][3] * m[3][2]
+        - m[3][0] * m[1][2] * m[2][3] + m[3][0] * m[1][3] * m[2][2];
+    r[2][0] = m[1][0] * m[2][1] * m[3][3] - m[1][0] * m[2][3] * m[3][1] - m[2][0] * m[1][1] * m[3][3] + m[2][0] * m[1][3] * m[3][1]
+        + m[3][0] * m[1][1] * m[2][3] - m[3][0] * m[1][3] * m[2][1];
+    r[3][0] = -m[1][0] * m[2][1] * m[3][2] + m[1][0] * m[2][2] * m[3][1] + m[2][0] * m[1][1] * m[3][2] - m[2][0] * m[1][2] * m[3][1]
+        - m[3][0] * m[1][1] * m[2][2] + m[3][0] * m[1][2] * m[2][1];
+    r[0][1] = -m[0][1] * m[2][2] * m[3][3] + m[0][1] * m[2][3] * m[3][2] + m[2][1] * m[0][2] * m[3][3] - m[2][1] * m[0][3] * m[3][2]
+        - m[3][1] * m[0][2] * m[2][3] + m[3][1] * m[0][3] * m[2][2];
+    r[1][1] = m[0][0] * m[2][2] * m[3][3] - m[0][0] * m[2][3] * m[3][2] - m[2][0] * m[0][2] * m[3][3] + m[2][0] * m[0][3] * m[3][2]
+        + m[3][0] * m[0][2] * m[2][3] - m[3][0] * m[0][3] * m[2][2];
+    r[2][1] = -m[0][0] * m[2][1] * m[3][3] + m[0][0] * m[2][3] * m[3][1] + m[2][0] * m[0][1] * m[3][3] - m[2][0] * m[0][3] * m[3][1]
+        - m[3][0] * m[0][1] * m[2][3] + m[3][0] * m[0][3] * m[2][1];
+    r[3][1] = m[0][0] * m[2][1] * m[3][2] - m[0][0] * m[2][2] * m[3][1] - m[2][0] * m[0][1] * m[3][2] + m[2][0] * m[0][2] * m[3][1]
+        + m[3][0] * m[0][1] * m[2][2] - m[3][0] * m[0][2] * m[2][1];
+    r[0][2] = m[0][1] * m[1][2] * m[3][3] - m[0][1] * m[1][3] * m[3][2] - m[1][1] * m[0][2] * m[3][3] + m[1][1] * m[0][3] * m[3][2]
+        + m[3][1] * m[0][2] * m[1][3] - m[3][1] * m[0][3] * m[1][2];
+    r[1][2] = -m[0][0] * m[1][2] * m[3][3] + m[0][0] * m[1][3] * m[3][2] + m[1][0] * m[0][2] * m[3][3] - m[1][0] * m[0][3] * m[3][2]
+        - m[3][0] * m[0][2] * m[1][3] + m[3][0] * m[0][3] * m[1][2];
+    r[2][2] = m[0][0] * m[1][1] * m[3][3] - m[0][0] * m[1][3] * m[3][1] - m[1][0] * m[0][1] * m[3][3] + m[1][0] * m[0][3] * m[3][1]
+        + m[3][0] * m[0][1] * m[1][3] - m[3][0] * m[0][3] * m[1][1];
+    r[3][2] = -m[0][0] * m[1][1] * m[3][2] + m[0][0] * m[1][2] * m[3][1] + m[1][0] * m[0][1] * m[3][2] - m[1][0] * m[0][2] * m[3][1]
+        - m[3][0] * m[0][1] * m[1][2] + m[3][0] * m[0][2] * m[1][1];
+    r[0][3] = -m[0][1] * m[1][2] * m[2][3] + m[0][1] * m[1][3] * m[2][2] + m[1][1] * m[0][2] * m[2][3] - m[1][1] * m[0][3] * m[2][2]
+        - m[2][1] * m[0][2] * m[1][3] + m[2][1] * m[0][3] * m[1][2];
+    r[1][3] = m[0][0] * m[1][2] * m[2][3] - m[0][0] * m[1][3] * m[2][2] - m[1][0] * m[0][2] * m[2][3] + m[1][0] * m[0][3] * m[2][2]
+        + m[2][0] * m[0][2] * m[1][3] - m[2][0] * m[0][3] * m[1][2];
+    r[2][3] = -m[0][0] * m[1][1] * m[2][3] + m[0][0] * m[1][3] * m[2][1] + m[1][0] * m[0][1] * m[2][3] - m[1][0] * m[0][3] * m[2][1]
+        - m[2][0] * m[0][1] * m[1][3] + m[2][0] * m[0][3] * m[1][1];
+    r[3][3] = m[0][0] * m[1][1] * m[2][2] - m[0][0] * m[1][2] * m[2][1] - m[1][0] * m[0][1] * m[2][2] + m[1][0] * m[0][2] * m[2][1]
+        + m[2][0] * m[0][1] * m[1][2] - m[2][0] * m[0][2] * m[1][1];
+
+    const f32 determinant = m[0][0] * r[0][0] + m[0][1] * r[1][0] + m[0][2] * r[2][0] + m[0][3] * r[3][0];
+    // NOLINTEND(readability-identifier-length)
+
+    if (determinant == 0.F || !std::isfinite(determinant))
+    {
+        return NULL_OPTION;
+    }
+
+    const auto scale = simd::Float4::Broadcast(1.F / determinant);
+    for (auto& column : r)
+    {
+        (simd::Float4::Load(column.data()) * scale).Store(column.data());
+    }
+    return r;
+}
+
+Float4x4 cblend::EulerToMatrix(const Float3& euler, RotationOrder order)
+{
+    static constexpr std::array<std::array<usize, 3>, 6> AXIS_ORDERS = {
+        std::array<usize, 3>{ 0, 1, 2 }, std::array<usize, 3>{ 0, 2, 1 }, std::array<usize, 3>{ 1, 0, 2 },
+        std::array<usize, 3>{ 1, 2, 0 }, std::array<usize, 3>{ 2, 0, 1 }, std::array<usize, 3>{ 2, 1, 0 },
+    };
+
+    // The first axis in the order is applied first, so it ends up rightmost in the product
+    const auto& axes = AXIS_ORDERS[usize(order)];
+    Float4x4 result = AxisRotation(axes[0], euler[axes[0]]);
+    result = Multiply(AxisRotation(axes[1], euler[axes[1]]), result);
+    return Multiply(AxisRotation(axes[2], euler[axes[2]]), result);
+}
+
+Float4x4 cblend::QuaternionToMatrix(const Float4& quaternion)
+{
+    const f32 length = std::sqrt(
+        quaternion[0] * quaternion[0] + quaternion[1] * quaternion[1] + quaternion[2] * quaternion[2] + quaternion[3] * quaternion[3]
+    );
+
+    if (length == 0.F)
+    {
+        return IDENTITY_MATRIX;
+    }
+
+    const f32 w = quaternion[0] / length;
+    const f32 x = quaternion[1] / length;
+    const f32 y = quaternion[2] / length;
+    const f32 z = quaternion[3] / length;
+
+    Float4x4 result = IDENTITY_MATRIX;
+    result[0] = { 1.F - 2.F * (y * y + z * z), 2.F * (x * y + w * z), 2.F * (x * z - w * y), 0.F };
+    result[1] = { 2.F * (x * y - w * z), 1.F - 2.F * (x * x + z * z), 2.F * (y * z + w * x), 0.F };
+    result[2] = { 2.F * (x * z + w * y), 2.F * (y * z - w * x), 1.F - 2.F * (x * x + y * y), 0.F };
+    return result;
+}
+
+Float4x4 cblend::AxisAngleToMatrix(const Float3& axis, f32 angle)
+{
+    const f32 length = Length(axis);
+    if (length == 0.F)
+    {
+        return IDENTITY_MATRIX;
+    }
+
+    const f32 half_angle = angle * 0.5F;
+    const f32 sine = std::sin(half_angle) / length;
+    return QuaternionToMatrix({ std::cos(half_angle), axis[0] * sine, axis[1] * sine, axis[2] * sine });
+}
+
+Float4x4 cblend::RotationToMatrix(s16 mode, const Float3& euler, const Float4& quaternion, const Float3& axis, f32 angle)
+{
+    if (mode == ROTATION_MODE_QUATERNION)
+    {
+        return QuaternionToMatrix(quaternion);
+    }
+
+    if (mode == ROTATION_MODE_AXIS_ANGLE)
+    {
+        return AxisAngleToMatrix(axis, angle);
+    }
+
+    return EulerToMatrix(euler, RotationOrder(std::clamp<s16>(mode, 1, ROTATION_MODE_EULER_LAST) - 1));
+}
+
+Float4x4 cblend::ComposeTransform(const Float3& translation, const Float4x4& rotation, const Float3& scale)
+{
+    Float4x4 result;
+    for (usize column = 0; column < 3; ++column)
+    {
+        result[column] = {
+            rotation[column][0] * scale[column],
+            rotation[column][1] * scale[column],
+            rotation[column][2] * scale[column],
+            0.F,
+        };
+    }
+    result[3] = { translation[0], translation[1], translation[2], 1.F };
+    return result;
+}
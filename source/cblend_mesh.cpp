@@ -0,0 +1,982 @@
+#include <cblend_mesh.hpp>
+#include <cblend_parallel.hpp>
+#include <cblend_simd.hpp>
+#include <range/v3/algorithm/all_of.hpp>
+#include <range/v3/algorithm/find_if.hpp>
+#include <range/v3/algorithm/sort.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <numbers>
+#include <numeric>
+
+using namespace cblend;
+
+static constexpr s64 MESH_FLAG_AUTO_SMOOTH = 1 << 5;
+static constexpr s64 EDGE_FLAG_SHARP = 1 << 9;
+static constexpr s64 FACE_FLAG_SMOOTH = 1 << 0;
+
+static constexpr usize FACE_GRAIN_SIZE = 1024;
+static constexpr usize VERTEX_GRAIN_SIZE = 1024;
+
+usize Mesh::GetVertexCount() const
+{
+    return positions.size();
+}
+
+usize Mesh::GetFaceCount() const
+{
+    return face_offsets.empty() ? 0 : face_offsets.size() - 1;
+}
+
+usize Mesh::GetCornerCount() const
+{
+    return corner_verts.size();
+}
+
+template<class T>
+[[nodiscard]] Option<s64> ReadInteger(const BlendFieldInfo& field, MemorySpan data)
+{
+    if (const auto value = field.GetValue<T>(data))
+    {
+        return s64(*value);
+    }
+    return NULL_OPTION;
+}
+
+[[nodiscard]] Option<s64> ReadInteger(const BlendFieldInfo& field, MemorySpan data)
+{
+    switch (field.GetSize())
+    {
+    case sizeof(s8): return ReadInteger<s8>(field, data);
+    case sizeof(s16): return ReadInteger<s16>(field, data);
+    case sizeof(s32): return ReadInteger<s32>(field, data);
+    case sizeof(s64): return ReadInteger<s64>(field, data);
+    default: return NULL_OPTION;
+    }
+}
+
+[[nodiscard]] Option<s64> ReadInteger(const BlendType& type, MemorySpan data, std::initializer_list<std::string_view> names)
+{
+    for (const auto& name : names)
+    {
+        if (const auto field = type.GetField(name))
+        {
+            return ReadInteger(*field, data);
+        }
+    }
+    return NULL_OPTION;
+}
+
+[[nodiscard]] Option<usize> GetLayerStride(const Blend& blend, CustomDataType type)
+{
+    const auto struct_size = [&blend](std::string_view name) -> Option<usize>
+    {
+        if (const auto struct_type = blend.GetType(name))
+        {
+            return struct_type->GetSize();
+        }
+        return NULL_OPTION;
+    };
+
+    switch (type)
+    {
+    case CustomDataType::MVert: return struct_size("MVert");
+    case CustomDataType::MEdge: return struct_size("MEdge");
+    case CustomDataType::MLoopUV: return struct_size("MLoopUV");
+    case CustomDataType::MPoly: return struct_size("MPoly");
+    case CustomDataType::MLoop: return struct_size("MLoop");
+    case CustomDataType::PropBool:
+    case CustomDataType::PropInt8: return sizeof(u8);
+    case CustomDataType::PropFloat:
+    case CustomDataType::PropInt32:
+    case CustomDataType::PropByteColor: return sizeof(u32);
+    case CustomDataType::PropFloat2:
+    case CustomDataType::PropInt32_2D: return 2 * sizeof(u32);
+    case CustomDataType::PropFloat3: return 3 * sizeof(f32);
+    case CustomDataType::PropColor: return 4 * sizeof(f32);
+    default: return NULL_OPTION;
+    }
+}
+
+[[nodiscard]] std::string_view ReadName(MemorySpan data)
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* name = reinterpret_cast<const char*>(data.data());
+    return { name, static_cast<usize>(std::find(name, name + data.size(), '\0') - name) };
+}
+
+Result<std::vector<CustomDataLayer>, MeshError> cblend::GetCustomDataLayers(
+    const Blend& blend,
+    const BlendType& owner_type,
+    MemorySpan owner_data,
+    std::string_view field_name,
+    usize element_count
+)
+{
+    const auto custom_data_field = owner_type.GetField(field_name);
+
+    if (!custom_data_field)
+    {
+        return MakeError(MeshError::InvalidCustomData);
+    }
+
+    const MemorySpan custom_data = custom_data_field->GetData(owner_data);
+    const BlendType& custom_data_type = custom_data_field->GetFieldType();
+    const auto layer_count = custom_data_type.QueryValue<s32, "totlayer">(custom_data);
+    const auto layers_field = custom_data_type.GetField("layers");
+
+    if (!layer_count || *layer_count < 0 || !layers_field)
+    {
+        return MakeError(MeshError::InvalidCustomData);
+    }
+
+    const auto layer_type = layers_field->GetFieldType().GetElementType();
+
+    if (!layer_type || !layer_type->IsStruct())
+    {
+        return MakeError(MeshError::InvalidCustomData);
+    }
+
+    const auto type_field = layer_type->GetField("type");
+    const auto name_field = layer_type->GetField("name");
+    const auto data_field = layer_type->GetField("data");
+
+    if (!type_field || !name_field || !data_field)
+    {
+        return MakeError(MeshError::InvalidCustomData);
+    }
+
+    const usize layer_size = layer_type->GetSize();
+    const MemorySpan layers = layers_field->GetPointerData(custom_data, layer_size * usize(*layer_count));
+
+    if (layers.size() != layer_size * usize(*layer_count))
+    {
+        return MakeError(MeshError::InvalidCustomData);
+    }
+
+    std::vector<CustomDataLayer> result;
+    result.reserve(usize(*layer_count));
+
+    for (usize layer_index = 0; layer_index < usize(*layer_count); ++layer_index)
+    {
+        const MemorySpan layer = layers.subspan(layer_index * layer_size, layer_size);
+        const auto type = type_field->GetValue<s32>(layer);
+
+        if (!type)
+        {
+            return MakeError(MeshError::InvalidCustomData);
+        }
+
+        CustomDataLayer& current = result.emplace_back();
+        current.type = CustomDataType(*type);
+        current.name = ReadName(name_field->GetData(layer));
+
+        if (const auto stride = GetLayerStride(blend, current.type); stride && element_count > 0)
+        {
+            current.data = data_field->GetPointerData(layer, *stride * element_count);
+        }
+    }
+
+    return result;
+}
+
+Result<std::vector<CustomDataLayer>, MeshError>
+cblend::GetCustomDataLayers(const Blend& blend, const Block& block, std::string_view field_name, usize element_count)
+{
+    const auto owner_type = blend.GetBlockType(block);
+
+    if (!owner_type)
+    {
+        return MakeError(MeshError::InvalidMeshType);
+    }
+
+    return GetCustomDataLayers(blend, *owner_type, block.body, field_name, element_count);
+}
+
+[[nodiscard]] const CustomDataLayer* FindLayer(std::span<const CustomDataLayer> layers, CustomDataType type, std::string_view name = {})
+{
+    const auto layer = ranges::find_if(
+        layers,
+        [type, name](const CustomDataLayer& current)
+        { return current.type == type && !current.data.empty() && (name.empty() || current.name == name); }
+    );
+    return layer != layers.end() ? &*layer : nullptr;
+}
+
+template<class T>
+void CopyLayer(const CustomDataLayer& layer, std::vector<T>& output, usize count)
+{
+    output.resize(count);
+    std::memcpy(output.data(), layer.data.data(), std::min(layer.data.size(), count * sizeof(T)));
+}
+
+// Visits each element of a legacy struct layer (MVert, MEdge, MLoop, MPoly) with the element's memory
+template<class F>
+bool VisitStructLayer(const Blend& blend, const CustomDataLayer& layer, std::string_view struct_name, usize count, F&& visitor)
+{
+    const auto struct_type = blend.GetType(struct_name);
+
+    if (!struct_type || layer.data.size() < struct_type->GetSize() * count)
+    {
+        return false;
+    }
+
+    const usize stride = struct_type->GetSize();
+
+    for (usize index = 0; index < count; ++index)
+    {
+        if (!visitor(*struct_type, index, layer.data.subspan(index * stride, stride)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+[[nodiscard]] bool ReadPositions(const Blend& blend, std::span<const CustomDataLayer> layers, usize count, Mesh& mesh)
+{
+    if (const auto* layer = FindLayer(layers, CustomDataType::PropFloat3, "position"))
+    {
+        CopyLayer(*layer, mesh.positions, count);
+        return true;
+    }
+
+    if (const auto* layer = FindLayer(layers, CustomDataType::MVert))
+    {
+        mesh.positions.resize(count);
+        return VisitStructLayer(
+            blend,
+            *layer,
+            "MVert",
+            count,
+            [&mesh](const BlendType& type, usize index, MemorySpan data)
+            {
+                const auto position = type.QueryValue<Float3, "co">(data);
+                mesh.positions[index] = position.value_or(Float3{});
+                return position.has_value();
+            }
+        );
+    }
+
+    return count == 0;
+}
+
+void ReadEdges(const Blend& blend, std::span<const CustomDataLayer> layers, usize count, Mesh& mesh)
+{
+    if (const auto* layer = FindLayer(layers, CustomDataType::PropInt32_2D, ".edge_verts"))
+    {
+        CopyLayer(*layer, mesh.edges, count);
+    }
+    else if (const auto* legacy_layer = FindLayer(layers, CustomDataType::MEdge))
+    {
+        mesh.edges.resize(count);
+        mesh.sharp_edges.resize(count);
+        const bool valid = VisitStructLayer(
+            blend,
+            *legacy_layer,
+            "MEdge",
+            count,
+            [&mesh](const BlendType& type, usize index, MemorySpan data)
+            {
+                const auto vertex_0 = type.QueryValue<u32, "v1">(data);
+                const auto vertex_1 = type.QueryValue<u32, "v2">(data);
+                const auto flag = type.GetField("flag");
+                mesh.edges[index] = { vertex_0.value_or(0U), vertex_1.value_or(0U) };
+                mesh.sharp_edges[index] = flag ? u8((ReadInteger(*flag, data).value_or(0) & EDGE_FLAG_SHARP) != 0) : 0U;
+                return vertex_0.has_value() && vertex_1.has_value();
+            }
+        );
+
+        if (!valid)
+        {
+            mesh.edges.clear();
+            mesh.sharp_edges.clear();
+        }
+    }
+
+    if (const auto* layer = FindLayer(layers, CustomDataType::PropBool, "sharp_edge"))
+    {
+        CopyLayer(*layer, mesh.sharp_edges, count);
+    }
+}
+
+[[nodiscard]] bool ReadCorners(const Blend& blend, std::span<const CustomDataLayer> layers, usize count, Mesh& mesh)
+{
+    if (const auto* layer = FindLayer(layers, CustomDataType::PropInt32, ".corner_vert"))
+    {
+        CopyLayer(*layer, mesh.corner_verts, count);
+
+        if (const auto* edge_layer = FindLayer(layers, CustomDataType::PropInt32, ".corner_edge"))
+        {
+            CopyLayer(*edge_layer, mesh.corner_edges, count);
+        }
+
+        return true;
+    }
+
+    if (const auto* layer = FindLayer(layers, CustomDataType::MLoop))
+    {
+        mesh.corner_verts.resize(count);
+        mesh.corner_edges.resize(count);
+        return VisitStructLayer(
+            blend,
+            *layer,
+            "MLoop",
+            count,
+            [&mesh](const BlendType& type, usize index, MemorySpan data)
+            {
+                const auto vertex = type.QueryValue<u32, "v">(data);
+                const auto edge = type.QueryValue<u32, "e">(data);
+                mesh.corner_verts[index] = vertex.value_or(0U);
+                mesh.corner_edges[index] = edge.value_or(0U);
+                return vertex.has_value() && edge.has_value();
+            }
+        );
+    }
+
+    return count == 0;
+}
+
+[[nodiscard]] bool ReadFaces(
+    const Blend& blend,
+    const BlendType& mesh_type,
+    MemorySpan mesh_data,
+    std::span<const CustomDataLayer> layers,
+    usize count,
+    Mesh& mesh
+)
+{
+    for (const auto name : { "face_offset_indices", "poly_offset_indices" })
+    {
+        if (const auto field = mesh_type.GetField(name))
+        {
+            const MemorySpan offsets = field->GetPointerData(mesh_data, (count + 1) * sizeof(u32));
+
+            if (offsets.size() == (count + 1) * sizeof(u32))
+            {
+                mesh.face_offsets.resize(count + 1);
+                std::memcpy(mesh.face_offsets.data(), offsets.data(), offsets.size());
+            }
+        }
+    }
+
+    if (mesh.face_offsets.empty())
+    {
+        if (const auto* layer = FindLayer(layers, CustomDataType::MPoly))
+        {
+            mesh.face_offsets.resize(count + 1);
+            mesh.sharp_faces.resize(count);
+            const bool valid = VisitStructLayer(
+                blend,
+                *layer,
+                "MPoly",
+                count,
+                [&mesh](const BlendType& type, usize index, MemorySpan data)
+                {
+                    const auto start = type.QueryValue<s32, "loopstart">(data);
+                    const auto size = type.QueryValue<s32, "totloop">(data);
+                    const auto flag = type.GetField("flag");
+                    mesh.face_offsets[index] = u32(start.value_or(0));
+                    mesh.face_offsets[index + 1] = u32(start.value_or(0) + size.value_or(0));
+                    mesh.sharp_faces[index] = flag ? u8((ReadInteger(*flag, data).value_or(0) & FACE_FLAG_SMOOTH) == 0) : 0U;
+                    return start.has_value() && size.has_value();
+                }
+            );
+
+            if (!valid)
+            {
+                return false;
+            }
+        }
+    }
+
+    if (const auto* layer = FindLayer(layers, CustomDataType::PropBool, "sharp_face"))
+    {
+        CopyLayer(*layer, mesh.sharp_faces, count);
+    }
+
+    if (count == 0)
+    {
+        mesh.face_offsets.assign(1, 0U);
+    }
+
+    return mesh.face_offsets.size() == count + 1;
+}
+
+void ReadAutoSmooth(const BlendType& mesh_type, MemorySpan mesh_data, Mesh& mesh)
+{
+    const auto threshold = mesh_type.QueryValue<f32, "smoothresh">(mesh_data);
+
+    // Files without the legacy auto smooth settings use sharp edges and faces as-is
+    if (!threshold)
+    {
+        return;
+    }
+
+    if ((ReadInteger(mesh_type, mesh_data, { "flag" }).value_or(0) & MESH_FLAG_AUTO_SMOOTH) != 0)
+    {
+        mesh.auto_smooth_angle = *threshold;
+    }
+    else
+    {
+        // Legacy meshes without auto smooth ignore sharp edges when shading
+        mesh.sharp_edges.clear();
+    }
+}
+
+[[nodiscard]] bool IsValidTopology(const Mesh& mesh)
+{
+    const usize vertex_count = mesh.GetVertexCount();
+    // Corner edges index the sharp edge flags even when the edges themselves were not read
+    const usize edge_count = std::max(mesh.edges.size(), mesh.sharp_edges.size());
+
+    if (!mesh.edges.empty() && !mesh.sharp_edges.empty() && mesh.sharp_edges.size() != mesh.edges.size())
+    {
+        return false;
+    }
+
+    for (usize face = 0; face < mesh.GetFaceCount(); ++face)
+    {
+        if (mesh.face_offsets[face + 1] < mesh.face_offsets[face] + 3)
+        {
+            return false;
+        }
+    }
+
+    if (mesh.face_offsets.back() != mesh.GetCornerCount())
+    {
+        return false;
+    }
+
+    if (!mesh.corner_edges.empty() && mesh.corner_edges.size() != mesh.GetCornerCount())
+    {
+        return false;
+    }
+
+    const auto vertex_in_range = [vertex_count](u32 vertex) { return vertex < vertex_count; };
+    const auto edge_in_range = [edge_count](u32 edge) { return edge < edge_count; };
+
+    return ranges::all_of(mesh.corner_verts, vertex_in_range)
+        && (edge_count == 0 || ranges::all_of(mesh.corner_edges, edge_in_range))
+        && ranges::all_of(mesh.edges, [&vertex_in_range](const auto& edge) { return ranges::all_of(edge, vertex_in_range); });
+}
+
+Result<Mesh, MeshError> cblend::ExtractMesh(const Blend& blend, const Block& block)
+{
+    const auto mesh_type = blend.GetBlockType(block);
+
+    if (block.header.code != BLOCK_CODE_ME || !mesh_type || !mesh_type->IsStruct())
+    {
+        return MakeError(MeshError::InvalidMeshType);
+    }
+
+    const MemorySpan mesh_data = block.body;
+    const auto vertex_count = ReadInteger(*mesh_type, mesh_data, { "verts_num", "totvert" });
+    const auto edge_count = ReadInteger(*mesh_type, mesh_data, { "edges_num", "totedge" });
+    const auto face_count = ReadInteger(*mesh_type, mesh_data, { "faces_num", "totpoly" });
+    const auto corner_count = ReadInteger(*mesh_type, mesh_data, { "corners_num", "totloop" });
+
+    if (!vertex_count || !edge_count || !face_count || !corner_count || *vertex_count < 0 || *edge_count < 0 || *face_count < 0
+        || *corner_count < 0)
+    {
+        return MakeError(MeshError::InvalidMeshType);
+    }
+
+    const auto vertex_layers = GetCustomDataLayers(blend, *mesh_type, mesh_data, "vdata", usize(*vertex_count));
+    const auto edge_layers = GetCustomDataLayers(blend, *mesh_type, mesh_data, "edata", usize(*edge_count));
+    const auto face_layers = GetCustomDataLayers(blend, *mesh_type, mesh_data, "pdata", usize(*face_count));
+    const auto corner_layers = GetCustomDataLayers(blend, *mesh_type, mesh_data, "ldata", usize(*corner_count));
+
+    if (!vertex_layers || !edge_layers || !face_layers || !corner_layers)
+    {
+        return MakeError(MeshError::InvalidCustomData);
+    }
+
+    Mesh mesh;
+
+    if (!ReadPositions(blend, *vertex_layers, usize(*vertex_count), mesh))
+    {
+        return MakeError(MeshError::MissingPositions);
+    }
+
+    ReadEdges(blend, *edge_layers, usize(*edge_count), mesh);
+
+    if (!ReadCorners(blend, *corner_layers, usize(*corner_count), mesh))
+    {
+        return MakeError(MeshError::MissingCorners);
+    }
+
+    if (!ReadFaces(blend, *mesh_type, mesh_data, *face_layers, usize(*face_count), mesh))
+    {
+        return MakeError(MeshError::MissingFaces);
+    }
+
+    ReadAutoSmooth(*mesh_type, mesh_data, mesh);
+
+    if (!IsValidTopology(mesh))
+    {
+        return MakeError(MeshError::InvalidTopology);
+    }
+
+    return mesh;
+}
+
+// SoA staging for up to one register width of vectors at a time
+template<usize Count>
+struct VectorBatch
+{
+    static constexpr usize WIDTH = simd::FloatN::WIDTH;
+
+    std::array<std::array<f32, WIDTH>, Count * 3> lanes = {};
+
+    void Set(usize vector, usize lane, const Float3& value)
+    {
+        lanes[vector * 3 + 0][lane] = value[0];
+        lanes[vector * 3 + 1][lane] = value[1];
+        lanes[vector * 3 + 2][lane] = value[2];
+    }
+
+    [[nodiscard]] Float3 Get(usize vector, usize lane) const
+    {
+        return { lanes[vector * 3 + 0][lane], lanes[vector * 3 + 1][lane], lanes[vector * 3 + 2][lane] };
+    }
+
+    [[nodiscard]] simd::FloatN Load(usize vector, usize axis) const { return simd::FloatN::Load(lanes[vector * 3 + axis].data()); }
+
+    void Store(usize vector, usize axis, simd::FloatN value) { value.Store(lanes[vector * 3 + axis].data()); }
+};
+
+template<usize Count>
+void CrossBatch(VectorBatch<Count>& batch, usize lhs, usize rhs, usize output)
+{
+    using simd::FloatN;
+    const FloatN lhs_x = batch.Load(lhs, 0);
+    const FloatN lhs_y = batch.Load(lhs, 1);
+    const FloatN lhs_z = batch.Load(lhs, 2);
+    const FloatN rhs_x = batch.Load(rhs, 0);
+    const FloatN rhs_y = batch.Load(rhs, 1);
+    const FloatN rhs_z = batch.Load(rhs, 2);
+    batch.Store(output, 0, lhs_y * rhs_z - lhs_z * rhs_y);
+    batch.Store(output, 1, lhs_z * rhs_x - lhs_x * rhs_z);
+    batch.Store(output, 2, lhs_x * rhs_y - lhs_y * rhs_x);
+}
+
+template<usize Count>
+void NormalizeBatch(VectorBatch<Count>& batch, usize vector)
+{
+    using simd::FloatN;
+    const FloatN x = batch.Load(vector, 0);
+    const FloatN y = batch.Load(vector, 1);
+    const FloatN z = batch.Load(vector, 2);
+    const FloatN length = FloatN::Sqrt(FloatN::MulAdd(x, x, FloatN::MulAdd(y, y, z * z)));
+    const FloatN scale = FloatN::SelectPositive(length, FloatN::Broadcast(1.F) / length, FloatN::Broadcast(0.F));
+    batch.Store(vector, 0, x * scale);
+    batch.Store(vector, 1, y * scale);
+    batch.Store(vector, 2, z * scale);
+}
+
+[[nodiscard]] Float3 ComputePolygonNormal(const Mesh& mesh, u32 first, u32 size)
+{
+    // Newell's method, robust for concave and non-planar polygons
+    Float3 normal = {};
+    Float3 previous = mesh.positions[mesh.corner_verts[first + size - 1]];
+    for (u32 corner = first; corner < first + size; ++corner)
+    {
+        const Float3& current = mesh.positions[mesh.corner_verts[corner]];
+        normal = Add(normal, Cross(previous, current));
+        previous = current;
+    }
+    return normal;
+}
+
+void ComputeFaceNormalRange(const Mesh& mesh, usize begin, usize end, std::span<Float3> face_normals)
+{
+    static constexpr usize WIDTH = simd::FloatN::WIDTH;
+    static constexpr usize EDGE_0 = 0;
+    static constexpr usize EDGE_1 = 1;
+    static constexpr usize NORMAL = 2;
+    VectorBatch<3> batch;
+
+    for (usize batch_begin = begin; batch_begin < end; batch_begin += WIDTH)
+    {
+        const usize lane_count = std::min(WIDTH, end - batch_begin);
+
+        // Triangles and quads are reduced to a cross product of two edges or diagonals
+        for (usize lane = 0; lane < WIDTH; ++lane)
+        {
+            Float3 edge_0 = {};
+            Float3 edge_1 = {};
+
+            if (lane < lane_count)
+            {
+                const u32 first = mesh.face_offsets[batch_begin + lane];
+                const u32 size = mesh.face_offsets[batch_begin + lane + 1] - first;
+                const auto position
+                    = [&mesh, first](u32 corner) -> const Float3& { return mesh.positions[mesh.corner_verts[first + corner]]; };
+
+                if (size == 3)
+                {
+                    edge_0 = Subtract(position(1), position(0));
+                    edge_1 = Subtract(position(2), position(0));
+                }
+                else if (size == 4)
+                {
+                    edge_0 = Subtract(position(2), position(0));
+                    edge_1 = Subtract(position(3), position(1));
+                }
+            }
+
+            batch.Set(EDGE_0, lane, edge_0);
+            batch.Set(EDGE_1, lane, edge_1);
+        }
+
+        CrossBatch(batch, EDGE_0, EDGE_1, NORMAL);
+
+        for (usize lane = 0; lane < lane_count; ++lane)
+        {
+            const u32 first = mesh.face_offsets[batch_begin + lane];
+            const u32 size = mesh.face_offsets[batch_begin + lane + 1] - first;
+
+            if (size > 4)
+            {
+                batch.Set(NORMAL, lane, ComputePolygonNormal(mesh, first, size));
+            }
+        }
+
+        NormalizeBatch(batch, NORMAL);
+
+        for (usize lane = 0; lane < lane_count; ++lane)
+        {
+            face_normals[batch_begin + lane] = batch.Get(NORMAL, lane);
+        }
+    }
+}
+
+std::vector<Float3> cblend::ComputeFaceNormals(const Mesh& mesh)
+{
+    std::vector<Float3> face_normals(mesh.GetFaceCount());
+    ParallelFor(
+        mesh.GetFaceCount(),
+        FACE_GRAIN_SIZE,
+        [&mesh, &face_normals](usize begin, usize end) { ComputeFaceNormalRange(mesh, begin, end, face_normals); }
+    );
+    return face_normals;
+}
+
+void ComputeCornerAngleRange(const Mesh& mesh, usize begin, usize end, std::span<f32> corner_angles)
+{
+    static constexpr usize WIDTH = simd::FloatN::WIDTH;
+    static constexpr usize PREVIOUS = 0;
+    static constexpr usize NEXT = 1;
+    VectorBatch<2> batch;
+    std::array<u32, WIDTH> corners = {};
+    std::array<f32, WIDTH> cosines = {};
+    usize lane_count = 0;
+
+    const auto flush = [&]()
+    {
+        using simd::FloatN;
+        NormalizeBatch(batch, PREVIOUS);
+        NormalizeBatch(batch, NEXT);
+        FloatN cosine = batch.Load(PREVIOUS, 0) * batch.Load(NEXT, 0);
+        cosine = FloatN::MulAdd(batch.Load(PREVIOUS, 1), batch.Load(NEXT, 1), cosine);
+        cosine = FloatN::MulAdd(batch.Load(PREVIOUS, 2), batch.Load(NEXT, 2), cosine);
+        cosine = FloatN::Max(FloatN::Min(cosine, FloatN::Broadcast(1.F)), FloatN::Broadcast(-1.F));
+        cosine.Store(cosines.data());
+
+        for (usize lane = 0; lane < lane_count; ++lane)
+        {
+            corner_angles[corners[lane]] = std::acos(cosines[lane]);
+        }
+        lane_count = 0;
+    };
+
+    for (usize face = begin; face < end; ++face)
+    {
+        const u32 first = mesh.face_offsets[face];
+        const u32 size = mesh.face_offsets[face + 1] - first;
+
+        for (u32 corner = 0; corner < size; ++corner)
+        {
+            const Float3& position = mesh.positions[mesh.corner_verts[first + corner]];
+            const Float3& previous = mesh.positions[mesh.corner_verts[first + (corner + size - 1) % size]];
+            const Float3& next = mesh.positions[mesh.corner_verts[first + (corner + 1) % size]];
+
+            batch.Set(PREVIOUS, lane_count, Subtract(previous, position));
+            batch.Set(NEXT, lane_count, Subtract(next, position));
+            corners[lane_count++] = first + corner;
+
+            if (lane_count == WIDTH)
+            {
+                flush();
+            }
+        }
+    }
+
+    if (lane_count > 0)
+    {
+        flush();
+    }
+}
+
+std::vector<f32> cblend::ComputeCornerAngles(const Mesh& mesh)
+{
+    std::vector<f32> corner_angles(mesh.GetCornerCount());
+    ParallelFor(
+        mesh.GetFaceCount(),
+        FACE_GRAIN_SIZE,
+        [&mesh, &corner_angles](usize begin, usize end) { ComputeCornerAngleRange(mesh, begin, end, corner_angles); }
+    );
+    return corner_angles;
+}
+
+struct MeshAdjacency
+{
+    std::vector<u32> corner_faces;
+    std::vector<u32> vertex_offsets;
+    std::vector<u32> vertex_corners;
+};
+
+[[nodiscard]] MeshAdjacency BuildAdjacency(const Mesh& mesh)
+{
+    MeshAdjacency adjacency;
+    adjacency.corner_faces.resize(mesh.GetCornerCount());
+
+    ParallelFor(
+        mesh.GetFaceCount(),
+        FACE_GRAIN_SIZE,
+        [&mesh, &adjacency](usize begin, usize end)
+        {
+            for (usize face = begin; face < end; ++face)
+            {
+                std::fill(
+                    adjacency.corner_faces.begin() + mesh.face_offsets[face],
+                    adjacency.corner_faces.begin() + mesh.face_offsets[face + 1],
+                    u32(face)
+                );
+            }
+        }
+    );
+
+    // Counting sort of corners by vertex, so each vertex owns a contiguous run of its corners
+    adjacency.vertex_offsets.assign(mesh.GetVertexCount() + 1, 0U);
+    for (const u32 vertex : mesh.corner_verts)
+    {
+        ++adjacency.vertex_offsets[vertex + 1];
+    }
+
+    std::partial_sum(adjacency.vertex_offsets.begin(), adjacency.vertex_offsets.end(), adjacency.vertex_offsets.begin());
+
+    std::vector<u32> cursors(adjacency.vertex_offsets.begin(), adjacency.vertex_offsets.end() - 1);
+    adjacency.vertex_corners.resize(mesh.GetCornerCount());
+    for (u32 corner = 0; corner < mesh.GetCornerCount(); ++corner)
+    {
+        adjacency.vertex_corners[cursors[mesh.corner_verts[corner]]++] = corner;
+    }
+
+    return adjacency;
+}
+
+[[nodiscard]] std::vector<Float3> ComputeVertexNormals(
+    const Mesh& mesh,
+    const MeshAdjacency& adjacency,
+    std::span<const Float3> face_normals,
+    std::span<const f32> corner_angles
+)
+{
+    std::vector<Float3> vertex_normals(mesh.GetVertexCount());
+
+    // Each vertex gathers from its own corners, so no two threads ever write the same normal
+    ParallelFor(
+        mesh.GetVertexCount(),
+        VERTEX_GRAIN_SIZE,
+        [&](usize begin, usize end)
+        {
+            for (usize vertex = begin; vertex < end; ++vertex)
+            {
+                Float3 normal = {};
+                for (u32 index = adjacency.vertex_offsets[vertex]; index < adjacency.vertex_offsets[vertex + 1]; ++index)
+                {
+                    const u32 corner = adjacency.vertex_corners[index];
+                    normal = Add(normal, Scale(face_normals[adjacency.corner_faces[corner]], corner_angles[corner]));
+                }
+
+                // Loose vertices point away from the origin, matching Blender
+                vertex_normals[vertex] = Length(normal) > 0.F ? Normalize(normal) : Normalize(mesh.positions[vertex]);
+            }
+        }
+    );
+
+    return vertex_normals;
+}
+
+std::vector<Float3> cblend::ComputeVertexNormals(const Mesh& mesh, std::span<const Float3> face_normals)
+{
+    return ::ComputeVertexNormals(mesh, BuildAdjacency(mesh), face_normals, ComputeCornerAngles(mesh));
+}
+
+struct FanEdge
+{
+    u32 vertex = 0U;
+    u32 local_corner = 0U;
+    bool outgoing = false;
+};
+
+[[nodiscard]] u32 FindFanRoot(std::vector<u32>& parents, u32 index)
+{
+    while (parents[index] != index)
+    {
+        parents[index] = parents[parents[index]];
+        index = parents[index];
+    }
+    return index;
+}
+
+[[nodiscard]] std::vector<Float3> ComputeCornerNormals(
+    const Mesh& mesh,
+    const MeshAdjacency& adjacency,
+    std::span<const Float3> face_normals,
+    std::span<const f32> corner_angles
+)
+{
+    std::vector<Float3> corner_normals(mesh.GetCornerCount());
+    const bool has_sharp_edges = !mesh.sharp_edges.empty() && !mesh.corner_edges.empty();
+    const f32 split_cosine = mesh.auto_smooth_angle ? std::cos(std::min(*mesh.auto_smooth_angle, std::numbers::pi_v<f32>)) : -1.F;
+
+    const auto is_sharp_face = [&mesh](u32 face) { return !mesh.sharp_faces.empty() && mesh.sharp_faces[face] != 0; };
+
+    ParallelFor(
+        mesh.GetVertexCount(),
+        VERTEX_GRAIN_SIZE,
+        [&](usize begin, usize end)
+        {
+            std::vector<FanEdge> fan_edges;
+            std::vector<u32> parents;
+            std::vector<Float3> sums;
+
+            for (usize vertex = begin; vertex < end; ++vertex)
+            {
+                const u32 first = adjacency.vertex_offsets[vertex];
+                const auto corners = std::span{ adjacency.vertex_corners }.subspan(first, adjacency.vertex_offsets[vertex + 1] - first);
+
+                fan_edges.clear();
+                parents.resize(corners.size());
+                sums.assign(corners.size(), Float3{});
+                std::iota(parents.begin(), parents.end(), 0U);
+
+                // Every corner touches two edges of this vertex, identified by the vertex on their other end
+                for (u32 local = 0; local < corners.size(); ++local)
+                {
+                    const u32 corner = corners[local];
+                    const u32 face = adjacency.corner_faces[corner];
+                    const u32 face_first = mesh.face_offsets[face];
+                    const u32 face_size = mesh.face_offsets[face + 1] - face_first;
+                    const u32 position = corner - face_first;
+                    const u32 next = mesh.corner_verts[face_first + (position + 1) % face_size];
+                    const u32 previous = mesh.corner_verts[face_first + (position + face_size - 1) % face_size];
+                    fan_edges.push_back({ .vertex = next, .local_corner = local, .outgoing = true });
+                    fan_edges.push_back({ .vertex = previous, .local_corner = local, .outgoing = false });
+                }
+
+                ranges::sort(fan_edges, [](const FanEdge& lhs, const FanEdge& rhs) { return lhs.vertex < rhs.vertex; });
+
+                // Corners sharing a smooth manifold edge belong to the same fan
+                for (usize index = 0; index < fan_edges.size();)
+                {
+                    usize group_end = index + 1;
+                    while (group_end < fan_edges.size() && fan_edges[group_end].vertex == fan_edges[index].vertex)
+                    {
+                        ++group_end;
+                    }
+
+                    if (group_end - index == 2 && fan_edges[index].outgoing != fan_edges[index + 1].outgoing)
+                    {
+                        const FanEdge& outgoing = fan_edges[index].outgoing ? fan_edges[index] : fan_edges[index + 1];
+                        const FanEdge& incoming = fan_edges[index].outgoing ? fan_edges[index + 1] : fan_edges[index];
+                        const u32 outgoing_corner = corners[outgoing.local_corner];
+                        const u32 outgoing_face = adjacency.corner_faces[outgoing_corner];
+                        const u32 incoming_face = adjacency.corner_faces[corners[incoming.local_corner]];
+
+                        const bool sharp = is_sharp_face(outgoing_face) || is_sharp_face(incoming_face)
+                            || (has_sharp_edges && mesh.sharp_edges[mesh.corner_edges[outgoing_corner]] != 0)
+                            || Dot(face_normals[outgoing_face], face_normals[incoming_face]) < split_cosine;
+
+                        if (!sharp)
+                        {
+                            parents[FindFanRoot(parents, outgoing.local_corner)] = FindFanRoot(parents, incoming.local_corner);
+                        }
+                    }
+
+                    index = group_end;
+                }
+
+                for (u32 local = 0; local < corners.size(); ++local)
+                {
+                    const u32 corner = corners[local];
+                    const u32 root = FindFanRoot(parents, local);
+                    sums[root] = Add(sums[root], Scale(face_normals[adjacency.corner_faces[corner]], corner_angles[corner]));
+                }
+
+                for (u32 local = 0; local < corners.size(); ++local)
+                {
+                    const u32 corner = corners[local];
+                    const Float3& face_normal = face_normals[adjacency.corner_faces[corner]];
+                    const Float3& sum = sums[FindFanRoot(parents, local)];
+                    const bool is_flat = is_sharp_face(adjacency.corner_faces[corner]) || Length(sum) <= 0.F;
+                    corner_normals[corner] = is_flat ? face_normal : Normalize(sum);
+                }
+            }
+        }
+    );
+
+    return corner_normals;
+}
+
+std::vector<Float3> cblend::ComputeCornerNormals(const Mesh& mesh, std::span<const Float3> face_normals)
+{
+    return ::ComputeCornerNormals(mesh, BuildAdjacency(mesh), face_normals, ComputeCornerAngles(mesh));
+}
+
+MeshNormals cblend::ComputeNormals(const Mesh& mesh)
+{
+    MeshNormals normals;
+    normals.face_normals = ComputeFaceNormals(mesh);
+
+    const MeshAdjacency adjacency = BuildAdjacency(mesh);
+    const std::vector<f32> corner_angles = ComputeCornerAngles(mesh);
+    normals.vertex_normals = ::ComputeVertexNormals(mesh, adjacency, normals.face_normals, corner_angles);
+    normals.corner_normals = ::ComputeCornerNormals(mesh, adjacency, normals.face_normals, corner_angles);
+
+    return normals;
+}
+
+std::vector<std::array<u32, 3>> cblend::TriangulateFaces(const Mesh& mesh)
+{
+    const usize face_count = mesh.GetFaceCount();
+    if (face_count == 0 || mesh.face_offsets.back() < 2 * face_count)
+    {
+        return {};
+    }
+
+    std::vector<std::array<u32, 3>> triangles(mesh.face_offsets.back() - 2 * face_count);
+    ParallelFor(
+        face_count,
+        FACE_GRAIN_SIZE,
+        [&mesh, &triangles](usize begin, usize end)
+        {
+            for (usize face = begin; face < end; ++face)
+            {
+                const u32 first = mesh.face_offsets[face];
+                usize triangle = first - 2 * face;
+                for (u32 corner = first + 1; corner + 1 < mesh.face_offsets[face + 1]; ++corner)
+                {
+                    triangles[triangle++] = { mesh.corner_verts[first], mesh.corner_verts[corner], mesh.corner_verts[corner + 1] };
+                }
+            }
+        }
+    );
+    return triangles;
+}
@@ -0,0 +1,385 @@
+#include <cblend_native.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <string>
+#include <utility>
+
+using namespace cblend;
+
+usize cblend::GetNativeTypeSize(NativeType type)
+{
+    switch (type)
+    {
+    case NativeType::S8:
+    case NativeType::U8:
+        return sizeof(u8);
+    case NativeType::S16:
+    case NativeType::U16:
+        return sizeof(u16);
+    case NativeType::S32:
+    case NativeType::U32:
+    case NativeType::F32:
+        return sizeof(u32);
+    case NativeType::S64:
+    case NativeType::U64:
+    case NativeType::F64:
+        return sizeof(u64);
+    }
+    return 0;
+}
+
+[[nodiscard]] Option<NativeType> GetFundamentalNativeType(std::string_view name)
+{
+    static constexpr std::array<std::pair<std::string_view, NativeType>, 16> FUNDAMENTAL_TYPES = { {
+        { "char", NativeType::S8 },
+        { "int8_t", NativeType::S8 },
+        { "uchar", NativeType::U8 },
+        { "uint8_t", NativeType::U8 },
+        { "short", NativeType::S16 },
+        { "int16_t", NativeType::S16 },
+        { "ushort", NativeType::U16 },
+        { "uint16_t", NativeType::U16 },
+        { "int", NativeType::S32 },
+        { "int32_t", NativeType::S32 },
+        { "uint32_t", NativeType::U32 },
+        { "float", NativeType::F32 },
+        { "double", NativeType::F64 },
+        { "int64_t", NativeType::S64 },
+        { "uint64_t", NativeType::U64 },
+        { "ulong", NativeType::U32 },
+    } };
+
+    // SDNA longs are always written as 4 bytes
+    if (name == "long")
+    {
+        return NativeType::S32;
+    }
+
+    const auto type
+        = std::find_if(FUNDAMENTAL_TYPES.begin(), FUNDAMENTAL_TYPES.end(), [name](const auto& entry) { return entry.first == name; });
+    if (type == FUNDAMENTAL_TYPES.end())
+    {
+        return NULL_OPTION;
+    }
+    return type->second;
+}
+
+struct SourceScalars
+{
+    NativeType type = NativeType::U8;
+    usize count = 0;
+};
+
+[[nodiscard]] BlendType GetInnermostElementType(const BlendType& type)
+{
+    if (const auto element_type = type.GetElementType(); element_type && type.IsArray())
+    {
+        return GetInnermostElementType(*element_type);
+    }
+    return type;
+}
+
+// Scalar element type and count of a field, multidimensional arrays are flattened
+[[nodiscard]] Option<SourceScalars> GetSourceScalars(const BlendFieldInfo& field)
+{
+    const BlendType type = GetInnermostElementType(field.GetFieldType());
+
+    Option<NativeType> scalar = NULL_OPTION;
+    if (type.IsPointer())
+    {
+        scalar = type.GetSize() == sizeof(u32) ? NativeType::U32 : NativeType::U64;
+    }
+    else if (type.IsPrimitive())
+    {
+        scalar = GetFundamentalNativeType(type.GetName());
+    }
+
+    if (!scalar || GetNativeTypeSize(*scalar) != type.GetSize())
+    {
+        return NULL_OPTION;
+    }
+
+    return SourceScalars{ .type = *scalar, .count = field.GetSize() / type.GetSize() };
+}
+
+void AppendCopyStep(std::vector<CopyStep>& steps, const CopyStep& step)
+{
+    if (step.count == 0)
+    {
+        return;
+    }
+
+    if (!steps.empty())
+    {
+        auto& last = steps.back();
+        const bool is_target_adjacent = last.target_offset + last.count == step.target_offset;
+        const bool is_source_adjacent = last.source_offset + last.count == step.source_offset;
+
+        if (last.operation == step.operation && step.operation == CopyOperation::Zero && is_target_adjacent)
+        {
+            last.count += step.count;
+            return;
+        }
+
+        if (last.operation == step.operation && step.operation == CopyOperation::Copy && is_target_adjacent && is_source_adjacent)
+        {
+            last.count += step.count;
+            return;
+        }
+    }
+
+    steps.push_back(step);
+}
+
+Result<CopyPlan, NativeStructError> cblend::CompileCopyPlan(const Blend& blend, const NativeStruct& native)
+{
+    const auto type = blend.GetType(native.name);
+    if (!type || !type->IsStruct())
+    {
+        return MakeError(NativeStructError::StructNotFound);
+    }
+
+    const bool is_byte_swapped = (blend.GetEndian() == Endian::Little) != (std::endian::native == std::endian::little);
+    std::vector<NativeField> fields = native.fields;
+    std::stable_sort(
+        fields.begin(), fields.end(), [](const NativeField& first, const NativeField& second) { return first.offset < second.offset; }
+    );
+
+    CopyPlan plan = { .source_size = type->GetSize(), .target_size = native.size };
+    for (const auto& native_field : fields)
+    {
+        const usize target_size = GetNativeTypeSize(native_field.type);
+        if (native_field.count == 0 || native_field.offset + native_field.count * target_size > native.size)
+        {
+            return MakeError(NativeStructError::InvalidNativeField);
+        }
+
+        const auto field = type->GetField(native_field.name);
+        const auto source = field ? GetSourceScalars(*field) : NULL_OPTION;
+        const usize count = source ? std::min(source->count, native_field.count) : 0;
+
+        if (count != 0 && source->type == native_field.type && (!is_byte_swapped || target_size == 1))
+        {
+            AppendCopyStep(
+                plan.steps,
+                {
+                    .operation = CopyOperation::Copy,
+                    .source_offset = u32(field->GetOffset()),
+                    .target_offset = u32(native_field.offset),
+                    .count = u32(count * target_size),
+                }
+            );
+        }
+        else if (count != 0)
+        {
+            AppendCopyStep(
+                plan.steps,
+                {
+                    .operation = CopyOperation::Convert,
+                    .source_type = source->type,
+                    .target_type = native_field.type,
+                    .is_byte_swapped = is_byte_swapped,
+                    .source_offset = u32(field->GetOffset()),
+                    .target_offset = u32(native_field.offset),
+                    .count = u32(count),
+                }
+            );
+        }
+
+        AppendCopyStep(
+            plan.steps,
+            {
+                .operation = CopyOperation::Zero,
+                .target_offset = u32(native_field.offset + count * target_size),
+                .count = u32((native_field.count - count) * target_size),
+            }
+        );
+    }
+
+    return plan;
+}
+
+template<class T>
+[[nodiscard]] T LoadNativeScalar(const u8* data, bool is_byte_swapped)
+{
+    std::array<u8, sizeof(T)> bytes = {};
+    std::memcpy(bytes.data(), data, sizeof(T));
+    if (is_byte_swapped)
+    {
+        std::reverse(bytes.begin(), bytes.end());
+    }
+    return std::bit_cast<T>(bytes);
+}
+
+template<class Target>
+[[nodiscard]] Target LoadNativeValue(NativeType type, const u8* data, bool is_byte_swapped)
+{
+    switch (type)
+    {
+    case NativeType::S8:
+        return Target(LoadNativeScalar<s8>(data, is_byte_swapped));
+    case NativeType::U8:
+        return Target(LoadNativeScalar<u8>(data, is_byte_swapped));
+    case NativeType::S16:
+        return Target(LoadNativeScalar<s16>(data, is_byte_swapped));
+    case NativeType::U16:
+        return Target(LoadNativeScalar<u16>(data, is_byte_swapped));
+    case NativeType::S32:
+        return Target(LoadNativeScalar<s32>(data, is_byte_swapped));
+    case NativeType::U32:
+        return Target(LoadNativeScalar<u32>(data, is_byte_swapped));
+    case NativeType::S64:
+        return Target(LoadNativeScalar<s64>(data, is_byte_swapped));
+    case NativeType::U64:
+        return Target(LoadNativeScalar<u64>(data, is_byte_swapped));
+    case NativeType::F32:
+        return Target(LoadNativeScalar<f32>(data, is_byte_swapped));
+    case NativeType::F64:
+        return Target(LoadNativeScalar<f64>(data, is_byte_swapped));
+    }
+    return Target();
+}
+
+template<class Target>
+void ConvertNativeElements(const CopyStep& step, const u8* source, u8* target)
+{
+    const usize source_size = GetNativeTypeSize(step.source_type);
+    for (usize element = 0; element < step.count; ++element)
+    {
+        const auto value = LoadNativeValue<Target>(step.source_type, source + element * source_size, step.is_byte_swapped);
+        std::memcpy(target + element * sizeof(Target), &value, sizeof(Target));
+    }
+}
+
+void ApplyCopyStep(const CopyStep& step, const u8* source, u8* target)
+{
+    source += step.source_offset;
+    target += step.target_offset;
+
+    if (step.operation == CopyOperation::Copy)
+    {
+        std::memcpy(target, source, step.count);
+        return;
+    }
+
+    if (step.operation == CopyOperation::Zero)
+    {
+        std::memset(target, 0, step.count);
+        return;
+    }
+
+    switch (step.target_type)
+    {
+    case NativeType::S8:
+        return ConvertNativeElements<s8>(step, source, target);
+    case NativeType::U8:
+        return ConvertNativeElements<u8>(step, source, target);
+    case NativeType::S16:
+        return ConvertNativeElements<s16>(step, source, target);
+    case NativeType::U16:
+        return ConvertNativeElements<u16>(step, source, target);
+    case NativeType::S32:
+        return ConvertNativeElements<s32>(step, source, target);
+    case NativeType::U32:
+        return ConvertNativeElements<u32>(step, source, target);
+    case NativeType::S64:
+        return ConvertNativeElements<s64>(step, source, target);
+    case NativeType::U64:
+        return ConvertNativeElements<u64>(step, source, target);
+    case NativeType::F32:
+        return ConvertNativeElements<f32>(step, source, target);
+    case NativeType::F64:
+        return ConvertNativeElements<f64>(step, source, target);
+    }
+}
+
+Result<void, NativeStructError> cblend::ConvertStructs(const CopyPlan& plan, MemorySpan source, std::span<u8> target)
+{
+    if (plan.source_size == 0 || plan.target_size == 0)
+    {
+        return MakeError(NativeStructError::InvalidTargetSize);
+    }
+
+    const usize count = source.size() / plan.source_size;
+    if (target.size() < count * plan.target_size)
+    {
+        return MakeError(NativeStructError::InvalidTargetSize);
+    }
+
+    // Identical layouts convert as one copy of the whole array
+    if (plan.steps.size() == 1 && plan.steps[0].operation == CopyOperation::Copy && plan.steps[0].count == plan.source_size
+        && plan.source_size == plan.target_size)
+    {
+        std::memcpy(target.data(), source.data(), count * plan.source_size);
+        return {};
+    }
+
+    for (usize index = 0; index < count; ++index)
+    {
+        const u8* source_struct = source.data() + index * plan.source_size;
+        u8* target_struct = target.data() + index * plan.target_size;
+        for (const auto& step : plan.steps)
+        {
+            ApplyCopyStep(step, source_struct, target_struct);
+        }
+    }
+
+    return {};
+}
+
+template<class T>
+void AppendKeyValue(std::string& key, const T& value)
+{
+    const auto bytes = std::bit_cast<std::array<char, sizeof(T)>>(value);
+    key.append(bytes.begin(), bytes.end());
+}
+
+// Serializes everything a plan depends on, names are null terminated to keep the encoding unambiguous
+[[nodiscard]] std::string SerializeNativeStruct(const NativeStruct& native)
+{
+    std::string key;
+    key.append(native.name).push_back('\0');
+    AppendKeyValue(key, native.size);
+    for (const auto& field : native.fields)
+    {
+        key.append(field.name).push_back('\0');
+        AppendKeyValue(key, field.offset);
+        AppendKeyValue(key, field.type);
+        AppendKeyValue(key, field.count);
+    }
+    return key;
+}
+
+usize CopyPlanCache::KeyHash::operator()(const Key& key) const
+{
+    // NOLINTNEXTLINE(*-magic-numbers)
+    return std::hash<u64>()(key.sdna_hash) ^ (std::hash<std::string>()(key.native) * 0x9E3779B97F4A7C15U);
+}
+
+Result<const CopyPlan*, NativeStructError> CopyPlanCache::GetPlan(const Blend& blend, const NativeStruct& native)
+{
+    Key key = { .sdna_hash = blend.GetSdnaHash(), .native = SerializeNativeStruct(native) };
+    const std::scoped_lock lock(m_Mutex);
+
+    if (const auto plan = m_Plans.find(key); plan != m_Plans.end())
+    {
+        return plan->second.get();
+    }
+
+    auto plan = CompileCopyPlan(blend, native);
+    if (!plan)
+    {
+        return MakeError(plan.error());
+    }
+
+    return m_Plans.emplace(std::move(key), std::make_unique<const CopyPlan>(std::move(*plan))).first->second.get();
+}
+
+usize CopyPlanCache::GetPlanCount() const
+{
+    const std::scoped_lock lock(m_Mutex);
+    return m_Plans.size();
+}
@@ -0,0 +1,349 @@
+#include <cblend_object.hpp>
+#include <cblend_parallel.hpp>
+#include <range/v3/algorithm/find.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+using namespace cblend;
+
+static constexpr usize OBJECT_GRAIN_SIZE = 256;
+static constexpr u32 UNKNOWN_DEPTH = std::numeric_limits<u32>::max();
+
+usize ObjectHierarchy::GetObjectCount() const
+{
+    return objects.size();
+}
+
+usize ObjectHierarchy::GetLevelCount() const
+{
+    return level_offsets.empty() ? 0 : level_offsets.size() - 1;
+}
+
+Option<u32> ObjectHierarchy::FindObject(std::string_view name) const
+{
+    if (const auto result = ranges::find(names, name); result != names.end())
+    {
+        return u32(result - names.begin());
+    }
+    return NULL_OPTION;
+}
+
+// Field lookups are resolved once per file, every object block shares the same SDNA struct
+struct ObjectFields
+{
+    explicit ObjectFields(const BlendType& object_type)
+        : type(object_type)
+        , id(type.GetField("id"))
+        , parent(type.GetField("parent"))
+        , parent_inverse(type.GetField("parentinv"))
+        , object_matrix(type.GetField("obmat"))
+        , location(type.GetField("loc"))
+        , delta_location(type.GetField("dloc"))
+        , rotation(type.GetField("rot"))
+        , delta_rotation(type.GetField("drot"))
+        , quaternion(type.GetField("quat"))
+        , delta_quaternion(type.GetField("dquat"))
+        , rotation_axis(type.GetField("rotAxis"))
+        , delta_rotation_axis(type.GetField("drotAxis"))
+        , rotation_angle(type.GetField("rotAngle"))
+        , delta_rotation_angle(type.GetField("drotAngle"))
+        , rotation_mode(type.GetField("rotmode"))
+        , scale(type.GetField("scale") ? type.GetField("scale") : type.GetField("size"))
+        , delta_scale(type.GetField("dscale") ? type.GetField("dscale") : type.GetField("dsize"))
+    {
+        if (id)
+        {
+            if (const auto name = id->GetFieldType().GetField("name"))
+            {
+                name_offset = id->GetOffset() + name->GetOffset();
+                name_size = name->GetSize();
+            }
+        }
+    }
+
+    BlendType type;
+    Option<BlendFieldInfo> id;
+    Option<BlendFieldInfo> parent;
+    Option<BlendFieldInfo> parent_inverse;
+    Option<BlendFieldInfo> object_matrix;
+    Option<BlendFieldInfo> location;
+    Option<BlendFieldInfo> delta_location;
+    Option<BlendFieldInfo> rotation;
+    Option<BlendFieldInfo> delta_rotation;
+    Option<BlendFieldInfo> quaternion;
+    Option<BlendFieldInfo> delta_quaternion;
+    Option<BlendFieldInfo> rotation_axis;
+    Option<BlendFieldInfo> delta_rotation_axis;
+    Option<BlendFieldInfo> rotation_angle;
+    Option<BlendFieldInfo> delta_rotation_angle;
+    Option<BlendFieldInfo> rotation_mode;
+    Option<BlendFieldInfo> scale;
+    Option<BlendFieldInfo> delta_scale;
+    usize name_offset = 0;
+    usize name_size = 0;
+};
+
+template<class T>
+[[nodiscard]] T ReadObjectValue(const Option<BlendFieldInfo>& field, const Block& block, const T& fallback)
+{
+    if (field)
+    {
+        return field->GetValue<T>(block).value_or(fallback);
+    }
+    return fallback;
+}
+
+[[nodiscard]] std::string_view ReadObjectName(const ObjectFields& fields, const Block& block)
+{
+    if (fields.name_size == 0 || fields.name_offset + fields.name_size > block.body.size())
+    {
+        return {};
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* name = reinterpret_cast<const char*>(block.body.data() + fields.name_offset);
+    const std::string_view result(name, strnlen(name, fields.name_size));
+    return result.size() > 2 ? result.substr(2) : std::string_view{};
+}
+
+[[nodiscard]] Float4x4 ReadObjectRotation(const ObjectFields& fields, const Block& block)
+{
+    static constexpr Float4 IDENTITY_QUATERNION = { 1.F, 0.F, 0.F, 0.F };
+    static constexpr Float3 DEFAULT_AXIS = { 0.F, 1.F, 0.F };
+
+    // Delta rotations share the rotation mode and are applied after the regular rotation
+    const s16 mode = ReadObjectValue<s16>(fields.rotation_mode, block, 1);
+    return Multiply(
+        RotationToMatrix(
+            mode,
+            ReadObjectValue(fields.delta_rotation, block, Float3{}),
+            ReadObjectValue(fields.delta_quaternion, block, IDENTITY_QUATERNION),
+            ReadObjectValue(fields.delta_rotation_axis, block, DEFAULT_AXIS),
+            ReadObjectValue(fields.delta_rotation_angle, block, 0.F)
+        ),
+        RotationToMatrix(
+            mode,
+            ReadObjectValue(fields.rotation, block, Float3{}),
+            ReadObjectValue(fields.quaternion, block, IDENTITY_QUATERNION),
+            ReadObjectValue(fields.rotation_axis, block, DEFAULT_AXIS),
+            ReadObjectValue(fields.rotation_angle, block, 0.F)
+        )
+    );
+}
+
+[[nodiscard]] Option<Float4x4> ReadObjectBasis(const ObjectFields& fields, const Block& block)
+{
+    const auto location = fields.location ? fields.location->GetValue<Float3>(block) : NULL_OPTION;
+    if (!location)
+    {
+        return NULL_OPTION;
+    }
+
+    const Float3 scale = ReadObjectValue(fields.scale, block, Float3{ 1.F, 1.F, 1.F });
+    const Float3 delta_scale = ReadObjectValue(fields.delta_scale, block, Float3{ 1.F, 1.F, 1.F });
+    return ComposeTransform(
+        Add(*location, ReadObjectValue(fields.delta_location, block, Float3{})),
+        ReadObjectRotation(fields, block),
+        { scale[0] * delta_scale[0], scale[1] * delta_scale[1], scale[2] * delta_scale[2] }
+    );
+}
+
+// Files without loc/rot/scale only store the evaluated matrix, so the local matrix is recovered from the parent's
+[[nodiscard]] Option<Float4x4> ReadObjectLocalMatrix(const ObjectFields& fields, const Block& block, const Block* parent)
+{
+    if (const auto basis = ReadObjectBasis(fields, block))
+    {
+        if (parent == nullptr)
+        {
+            return *basis;
+        }
+        return Multiply(ReadObjectValue(fields.parent_inverse, block, IDENTITY_MATRIX), *basis);
+    }
+
+    const auto object_matrix = fields.object_matrix ? fields.object_matrix->GetValue<Float4x4>(block) : NULL_OPTION;
+    if (!object_matrix)
+    {
+        return NULL_OPTION;
+    }
+
+    if (parent == nullptr)
+    {
+        return *object_matrix;
+    }
+
+    const auto parent_matrix = fields.object_matrix->GetValue<Float4x4>(*parent);
+    const auto parent_inverse = parent_matrix ? Invert(*parent_matrix) : NULL_OPTION;
+    return Multiply(parent_inverse.value_or(IDENTITY_MATRIX), *object_matrix);
+}
+
+[[nodiscard]] Result<std::vector<u32>, ObjectError> ComputeObjectDepths(std::span<const u32> parents)
+{
+    std::vector<u32> depths(parents.size(), UNKNOWN_DEPTH);
+    std::vector<u32> chain;
+
+    for (usize object = 0; object < parents.size(); ++object)
+    {
+        u32 current = u32(object);
+        while (current != NO_PARENT && depths[current] == UNKNOWN_DEPTH)
+        {
+            if (chain.size() >= parents.size())
+            {
+                return MakeError(ObjectError::CyclicParent);
+            }
+
+            chain.push_back(current);
+            current = parents[current];
+        }
+
+        u32 depth = current == NO_PARENT ? 0 : depths[current] + 1;
+        for (auto link = chain.rbegin(); link != chain.rend(); ++link)
+        {
+            depths[*link] = depth++;
+        }
+        chain.clear();
+    }
+
+    return depths;
+}
+
+Result<ObjectHierarchy, ObjectError> cblend::ExtractObjectHierarchy(const Blend& blend)
+{
+    std::vector<const Block*> blocks;
+    for (const auto& block : blend.GetBlocks(BLOCK_CODE_OB))
+    {
+        blocks.push_back(&block);
+    }
+
+    ObjectHierarchy hierarchy;
+    if (blocks.empty())
+    {
+        hierarchy.level_offsets = { 0 };
+        return hierarchy;
+    }
+
+    const auto object_type = blend.GetBlockType(*blocks.front());
+    if (!object_type || object_type->GetSize() > blocks.front()->body.size())
+    {
+        return MakeError(ObjectError::InvalidObjectType);
+    }
+
+    const ObjectFields fields(*object_type);
+    if (!fields.parent)
+    {
+        return MakeError(ObjectError::InvalidObjectType);
+    }
+
+    std::unordered_map<u64, u32> block_indices;
+    block_indices.reserve(blocks.size());
+    for (usize index = 0; index < blocks.size(); ++index)
+    {
+        block_indices.emplace(blocks[index]->header.address, u32(index));
+    }
+
+    std::vector<u32> block_parents(blocks.size(), NO_PARENT);
+    for (usize index = 0; index < blocks.size(); ++index)
+    {
+        if (const auto address = fields.parent->GetPointerAddress(blocks[index]->body); address && *address != 0)
+        {
+            if (const auto parent = block_indices.find(*address); parent != block_indices.end())
+            {
+                block_parents[index] = parent->second;
+            }
+        }
+    }
+
+    const auto depths = ComputeObjectDepths(block_parents);
+    if (!depths)
+    {
+        return MakeError(depths.error());
+    }
+
+    const u32 level_count = *std::max_element(depths->begin(), depths->end()) + 1;
+    hierarchy.level_offsets.assign(level_count + 1, 0);
+    for (const u32 depth : *depths)
+    {
+        ++hierarchy.level_offsets[depth + 1];
+    }
+    std::partial_sum(hierarchy.level_offsets.begin(), hierarchy.level_offsets.end(), hierarchy.level_offsets.begin());
+
+    std::vector<u32> cursors(hierarchy.level_offsets.begin(), hierarchy.level_offsets.end() - 1);
+    std::vector<u32> order(blocks.size());
+    for (usize index = 0; index < blocks.size(); ++index)
+    {
+        order[index] = cursors[(*depths)[index]]++;
+    }
+
+    const usize object_count = blocks.size();
+    hierarchy.objects.resize(object_count);
+    hierarchy.names.resize(object_count);
+    hierarchy.parents.resize(object_count);
+    hierarchy.local_matrices.resize(object_count);
+    hierarchy.world_matrices.resize(object_count);
+
+    for (usize index = 0; index < object_count; ++index)
+    {
+        hierarchy.objects[order[index]] = blocks[index];
+        hierarchy.parents[order[index]] = block_parents[index] == NO_PARENT ? NO_PARENT : order[block_parents[index]];
+    }
+
+    std::atomic<bool> missing_transform = false;
+    ParallelFor(
+        object_count,
+        OBJECT_GRAIN_SIZE,
+        [&](usize begin, usize end)
+        {
+            for (usize object = begin; object < end; ++object)
+            {
+                const Block& block = *hierarchy.objects[object];
+                const u32 parent = hierarchy.parents[object];
+                const auto local_matrix = ReadObjectLocalMatrix(fields, block, parent == NO_PARENT ? nullptr : hierarchy.objects[parent]);
+
+                if (!local_matrix)
+                {
+                    missing_transform = true;
+                    return;
+                }
+
+                hierarchy.names[object] = ReadObjectName(fields, block);
+                hierarchy.local_matrices[object] = *local_matrix;
+            }
+        }
+    );
+
+    if (missing_transform)
+    {
+        return MakeError(ObjectError::MissingTransform);
+    }
+
+    ComputeWorldMatrices(hierarchy);
+    return hierarchy;
+}
+
+void cblend::ComputeWorldMatrices(ObjectHierarchy& hierarchy)
+{
+    hierarchy.world_matrices.resize(hierarchy.local_matrices.size());
+
+    // Levels run in order, objects within a level only read their parent's already finished world matrix
+    for (usize level = 0; level < hierarchy.GetLevelCount(); ++level)
+    {
+        const usize level_begin = hierarchy.level_offsets[level];
+        ParallelFor(
+            hierarchy.level_offsets[level + 1] - level_begin,
+            OBJECT_GRAIN_SIZE,
+            [&hierarchy, level_begin](usize begin, usize end)
+            {
+                for (usize object = level_begin + begin; object < level_begin + end; ++object)
+                {
+                    const u32 parent = hierarchy.parents[object];
+                    hierarchy.world_matrices[object] = parent == NO_PARENT
+                        ? hierarchy.local_matrices[object]
+                        : Multiply(hierarchy.world_matrices[parent], hierarchy.local_matrices[object]);
+                }
+            }
+        );
+    }
+}
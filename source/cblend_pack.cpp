@@ -0,0 +1,392 @@
+#include <cblend_pack.hpp>
+#include <cblend_parallel.hpp>
+#include <cblend_simd.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+using namespace cblend;
+
+using PackLanes = std::array<f32, simd::FloatN::WIDTH>;
+
+static constexpr usize PACK_GRAIN_SIZE = 4096;
+static constexpr u32 PACK_ALIGNMENT = 4;
+static constexpr f32 UNORM8_SCALE = 255.F;
+static constexpr f32 SNORM16_SCALE = 32767.F;
+static constexpr f32 MIN_OCTAHEDRAL_LENGTH = 1e-20F;
+
+usize AttributeSource::GetElementCount() const
+{
+    if (!indices.empty())
+    {
+        return indices.size();
+    }
+
+    return stride == 0 ? 0 : data.size() / stride;
+}
+
+[[nodiscard]] usize GetSourceComponentSize(SourceFormat format)
+{
+    return format == SourceFormat::Unorm8 ? sizeof(u8) : sizeof(f32);
+}
+
+Result<AttributeSource, PackError> cblend::MakeAttributeSource(const CustomDataLayer& layer, usize element_count)
+{
+    if (element_count == 0 || layer.data.size() % element_count != 0)
+    {
+        return MakeError(PackError::InvalidSource);
+    }
+
+    AttributeSource source = { .data = layer.data, .stride = layer.data.size() / element_count };
+    switch (layer.type)
+    {
+    case CustomDataType::PropFloat: source.component_count = 1; break;
+    case CustomDataType::MLoopUV:
+    case CustomDataType::PropFloat2: source.component_count = 2; break;
+    case CustomDataType::PropFloat3: source.component_count = 3; break;
+    case CustomDataType::PropColor: source.component_count = 4; break;
+    case CustomDataType::PropByteColor:
+        source.component_count = 4;
+        source.format = SourceFormat::Unorm8;
+        break;
+    default: return MakeError(PackError::UnsupportedLayerType);
+    }
+
+    if (source.stride < source.component_count * GetSourceComponentSize(source.format))
+    {
+        return MakeError(PackError::InvalidSource);
+    }
+
+    return source;
+}
+
+[[nodiscard]] f32 ReadSourceComponent(const AttributeSource& source, usize element, u32 component)
+{
+    const usize source_element = source.indices.empty() ? element : source.indices[element];
+    const u8* address = source.data.data() + source_element * source.stride;
+
+    if (source.format == SourceFormat::Unorm8)
+    {
+        return f32(address[component]) / UNORM8_SCALE;
+    }
+
+    f32 value = 0.F;
+    std::memcpy(&value, address + usize(component) * sizeof(f32), sizeof(f32));
+    return value;
+}
+
+void LoadSourceLanes(const AttributeSource& source, usize first, usize count, u32 component, PackLanes& lanes)
+{
+    lanes.fill(0.F);
+    for (usize lane = 0; lane < count; ++lane)
+    {
+        lanes[lane] = ReadSourceComponent(source, first + lane, component);
+    }
+}
+
+AttributeBounds cblend::ComputeBounds(const AttributeSource& source)
+{
+    AttributeBounds bounds = {};
+    const usize element_count = source.GetElementCount();
+
+    if (element_count == 0)
+    {
+        return bounds;
+    }
+
+    for (u32 component = 0; component < std::min<u32>(source.component_count, 4); ++component)
+    {
+        auto minimum = simd::FloatN::Broadcast(std::numeric_limits<f32>::max());
+        auto maximum = simd::FloatN::Broadcast(std::numeric_limits<f32>::lowest());
+        PackLanes lanes = {};
+
+        for (usize first = 0; first < element_count; first += simd::FloatN::WIDTH)
+        {
+            const usize count = std::min(simd::FloatN::WIDTH, element_count - first);
+            LoadSourceLanes(source, first, count, component, lanes);
+
+            // Padding lanes repeat the first element so they cannot widen the bounds
+            std::fill(lanes.begin() + std::ptrdiff_t(count), lanes.end(), lanes[0]);
+            const auto values = simd::FloatN::Load(lanes.data());
+            minimum = simd::FloatN::Min(minimum, values);
+            maximum = simd::FloatN::Max(maximum, values);
+        }
+
+        PackLanes minimum_lanes = {};
+        PackLanes maximum_lanes = {};
+        minimum.Store(minimum_lanes.data());
+        maximum.Store(maximum_lanes.data());
+        bounds.min[component] = *std::min_element(minimum_lanes.begin(), minimum_lanes.end());
+        bounds.max[component] = *std::max_element(maximum_lanes.begin(), maximum_lanes.end());
+    }
+
+    return bounds;
+}
+
+u32 cblend::GetPackedComponentCount(PackedFormat format, u32 source_component_count)
+{
+    return format == PackedFormat::OctahedralSnorm16 ? 2 : source_component_count;
+}
+
+u32 cblend::GetPackedSize(PackedFormat format, u32 source_component_count)
+{
+    const u32 component_count = GetPackedComponentCount(format, source_component_count);
+    switch (format)
+    {
+    case PackedFormat::Float32: return component_count * u32(sizeof(f32));
+    case PackedFormat::Float16: return component_count * u32(sizeof(u16));
+    case PackedFormat::Unorm8: return component_count * u32(sizeof(u8));
+    case PackedFormat::Snorm16:
+    case PackedFormat::BoundedSnorm16:
+    case PackedFormat::OctahedralSnorm16: return component_count * u32(sizeof(s16));
+    }
+
+    return 0;
+}
+
+[[nodiscard]] u32 AlignPackedSize(u32 size)
+{
+    return (size + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+}
+
+// Lane-wise destination of one packed component for a batch of consecutive elements
+struct PackTarget
+{
+    u8* first = nullptr;
+    usize stride = 0;
+    usize count = 0;
+
+    template<class T>
+    void Write(const std::array<T, simd::FloatN::WIDTH>& lanes) const
+    {
+        for (usize lane = 0; lane < count; ++lane)
+        {
+            std::memcpy(first + lane * stride, &lanes[lane], sizeof(T));
+        }
+    }
+
+    template<class T>
+    void WriteRounded(simd::FloatN values) const
+    {
+        PackLanes rounded = {};
+        simd::FloatN::Round(values).Store(rounded.data());
+
+        std::array<T, simd::FloatN::WIDTH> converted = {};
+        std::transform(rounded.begin(), rounded.end(), converted.begin(), [](f32 value) { return T(value); });
+        Write(converted);
+    }
+};
+
+[[nodiscard]] simd::FloatN ClampSigned(simd::FloatN value)
+{
+    return simd::FloatN::Min(simd::FloatN::Max(value, simd::FloatN::Broadcast(-1.F)), simd::FloatN::Broadcast(1.F));
+}
+
+[[nodiscard]] simd::FloatN Absolute(simd::FloatN value)
+{
+    return simd::FloatN::Max(value, simd::FloatN::Broadcast(0.F) - value);
+}
+
+// +1 for non-negative lanes, -1 otherwise, so zero components fold onto the positive side
+[[nodiscard]] simd::FloatN NonZeroSign(simd::FloatN value)
+{
+    return simd::FloatN::SelectPositive(simd::FloatN::Broadcast(0.F) - value, simd::FloatN::Broadcast(-1.F), simd::FloatN::Broadcast(1.F));
+}
+
+void PackOctahedral(const AttributeSource& source, usize first, const PackTarget& target)
+{
+    PackLanes lanes = {};
+    LoadSourceLanes(source, first, target.count, 0, lanes);
+    const auto x = simd::FloatN::Load(lanes.data());
+    LoadSourceLanes(source, first, target.count, 1, lanes);
+    const auto y = simd::FloatN::Load(lanes.data());
+    LoadSourceLanes(source, first, target.count, 2, lanes);
+    const auto z = simd::FloatN::Load(lanes.data());
+
+    const auto length = simd::FloatN::Max(Absolute(x) + Absolute(y) + Absolute(z), simd::FloatN::Broadcast(MIN_OCTAHEDRAL_LENGTH));
+    const auto scale = simd::FloatN::Broadcast(1.F) / length;
+    const auto u = x * scale;
+    const auto v = y * scale;
+
+    // The lower hemisphere is folded over the diagonals of the upper one
+    const auto one = simd::FloatN::Broadcast(1.F);
+    const auto folded_u = (one - Absolute(v)) * NonZeroSign(u);
+    const auto folded_v = (one - Absolute(u)) * NonZeroSign(v);
+    const auto lower = simd::FloatN::Broadcast(0.F) - z;
+    const auto packed_u = simd::FloatN::SelectPositive(lower, folded_u, u);
+    const auto packed_v = simd::FloatN::SelectPositive(lower, folded_v, v);
+
+    const auto quantize = simd::FloatN::Broadcast(SNORM16_SCALE);
+    target.WriteRounded<s16>(ClampSigned(packed_u) * quantize);
+    PackTarget second = target;
+    second.first += sizeof(s16);
+    second.WriteRounded<s16>(ClampSigned(packed_v) * quantize);
+}
+
+void PackComponents(const PackedAttributeLayout& layout, const AttributeSource& source, usize first, const PackTarget& target)
+{
+    PackLanes lanes = {};
+    PackTarget component_target = target;
+
+    for (u32 component = 0; component < source.component_count; ++component)
+    {
+        LoadSourceLanes(source, first, target.count, component, lanes);
+        const auto values = simd::FloatN::Load(lanes.data());
+
+        switch (layout.format)
+        {
+        case PackedFormat::Float32:
+            component_target.Write(lanes);
+            component_target.first += sizeof(f32);
+            break;
+        case PackedFormat::Float16:
+        {
+            std::array<u16, simd::FloatN::WIDTH> halves = {};
+            values.StoreHalf(halves.data());
+            component_target.Write(halves);
+            component_target.first += sizeof(u16);
+            break;
+        }
+        case PackedFormat::Unorm8:
+        {
+            const auto clamped = simd::FloatN::Min(simd::FloatN::Max(values, simd::FloatN::Broadcast(0.F)), simd::FloatN::Broadcast(1.F));
+            component_target.WriteRounded<u8>(clamped * simd::FloatN::Broadcast(UNORM8_SCALE));
+            component_target.first += sizeof(u8);
+            break;
+        }
+        case PackedFormat::Snorm16:
+            component_target.WriteRounded<s16>(ClampSigned(values) * simd::FloatN::Broadcast(SNORM16_SCALE));
+            component_target.first += sizeof(s16);
+            break;
+        case PackedFormat::BoundedSnorm16:
+        {
+            const f32 center = (layout.bounds.min[component] + layout.bounds.max[component]) * 0.5F;
+            const f32 extent = (layout.bounds.max[component] - layout.bounds.min[component]) * 0.5F;
+            const f32 scale = extent > 0.F ? SNORM16_SCALE / extent : 0.F;
+            const auto normalized = (values - simd::FloatN::Broadcast(center)) * simd::FloatN::Broadcast(scale);
+            const auto limit = simd::FloatN::Broadcast(SNORM16_SCALE);
+            const auto clamped = simd::FloatN::Min(simd::FloatN::Max(normalized, simd::FloatN::Broadcast(0.F) - limit), limit);
+            component_target.WriteRounded<s16>(clamped);
+            component_target.first += sizeof(s16);
+            break;
+        }
+        case PackedFormat::OctahedralSnorm16: break;
+        }
+    }
+}
+
+[[nodiscard]] bool IsValidSource(const AttributeSource& source)
+{
+    const usize component_size = GetSourceComponentSize(source.format);
+    if (source.stride < source.component_count * component_size)
+    {
+        return false;
+    }
+
+    if (source.indices.empty())
+    {
+        return true;
+    }
+
+    // The last element only needs its components, not a full stride
+    const usize element_size = source.component_count * component_size;
+    const usize available = source.data.size() < element_size ? 0 : (source.data.size() - element_size) / source.stride + 1;
+    return std::all_of(source.indices.begin(), source.indices.end(), [available](u32 index) { return index < available; });
+}
+
+Result<PackedVertices, PackError> cblend::PackAttributes(std::span<const PackedAttribute> attributes, PackLayout layout)
+{
+    PackedVertices packed;
+    if (attributes.empty())
+    {
+        return packed;
+    }
+
+    packed.vertex_count = attributes.front().source.GetElementCount();
+    packed.attributes.reserve(attributes.size());
+
+    u32 interleaved_stride = 0;
+    for (const auto& attribute : attributes)
+    {
+        const auto& source = attribute.source;
+        if (source.component_count == 0 || source.component_count > 4
+            || (attribute.format == PackedFormat::OctahedralSnorm16 && source.component_count != 3))
+        {
+            return MakeError(PackError::InvalidComponentCount);
+        }
+
+        if (!IsValidSource(source))
+        {
+            return MakeError(PackError::InvalidSource);
+        }
+
+        if (source.GetElementCount() != packed.vertex_count)
+        {
+            return MakeError(PackError::MismatchedElementCount);
+        }
+
+        const u32 size = AlignPackedSize(GetPackedSize(attribute.format, source.component_count));
+        PackedAttributeLayout attribute_layout = {
+            .format = attribute.format,
+            .component_count = GetPackedComponentCount(attribute.format, source.component_count),
+        };
+
+        if (attribute.format == PackedFormat::BoundedSnorm16)
+        {
+            attribute_layout.bounds = attribute.bounds.has_value() ? *attribute.bounds : ComputeBounds(source);
+        }
+
+        if (layout == PackLayout::Interleaved)
+        {
+            attribute_layout.offset = interleaved_stride;
+            interleaved_stride += size;
+        }
+        else
+        {
+            attribute_layout.stream = u32(packed.streams.size());
+            packed.streams.push_back({ .data = std::vector<u8>(packed.vertex_count * size), .stride = size });
+        }
+
+        packed.attributes.push_back(attribute_layout);
+    }
+
+    if (layout == PackLayout::Interleaved)
+    {
+        packed.streams.push_back({ .data = std::vector<u8>(packed.vertex_count * interleaved_stride), .stride = interleaved_stride });
+    }
+
+    ParallelFor(
+        packed.vertex_count,
+        PACK_GRAIN_SIZE,
+        [&](usize begin, usize end)
+        {
+            for (usize index = 0; index < attributes.size(); ++index)
+            {
+                const auto& attribute_layout = packed.attributes[index];
+                auto& stream = packed.streams[attribute_layout.stream];
+
+                for (usize first = begin; first < end; first += simd::FloatN::WIDTH)
+                {
+                    const PackTarget target = {
+                        .first = stream.data.data() + first * stream.stride + attribute_layout.offset,
+                        .stride = stream.stride,
+                        .count = std::min(simd::FloatN::WIDTH, end - first),
+                    };
+
+                    if (attribute_layout.format == PackedFormat::OctahedralSnorm16)
+                    {
+                        PackOctahedral(attributes[index].source, first, target);
+                    }
+                    else
+                    {
+                        PackComponents(attribute_layout, attributes[index].source, first, target);
+                    }
+                }
+            }
+        }
+    );
+
+    return packed;
+}
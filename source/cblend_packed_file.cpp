@@ -0,0 +1,182 @@
+#include <cblend_packed_file.hpp>
+
+using namespace cblend;
+
+usize PackedFileEntry::GetSize() const
+{
+    return data.size();
+}
+
+[[nodiscard]] Option<BlendFieldInfo> GetFirstField(const BlendType& type, std::initializer_list<std::string_view> names)
+{
+    for (const auto name : names)
+    {
+        if (auto field = type.GetField(name))
+        {
+            return field;
+        }
+    }
+    return NULL_OPTION;
+}
+
+struct PackedFileSource
+{
+    const Block& owner;
+    std::string_view owner_name;
+    std::string_view file_path;
+};
+
+// Packed files whose header or payload cannot be resolved are skipped rather than failing the whole owner
+[[nodiscard]] Result<void, PackedFileError> AppendPackedFile(
+    const Blend& blend,
+    const BlendFieldInfo& packed_file_field,
+    MemorySpan container,
+    const PackedFileSource& source,
+    std::vector<PackedFileEntry>& entries
+)
+{
+    if (packed_file_field.GetPointerAddress(container).value_or(0) == 0)
+    {
+        return {};
+    }
+
+    const auto packed_file_type = blend.GetType("PackedFile");
+    const auto size_field = packed_file_type ? packed_file_type->GetField("size") : NULL_OPTION;
+    const auto data_field = packed_file_type ? packed_file_type->GetField("data") : NULL_OPTION;
+    if (!size_field || !data_field)
+    {
+        return MakeError(PackedFileError::InvalidPackedFileType);
+    }
+
+    const MemorySpan packed_file = packed_file_field.GetPointerData(container, packed_file_type->GetSize());
+    if (packed_file.empty())
+    {
+        return {};
+    }
+
+    const usize size = usize(std::max(size_field->GetValue<s32>(packed_file).value_or(0), 0));
+    const u64 address = data_field->GetPointerAddress(packed_file).value_or(0);
+    MemorySpan data;
+    u64 file_offset = 0;
+    if (size != 0)
+    {
+        const auto block = blend.GetBlockAt(address);
+        if (!block || address - block->header.address + size > block->body.size())
+        {
+            return {};
+        }
+
+        const usize offset = address - block->header.address;
+        data = MemorySpan(block->body).subspan(offset, size);
+        file_offset = block->offset + offset;
+    }
+
+    PackedFileEntry& entry = entries.emplace_back();
+    entry.owner = &source.owner;
+    entry.owner_name = source.owner_name;
+    entry.file_path = source.file_path;
+    entry.data = data;
+    entry.file_offset = file_offset;
+    return {};
+}
+
+// Images hold one packed file per view or UDIM tile since 2.80
+[[nodiscard]] Result<void, PackedFileError> AppendImagePackedFiles(
+    const Blend& blend,
+    const BlendType& owner_type,
+    const PackedFileSource& source,
+    std::vector<PackedFileEntry>& entries
+)
+{
+    const auto packed_files = owner_type.GetField("packedfiles");
+    const auto image_packed_file_type = blend.GetType("ImagePackedFile");
+    if (!packed_files || !image_packed_file_type)
+    {
+        return {};
+    }
+
+    const auto list_first = packed_files->GetFieldType().GetField("first");
+    const auto next = image_packed_file_type->GetField("next");
+    const auto packed_file = image_packed_file_type->GetField("packedfile");
+    const auto tile_path = image_packed_file_type->GetField("filepath");
+    if (!list_first || !next || !packed_file)
+    {
+        return MakeError(PackedFileError::InvalidOwnerType);
+    }
+
+    const usize link_size = image_packed_file_type->GetSize();
+    MemorySpan link = list_first->GetPointerData(packed_files->GetData(source.owner), link_size);
+    for (usize visited = 0; !link.empty() && visited < blend.GetBlockCount(); ++visited)
+    {
+        PackedFileSource tile_source = source;
+        if (tile_path)
+        {
+            tile_source.file_path = tile_path->GetString(link);
+        }
+
+        if (auto result = AppendPackedFile(blend, *packed_file, link, tile_source, entries); !result)
+        {
+            return MakeError(result.error());
+        }
+
+        link = next->GetPointerData(link, link_size);
+    }
+
+    return {};
+}
+
+Result<std::vector<PackedFileEntry>, PackedFileError> cblend::GetPackedFiles(const Blend& blend, const Block& owner)
+{
+    const auto owner_type = blend.GetBlockType(owner);
+    const auto id = owner_type ? owner_type->GetField("id") : NULL_OPTION;
+    const auto name = id ? id->GetFieldType().GetField("name") : NULL_OPTION;
+    if (!name)
+    {
+        return MakeError(PackedFileError::InvalidOwnerType);
+    }
+
+    const auto file_path = GetFirstField(*owner_type, { "filepath", "name" });
+    const PackedFileSource source = {
+        .owner = owner,
+        .owner_name = name->GetString(id->GetData(owner)),
+        .file_path = file_path ? file_path->GetString(owner.body) : std::string_view(),
+    };
+
+    std::vector<PackedFileEntry> entries;
+    if (auto result = AppendImagePackedFiles(blend, *owner_type, source, entries); !result)
+    {
+        return MakeError(result.error());
+    }
+
+    // The single packed file of sounds, fonts and older images, which newer images may still mirror into their list
+    const auto packed_file = owner_type->GetField("packedfile");
+    if (entries.empty() && packed_file)
+    {
+        if (auto result = AppendPackedFile(blend, *packed_file, owner.body, source, entries); !result)
+        {
+            return MakeError(result.error());
+        }
+    }
+
+    return entries;
+}
+
+Result<std::vector<PackedFileEntry>, PackedFileError> cblend::GetPackedFiles(const Blend& blend)
+{
+    std::vector<PackedFileEntry> entries;
+    for (const auto& code : { BLOCK_CODE_IM, BLOCK_CODE_SO, BLOCK_CODE_VF })
+    {
+        for (const auto& block : blend.GetBlocks(code))
+        {
+            auto owner_entries = GetPackedFiles(blend, block);
+            if (!owner_entries)
+            {
+                return MakeError(owner_entries.error());
+            }
+
+            entries.insert(entries.end(), owner_entries->begin(), owner_entries->end());
+        }
+    }
+
+    return entries;
+}
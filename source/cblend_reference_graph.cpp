@@ -0,0 +1,314 @@
+#include <cblend_parallel.hpp>
+#include <cblend_reference_graph.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+using namespace cblend;
+
+static constexpr u32 NO_NODE = std::numeric_limits<u32>::max();
+
+usize ReferenceGraph::GetNodeCount() const
+{
+    return nodes.size();
+}
+
+Option<u32> ReferenceGraph::FindNode(const Block& block) const
+{
+    const auto node = std::lower_bound(nodes.begin(), nodes.end(), &block, std::less<>());
+    if (node == nodes.end() || *node != &block)
+    {
+        return NULL_OPTION;
+    }
+
+    return u32(node - nodes.begin());
+}
+
+std::span<const u32> ReferenceGraph::GetReferences(u32 node) const
+{
+    return std::span{ references }.subspan(reference_offsets[node], reference_offsets[node + 1] - reference_offsets[node]);
+}
+
+std::span<const u32> ReferenceGraph::GetReferrers(u32 node) const
+{
+    return std::span{ referrers }.subspan(referrer_offsets[node], referrer_offsets[node + 1] - referrer_offsets[node]);
+}
+
+usize ReferenceGraph::GetWaveCount() const
+{
+    return wave_offsets.empty() ? 0 : wave_offsets.size() - 1;
+}
+
+std::span<const u32> ReferenceGraph::GetWave(usize wave) const
+{
+    return std::span{ order }.subspan(wave_offsets[wave], wave_offsets[wave + 1] - wave_offsets[wave]);
+}
+
+void BuildReferenceWaves(ReferenceGraph& graph)
+{
+    // Iterative Tarjan, a component is completed only after every component it references, so its wave is final
+    const auto node_count = u32(graph.nodes.size());
+    std::vector<u32> indices(node_count, NO_NODE);
+    std::vector<u32> lowlinks(node_count, 0);
+    std::vector<u32> components(node_count, NO_NODE);
+    std::vector<u32> component_waves;
+    std::vector<u8> on_stack(node_count, 0);
+    std::vector<u32> stack;
+    std::vector<std::pair<u32, u32>> frames;
+    u32 next_index = 0;
+
+    for (u32 root = 0; root < node_count; ++root)
+    {
+        if (indices[root] != NO_NODE)
+        {
+            continue;
+        }
+
+        frames.emplace_back(root, graph.reference_offsets[root]);
+        indices[root] = lowlinks[root] = next_index++;
+        stack.push_back(root);
+        on_stack[root] = 1;
+
+        while (!frames.empty())
+        {
+            const u32 node = frames.back().first;
+            if (const u32 edge = frames.back().second; edge < graph.reference_offsets[node + 1])
+            {
+                ++frames.back().second;
+                const u32 target = graph.references[edge];
+                if (indices[target] == NO_NODE)
+                {
+                    indices[target] = lowlinks[target] = next_index++;
+                    stack.push_back(target);
+                    on_stack[target] = 1;
+                    frames.emplace_back(target, graph.reference_offsets[target]);
+                }
+                else if (on_stack[target] != 0)
+                {
+                    lowlinks[node] = std::min(lowlinks[node], indices[target]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty())
+            {
+                const u32 parent = frames.back().first;
+                lowlinks[parent] = std::min(lowlinks[parent], lowlinks[node]);
+            }
+
+            if (lowlinks[node] != indices[node])
+            {
+                continue;
+            }
+
+            const auto component = u32(component_waves.size());
+            const usize component_begin = usize(std::find(stack.rbegin(), stack.rend(), node).base() - stack.begin()) - 1;
+            for (usize member = component_begin; member < stack.size(); ++member)
+            {
+                components[stack[member]] = component;
+                on_stack[stack[member]] = 0;
+            }
+
+            u32 wave = 0;
+            for (usize member = component_begin; member < stack.size(); ++member)
+            {
+                for (const u32 target : graph.GetReferences(stack[member]))
+                {
+                    if (components[target] != component)
+                    {
+                        wave = std::max(wave, component_waves[components[target]] + 1);
+                    }
+                }
+            }
+
+            component_waves.push_back(wave);
+            stack.resize(component_begin);
+        }
+    }
+
+    const u32 wave_count = component_waves.empty() ? 0 : *std::max_element(component_waves.begin(), component_waves.end()) + 1;
+    graph.wave_offsets.assign(wave_count + 1, 0);
+    for (u32 node = 0; node < node_count; ++node)
+    {
+        ++graph.wave_offsets[component_waves[components[node]] + 1];
+    }
+
+    std::partial_sum(graph.wave_offsets.begin(), graph.wave_offsets.end(), graph.wave_offsets.begin());
+
+    std::vector<u32> cursors(graph.wave_offsets.begin(), graph.wave_offsets.end() - 1);
+    graph.order.resize(node_count);
+    for (u32 node = 0; node < node_count; ++node)
+    {
+        graph.order[cursors[component_waves[components[node]]]++] = node;
+    }
+}
+
+Result<ReferenceGraph, ReferenceGraphError> cblend::BuildReferenceGraph(const Blend& blend)
+{
+    const auto id_type = blend.GetType("ID");
+    if (!id_type)
+    {
+        return MakeError(ReferenceGraphError::InvalidIdType);
+    }
+
+    const auto blocks = blend.GetBlocks();
+    if (blocks.size() >= NO_NODE)
+    {
+        return MakeError(ReferenceGraphError::TooManyNodes);
+    }
+
+    ReferenceGraph graph;
+    std::vector<u32> block_nodes(blocks.size(), NO_NODE);
+    std::unordered_map<u32, usize> struct_slots;
+    std::vector<const Block*> struct_blocks;
+
+    // Struct zero marks raw data and the REND, TEST and DNA1 blocks, none of them hold typed pointers
+    std::vector<std::pair<usize, usize>> node_ranges;
+    u32 current_node = NO_NODE;
+    for (usize block_index = 0; block_index < blocks.size() && blocks[block_index].header.code != BLOCK_CODE_ENDB; ++block_index)
+    {
+        const auto& block = blocks[block_index];
+        if (block.header.code != BLOCK_CODE_DATA)
+        {
+            current_node = NO_NODE;
+            if (block.header.struct_index != 0)
+            {
+                current_node = u32(graph.nodes.size());
+                graph.nodes.push_back(&block);
+                node_ranges.emplace_back(block_index, block_index);
+            }
+        }
+
+        if (current_node != NO_NODE)
+        {
+            block_nodes[block_index] = current_node;
+            node_ranges.back().second = block_index + 1;
+        }
+
+        if (block.header.struct_index != 0 && struct_slots.emplace(block.header.struct_index, struct_blocks.size()).second)
+        {
+            struct_blocks.push_back(&block);
+        }
+    }
+
+    std::vector<std::vector<PointerSlot>> slots(struct_blocks.size());
+    std::vector<usize> struct_sizes(struct_blocks.size(), 0);
+    ParallelFor(
+        struct_blocks.size(),
+        16,
+        [&](usize begin, usize end)
+        {
+            for (usize struct_index = begin; struct_index < end; ++struct_index)
+            {
+                if (const auto type = blend.GetBlockType(*struct_blocks[struct_index]))
+                {
+                    struct_sizes[struct_index] = type->GetSize();
+                    slots[struct_index] = GetPointerSlots(*type, *id_type);
+                }
+            }
+        }
+    );
+
+    const Pointer pointer = blend.GetPointer();
+    const usize pointer_size = pointer == Pointer::U32 ? sizeof(u32) : sizeof(u64);
+    const auto resolve = [&blend, &blocks, &block_nodes](u64 address) -> Option<usize>
+    {
+        if (address == 0)
+        {
+            return NULL_OPTION;
+        }
+
+        if (const auto target = blend.GetBlockAt(address))
+        {
+            return usize(&*target - blocks.data());
+        }
+
+        return NULL_OPTION;
+    };
+
+    std::vector<std::vector<u32>> node_references(graph.nodes.size());
+    ParallelFor(
+        graph.nodes.size(),
+        64,
+        [&](usize begin, usize end)
+        {
+            for (usize node = begin; node < end; ++node)
+            {
+                auto& targets = node_references[node];
+                const auto add_target = [&](u64 address)
+                {
+                    const auto target = resolve(address);
+                    if (target && block_nodes[*target] != NO_NODE && block_nodes[*target] != node)
+                    {
+                        targets.push_back(block_nodes[*target]);
+                    }
+                    return target;
+                };
+
+                for (usize block_index = node_ranges[node].first; block_index < node_ranges[node].second; ++block_index)
+                {
+                    const auto& block = blocks[block_index];
+                    const auto struct_slot = struct_slots.find(block.header.struct_index);
+                    if (block.header.struct_index == 0 || struct_slot == struct_slots.end() || struct_sizes[struct_slot->second] == 0)
+                    {
+                        continue;
+                    }
+
+                    const usize struct_size = struct_sizes[struct_slot->second];
+                    for (usize element = 0; (element + 1) * struct_size <= block.body.size(); ++element)
+                    {
+                        for (const auto& [offset, is_pointer_array] : slots[struct_slot->second])
+                        {
+                            const auto target = add_target(ReadPointerSlot(block.body, element * struct_size + offset, pointer));
+                            if (!is_pointer_array || !target)
+                            {
+                                continue;
+                            }
+
+                            const MemorySpan pointers = blocks[*target].body;
+                            for (usize pointer_offset = 0; pointer_offset + pointer_size <= pointers.size(); pointer_offset += pointer_size)
+                            {
+                                add_target(ReadPointerSlot(pointers, pointer_offset, pointer));
+                            }
+                        }
+                    }
+                }
+
+                std::sort(targets.begin(), targets.end());
+                targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+            }
+        }
+    );
+
+    graph.reference_offsets.assign(graph.nodes.size() + 1, 0);
+    graph.referrer_offsets.assign(graph.nodes.size() + 1, 0);
+    for (usize node = 0; node < graph.nodes.size(); ++node)
+    {
+        graph.reference_offsets[node + 1] = graph.reference_offsets[node] + u32(node_references[node].size());
+        graph.references.insert(graph.references.end(), node_references[node].begin(), node_references[node].end());
+        for (const u32 target : node_references[node])
+        {
+            ++graph.referrer_offsets[target + 1];
+        }
+    }
+
+    std::partial_sum(graph.referrer_offsets.begin(), graph.referrer_offsets.end(), graph.referrer_offsets.begin());
+
+    // Filling by ascending referrer keeps every row sorted
+    std::vector<u32> cursors(graph.referrer_offsets.begin(), graph.referrer_offsets.end() - 1);
+    graph.referrers.resize(graph.references.size());
+    for (usize node = 0; node < graph.nodes.size(); ++node)
+    {
+        for (const u32 target : node_references[node])
+        {
+            graph.referrers[cursors[target]++] = u32(node);
+        }
+    }
+
+    BuildReferenceWaves(graph);
+    return graph;
+}
@@ -1,5 +1,8 @@
 #include <cblend_reflection.hpp>
 
+#include <algorithm>
+#include <utility>
+
 using namespace cblend;
 
 bool Type::IsAggregateType() const
@@ -27,7 +30,57 @@ bool Type::IsPointerType() const
     return GetCanonicalType() == CanonicalType::Pointer;
 }
 
-TypeContainer::TypeContainer(std::unique_ptr<Type> contained) : m_Pointer(contained.get()), m_Contained(std::move(contained)) {}
+TypeArena::TypeArena(TypeArena&& other) noexcept
+    : m_Chunks(std::move(other.m_Chunks))
+    , m_Types(std::move(other.m_Types))
+    , m_Cursor(std::exchange(other.m_Cursor, nullptr))
+    , m_Remaining(std::exchange(other.m_Remaining, 0))
+{
+    other.m_Chunks.clear();
+    other.m_Types.clear();
+}
+
+TypeArena& TypeArena::operator=(TypeArena&& other) noexcept
+{
+    std::swap(m_Chunks, other.m_Chunks);
+    std::swap(m_Types, other.m_Types);
+    std::swap(m_Cursor, other.m_Cursor);
+    std::swap(m_Remaining, other.m_Remaining);
+    return *this;
+}
+
+TypeArena::~TypeArena()
+{
+    for (Type* type : m_Types)
+    {
+        type->~Type();
+    }
+}
+
+usize TypeArena::GetTypeCount() const
+{
+    return m_Types.size();
+}
+
+void* TypeArena::Allocate(usize size, usize alignment)
+{
+    void* memory = m_Cursor;
+    if (m_Cursor == nullptr || std::align(alignment, size, memory, m_Remaining) == nullptr)
+    {
+        // Chunks come from operator new, which is aligned for any type
+        const usize chunk_size = std::max(size, CHUNK_SIZE);
+        // NOLINTNEXTLINE(*-avoid-c-arrays)
+        m_Chunks.push_back(std::make_unique_for_overwrite<std::byte[]>(chunk_size));
+        memory = m_Chunks.back().get();
+        m_Remaining = chunk_size;
+    }
+
+    m_Cursor = static_cast<std::byte*>(memory) + size;
+    m_Remaining -= size;
+    return memory;
+}
+
+TypeContainer::TypeContainer(const Type& contained) : m_Pointer(&contained) {}
 
 const Type* const* TypeContainer::operator&() const
 {
@@ -156,3 +209,59 @@ CanonicalType PointerType::GetCanonicalType() const
 {
     return CanonicalType::Pointer;
 }
+
+Option<const FieldDescriptor&> TypeDescriptorTable::FindField(const TypeDescriptor& type, std::string_view name) const
+{
+    if (type.field_count == 0)
+    {
+        return NULL_OPTION;
+    }
+
+    const u64 hash = HashFieldName(name);
+    const u16 seed = lookup_seeds[type.lookup_seed_begin + GetFieldLookupBucket(hash, type.lookup_bucket_mask)];
+    const u32 field_index = lookup_slots[type.lookup_slot_begin + GetFieldLookupSlot(hash, seed, type.lookup_slot_mask)];
+    if (field_index == INVALID_FIELD_INDEX)
+    {
+        return NULL_OPTION;
+    }
+
+    const FieldDescriptor& field = fields[field_index];
+    if (field.name.data() != name.data() && field.name != name)
+    {
+        return NULL_OPTION;
+    }
+
+    return field;
+}
+
+// NOLINTBEGIN(*-magic-numbers)
+[[nodiscard]] u64 MixFieldHash(u64 value)
+{
+    value ^= value >> 33U;
+    value *= 0xFF51AFD7ED558CCDU;
+    value ^= value >> 33U;
+    value *= 0xC4CEB9FE1A85EC53U;
+    value ^= value >> 33U;
+    return value;
+}
+
+u64 cblend::HashFieldName(std::string_view name)
+{
+    u64 hash = 0xCBF29CE484222325U;
+    for (const char chr : name)
+    {
+        hash = (hash ^ u8(chr)) * 0x100000001B3U;
+    }
+    return MixFieldHash(hash);
+}
+
+u32 cblend::GetFieldLookupBucket(u64 hash, u32 bucket_mask)
+{
+    return u32(hash >> 32U) & bucket_mask;
+}
+
+u32 cblend::GetFieldLookupSlot(u64 hash, u16 seed, u32 slot_mask)
+{
+    return u32(MixFieldHash(hash ^ (u64(seed) * 0x9E3779B97F4A7C15U))) & slot_mask;
+}
+// NOLINTEND(*-magic-numbers)
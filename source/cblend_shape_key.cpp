@@ -0,0 +1,247 @@
+#include <cblend_parallel.hpp>
+#include <cblend_shape_key.hpp>
+#include <cblend_simd.hpp>
+#include <range/v3/algorithm/find.hpp>
+#include <range/v3/algorithm/find_if.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+using namespace cblend;
+
+static constexpr usize ELEMENT_SIZE = sizeof(Float3);
+
+usize ShapeKeys::GetKeyCount() const
+{
+    return names.size();
+}
+
+usize ShapeKeys::GetVertexCount() const
+{
+    return basis.size();
+}
+
+Option<u32> ShapeKeys::FindKey(std::string_view name) const
+{
+    if (const auto result = ranges::find(names, name); result != names.end())
+    {
+        return u32(result - names.begin());
+    }
+    return NULL_OPTION;
+}
+
+Option<const Block&> cblend::GetShapeKey(const Blend& blend, const Block& owner)
+{
+    const auto owner_type = blend.GetBlockType(owner);
+    if (!owner_type)
+    {
+        return NULL_OPTION;
+    }
+
+    const auto key_field = owner_type->GetField("key");
+    const auto address = key_field ? key_field->GetPointerAddress(owner.body) : NULL_OPTION;
+    if (!address || *address == 0)
+    {
+        return NULL_OPTION;
+    }
+
+    for (const auto& block : blend.GetBlocks(BLOCK_CODE_KE))
+    {
+        if (block.header.address == *address)
+        {
+            return block;
+        }
+    }
+    return NULL_OPTION;
+}
+
+void cblend::EncodeShapeKeyDeltas(
+    std::span<const Float3> reference,
+    std::span<const Float3> positions,
+    f32 threshold,
+    std::vector<u32>& indices,
+    std::vector<Float3>& deltas
+)
+{
+    static constexpr usize WIDTH = simd::FloatN::WIDTH;
+
+    const usize count = std::min(reference.size(), positions.size());
+    const f32 threshold_squared = threshold * threshold;
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* reference_data = reinterpret_cast<const f32*>(reference.data());
+    const auto* position_data = reinterpret_cast<const f32*>(positions.data());
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+    const auto emit = [&indices, &deltas, threshold_squared](usize vertex, const Float3& delta)
+    {
+        if (Dot(delta, delta) > threshold_squared)
+        {
+            indices.push_back(u32(vertex));
+            deltas.push_back(delta);
+        }
+    };
+
+    // WIDTH vertices span exactly three registers of interleaved components
+    std::array<f32, WIDTH * 3> staging = {};
+    usize vertex = 0;
+    for (; vertex + WIDTH <= count; vertex += WIDTH)
+    {
+        for (usize part = 0; part < 3; ++part)
+        {
+            const usize offset = vertex * 3 + part * WIDTH;
+            const auto delta = simd::FloatN::Load(position_data + offset) - simd::FloatN::Load(reference_data + offset);
+            delta.Store(staging.data() + part * WIDTH);
+        }
+
+        for (usize lane = 0; lane < WIDTH; ++lane)
+        {
+            emit(vertex + lane, { staging[lane * 3 + 0], staging[lane * 3 + 1], staging[lane * 3 + 2] });
+        }
+    }
+
+    for (; vertex < count; ++vertex)
+    {
+        emit(vertex, Subtract(positions[vertex], reference[vertex]));
+    }
+}
+
+struct KeyBlockData
+{
+    u64 address = 0;
+    std::string_view name = {};
+    f32 value = 0.F;
+    s16 relative = 0;
+    std::span<const Float3> positions = {};
+};
+
+Result<ShapeKeys, ShapeKeyError> cblend::ExtractShapeKeys(const Blend& blend, const Block& key, f32 threshold)
+{
+    const auto key_type = blend.GetBlockType(key);
+    const auto key_block_type = blend.GetType("KeyBlock");
+    if (!key_type || !key_block_type)
+    {
+        return MakeError(ShapeKeyError::InvalidKeyType);
+    }
+
+    const auto block_list = key_type->GetField("block");
+    const auto reference_key = key_type->GetField("refkey");
+    const auto element_size = key_type->GetField("elemsize");
+    if (!block_list || !reference_key)
+    {
+        return MakeError(ShapeKeyError::InvalidKeyType);
+    }
+
+    if (element_size && element_size->GetValue<s32>(key).value_or(0) != s32(ELEMENT_SIZE))
+    {
+        return MakeError(ShapeKeyError::InvalidElementSize);
+    }
+
+    const auto list_first = block_list->GetFieldType().GetField("first");
+    const auto next = key_block_type->GetField("next");
+    const auto name = key_block_type->GetField("name");
+    const auto value = key_block_type->GetField("curval");
+    const auto relative = key_block_type->GetField("relative");
+    const auto element_count = key_block_type->GetField("totelem");
+    const auto data = key_block_type->GetField("data");
+    if (!list_first || !next || !name || !element_count || !data)
+    {
+        return MakeError(ShapeKeyError::InvalidKeyBlockType);
+    }
+
+    const usize key_block_size = key_block_type->GetSize();
+    std::vector<KeyBlockData> key_blocks;
+    MemorySpan link = list_first->GetPointerData(block_list->GetData(key), key_block_size);
+    u64 address = list_first->GetPointerAddress(block_list->GetData(key)).value_or(0);
+
+    while (!link.empty())
+    {
+        if (key_blocks.size() >= blend.GetBlockCount())
+        {
+            return MakeError(ShapeKeyError::InvalidKeyBlockList);
+        }
+
+        const usize count = usize(std::max(element_count->GetValue<s32>(link).value_or(0), 0));
+        const auto positions = data->GetPointerData(link, count * ELEMENT_SIZE);
+        if (positions.size() != count * ELEMENT_SIZE)
+        {
+            return MakeError(ShapeKeyError::MismatchedElementCount);
+        }
+
+        const auto name_data = name->GetData(link);
+        // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+        const auto* name_chars = reinterpret_cast<const char*>(name_data.data());
+        key_blocks.push_back({
+            .address = address,
+            .name = std::string_view(name_chars, strnlen(name_chars, name_data.size())),
+            .value = value ? value->GetValue<f32>(link).value_or(0.F) : 0.F,
+            .relative = relative ? relative->GetValue<s16>(link).value_or(0) : s16(0),
+            .positions = std::span(reinterpret_cast<const Float3*>(positions.data()), count),
+        });
+        // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+        address = next->GetPointerAddress(link).value_or(0);
+        link = next->GetPointerData(link, key_block_size);
+    }
+
+    ShapeKeys shape_keys;
+    if (key_blocks.empty())
+    {
+        shape_keys.delta_offsets = { 0 };
+        return shape_keys;
+    }
+
+    const u64 reference_address = reference_key->GetPointerAddress(key.body).value_or(0);
+    const auto reference
+        = ranges::find_if(key_blocks, [reference_address](const KeyBlockData& block) { return block.address == reference_address; });
+    const auto& basis = reference != key_blocks.end() ? *reference : key_blocks.front();
+
+    const usize key_count = key_blocks.size();
+    for (const auto& block : key_blocks)
+    {
+        if (block.positions.size() != basis.positions.size())
+        {
+            return MakeError(ShapeKeyError::MismatchedElementCount);
+        }
+
+        shape_keys.names.push_back(block.name);
+        shape_keys.values.push_back(block.value);
+        shape_keys.relative_keys.push_back(block.relative >= 0 && usize(block.relative) < key_count ? u32(block.relative) : 0U);
+    }
+    shape_keys.basis.assign(basis.positions.begin(), basis.positions.end());
+
+    // Keys are encoded independently against the key they are relative to, then concatenated in order
+    std::vector<std::vector<u32>> key_indices(key_count);
+    std::vector<std::vector<Float3>> key_deltas(key_count);
+    ParallelFor(
+        key_count,
+        1,
+        [&](usize begin, usize end)
+        {
+            for (usize index = begin; index < end; ++index)
+            {
+                const u32 relative_key = shape_keys.relative_keys[index];
+                if (relative_key != index && &key_blocks[index] != &basis)
+                {
+                    EncodeShapeKeyDeltas(
+                        key_blocks[relative_key].positions,
+                        key_blocks[index].positions,
+                        threshold,
+                        key_indices[index],
+                        key_deltas[index]
+                    );
+                }
+            }
+        }
+    );
+
+    shape_keys.delta_offsets.push_back(0);
+    for (usize index = 0; index < key_count; ++index)
+    {
+        shape_keys.delta_indices.insert(shape_keys.delta_indices.end(), key_indices[index].begin(), key_indices[index].end());
+        shape_keys.deltas.insert(shape_keys.deltas.end(), key_deltas[index].begin(), key_deltas[index].end());
+        shape_keys.delta_offsets.push_back(u32(shape_keys.delta_indices.size()));
+    }
+
+    return shape_keys;
+}
@@ -0,0 +1,307 @@
+#include <cblend_parallel.hpp>
+#include <cblend_skeleton.hpp>
+#include <range/v3/algorithm/find.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+using namespace cblend;
+
+static constexpr s16 OBJECT_TYPE_ARMATURE = 25;
+static constexpr usize BONE_GRAIN_SIZE = 256;
+
+usize Skeleton::GetBoneCount() const
+{
+    return names.size();
+}
+
+Option<u32> Skeleton::FindBone(std::string_view name) const
+{
+    if (const auto result = ranges::find(names, name); result != names.end())
+    {
+        return u32(result - names.begin());
+    }
+    return NULL_OPTION;
+}
+
+struct BoneLink
+{
+    u64 address = 0;
+    MemorySpan data = {};
+    u32 parent = NO_PARENT;
+};
+
+[[nodiscard]] std::string_view ReadFixedString(const Option<BlendFieldInfo>& field, MemorySpan data)
+{
+    const auto value = field ? field->GetData(data) : MemorySpan{};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* chars = reinterpret_cast<const char*>(value.data());
+    return value.empty() ? std::string_view{} : std::string_view(chars, strnlen(chars, value.size()));
+}
+
+// Reads a ListBase into addresses and spans, reversed so that popping from the back keeps the original order
+[[nodiscard]] bool ReadBoneList(
+    const BlendFieldInfo& list_first,
+    MemorySpan list,
+    const BlendFieldInfo& next,
+    usize bone_size,
+    u32 parent,
+    usize link_limit,
+    std::vector<BoneLink>& stack
+)
+{
+    const usize stack_begin = stack.size();
+    BoneLink link = { list_first.GetPointerAddress(list).value_or(0), list_first.GetPointerData(list, bone_size), parent };
+
+    while (!link.data.empty())
+    {
+        if (stack.size() - stack_begin >= link_limit)
+        {
+            return false;
+        }
+
+        stack.push_back(link);
+        link = { next.GetPointerAddress(link.data).value_or(0), next.GetPointerData(link.data, bone_size), parent };
+    }
+
+    std::reverse(stack.begin() + s64(stack_begin), stack.end());
+    return true;
+}
+
+[[nodiscard]] Result<void, SkeletonError>
+ReadBones(const Blend& blend, MemorySpan armature, const BlendType& armature_type, Skeleton& skeleton, std::vector<u64>& addresses)
+{
+    const auto bone_type = blend.GetType("Bone");
+    if (!bone_type)
+    {
+        return MakeError(SkeletonError::InvalidBoneType);
+    }
+
+    const auto bone_list = armature_type.GetField("bonebase");
+    const auto next = bone_type->GetField("next");
+    const auto children = bone_type->GetField("childbase");
+    const auto name = bone_type->GetField("name");
+    const auto rest = bone_type->GetField("arm_mat");
+    if (!bone_list || !next || !children || !name || !rest)
+    {
+        return MakeError(SkeletonError::InvalidBoneType);
+    }
+
+    const auto list_first = bone_list->GetFieldType().GetField("first");
+    if (!list_first)
+    {
+        return MakeError(SkeletonError::InvalidBoneType);
+    }
+
+    const usize bone_size = bone_type->GetSize();
+    const usize link_limit = blend.GetBlockCount();
+    std::vector<BoneLink> stack;
+
+    if (!ReadBoneList(*list_first, bone_list->GetData(armature), *next, bone_size, NO_PARENT, link_limit, stack))
+    {
+        return MakeError(SkeletonError::InvalidBoneList);
+    }
+
+    while (!stack.empty())
+    {
+        const BoneLink bone = stack.back();
+        stack.pop_back();
+
+        if (skeleton.GetBoneCount() >= link_limit)
+        {
+            return MakeError(SkeletonError::InvalidBoneList);
+        }
+
+        const u32 index = u32(skeleton.GetBoneCount());
+        skeleton.names.push_back(ReadFixedString(name, bone.data));
+        skeleton.parents.push_back(bone.parent);
+        skeleton.rest_matrices.push_back(rest->GetValue<Float4x4>(bone.data).value_or(IDENTITY_MATRIX));
+        addresses.push_back(bone.address);
+
+        if (!ReadBoneList(*list_first, children->GetData(bone.data), *next, bone_size, index, link_limit, stack))
+        {
+            return MakeError(SkeletonError::InvalidBoneList);
+        }
+    }
+
+    return {};
+}
+
+[[nodiscard]] Result<void, SkeletonError>
+ReadPoseChannels(const Blend& blend, MemorySpan pose, std::span<const u64> bone_addresses, Skeleton& skeleton)
+{
+    const auto pose_type = blend.GetType("bPose");
+    const auto channel_type = blend.GetType("bPoseChannel");
+    if (!pose_type || !channel_type)
+    {
+        return MakeError(SkeletonError::InvalidPoseType);
+    }
+
+    const auto channel_list = pose_type->GetField("chanbase");
+    const auto next = channel_type->GetField("next");
+    const auto name = channel_type->GetField("name");
+    const auto bone = channel_type->GetField("bone");
+    const auto location = channel_type->GetField("loc");
+    const auto scale = channel_type->GetField("size") ? channel_type->GetField("size") : channel_type->GetField("scale");
+    const auto euler = channel_type->GetField("eul");
+    const auto quaternion = channel_type->GetField("quat");
+    const auto axis = channel_type->GetField("rotAxis");
+    const auto angle = channel_type->GetField("rotAngle");
+    const auto mode = channel_type->GetField("rotmode");
+    if (!channel_list || !next || !name || !location || !scale || !euler || !quaternion)
+    {
+        return MakeError(SkeletonError::InvalidPoseType);
+    }
+
+    const auto list_first = channel_list->GetFieldType().GetField("first");
+    if (!list_first)
+    {
+        return MakeError(SkeletonError::InvalidPoseType);
+    }
+
+    std::unordered_map<u64, u32> bone_indices;
+    for (usize index = 0; index < bone_addresses.size(); ++index)
+    {
+        bone_indices.emplace(bone_addresses[index], u32(index));
+    }
+
+    const usize channel_size = channel_type->GetSize();
+    MemorySpan channel = list_first->GetPointerData(channel_list->GetData(pose), channel_size);
+
+    for (usize count = 0; !channel.empty(); ++count)
+    {
+        if (count >= blend.GetBlockCount())
+        {
+            return MakeError(SkeletonError::InvalidBoneList);
+        }
+
+        // Channels normally point at their bone, older files are matched by name instead
+        Option<u32> index = NULL_OPTION;
+        if (const auto found = bone_indices.find(bone ? bone->GetPointerAddress(channel).value_or(0) : 0); found != bone_indices.end())
+        {
+            index = found->second;
+        }
+        else
+        {
+            index = skeleton.FindBone(ReadFixedString(name, channel));
+        }
+
+        if (index)
+        {
+            const auto rotation = RotationToMatrix(
+                mode ? mode->GetValue<s16>(channel).value_or(0) : 0,
+                euler->GetValue<Float3>(channel).value_or(Float3{}),
+                quaternion->GetValue<Float4>(channel).value_or(Float4{ 1.F, 0.F, 0.F, 0.F }),
+                axis ? axis->GetValue<Float3>(channel).value_or(Float3{ 0.F, 1.F, 0.F }) : Float3{ 0.F, 1.F, 0.F },
+                angle ? angle->GetValue<f32>(channel).value_or(0.F) : 0.F
+            );
+
+            skeleton.pose_local_matrices[*index] = ComposeTransform(
+                location->GetValue<Float3>(channel).value_or(Float3{}),
+                rotation,
+                scale->GetValue<Float3>(channel).value_or(Float3{ 1.F, 1.F, 1.F })
+            );
+        }
+
+        channel = next->GetPointerData(channel, channel_size);
+    }
+
+    return {};
+}
+
+Result<Skeleton, SkeletonError> cblend::ExtractSkeleton(const Blend& blend, const Block& block)
+{
+    const auto armature_type = blend.GetType("bArmature");
+    if (!armature_type)
+    {
+        return MakeError(SkeletonError::InvalidArmatureType);
+    }
+
+    MemorySpan armature = block.body;
+    MemorySpan pose = {};
+
+    if (block.header.code == BLOCK_CODE_OB)
+    {
+        const auto object_type = blend.GetBlockType(block);
+        if (!object_type)
+        {
+            return MakeError(SkeletonError::InvalidObjectType);
+        }
+
+        const auto type = object_type->GetField("type");
+        const auto data = object_type->GetField("data");
+        const auto pose_field = object_type->GetField("pose");
+        const auto pose_type = blend.GetType("bPose");
+        if (!type || !data || type->GetValue<s16>(block) != OBJECT_TYPE_ARMATURE)
+        {
+            return MakeError(SkeletonError::InvalidObjectType);
+        }
+
+        armature = data->GetPointerData(block.body, armature_type->GetSize());
+        if (pose_field && pose_type)
+        {
+            pose = pose_field->GetPointerData(block.body, pose_type->GetSize());
+        }
+    }
+
+    if (armature.size() < armature_type->GetSize())
+    {
+        return MakeError(SkeletonError::InvalidArmatureType);
+    }
+
+    Skeleton skeleton;
+    std::vector<u64> bone_addresses;
+    if (const auto bones = ReadBones(blend, armature, *armature_type, skeleton, bone_addresses); !bones)
+    {
+        return MakeError(bones.error());
+    }
+
+    skeleton.pose_local_matrices.assign(skeleton.GetBoneCount(), IDENTITY_MATRIX);
+    if (!pose.empty())
+    {
+        if (const auto channels = ReadPoseChannels(blend, pose, bone_addresses, skeleton); !channels)
+        {
+            return MakeError(channels.error());
+        }
+    }
+
+    ComputePoseMatrices(skeleton);
+    return skeleton;
+}
+
+void cblend::ComputePoseMatrices(Skeleton& skeleton)
+{
+    const usize bone_count = skeleton.GetBoneCount();
+    skeleton.pose_matrices.resize(bone_count);
+
+    // Rest offsets relative to the parent are independent per bone, only the final chain needs parents first
+    ParallelFor(
+        bone_count,
+        BONE_GRAIN_SIZE,
+        [&skeleton](usize begin, usize end)
+        {
+            for (usize bone = begin; bone < end; ++bone)
+            {
+                const u32 parent = skeleton.parents[bone];
+                Float4x4 offset = skeleton.rest_matrices[bone];
+
+                if (parent != NO_PARENT)
+                {
+                    const auto parent_inverse = Invert(skeleton.rest_matrices[parent]);
+                    offset = Multiply(parent_inverse.value_or(IDENTITY_MATRIX), offset);
+                }
+
+                skeleton.pose_matrices[bone] = Multiply(offset, skeleton.pose_local_matrices[bone]);
+            }
+        }
+    );
+
+    for (usize bone = 0; bone < bone_count; ++bone)
+    {
+        if (const u32 parent = skeleton.parents[bone]; parent != NO_PARENT)
+        {
+            skeleton.pose_matrices[bone] = Multiply(skeleton.pose_matrices[parent], skeleton.pose_matrices[bone]);
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#include <cblend_view.hpp>
+
+using namespace cblend;
+
+[[nodiscard]] Result<ViewField, QueryValueError>
+ResolveViewTokens(const BlendType& type, const Query& query, usize token_index, usize offset)
+{
+    const auto token = query.GetToken(token_index);
+    if (!token)
+    {
+        return ViewField{ .offset = offset, .size = type.GetSize(), .is_pointer = type.IsPointer() };
+    }
+
+    if (const auto* index = std::get_if<usize>(&*token))
+    {
+        const auto element_type = type.GetElementType();
+        if (!type.IsArray() || !element_type)
+        {
+            return MakeError(QueryValueError::IndexedInvalidType);
+        }
+
+        if (*index >= type.GetArrayRank())
+        {
+            return MakeError(QueryValueError::IndexOutOfBounds);
+        }
+
+        return ResolveViewTokens(*element_type, query, token_index + 1, offset + *index * element_type->GetSize());
+    }
+
+    if (!type.IsStruct())
+    {
+        return MakeError(QueryValueError::IndexedInvalidType);
+    }
+
+    const auto field = type.GetField(std::get<std::string_view>(*token));
+    if (!field)
+    {
+        return MakeError(QueryValueError::FieldNotFound);
+    }
+
+    return ResolveViewTokens(field->GetFieldType(), query, token_index + 1, offset + field->GetOffset());
+}
+
+Result<ViewField, QueryValueError> cblend::ResolveViewField(const BlendType& type, const Query& query)
+{
+    return ResolveViewTokens(type, query, 0, 0);
+}
@@ -0,0 +1,281 @@
+#include <cblend_parallel.hpp>
+#include <cblend_simd.hpp>
+#include <cblend_weld.hpp>
+#include <range/v3/algorithm/any_of.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+using namespace cblend;
+
+static constexpr u32 EMPTY_SLOT = std::numeric_limits<u32>::max();
+static constexpr u32 HASH_SEED = 0x811C9DC5U;
+static constexpr u32 HASH_PRIME = 0x9E3779B1U;
+static constexpr u32 FINALIZE_PRIME_A = 0x85EBCA6BU;
+static constexpr u32 FINALIZE_PRIME_B = 0xC2B2AE35U;
+
+static constexpr u32 SHARD_BITS = 6;
+static constexpr usize SHARD_COUNT = usize(1) << SHARD_BITS;
+static constexpr usize MIN_TABLE_CAPACITY = 16;
+
+static constexpr usize HASH_GRAIN_SIZE = 4096;
+static constexpr usize NUMBERING_BLOCK_SIZE = 4096;
+
+usize WeldResult::GetCornerCount() const
+{
+    return indices.size();
+}
+
+usize WeldResult::GetVertexCount() const
+{
+    return source_corners.size();
+}
+
+f32 WeldResult::GetReuseRatio() const
+{
+    if (source_corners.empty())
+    {
+        return 0.F;
+    }
+
+    return f32(indices.size()) / f32(source_corners.size());
+}
+
+[[nodiscard]] u32 ReadWord(const AttributeStream& stream, usize corner, usize offset)
+{
+    u32 word = 0;
+    const usize size = std::min<usize>(sizeof(u32), stream.element_size - offset);
+    std::memcpy(&word, stream.data.data() + corner * stream.element_size + offset, size);
+    return word;
+}
+
+[[nodiscard]] simd::UInt32N MixWord(simd::UInt32N hash, simd::UInt32N word)
+{
+    hash = (hash ^ word) * simd::UInt32N::Broadcast(HASH_PRIME);
+    return hash ^ hash.ShiftRight<15>();
+}
+
+[[nodiscard]] simd::UInt32N FinalizeHash(simd::UInt32N hash)
+{
+    hash = (hash ^ hash.ShiftRight<16>()) * simd::UInt32N::Broadcast(FINALIZE_PRIME_A);
+    hash = (hash ^ hash.ShiftRight<13>()) * simd::UInt32N::Broadcast(FINALIZE_PRIME_B);
+    return hash ^ hash.ShiftRight<16>();
+}
+
+// Hashes simd::UInt32N::WIDTH corners at a time; a partial batch repeats its last corner and discards the extra lanes.
+void HashCornerRange(std::span<const AttributeStream> streams, usize begin, usize end, std::span<u32> hashes)
+{
+    static constexpr usize WIDTH = simd::UInt32N::WIDTH;
+    std::array<usize, WIDTH> corners = {};
+    std::array<u32, WIDTH> words = {};
+
+    for (usize batch = begin; batch < end; batch += WIDTH)
+    {
+        const usize lane_count = std::min(WIDTH, end - batch);
+        for (usize lane = 0; lane < WIDTH; ++lane)
+        {
+            corners[lane] = batch + std::min(lane, lane_count - 1);
+        }
+
+        auto hash = simd::UInt32N::Broadcast(HASH_SEED);
+        for (const auto& stream : streams)
+        {
+            for (usize offset = 0; offset < stream.element_size; offset += sizeof(u32))
+            {
+                for (usize lane = 0; lane < WIDTH; ++lane)
+                {
+                    words[lane] = ReadWord(stream, corners[lane], offset);
+                }
+                hash = MixWord(hash, simd::UInt32N::Load(words.data()));
+            }
+        }
+
+        FinalizeHash(hash).Store(words.data());
+        std::copy_n(words.begin(), lane_count, hashes.begin() + s64(batch));
+    }
+}
+
+[[nodiscard]] bool IsSameTuple(std::span<const AttributeStream> streams, usize lhs, usize rhs)
+{
+    return !ranges::any_of(
+        streams,
+        [lhs, rhs](const AttributeStream& stream)
+        {
+            const u8* data = stream.data.data();
+            return std::memcmp(data + lhs * stream.element_size, data + rhs * stream.element_size, stream.element_size) != 0;
+        }
+    );
+}
+
+[[nodiscard]] usize GetShard(u32 hash)
+{
+    return usize(hash >> (32U - SHARD_BITS));
+}
+
+// Linear probing table local to one shard; corners are inserted in increasing order so the first corner of a tuple wins.
+void WeldShard(
+    std::span<const AttributeStream> streams,
+    std::span<const u32> hashes,
+    std::span<const u32> shard_corners,
+    std::span<u32> representatives
+)
+{
+    const usize capacity = std::bit_ceil(std::max(shard_corners.size() * 2, MIN_TABLE_CAPACITY));
+    const usize mask = capacity - 1;
+    std::vector<u32> slots(capacity, EMPTY_SLOT);
+
+    for (const u32 corner : shard_corners)
+    {
+        const u32 hash = hashes[corner];
+        for (usize slot = hash & mask;; slot = (slot + 1) & mask)
+        {
+            if (slots[slot] == EMPTY_SLOT)
+            {
+                slots[slot] = corner;
+                representatives[corner] = corner;
+                break;
+            }
+
+            if (hashes[slots[slot]] == hash && IsSameTuple(streams, slots[slot], corner))
+            {
+                representatives[corner] = slots[slot];
+                break;
+            }
+        }
+    }
+}
+
+Result<WeldResult, WeldError> cblend::WeldCorners(std::span<const AttributeStream> streams, usize corner_count)
+{
+    if (corner_count >= usize(EMPTY_SLOT))
+    {
+        return MakeError(WeldError::TooManyCorners);
+    }
+
+    for (const auto& stream : streams)
+    {
+        if (stream.element_size == 0)
+        {
+            return MakeError(WeldError::InvalidStream);
+        }
+
+        if (stream.data.size() < stream.element_size * corner_count)
+        {
+            return MakeError(WeldError::StreamTooSmall);
+        }
+    }
+
+    std::vector<u32> hashes(corner_count);
+    ParallelFor(
+        corner_count,
+        HASH_GRAIN_SIZE,
+        [&streams, &hashes](usize begin, usize end) { HashCornerRange(streams, begin, end, hashes); }
+    );
+
+    std::vector<u32> shard_offsets(SHARD_COUNT + 1, 0);
+    for (const u32 hash : hashes)
+    {
+        ++shard_offsets[GetShard(hash) + 1];
+    }
+    std::partial_sum(shard_offsets.begin(), shard_offsets.end(), shard_offsets.begin());
+
+    std::vector<u32> shard_corners(corner_count);
+    std::vector<u32> shard_cursors(shard_offsets.begin(), shard_offsets.end() - 1);
+    for (usize corner = 0; corner < corner_count; ++corner)
+    {
+        shard_corners[shard_cursors[GetShard(hashes[corner])]++] = u32(corner);
+    }
+
+    std::vector<u32> representatives(corner_count);
+    ParallelFor(
+        SHARD_COUNT,
+        1,
+        [&](usize begin, usize end)
+        {
+            for (usize shard = begin; shard < end; ++shard)
+            {
+                const usize shard_size = shard_offsets[shard + 1] - shard_offsets[shard];
+                const auto corners = std::span(shard_corners).subspan(shard_offsets[shard], shard_size);
+                WeldShard(streams, hashes, corners, representatives);
+            }
+        }
+    );
+
+    const usize block_count = (corner_count + NUMBERING_BLOCK_SIZE - 1) / NUMBERING_BLOCK_SIZE;
+    std::vector<u32> block_offsets(block_count + 1, 0);
+    ParallelFor(
+        block_count,
+        1,
+        [&](usize begin, usize end)
+        {
+            for (usize block = begin; block < end; ++block)
+            {
+                const usize last = std::min((block + 1) * NUMBERING_BLOCK_SIZE, corner_count);
+                for (usize corner = block * NUMBERING_BLOCK_SIZE; corner < last; ++corner)
+                {
+                    block_offsets[block + 1] += u32(representatives[corner] == corner);
+                }
+            }
+        }
+    );
+    std::partial_sum(block_offsets.begin(), block_offsets.end(), block_offsets.begin());
+
+    WeldResult result;
+    result.indices.resize(corner_count);
+    result.source_corners.resize(block_offsets.back());
+    ParallelFor(
+        block_count,
+        1,
+        [&](usize begin, usize end)
+        {
+            for (usize block = begin; block < end; ++block)
+            {
+                u32 vertex = block_offsets[block];
+                const usize last = std::min((block + 1) * NUMBERING_BLOCK_SIZE, corner_count);
+                for (usize corner = block * NUMBERING_BLOCK_SIZE; corner < last; ++corner)
+                {
+                    if (representatives[corner] == corner)
+                    {
+                        result.source_corners[vertex] = u32(corner);
+                        result.indices[corner] = vertex++;
+                    }
+                }
+            }
+        }
+    );
+
+    ParallelFor(
+        corner_count,
+        HASH_GRAIN_SIZE,
+        [&](usize begin, usize end)
+        {
+            for (usize corner = begin; corner < end; ++corner)
+            {
+                if (representatives[corner] != corner)
+                {
+                    result.indices[corner] = result.indices[representatives[corner]];
+                }
+            }
+        }
+    );
+
+    return result;
+}
+
+std::vector<u8> cblend::GatherVertices(const AttributeStream& stream, const WeldResult& result)
+{
+    std::vector<u8> vertices(result.GetVertexCount() * stream.element_size);
+    for (usize vertex = 0; vertex < result.GetVertexCount(); ++vertex)
+    {
+        std::memcpy(
+            vertices.data() + vertex * stream.element_size,
+            stream.data.data() + usize(result.source_corners[vertex]) * stream.element_size,
+            stream.element_size
+        );
+    }
+    return vertices;
+}
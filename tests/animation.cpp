@@ -0,0 +1,301 @@
+#include "blend_builder.hpp"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cblend_animation.hpp>
+
+#include <array>
+#include <cstring>
+
+using namespace cblend;
+
+struct TestKey
+{
+    f32 frame = 0.F;
+    f32 value = 0.F;
+    f32 left_frame = 0.F;
+    f32 left_value = 0.F;
+    f32 right_frame = 0.F;
+    f32 right_value = 0.F;
+    KeyframeInterpolation interpolation = KeyframeInterpolation::Bezier;
+};
+
+void AddChannel(ActionCurves& curves, std::string_view path, CurveExtrapolation extrapolation, std::initializer_list<TestKey> keys)
+{
+    if (curves.key_offsets.empty())
+    {
+        curves.key_offsets.push_back(0);
+    }
+
+    curves.paths.push_back(path);
+    curves.array_indices.push_back(s32(curves.paths.size() - 1));
+    curves.extrapolations.push_back(extrapolation);
+
+    for (const auto& key : keys)
+    {
+        curves.frames.push_back(key.frame);
+        curves.values.push_back(key.value);
+        curves.left_frames.push_back(key.left_frame);
+        curves.left_values.push_back(key.left_value);
+        curves.right_frames.push_back(key.right_frame);
+        curves.right_values.push_back(key.right_value);
+        curves.interpolations.push_back(key.interpolation);
+    }
+    curves.key_offsets.push_back(u32(curves.frames.size()));
+}
+
+[[nodiscard]] ActionCurves CreateCurves()
+{
+    ActionCurves curves;
+    AddChannel(
+        curves,
+        "linear",
+        CurveExtrapolation::Constant,
+        { TestKey{ .frame = 0.F, .value = 0.F, .interpolation = KeyframeInterpolation::Linear },
+          TestKey{ .frame = 10.F, .value = 10.F, .interpolation = KeyframeInterpolation::Linear } }
+    );
+    AddChannel(
+        curves,
+        "ease",
+        CurveExtrapolation::Constant,
+        { TestKey{ .frame = 0.F, .value = 0.F, .left_frame = -3.F, .right_frame = 3.F },
+          TestKey{ .frame = 10.F, .value = 1.F, .left_frame = 7.F, .left_value = 1.F, .right_frame = 13.F, .right_value = 1.F } }
+    );
+    AddChannel(
+        curves,
+        "straight",
+        CurveExtrapolation::Linear,
+        { TestKey{ .frame = 0.F, .value = 0.F, .left_frame = -2.F, .left_value = -2.F, .right_frame = 2.F, .right_value = 2.F },
+          TestKey{ .frame = 10.F, .value = 10.F, .left_frame = 6.F, .left_value = 6.F, .right_frame = 14.F, .right_value = 14.F } }
+    );
+    AddChannel(
+        curves,
+        "constant",
+        CurveExtrapolation::Linear,
+        { TestKey{ .frame = 0.F, .value = 1.F, .interpolation = KeyframeInterpolation::Constant },
+          TestKey{ .frame = 10.F, .value = 3.F, .interpolation = KeyframeInterpolation::Constant } }
+    );
+    return curves;
+}
+
+// NOLINTBEGIN
+TEST_CASE("fcurves can be evaluated", "[animation]")
+// NOLINTEND
+{
+    const auto curves = CreateCurves();
+    REQUIRE(curves.GetChannelCount() == 4);
+    REQUIRE(curves.FindChannel("ease", 1) == 1U);
+
+    SECTION("linear segments interpolate and clamp")
+    {
+        REQUIRE(EvaluateChannel(curves, 0, 2.5F) == Catch::Approx(2.5F));
+        REQUIRE(EvaluateChannel(curves, 0, -5.F) == Catch::Approx(0.F));
+        REQUIRE(EvaluateChannel(curves, 0, 15.F) == Catch::Approx(10.F));
+    }
+
+    SECTION("bezier segments follow their handles")
+    {
+        REQUIRE(EvaluateChannel(curves, 1, 5.F) == Catch::Approx(0.5F).margin(1e-4));
+        REQUIRE(EvaluateChannel(curves, 1, 2.F) < 0.2F);
+        REQUIRE(EvaluateChannel(curves, 1, 2.F) + EvaluateChannel(curves, 1, 8.F) == Catch::Approx(1.F).margin(1e-4));
+
+        for (f32 frame = 0.F; frame <= 10.F; frame += 0.25F)
+        {
+            REQUIRE(EvaluateChannel(curves, 2, frame) == Catch::Approx(frame).margin(1e-4));
+        }
+    }
+
+    SECTION("extrapolation follows the outer handles")
+    {
+        REQUIRE(EvaluateChannel(curves, 2, -4.F) == Catch::Approx(-4.F).margin(1e-4));
+        REQUIRE(EvaluateChannel(curves, 2, 20.F) == Catch::Approx(20.F).margin(1e-4));
+        REQUIRE(EvaluateChannel(curves, 3, 9.F) == Catch::Approx(1.F));
+        REQUIRE(EvaluateChannel(curves, 3, 20.F) == Catch::Approx(3.F));
+    }
+}
+
+// NOLINTBEGIN
+TEST_CASE("fcurves can be baked", "[animation]")
+// NOLINTEND
+{
+    const auto curves = CreateCurves();
+    const auto baked = BakeActionCurves(curves, -2.F, 12.F, 0.5F);
+    REQUIRE(baked);
+    REQUIRE(baked->sample_count == 29);
+    REQUIRE(baked->GetChannelCount() == curves.GetChannelCount());
+
+    for (usize channel = 0; channel < curves.GetChannelCount(); ++channel)
+    {
+        const auto samples = baked->GetChannel(channel);
+        for (usize sample = 0; sample < samples.size(); ++sample)
+        {
+            const f32 frame = baked->start_frame + f32(sample) * baked->frame_step;
+            REQUIRE(samples[sample] == Catch::Approx(EvaluateChannel(curves, channel, frame)).margin(1e-5));
+        }
+    }
+
+    REQUIRE(BakeActionCurves(curves, 10.F, 0.F, 1.F).error() == AnimationError::InvalidSampleRange);
+    REQUIRE(BakeActionCurves(curves, 0.F, 10.F, 0.F).error() == AnimationError::InvalidSampleRange);
+}
+
+void AddActionStructs(BlendBuilder& builder, std::string_view curves_name)
+{
+    builder.AddIdStructs();
+    builder.AddStruct("BezTriple", { { "float", "vec[3][3]" }, { "char", "ipo" }, { "char", "_pad[3]" } });
+    builder.AddStruct(
+        "FCurve",
+        {
+            { "FCurve", "*next" },
+            { "FCurve", "*prev" },
+            { "BezTriple", "*bezt" },
+            { "int", "totvert" },
+            { "short", "flag" },
+            { "short", "extend" },
+            { "int", "array_index" },
+            { "char", "*rna_path" },
+        }
+    );
+    builder.AddStruct("bAction", { { "ID", "id" }, { "ListBase", curves_name } });
+    builder.AddStruct("AnimData", { { "bAction", "*action" }, { "bAction", "*tmpact" } });
+    builder.AddStruct("Object", { { "ID", "id" }, { "AnimData", "*adt" } });
+}
+
+// Writes the channels as the FCurve list of an action animating one of two objects, a cyclic list links the last curve back
+[[nodiscard]] std::vector<u8> CreateActionFile(const ActionCurves& curves, bool is_cyclic)
+{
+    BlendBuilder builder;
+    AddActionStructs(builder, "curves");
+    const usize keyframe_size = builder.GetSize("BezTriple");
+
+    std::vector<u64> curve_addresses(curves.GetChannelCount());
+    for (auto& address : curve_addresses)
+    {
+        address = builder.Allocate();
+    }
+
+    for (usize channel = 0; channel < curves.GetChannelCount(); ++channel)
+    {
+        const usize first = curves.key_offsets[channel];
+        const usize last = curves.key_offsets[channel + 1];
+        auto keyframes = builder.MakeStruct("BezTriple", last - first);
+        for (usize key = first; key < last; ++key)
+        {
+            const usize offset = (key - first) * keyframe_size;
+            const std::array<f32, 9> points = {
+                curves.left_frames[key],  curves.left_values[key],  0.F, curves.frames[key], curves.values[key], 0.F,
+                curves.right_frames[key], curves.right_values[key], 0.F,
+            };
+            BlendBuilder::Write(keyframes, offset + builder.GetOffset("BezTriple", "vec"), points);
+            BlendBuilder::Write(keyframes, offset + builder.GetOffset("BezTriple", "ipo"), s8(curves.interpolations[key]));
+        }
+
+        const std::string_view path = curves.paths[channel];
+        std::vector<u8> path_data(path.size() + 1, 0);
+        std::memcpy(path_data.data(), path.data(), path.size());
+
+        const bool is_last = channel + 1 == curves.GetChannelCount();
+        auto curve = builder.MakeStruct("FCurve");
+        builder.Set(curve, "FCurve", "next", is_last ? (is_cyclic ? curve_addresses.front() : u64(0)) : curve_addresses[channel + 1]);
+        builder.Set(curve, "FCurve", "prev", channel == 0 ? u64(0) : curve_addresses[channel - 1]);
+        builder.Set(curve, "FCurve", "bezt", builder.AddBlock(BLOCK_CODE_DATA, "BezTriple", std::move(keyframes)));
+        builder.Set(curve, "FCurve", "totvert", s32(last - first));
+        builder.Set(curve, "FCurve", "extend", s16(curves.extrapolations[channel]));
+        builder.Set(curve, "FCurve", "array_index", curves.array_indices[channel]);
+        builder.Set(curve, "FCurve", "rna_path", builder.AddData(std::move(path_data)));
+        builder.AddBlock(BLOCK_CODE_DATA, "FCurve", std::move(curve), curve_addresses[channel]);
+    }
+
+    auto action = builder.MakeStruct("bAction");
+    builder.SetName(action, "ACAction");
+    builder.Set(action, "bAction", "curves", std::array<u64, 2>{ curve_addresses.front(), curve_addresses.back() });
+    const u64 action_address = builder.AddBlock(BLOCK_CODE_AC, "bAction", std::move(action));
+
+    auto anim_data = builder.MakeStruct("AnimData");
+    builder.Set(anim_data, "AnimData", "action", action_address);
+
+    auto animated = builder.MakeStruct("Object");
+    builder.SetName(animated, "OBAnimated");
+    builder.Set(animated, "Object", "adt", builder.AddBlock(BLOCK_CODE_DATA, "AnimData", std::move(anim_data)));
+    builder.AddBlock(BLOCK_CODE_OB, "Object", std::move(animated));
+
+    auto still = builder.MakeStruct("Object");
+    builder.SetName(still, "OBStill");
+    builder.AddBlock(BLOCK_CODE_OB, "Object", std::move(still));
+    return builder.Build();
+}
+
+// NOLINTBEGIN
+TEST_CASE("actions can be extracted", "[animation]")
+// NOLINTEND
+{
+    const auto expected = CreateCurves();
+
+    SECTION("fcurves are read from the action of an object")
+    {
+        const auto buffer = CreateActionFile(expected, false);
+        const auto blend = Blend::Read(buffer);
+        REQUIRE(blend);
+
+        usize object_count = 0;
+        Option<const Block&> action;
+        for (const auto& object : blend->GetBlocks(BLOCK_CODE_OB))
+        {
+            if (object_count++ == 0)
+            {
+                action = GetAction(*blend, object);
+            }
+            else
+            {
+                REQUIRE(!GetAction(*blend, object));
+            }
+        }
+        REQUIRE(object_count == 2);
+        REQUIRE(action);
+        REQUIRE(action->header.code == BLOCK_CODE_AC);
+
+        const auto curves = ExtractActionCurves(*blend, *action);
+        REQUIRE(curves);
+        REQUIRE(curves->paths == expected.paths);
+        REQUIRE(curves->array_indices == expected.array_indices);
+        REQUIRE(curves->extrapolations == expected.extrapolations);
+        REQUIRE(curves->key_offsets == expected.key_offsets);
+        REQUIRE(curves->frames == expected.frames);
+        REQUIRE(curves->values == expected.values);
+        REQUIRE(curves->left_frames == expected.left_frames);
+        REQUIRE(curves->right_values == expected.right_values);
+        REQUIRE(curves->interpolations == expected.interpolations);
+        REQUIRE(curves->FindChannel("straight", 2).value() == 2U);
+
+        const auto baked = BakeActionCurves(*curves, 0.F, 10.F, 1.F);
+        const auto expected_baked = BakeActionCurves(expected, 0.F, 10.F, 1.F);
+        REQUIRE(baked);
+        REQUIRE(expected_baked);
+        REQUIRE(baked->samples == expected_baked->samples);
+    }
+
+    SECTION("cyclic fcurve lists are rejected")
+    {
+        const auto buffer = CreateActionFile(expected, true);
+        const auto blend = Blend::Read(buffer);
+        REQUIRE(blend);
+
+        const auto action = blend->GetBlock(BLOCK_CODE_AC);
+        REQUIRE(action);
+        REQUIRE(ExtractActionCurves(*blend, *action).error() == AnimationError::InvalidCurveList);
+    }
+
+    SECTION("actions without a curve list are rejected")
+    {
+        BlendBuilder builder;
+        AddActionStructs(builder, "groups");
+        builder.AddBlock(BLOCK_CODE_AC, "bAction", builder.MakeStruct("bAction"));
+
+        const auto buffer = builder.Build();
+        const auto blend = Blend::Read(buffer);
+        REQUIRE(blend);
+
+        const auto action = blend->GetBlock(BLOCK_CODE_AC);
+        REQUIRE(action);
+        REQUIRE(ExtractActionCurves(*blend, *action).error() == AnimationError::InvalidActionType);
+    }
+}
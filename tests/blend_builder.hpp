@@ -0,0 +1,354 @@
+#pragma once
+
+#include <cblend.hpp>
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cblend
+{
+// Writes 64-bit blend files in the native byte order from a hand written SDNA, struct fields are packed without padding
+class BlendBuilder
+{
+public:
+    struct Field
+    {
+        std::string_view type;
+        // Declared as in SDNA, such as "*next", "mat[4][4]" or "(*callback)()"
+        std::string_view name;
+    };
+
+    struct Layer
+    {
+        s32 type = 0;
+        std::string_view name = {};
+        u64 address = 0;
+    };
+
+    BlendBuilder()
+    {
+        static constexpr std::array<std::pair<std::string_view, u16>, 18> FUNDAMENTAL_TYPES = { {
+            { "char", 1 },    { "uchar", 1 },    { "short", 2 },   { "ushort", 2 },   { "int", 4 },      { "long", 4 },
+            { "ulong", 4 },   { "float", 4 },    { "double", 8 },  { "int64_t", 8 },  { "uint64_t", 8 }, { "void", 0 },
+            { "int8_t", 1 },  { "uint8_t", 1 },  { "int16_t", 2 }, { "uint16_t", 2 }, { "int32_t", 4 },  { "uint32_t", 4 },
+        } };
+
+        for (const auto& [name, size] : FUNDAMENTAL_TYPES)
+        {
+            m_Sizes[AddType(name)] = size;
+        }
+    }
+
+    // Structs embedded by value have to be added before the structs embedding them
+    void AddStruct(std::string_view name, std::initializer_list<Field> fields)
+    {
+        StructLayout layout = { .type = AddType(name), .index = m_Structs.size() };
+        usize offset = 0;
+        for (const auto& field : fields)
+        {
+            layout.fields.emplace_back(AddType(field.type), AddName(field.name));
+            layout.offsets.emplace(GetFieldName(field.name), offset);
+            offset += GetFieldSize(field.type, field.name);
+        }
+
+        m_Sizes[layout.type] = u16(offset);
+        m_StructIndices.emplace(std::string(name), m_Structs.size());
+        m_Structs.push_back(std::move(layout));
+    }
+
+    // ListBase, ID and Library as laid out by Blender
+    void AddIdStructs()
+    {
+        AddStruct("ListBase", { { "void", "*first" }, { "void", "*last" } });
+        AddStruct(
+            "ID",
+            {
+                { "void", "*next" },
+                { "void", "*prev" },
+                { "ID", "*newid" },
+                { "Library", "*lib" },
+                { "char", "name[66]" },
+                { "short", "flag" },
+                { "int", "tag" },
+                { "int", "us" },
+                { "int", "icon_id" },
+            }
+        );
+        AddStruct("Library", { { "ID", "id" }, { "char", "filepath[1024]" } });
+    }
+
+    void AddCustomDataStructs()
+    {
+        AddStruct(
+            "CustomDataLayer",
+            { { "int", "type" }, { "int", "offset" }, { "int", "flag" }, { "int", "active" }, { "char", "name[64]" }, { "void", "*data" } }
+        );
+        AddStruct("CustomData", { { "CustomDataLayer", "*layers" }, { "int", "totlayer" }, { "int", "maxlayer" } });
+    }
+
+    // Adds the layers as one DATA block and returns a CustomData pointing at them
+    [[nodiscard]] std::vector<u8> MakeCustomData(std::initializer_list<Layer> layers)
+    {
+        std::vector<u8> layer_data;
+        for (const auto& layer : layers)
+        {
+            auto data = MakeStruct("CustomDataLayer");
+            Set(data, "CustomDataLayer", "type", layer.type);
+            std::memcpy(data.data() + GetOffset("CustomDataLayer", "name"), layer.name.data(), layer.name.size());
+            Set(data, "CustomDataLayer", "data", layer.address);
+            layer_data.insert(layer_data.end(), data.begin(), data.end());
+        }
+
+        auto custom_data = MakeStruct("CustomData");
+        Set(custom_data, "CustomData", "layers", AddBlock(BLOCK_CODE_DATA, "CustomDataLayer", std::move(layer_data)));
+        Set(custom_data, "CustomData", "totlayer", s32(layers.size()));
+        return custom_data;
+    }
+
+    [[nodiscard]] usize GetSize(std::string_view struct_name) const { return m_Sizes.at(m_Types.at(std::string(struct_name))); }
+
+    [[nodiscard]] usize GetOffset(std::string_view struct_name, std::string_view field_name) const
+    {
+        return GetStruct(struct_name).offsets.at(std::string(field_name));
+    }
+
+    [[nodiscard]] std::vector<u8> MakeStruct(std::string_view struct_name, usize count = 1) const
+    {
+        return std::vector<u8>(GetSize(struct_name) * count);
+    }
+
+    template<class T>
+    requires std::is_trivially_copyable_v<T>
+    static void Write(std::vector<u8>& data, usize offset, const T& value)
+    {
+        std::memcpy(data.data() + offset, &value, sizeof(T));
+    }
+
+    template<class T>
+    void Set(std::vector<u8>& data, std::string_view struct_name, std::string_view field_name, const T& value) const
+    {
+        Write(data, GetOffset(struct_name, field_name), value);
+    }
+
+    // Writes an ID name into the ID embedded at the start of a struct
+    void SetName(std::vector<u8>& data, std::string_view name) const
+    {
+        std::memcpy(data.data() + GetOffset("ID", "name"), name.data(), name.size());
+    }
+
+    [[nodiscard]] u64 Allocate()
+    {
+        m_NextAddress += ADDRESS_STRIDE;
+        return m_NextAddress;
+    }
+
+    u64 AddBlock(const BlockCode& code, std::string_view struct_name, std::vector<u8> body, u64 address = 0)
+    {
+        const usize size = GetSize(struct_name);
+        const u32 count = size == 0 ? 1U : u32(body.size() / size);
+        return AddRawBlock(code, u32(GetStruct(struct_name).index), std::move(body), address, count);
+    }
+
+    // Raw DATA block, such as the payload of a pointer to a fundamental type
+    u64 AddData(std::vector<u8> body, u64 address = 0)
+    {
+        return AddRawBlock(BLOCK_CODE_DATA, 0, std::move(body), address, 1);
+    }
+
+    template<class T>
+    requires std::is_trivially_copyable_v<T>
+    u64 AddValues(std::initializer_list<T> values)
+    {
+        std::vector<u8> body(values.size() * sizeof(T));
+        std::memcpy(body.data(), std::data(values), body.size());
+        return AddData(std::move(body));
+    }
+
+    [[nodiscard]] std::vector<u8> Build() const
+    {
+        const std::string_view magic = std::endian::native == std::endian::little ? "BLENDER-v300" : "BLENDER-V300";
+        std::vector<u8> buffer(magic.begin(), magic.end());
+        for (const auto& block : m_Blocks)
+        {
+            AppendBlockHeader(buffer, block.code, block.body.size(), block.address, block.struct_index, block.count);
+            buffer.insert(buffer.end(), block.body.begin(), block.body.end());
+        }
+
+        const auto sdna = BuildSdna();
+        AppendBlockHeader(buffer, BLOCK_CODE_DNA1, sdna.size(), 0, 0, 1);
+        buffer.insert(buffer.end(), sdna.begin(), sdna.end());
+        AppendBlockHeader(buffer, BLOCK_CODE_ENDB, 0, 0, 0, 0);
+        return buffer;
+    }
+
+private:
+    static constexpr u64 ADDRESS_STRIDE = 0x1000;
+
+    struct StructLayout
+    {
+        usize type = 0;
+        usize index = 0;
+        std::vector<std::pair<usize, usize>> fields = {};
+        std::unordered_map<std::string, usize> offsets = {};
+    };
+
+    struct BlockData
+    {
+        BlockCode code = {};
+        u64 address = 0;
+        u32 struct_index = 0;
+        u32 count = 0;
+        std::vector<u8> body = {};
+    };
+
+    std::vector<std::string> m_TypeNames;
+    std::unordered_map<std::string, usize> m_Types;
+    std::unordered_map<usize, u16> m_Sizes;
+    std::vector<std::string> m_Names;
+    std::unordered_map<std::string, usize> m_NameIndices;
+    std::vector<StructLayout> m_Structs;
+    std::unordered_map<std::string, usize> m_StructIndices;
+    std::vector<BlockData> m_Blocks;
+    u64 m_NextAddress = 0;
+
+    usize AddType(std::string_view name)
+    {
+        const auto [type, is_new] = m_Types.emplace(std::string(name), m_TypeNames.size());
+        if (is_new)
+        {
+            m_TypeNames.emplace_back(name);
+        }
+        return type->second;
+    }
+
+    usize AddName(std::string_view name)
+    {
+        const auto [index, is_new] = m_NameIndices.emplace(std::string(name), m_Names.size());
+        if (is_new)
+        {
+            m_Names.emplace_back(name);
+        }
+        return index->second;
+    }
+
+    [[nodiscard]] const StructLayout& GetStruct(std::string_view struct_name) const
+    {
+        return m_Structs.at(m_StructIndices.at(std::string(struct_name)));
+    }
+
+    [[nodiscard]] static std::string GetFieldName(std::string_view name)
+    {
+        std::string result;
+        for (const char chr : name.substr(0, name.find('[')))
+        {
+            if (chr != '*' && chr != '(' && chr != ')')
+            {
+                result += chr;
+            }
+        }
+        return result;
+    }
+
+    [[nodiscard]] usize GetFieldSize(std::string_view type, std::string_view name) const
+    {
+        usize count = 1;
+        for (usize begin = name.find('['); begin != std::string_view::npos; begin = name.find('[', begin + 1))
+        {
+            count *= std::stoul(std::string(name.substr(begin + 1, name.find(']', begin) - begin - 1)));
+        }
+
+        const bool is_pointer = name.starts_with('*') || name.starts_with('(');
+        return count * (is_pointer ? sizeof(u64) : m_Sizes.at(m_Types.at(std::string(type))));
+    }
+
+    u64 AddRawBlock(const BlockCode& code, u32 struct_index, std::vector<u8> body, u64 address, u32 count)
+    {
+        if (address == 0)
+        {
+            address = Allocate();
+        }
+
+        m_Blocks.push_back(
+            { .code = code, .address = address, .struct_index = struct_index, .count = count, .body = std::move(body) }
+        );
+        return address;
+    }
+
+    static void
+    AppendBlockHeader(std::vector<u8>& buffer, const BlockCode& code, usize length, u64 address, u32 index, u32 count)
+    {
+        const auto code_bytes = std::bit_cast<std::array<u8, sizeof(BlockCode)>>(code);
+        buffer.insert(buffer.end(), code_bytes.begin(), code_bytes.end());
+        AppendValue(buffer, u32(length));
+        AppendValue(buffer, address);
+        AppendValue(buffer, index);
+        AppendValue(buffer, count);
+    }
+
+    template<class T>
+    static void AppendValue(std::vector<u8>& buffer, const T& value)
+    {
+        const auto bytes = std::bit_cast<std::array<u8, sizeof(T)>>(value);
+        buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+    }
+
+    static void AppendStrings(std::vector<u8>& buffer, std::string_view code, const std::vector<std::string>& strings)
+    {
+        buffer.insert(buffer.end(), code.begin(), code.end());
+        AppendValue(buffer, u32(strings.size()));
+        for (const auto& string : strings)
+        {
+            buffer.insert(buffer.end(), string.begin(), string.end());
+            buffer.push_back(0);
+        }
+        AlignBuffer(buffer);
+    }
+
+    static void AlignBuffer(std::vector<u8>& buffer)
+    {
+        while (buffer.size() % 4 != 0)
+        {
+            buffer.push_back(0);
+        }
+    }
+
+    [[nodiscard]] std::vector<u8> BuildSdna() const
+    {
+        const std::string_view code = "SDNA";
+        std::vector<u8> sdna(code.begin(), code.end());
+        AppendStrings(sdna, "NAME", m_Names);
+        AppendStrings(sdna, "TYPE", m_TypeNames);
+
+        const std::string_view lengths = "TLEN";
+        sdna.insert(sdna.end(), lengths.begin(), lengths.end());
+        for (usize type = 0; type < m_TypeNames.size(); ++type)
+        {
+            const auto size = m_Sizes.find(type);
+            AppendValue(sdna, size == m_Sizes.end() ? u16(0) : size->second);
+        }
+        AlignBuffer(sdna);
+
+        const std::string_view structs = "STRC";
+        sdna.insert(sdna.end(), structs.begin(), structs.end());
+        AppendValue(sdna, u32(m_Structs.size()));
+        for (const auto& layout : m_Structs)
+        {
+            AppendValue(sdna, u16(layout.type));
+            AppendValue(sdna, u16(layout.fields.size()));
+            for (const auto& [type, name] : layout.fields)
+            {
+                AppendValue(sdna, u16(type));
+                AppendValue(sdna, u16(name));
+            }
+        }
+        return sdna;
+    }
+};
+} // namespace cblend
@@ -0,0 +1,128 @@
+#include "blend_builder.hpp"
+#include "synthetic_sdna.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cblend_codegen.hpp>
+
+#include <array>
+#include <fstream>
+#include <sstream>
+
+using namespace cblend;
+
+struct MismatchedObject
+{
+    static constexpr u64 SDNA_HASH = 0;
+    static constexpr std::string_view SDNA_NAME = "Object";
+};
+
+// Layouts of synthetic_sdna.hpp, which is regenerated with GenerateHeader(blend, { .namespace_name = "synthetic" })
+[[nodiscard]] BlendBuilder CreateSyntheticBuilder()
+{
+    BlendBuilder builder;
+    builder.AddStruct("Vec", { { "float", "co[3]" } });
+    // Keyword and struct named fields have to be renamed, and the short before value forces a packed layout
+    builder.AddStruct(
+        "Thing",
+        {
+            { "int", "class" },
+            { "short", "Thing" },
+            { "int", "value" },
+            { "Vec", "Vec" },
+            { "float", "matrix[2][2]" },
+            { "Thing", "*next" },
+        }
+    );
+    builder.AddStruct("Aligned", { { "int", "new" }, { "int", "count" }, { "Thing", "*thing" } });
+    return builder;
+}
+
+// NOLINTBEGIN
+TEST_CASE("generated headers view matching blocks", "[codegen]")
+// NOLINTEND
+{
+    auto builder = CreateSyntheticBuilder();
+    auto things = builder.MakeStruct("Thing", 2);
+    const usize thing_size = builder.GetSize("Thing");
+    for (usize thing = 0; thing < 2; ++thing)
+    {
+        const usize offset = thing * thing_size;
+        BlendBuilder::Write(things, offset + builder.GetOffset("Thing", "class"), s32(thing + 1));
+        BlendBuilder::Write(things, offset + builder.GetOffset("Thing", "Thing"), s16(-2));
+        BlendBuilder::Write(things, offset + builder.GetOffset("Thing", "value"), s32(1000 * thing));
+        BlendBuilder::Write(things, offset + builder.GetOffset("Thing", "Vec"), std::array<f32, 3>{ 1.F, 2.F, f32(thing) });
+        BlendBuilder::Write(things, offset + builder.GetOffset("Thing", "matrix"), std::array<f32, 4>{ 0.F, 1.F, 2.F, 3.F });
+        BlendBuilder::Write(things, offset + builder.GetOffset("Thing", "next"), 0xABC0 + thing);
+    }
+    const u64 things_address = builder.AddBlock(BLOCK_CODE_DATA, "Thing", std::move(things));
+
+    auto aligned = builder.MakeStruct("Aligned");
+    builder.Set(aligned, "Aligned", "new", 7);
+    builder.Set(aligned, "Aligned", "thing", things_address);
+    builder.AddBlock(BLOCK_CODE_DATA, "Aligned", std::move(aligned));
+
+    const auto buffer = builder.Build();
+    const auto blend = Blend::Read(buffer);
+    REQUIRE(blend);
+
+    SECTION("the checked in header matches the generator")
+    {
+        std::ifstream file("synthetic_sdna.hpp", std::ios::binary);
+        REQUIRE(file);
+        std::stringstream expected;
+        expected << file.rdbuf();
+        REQUIRE(GenerateHeader(*blend, { .namespace_name = "synthetic" }).value() == expected.str());
+    }
+
+    SECTION("blocks are viewed as the generated structs")
+    {
+        const auto thing_block = blend->GetBlockAt(things_address);
+        REQUIRE(thing_block);
+        const auto view = ViewBlock<synthetic::Thing>(*blend, *thing_block);
+        REQUIRE(view);
+        REQUIRE(view->size() == 2);
+        for (usize thing = 0; thing < 2; ++thing)
+        {
+            const auto& value = (*view)[thing];
+            REQUIRE(value.class_ == s32(thing + 1));
+            REQUIRE(value.Thing_ == -2);
+            REQUIRE(value.value == s32(1000 * thing));
+            REQUIRE(value.Vec.co[2] == f32(thing));
+            REQUIRE(value.matrix[1][0] == 2.F);
+            REQUIRE(value.next == 0xABC0 + thing);
+        }
+
+        REQUIRE(!ViewBlock<synthetic::Aligned>(*blend, *thing_block));
+        for (const auto& block : blend->GetBlocks(*blend->GetType("Aligned")))
+        {
+            const auto aligned_view = ViewBlock<synthetic::Aligned>(*blend, block);
+            REQUIRE(aligned_view);
+            REQUIRE(aligned_view->front().new_ == 7);
+            REQUIRE(aligned_view->front().thing == things_address);
+        }
+    }
+}
+
+// NOLINTBEGIN
+TEST_CASE("headers can be generated", "[default]")
+// NOLINTEND
+{
+    auto blend = Blend::Open("default.blend");
+    REQUIRE(blend);
+
+    const auto header = GenerateHeader(*blend, { .struct_names = { "Object" } });
+    REQUIRE(header);
+    REQUIRE(header->find("struct Object\n") != std::string::npos);
+    REQUIRE(header->find("struct ID\n") < header->find("struct Object\n"));
+    const auto size_assert = "static_assert(sizeof(Object) == " + std::to_string(blend->GetType("Object")->GetSize()) + ");";
+    REQUIRE(header->find(size_assert) != std::string::npos);
+    REQUIRE(header->find("struct Mesh\n") == std::string::npos);
+
+    REQUIRE(GenerateHeader(*blend, { .struct_names = { "NotAStruct" } }).error() == CodegenError::StructNotFound);
+    REQUIRE(GenerateHeader(*blend, { .namespace_name = "not a namespace" }).error() == CodegenError::InvalidNamespace);
+
+    for (const auto& block : blend->GetBlocks(BLOCK_CODE_OB))
+    {
+        REQUIRE(!ViewBlock<MismatchedObject>(*blend, block));
+    }
+}
@@ -0,0 +1,363 @@
+#include "blend_builder.hpp"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cblend_curve.hpp>
+
+#include <cmath>
+
+using namespace cblend;
+
+void AddSpline(Splines& splines, SplineType type, std::initializer_list<Float3> positions, bool cyclic = false, u8 order = 4)
+{
+    if (splines.point_offsets.empty())
+    {
+        splines.point_offsets.push_back(0);
+    }
+
+    splines.types.push_back(type);
+    splines.cyclic.push_back(u8(cyclic));
+    splines.resolutions.push_back(4);
+    splines.orders.push_back(order);
+    splines.knots_modes.push_back(KnotsMode::Endpoint);
+    splines.positions.insert(splines.positions.end(), positions);
+    splines.handles_left.insert(splines.handles_left.end(), positions);
+    splines.handles_right.insert(splines.handles_right.end(), positions);
+    splines.point_offsets.push_back(u32(splines.positions.size()));
+}
+
+[[nodiscard]] bool IsNear(const Float3& lhs, const Float3& rhs)
+{
+    return lhs[0] == Catch::Approx(rhs[0]).margin(1e-5) && lhs[1] == Catch::Approx(rhs[1]).margin(1e-5)
+        && lhs[2] == Catch::Approx(rhs[2]).margin(1e-5);
+}
+
+// NOLINTBEGIN
+TEST_CASE("splines can be tessellated", "[curve]")
+// NOLINTEND
+{
+    SECTION("bezier segments follow their handles")
+    {
+        Splines splines;
+        AddSpline(splines, SplineType::Bezier, { Float3{ 0.F, 0.F, 0.F }, Float3{ 3.F, 0.F, 0.F } });
+        splines.handles_right[0] = { 1.F, 1.F, 0.F };
+        splines.handles_left[1] = { 2.F, 1.F, 0.F };
+        splines.radii = { 1.F, 3.F };
+
+        const auto result = TessellateSplines(splines, {});
+        REQUIRE(result.offsets == std::vector<u32>{ 0, 5 });
+        REQUIRE(IsNear(result.positions[0], Float3{ 0.F, 0.F, 0.F }));
+        REQUIRE(IsNear(result.positions[2], Float3{ 1.5F, 0.75F, 0.F }));
+        REQUIRE(IsNear(result.positions[4], Float3{ 3.F, 0.F, 0.F }));
+        REQUIRE(result.radii[2] == Catch::Approx(2.F));
+    }
+
+    SECTION("catmull-rom splines pass through their points")
+    {
+        Splines splines;
+        AddSpline(
+            splines,
+            SplineType::CatmullRom,
+            { Float3{ 0.F, 0.F, 0.F }, Float3{ 1.F, 1.F, 0.F }, Float3{ 2.F, 0.F, 0.F }, Float3{ 3.F, 1.F, 0.F } },
+            true
+        );
+
+        const auto result = TessellateSplines(splines, {});
+        REQUIRE(result.positions.size() == 16);
+        for (usize point = 0; point < 4; ++point)
+        {
+            REQUIRE(IsNear(result.positions[point * 4], splines.positions[point]));
+        }
+    }
+
+    SECTION("endpoint nurbs match their bezier equivalent")
+    {
+        Splines splines;
+        AddSpline(splines, SplineType::Nurbs, { Float3{ 0.F, 0.F, 0.F }, Float3{ 1.F, 2.F, 0.F }, Float3{ 2.F, 0.F, 0.F } }, false, 3);
+
+        const auto result = TessellateSplines(splines, {});
+        REQUIRE(result.positions.size() == 8);
+        REQUIRE(IsNear(result.positions.front(), splines.positions.front()));
+        REQUIRE(IsNear(result.positions.back(), splines.positions.back()));
+
+        // Eight samples over a single span, t = 3/7
+        const f32 t = 3.F / 7.F;
+        const f32 s = 1.F - t;
+        REQUIRE(IsNear(result.positions[3], Float3{ 2.F * s * t + 2.F * t * t, 4.F * s * t, 0.F }));
+    }
+
+    SECTION("cyclic nurbs start on the uniform b-spline average")
+    {
+        Splines splines;
+        AddSpline(
+            splines,
+            SplineType::Nurbs,
+            {
+                Float3{ 0.F, 0.F, 0.F },
+                Float3{ 6.F, 0.F, 0.F },
+                Float3{ 6.F, 6.F, 0.F },
+                Float3{ 0.F, 6.F, 0.F },
+                Float3{ -6.F, 3.F, 0.F },
+            },
+            true
+        );
+        splines.knots_modes.back() = KnotsMode::Normal;
+
+        const auto result = TessellateSplines(splines, {});
+        REQUIRE(result.positions.size() == 20);
+        REQUIRE(IsNear(result.positions[0], Float3{ 5.F, 1.F, 0.F }));
+        REQUIRE(IsNear(result.positions[4], Float3{ 5.F, 5.F, 0.F }));
+    }
+
+    SECTION("bezier knots evaluate the inner cubic segment")
+    {
+        Splines splines;
+        AddSpline(
+            splines,
+            SplineType::Nurbs,
+            {
+                Float3{ 0.F, 0.F, 0.F },
+                Float3{ 1.F, 0.F, 0.F },
+                Float3{ 2.F, 2.F, 0.F },
+                Float3{ 3.F, 2.F, 0.F },
+                Float3{ 4.F, 0.F, 0.F },
+                Float3{ 5.F, 0.F, 0.F },
+                Float3{ 6.F, 0.F, 0.F },
+            }
+        );
+        splines.knots_modes.back() = KnotsMode::Bezier;
+
+        // Knots 0 0 1 1 1 2 2 2 3 3 3 leave a single span between the repeated knots at 1 and 2
+        const auto result = TessellateSplines(splines, {});
+        REQUIRE(result.positions.size() == 24);
+        REQUIRE(IsNear(result.positions.front(), splines.positions[1]));
+        REQUIRE(IsNear(result.positions.back(), splines.positions[4]));
+
+        const f32 t = 12.F / 23.F;
+        const f32 s = 1.F - t;
+        REQUIRE(IsNear(result.positions[12], Float3{ 1.F + 3.F * t, 6.F * s * t, 0.F }));
+    }
+
+    SECTION("endpoint bezier knots end on the last span with a length")
+    {
+        Splines splines;
+        AddSpline(
+            splines,
+            SplineType::Nurbs,
+            { Float3{ 0.F, 0.F, 0.F }, Float3{ 1.F, 2.F, 0.F }, Float3{ 2.F, 0.F, 0.F }, Float3{ 3.F, 2.F, 0.F } },
+            false,
+            3
+        );
+        splines.knots_modes.back() = KnotsMode::EndpointBezier;
+
+        // Knots 0 0 0 1 1 1 1 only give the first three points a span
+        const auto result = TessellateSplines(splines, {});
+        REQUIRE(result.positions.size() == 12);
+        REQUIRE(IsNear(result.positions.front(), splines.positions[0]));
+        REQUIRE(IsNear(result.positions.back(), splines.positions[2]));
+        for (const auto& position : result.positions)
+        {
+            REQUIRE((std::isfinite(position[0]) && std::isfinite(position[1]) && std::isfinite(position[2])));
+        }
+    }
+
+    SECTION("bezier knots without a full span fall back to the control polygon")
+    {
+        Splines splines;
+        AddSpline(
+            splines,
+            SplineType::Nurbs,
+            { Float3{ 0.F, 0.F, 0.F }, Float3{ 1.F, 2.F, 0.F }, Float3{ 2.F, 0.F, 0.F }, Float3{ 3.F, 2.F, 0.F } }
+        );
+        splines.knots_modes.back() = KnotsMode::Bezier;
+
+        const auto result = TessellateSplines(splines, {});
+        REQUIRE(result.positions == splines.positions);
+    }
+
+    SECTION("adaptive resolution depends on curvature")
+    {
+        Splines splines;
+        AddSpline(splines, SplineType::CatmullRom, { Float3{ 0.F, 0.F, 0.F }, Float3{ 1.F, 0.F, 0.F }, Float3{ 2.F, 0.F, 0.F } });
+        AddSpline(splines, SplineType::CatmullRom, { Float3{ 0.F, 0.F, 0.F }, Float3{ 1.F, 1.F, 0.F }, Float3{ 2.F, 0.F, 0.F } });
+        AddSpline(splines, SplineType::Poly, { Float3{ 0.F, 0.F, 0.F }, Float3{ 1.F, 1.F, 0.F } });
+
+        const TessellationSettings settings = { .mode = ResolutionMode::Adaptive, .tolerance = 1e-3F, .max_resolution = 32 };
+        const auto offsets = ComputeEvaluatedOffsets(splines, settings);
+        REQUIRE(offsets[1] - offsets[0] < offsets[2] - offsets[1]);
+        REQUIRE(offsets[3] - offsets[2] == 2);
+
+        std::vector<Float3> positions(offsets.back());
+        REQUIRE(TessellateSplines(splines, settings, offsets, positions, {}));
+        REQUIRE(IsNear(positions[offsets[2] - 1], Float3{ 2.F, 0.F, 0.F }));
+        REQUIRE(IsNear(positions.back(), Float3{ 1.F, 1.F, 0.F }));
+
+        positions.pop_back();
+        REQUIRE(TessellateSplines(splines, settings, offsets, positions, {}).error() == CurveError::InvalidOutputSize);
+    }
+
+    SECTION("offsets have to match the settings")
+    {
+        Splines splines;
+        AddSpline(splines, SplineType::Bezier, { Float3{ 0.F, 0.F, 0.F }, Float3{ 3.F, 0.F, 0.F } });
+        AddSpline(splines, SplineType::Poly, { Float3{ 0.F, 0.F, 0.F }, Float3{ 1.F, 1.F, 0.F } });
+
+        const TessellationSettings coarse = { .mode = ResolutionMode::Fixed, .resolution = 2 };
+        const TessellationSettings fine = { .mode = ResolutionMode::Fixed, .resolution = 32 };
+        const auto offsets = ComputeEvaluatedOffsets(splines, coarse);
+        std::vector<Float3> positions(64);
+        REQUIRE(TessellateSplines(splines, coarse, offsets, positions, {}));
+        REQUIRE(TessellateSplines(splines, fine, offsets, positions, {}).error() == CurveError::InvalidOutputSize);
+
+        const std::vector<u32> decreasing = { 0, 3, 1 };
+        REQUIRE(TessellateSplines(splines, coarse, decreasing, positions, {}).error() == CurveError::InvalidOutputSize);
+    }
+}
+
+void AddCurveStructs(BlendBuilder& builder)
+{
+    builder.AddIdStructs();
+    builder.AddCustomDataStructs();
+    builder.AddStruct(
+        "BezTriple",
+        { { "float", "vec[3][3]" }, { "float", "tilt" }, { "float", "weight" }, { "float", "radius" }, { "char", "f1[4]" } }
+    );
+    builder.AddStruct("BPoint", { { "float", "vec[4]" }, { "float", "tilt" }, { "float", "weight" }, { "float", "radius" } });
+    builder.AddStruct(
+        "Nurb",
+        {
+            { "Nurb", "*next" },
+            { "Nurb", "*prev" },
+            { "short", "type" },
+            { "short", "flag" },
+            { "int", "pntsu" },
+            { "short", "resolu" },
+            { "short", "orderu" },
+            { "short", "flagu" },
+            { "short", "_pad" },
+            { "BPoint", "*bp" },
+            { "BezTriple", "*bezt" },
+        }
+    );
+    builder.AddStruct("Curve", { { "ID", "id" }, { "ListBase", "nurb" }, { "short", "resolu" } });
+    builder.AddStruct(
+        "CurvesGeometry",
+        {
+            { "int", "*curve_offsets" },
+            { "CustomData", "point_data" },
+            { "CustomData", "curve_data" },
+            { "int", "point_num" },
+            { "int", "curve_num" },
+        }
+    );
+    builder.AddStruct("Curves", { { "ID", "id" }, { "CurvesGeometry", "geometry" } });
+}
+
+// NOLINTBEGIN
+TEST_CASE("curves can be extracted", "[curve]")
+// NOLINTEND
+{
+    BlendBuilder builder;
+    AddCurveStructs(builder);
+
+    SECTION("legacy curves read their nurb list")
+    {
+        auto bezier_points = builder.MakeStruct("BezTriple", 2);
+        const usize bezier_size = builder.GetSize("BezTriple");
+        using Handles = std::array<Float3, 3>;
+        BlendBuilder::Write(bezier_points, 0, Handles{ Float3{ -1.F, 1.F, 0.F }, Float3{}, Float3{ 1.F, 1.F, 0.F } });
+        BlendBuilder::Write(bezier_points, bezier_size, Handles{ Float3{ 2.F, 1.F, 0.F }, Float3{ 3.F, 0.F, 0.F }, Float3{} });
+        BlendBuilder::Write(bezier_points, builder.GetOffset("BezTriple", "radius"), 1.F);
+        BlendBuilder::Write(bezier_points, bezier_size + builder.GetOffset("BezTriple", "radius"), 3.F);
+
+        auto nurbs_points = builder.MakeStruct("BPoint", 3);
+        const usize point_size = builder.GetSize("BPoint");
+        for (usize point = 0; point < 3; ++point)
+        {
+            BlendBuilder::Write(nurbs_points, point * point_size, Float4{ f32(point), 1.F, 0.F, 0.5F });
+        }
+
+        const u64 first = builder.Allocate();
+        const u64 second = builder.Allocate();
+        auto bezier = builder.MakeStruct("Nurb");
+        builder.Set(bezier, "Nurb", "next", second);
+        builder.Set(bezier, "Nurb", "type", s16(1));
+        builder.Set(bezier, "Nurb", "pntsu", 2);
+        builder.Set(bezier, "Nurb", "resolu", s16(4));
+        builder.Set(bezier, "Nurb", "bezt", builder.AddBlock(BLOCK_CODE_DATA, "BezTriple", bezier_points));
+        builder.AddBlock(BLOCK_CODE_DATA, "Nurb", bezier, first);
+
+        auto nurbs = builder.MakeStruct("Nurb");
+        builder.Set(nurbs, "Nurb", "prev", first);
+        builder.Set(nurbs, "Nurb", "type", s16(4));
+        builder.Set(nurbs, "Nurb", "pntsu", 3);
+        builder.Set(nurbs, "Nurb", "orderu", s16(3));
+        builder.Set(nurbs, "Nurb", "flagu", s16(2));
+        builder.Set(nurbs, "Nurb", "bp", builder.AddBlock(BLOCK_CODE_DATA, "BPoint", nurbs_points));
+        builder.AddBlock(BLOCK_CODE_DATA, "Nurb", nurbs, second);
+
+        auto curve = builder.MakeStruct("Curve");
+        builder.Set(curve, "Curve", "nurb", std::array<u64, 2>{ first, second });
+        builder.Set(curve, "Curve", "resolu", s16(6));
+        builder.AddBlock(BLOCK_CODE_CU, "Curve", curve);
+
+        const auto buffer = builder.Build();
+        const auto blend = Blend::Read(buffer);
+        REQUIRE(blend);
+
+        const auto splines = ExtractCurveSplines(*blend, *blend->GetBlock(BLOCK_CODE_CU));
+        REQUIRE(splines);
+        REQUIRE(splines->types == std::vector<SplineType>{ SplineType::Bezier, SplineType::Nurbs });
+        REQUIRE(splines->point_offsets == std::vector<u32>{ 0, 2, 5 });
+        REQUIRE(splines->resolutions == std::vector<u32>{ 4, 6 });
+        REQUIRE(splines->knots_modes == std::vector<KnotsMode>{ KnotsMode::Normal, KnotsMode::Endpoint });
+        REQUIRE(splines->orders[1] == 3);
+        REQUIRE(IsNear(splines->handles_left[0], Float3{ -1.F, 1.F, 0.F }));
+        REQUIRE(IsNear(splines->positions[1], Float3{ 3.F, 0.F, 0.F }));
+        REQUIRE(IsNear(splines->positions[4], Float3{ 2.F, 1.F, 0.F }));
+        REQUIRE(splines->radii[1] == 3.F);
+        REQUIRE(splines->weights[4] == 0.5F);
+    }
+
+    SECTION("curves read their generic attributes")
+    {
+        const u64 positions = builder.AddValues<Float3>(
+            { Float3{ 0.F, 0.F, 0.F }, Float3{ 1.F, 1.F, 0.F }, Float3{ 2.F, 0.F, 0.F }, Float3{ 0.F, 0.F, 1.F }, Float3{ 1.F, 0.F, 1.F } }
+        );
+        const u64 types = builder.AddValues<s8>({ 0, 1 });
+        const u64 resolutions = builder.AddValues<s32>({ 2, 12 });
+
+        auto geometry = builder.MakeStruct("CurvesGeometry");
+        builder.Set(geometry, "CurvesGeometry", "curve_offsets", builder.AddValues<s32>({ 0, 3, 5 }));
+        builder.Set(geometry, "CurvesGeometry", "point_num", 5);
+        builder.Set(geometry, "CurvesGeometry", "curve_num", 2);
+
+        const auto point_data = builder.MakeCustomData({ { .type = 48, .name = "position", .address = positions } });
+        const auto curve_data = builder.MakeCustomData(
+            { { .type = 45, .name = "curve_type", .address = types }, { .type = 11, .name = "resolution", .address = resolutions } }
+        );
+        std::copy(point_data.begin(), point_data.end(), geometry.begin() + ssize(builder.GetOffset("CurvesGeometry", "point_data")));
+        std::copy(curve_data.begin(), curve_data.end(), geometry.begin() + ssize(builder.GetOffset("CurvesGeometry", "curve_data")));
+
+        auto curves = builder.MakeStruct("Curves");
+        std::copy(geometry.begin(), geometry.end(), curves.begin() + ssize(builder.GetOffset("Curves", "geometry")));
+        builder.AddBlock(BLOCK_CODE_CV, "Curves", curves);
+
+        const auto buffer = builder.Build();
+        const auto blend = Blend::Read(buffer);
+        REQUIRE(blend);
+
+        const auto splines = ExtractCurvesSplines(*blend, *blend->GetBlock(BLOCK_CODE_CV));
+        REQUIRE(splines);
+        REQUIRE(splines->types == std::vector<SplineType>{ SplineType::CatmullRom, SplineType::Poly });
+        REQUIRE(splines->point_offsets == std::vector<u32>{ 0, 3, 5 });
+        REQUIRE(splines->resolutions == std::vector<u32>{ 2, 12 });
+        REQUIRE(splines->orders == std::vector<u8>{ 4, 4 });
+        REQUIRE(IsNear(splines->positions[4], Float3{ 1.F, 0.F, 1.F }));
+        REQUIRE(IsNear(splines->handles_right[1], Float3{ 1.F, 1.F, 0.F }));
+        REQUIRE(splines->radii == std::vector<f32>(5, 1.F));
+
+        const auto tessellated = TessellateSplines(*splines, {});
+        REQUIRE(tessellated.offsets == std::vector<u32>{ 0, 5, 7 });
+    }
+}
@@ -0,0 +1,565 @@
+#include "blend_builder.hpp"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cblend_bvh.hpp>
+#include <cblend_mesh.hpp>
+#include <cblend_pack.hpp>
+#include <cblend_shape_key.hpp>
+#include <cblend_simd.hpp>
+#include <cblend_weld.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+using namespace cblend;
+
+[[nodiscard]] Mesh CreateCube()
+{
+    Mesh mesh;
+    mesh.positions = {
+        Float3{ -1.F, -1.F, -1.F }, Float3{ 1.F, -1.F, -1.F }, Float3{ 1.F, 1.F, -1.F }, Float3{ -1.F, 1.F, -1.F },
+        Float3{ -1.F, -1.F, 1.F },  Float3{ 1.F, -1.F, 1.F },  Float3{ 1.F, 1.F, 1.F },  Float3{ -1.F, 1.F, 1.F },
+    };
+    mesh.corner_verts = {
+        0, 3, 2, 1, // -Z
+        4, 5, 6, 7, // +Z
+        0, 1, 5, 4, // -Y
+        2, 3, 7, 6, // +Y
+        0, 4, 7, 3, // -X
+        1, 2, 6, 5, // +X
+    };
+    mesh.face_offsets = { 0, 4, 8, 12, 16, 20, 24 };
+    return mesh;
+}
+
+[[nodiscard]] bool IsApprox(const Float3& lhs, const Float3& rhs)
+{
+    return lhs[0] == Catch::Approx(rhs[0]).margin(1e-5) && lhs[1] == Catch::Approx(rhs[1]).margin(1e-5)
+        && lhs[2] == Catch::Approx(rhs[2]).margin(1e-5);
+}
+
+// NOLINTBEGIN
+TEST_CASE("mesh normals can be computed", "[mesh]")
+// NOLINTEND
+{
+    auto mesh = CreateCube();
+    static const std::array<Float3, 6> EXPECTED_FACE_NORMALS = {
+        Float3{ 0.F, 0.F, -1.F }, Float3{ 0.F, 0.F, 1.F }, Float3{ 0.F, -1.F, 0.F },
+        Float3{ 0.F, 1.F, 0.F },  Float3{ -1.F, 0.F, 0.F }, Float3{ 1.F, 0.F, 0.F },
+    };
+
+    SECTION("face normals point outwards")
+    {
+        const auto face_normals = ComputeFaceNormals(mesh);
+        REQUIRE(face_normals.size() == 6);
+        for (usize face = 0; face < face_normals.size(); ++face)
+        {
+            REQUIRE(IsApprox(face_normals[face], EXPECTED_FACE_NORMALS[face]));
+        }
+    }
+
+    SECTION("vertex normals are angle weighted")
+    {
+        const auto normals = ComputeNormals(mesh);
+        REQUIRE(normals.vertex_normals.size() == 8);
+        for (usize vertex = 0; vertex < mesh.positions.size(); ++vertex)
+        {
+            REQUIRE(IsApprox(normals.vertex_normals[vertex], Normalize(mesh.positions[vertex])));
+        }
+
+        // Without sharp edges every corner shares its vertex normal
+        for (usize corner = 0; corner < mesh.GetCornerCount(); ++corner)
+        {
+            REQUIRE(IsApprox(normals.corner_normals[corner], normals.vertex_normals[mesh.corner_verts[corner]]));
+        }
+    }
+
+    SECTION("sharp faces and auto smooth split corner normals")
+    {
+        mesh.auto_smooth_angle = std::numbers::pi_v<f32> / 6.F;
+        const auto normals = ComputeNormals(mesh);
+        for (usize corner = 0; corner < mesh.GetCornerCount(); ++corner)
+        {
+            REQUIRE(IsApprox(normals.corner_normals[corner], EXPECTED_FACE_NORMALS[corner / 4]));
+        }
+
+        mesh.auto_smooth_angle = NULL_OPTION;
+        mesh.sharp_faces = { 1, 0, 0, 0, 0, 0 };
+        const auto sharp_normals = ComputeNormals(mesh);
+        REQUIRE(IsApprox(sharp_normals.corner_normals[0], EXPECTED_FACE_NORMALS[0]));
+        REQUIRE(IsApprox(sharp_normals.corner_normals[8], Normalize(Float3{ -1.F, -1.F, 0.F })));
+        REQUIRE(IsApprox(sharp_normals.corner_normals[4], sharp_normals.vertex_normals[4]));
+    }
+
+    SECTION("sharp edges split corner normals")
+    {
+        // Edges 0-1 and 0-3 cut the -Z face away from the rest of vertex 0's fan
+        mesh.edges = {
+            { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 }, { 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 }, { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 },
+        };
+        mesh.corner_edges = { 3, 2, 1, 0, 4, 5, 6, 7, 0, 9, 4, 8, 2, 11, 6, 10, 8, 7, 11, 3, 1, 10, 5, 9 };
+        mesh.sharp_edges.assign(mesh.edges.size(), 0U);
+        mesh.sharp_edges[0] = 1U;
+        mesh.sharp_edges[3] = 1U;
+
+        const auto normals = ComputeNormals(mesh);
+        // Corner 0 is vertex 0 on -Z, corner 8 is vertex 0 on -Y, corner 16 is vertex 0 on -X
+        REQUIRE(IsApprox(normals.corner_normals[0], EXPECTED_FACE_NORMALS[0]));
+        REQUIRE(IsApprox(normals.corner_normals[8], Normalize(Float3{ -1.F, -1.F, 0.F })));
+        REQUIRE(IsApprox(normals.corner_normals[16], normals.corner_normals[8]));
+        REQUIRE(IsApprox(normals.corner_normals[5], normals.vertex_normals[5]));
+    }
+}
+
+// NOLINTBEGIN
+TEST_CASE("polygon normals handle mixed face sizes", "[mesh]")
+// NOLINTEND
+{
+    Mesh mesh;
+    mesh.positions = { Float3{ 0.F, 0.F, 0.F }, Float3{ 1.F, 0.F, 0.F }, Float3{ 2.F, 1.F, 0.F },
+                       Float3{ 1.F, 2.F, 0.F }, Float3{ 0.F, 1.F, 0.F }, Float3{ 0.F, 0.F, 1.F } };
+    mesh.corner_verts = { 0, 1, 2, 3, 4, 0, 5, 1 };
+    mesh.face_offsets = { 0, 5, 8 };
+
+    const auto face_normals = ComputeFaceNormals(mesh);
+    REQUIRE(IsApprox(face_normals[0], Float3{ 0.F, 0.F, 1.F }));
+    REQUIRE(IsApprox(face_normals[1], Float3{ 0.F, 1.F, 0.F }));
+
+    const auto vertex_normals = ComputeVertexNormals(mesh, face_normals);
+    REQUIRE(IsApprox(vertex_normals[3], Float3{ 0.F, 0.F, 1.F }));
+    REQUIRE(IsApprox(vertex_normals[5], Float3{ 0.F, 1.F, 0.F }));
+}
+
+// NOLINTBEGIN
+TEST_CASE("mesh corners can be welded", "[mesh]")
+// NOLINTEND
+{
+    auto mesh = CreateCube();
+    const auto corner_verts = std::as_bytes(std::span(mesh.corner_verts));
+    const auto as_stream = [](auto bytes, usize element_size)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return AttributeStream{ MemorySpan(reinterpret_cast<const u8*>(bytes.data()), bytes.size()), element_size };
+    };
+
+    SECTION("smooth corners collapse onto their vertices")
+    {
+        const auto normals = ComputeNormals(mesh);
+        const std::array streams = {
+            as_stream(corner_verts, sizeof(u32)),
+            as_stream(std::as_bytes(std::span(normals.corner_normals)), sizeof(Float3)),
+        };
+
+        const auto weld = WeldCorners(streams, mesh.GetCornerCount());
+        REQUIRE(weld);
+        REQUIRE(weld->GetVertexCount() == 8);
+        REQUIRE(weld->GetReuseRatio() == Catch::Approx(3.F));
+        for (usize corner = 0; corner < mesh.GetCornerCount(); ++corner)
+        {
+            REQUIRE(mesh.corner_verts[weld->source_corners[weld->indices[corner]]] == mesh.corner_verts[corner]);
+        }
+
+        const auto vertices = GatherVertices(streams[0], *weld);
+        REQUIRE(vertices.size() == 8 * sizeof(u32));
+    }
+
+    SECTION("split corners stay unique")
+    {
+        mesh.auto_smooth_angle = std::numbers::pi_v<f32> / 6.F;
+        const auto normals = ComputeNormals(mesh);
+        const std::array streams = {
+            as_stream(corner_verts, sizeof(u32)),
+            as_stream(std::as_bytes(std::span(normals.corner_normals)), sizeof(Float3)),
+        };
+
+        const auto weld = WeldCorners(streams, mesh.GetCornerCount());
+        REQUIRE(weld);
+        REQUIRE(weld->GetVertexCount() == 24);
+        REQUIRE(weld->GetReuseRatio() == Catch::Approx(1.F));
+    }
+
+    SECTION("large inputs number vertices by first appearance")
+    {
+        static constexpr usize CORNER_COUNT = 50000;
+        static constexpr u16 UNIQUE_COUNT = 1000;
+        std::vector<u16> keys(CORNER_COUNT);
+        for (usize corner = 0; corner < CORNER_COUNT; ++corner)
+        {
+            keys[corner] = u16(corner % UNIQUE_COUNT);
+        }
+
+        const std::array streams = { as_stream(std::as_bytes(std::span(keys)), sizeof(u16)) };
+        const auto weld = WeldCorners(streams, CORNER_COUNT);
+        REQUIRE(weld);
+        REQUIRE(weld->GetVertexCount() == UNIQUE_COUNT);
+        for (usize corner = 0; corner < CORNER_COUNT; ++corner)
+        {
+            REQUIRE(weld->indices[corner] == corner % UNIQUE_COUNT);
+        }
+    }
+
+    SECTION("short streams are rejected")
+    {
+        const std::array streams = { as_stream(corner_verts, sizeof(u32)) };
+        REQUIRE(WeldCorners(streams, mesh.GetCornerCount() + 1).error() == WeldError::StreamTooSmall);
+    }
+}
+
+// NOLINTBEGIN
+TEST_CASE("shape key deltas are sparse", "[mesh]")
+// NOLINTEND
+{
+    std::vector<Float3> basis(37);
+    for (usize vertex = 0; vertex < basis.size(); ++vertex)
+    {
+        basis[vertex] = { f32(vertex), 0.F, 0.F };
+    }
+
+    auto key = basis;
+    key[2][1] += 1.F;
+    key[19][2] -= 0.5F;
+    key[36][0] += 0.001F;
+
+    std::vector<u32> indices;
+    std::vector<Float3> deltas;
+    EncodeShapeKeyDeltas(basis, key, 0.F, indices, deltas);
+    REQUIRE(indices == std::vector<u32>{ 2, 19, 36 });
+    REQUIRE(IsApprox(deltas[1], Float3{ 0.F, 0.F, -0.5F }));
+
+    indices.clear();
+    deltas.clear();
+    EncodeShapeKeyDeltas(basis, key, 0.01F, indices, deltas);
+    REQUIRE(indices == std::vector<u32>{ 2, 19 });
+    REQUIRE(IsApprox(deltas[0], Float3{ 0.F, 1.F, 0.F }));
+}
+
+// Key blocks Smile, Basis and Frown where refkey picks the second one, Frown moves relative to Smile
+[[nodiscard]] std::vector<u8> CreateShapeKeyFile(usize vertex_count, usize frown_vertex_count)
+{
+    BlendBuilder builder;
+    builder.AddIdStructs();
+    builder.AddStruct(
+        "KeyBlock",
+        {
+            { "KeyBlock", "*next" },
+            { "KeyBlock", "*prev" },
+            { "float", "pos" },
+            { "float", "curval" },
+            { "short", "type" },
+            { "short", "_pad1" },
+            { "short", "relative" },
+            { "short", "flag" },
+            { "int", "totelem" },
+            { "int", "uid" },
+            { "void", "*data" },
+            { "char", "name[64]" },
+        }
+    );
+    builder.AddStruct(
+        "Key",
+        {
+            { "ID", "id" },
+            { "KeyBlock", "*refkey" },
+            { "char", "elemstr[32]" },
+            { "int", "elemsize" },
+            { "int", "_pad" },
+            { "ListBase", "block" },
+            { "int", "totkey" },
+        }
+    );
+    builder.AddStruct("Mesh", { { "ID", "id" }, { "Key", "*key" } });
+
+    std::vector<Float3> basis(vertex_count);
+    for (usize vertex = 0; vertex < basis.size(); ++vertex)
+    {
+        basis[vertex] = { f32(vertex), 0.F, 0.F };
+    }
+
+    auto smile = basis;
+    smile[3][1] += 1.F;
+    smile[17][2] += 0.001F;
+    auto frown = smile;
+    frown[20] = { 20.F, 2.F, 2.F };
+    frown.resize(frown_vertex_count);
+
+    const std::array<std::string_view, 3> names = { "Smile", "Basis", "Frown" };
+    const std::array<const std::vector<Float3>*, 3> positions = { &smile, &basis, &frown };
+    const std::array<s16, 3> relative_keys = { 1, 1, 0 };
+    const std::array<u64, 3> addresses = { builder.Allocate(), builder.Allocate(), builder.Allocate() };
+
+    for (usize index = 0; index < names.size(); ++index)
+    {
+        const auto& key_positions = *positions[index];
+        std::vector<u8> data(key_positions.size() * sizeof(Float3));
+        std::memcpy(data.data(), key_positions.data(), data.size());
+
+        auto key_block = builder.MakeStruct("KeyBlock");
+        builder.Set(key_block, "KeyBlock", "next", index + 1 < addresses.size() ? addresses[index + 1] : u64(0));
+        builder.Set(key_block, "KeyBlock", "prev", index == 0 ? u64(0) : addresses[index - 1]);
+        builder.Set(key_block, "KeyBlock", "curval", 0.25F * f32(index + 1));
+        builder.Set(key_block, "KeyBlock", "relative", relative_keys[index]);
+        builder.Set(key_block, "KeyBlock", "totelem", s32(key_positions.size()));
+        builder.Set(key_block, "KeyBlock", "data", builder.AddData(std::move(data)));
+        std::memcpy(key_block.data() + builder.GetOffset("KeyBlock", "name"), names[index].data(), names[index].size());
+        builder.AddBlock(BLOCK_CODE_DATA, "KeyBlock", std::move(key_block), addresses[index]);
+    }
+
+    auto key = builder.MakeStruct("Key");
+    builder.SetName(key, "KEKey");
+    builder.Set(key, "Key", "refkey", addresses[1]);
+    builder.Set(key, "Key", "elemsize", s32(sizeof(Float3)));
+    builder.Set(key, "Key", "block", std::array<u64, 2>{ addresses.front(), addresses.back() });
+    builder.Set(key, "Key", "totkey", s32(addresses.size()));
+    const u64 key_address = builder.AddBlock(BLOCK_CODE_KE, "Key", std::move(key));
+
+    auto mesh = builder.MakeStruct("Mesh");
+    builder.SetName(mesh, "MEMesh");
+    builder.Set(mesh, "Mesh", "key", key_address);
+    builder.AddBlock(BLOCK_CODE_ME, "Mesh", std::move(mesh));
+    return builder.Build();
+}
+
+// NOLINTBEGIN
+TEST_CASE("shape keys can be extracted", "[mesh]")
+// NOLINTEND
+{
+    static constexpr usize VERTEX_COUNT = 21;
+
+    SECTION("keys are encoded against the key they are relative to")
+    {
+        const auto buffer = CreateShapeKeyFile(VERTEX_COUNT, VERTEX_COUNT);
+        const auto blend = Blend::Read(buffer);
+        REQUIRE(blend);
+
+        const auto mesh = blend->GetBlock(BLOCK_CODE_ME);
+        REQUIRE(mesh);
+        const auto key = GetShapeKey(*blend, *mesh);
+        REQUIRE(key);
+        REQUIRE(key->header.code == BLOCK_CODE_KE);
+
+        const auto shape_keys = ExtractShapeKeys(*blend, *key, 0.01F);
+        REQUIRE(shape_keys);
+        REQUIRE(shape_keys->names == std::vector<std::string_view>{ "Smile", "Basis", "Frown" });
+        REQUIRE(shape_keys->values == std::vector<f32>{ 0.25F, 0.5F, 0.75F });
+        REQUIRE(shape_keys->relative_keys == std::vector<u32>{ 1, 1, 0 });
+        REQUIRE(shape_keys->FindKey("Frown").value() == 2U);
+
+        // The basis comes from refkey even though it is not the first key block
+        REQUIRE(shape_keys->GetVertexCount() == VERTEX_COUNT);
+        REQUIRE(IsApprox(shape_keys->basis[3], Float3{ 3.F, 0.F, 0.F }));
+
+        // Frown only keeps the vertex it moves on top of Smile, the basis itself has no deltas
+        REQUIRE(shape_keys->delta_offsets == std::vector<u32>{ 0, 1, 1, 2 });
+        REQUIRE(shape_keys->delta_indices == std::vector<u32>{ 3, 20 });
+        REQUIRE(IsApprox(shape_keys->deltas[0], Float3{ 0.F, 1.F, 0.F }));
+        REQUIRE(IsApprox(shape_keys->deltas[1], Float3{ 0.F, 2.F, 2.F }));
+    }
+
+    SECTION("keys have to match the vertex count of the basis")
+    {
+        const auto buffer = CreateShapeKeyFile(VERTEX_COUNT, VERTEX_COUNT - 1);
+        const auto blend = Blend::Read(buffer);
+        REQUIRE(blend);
+
+        const auto key = blend->GetBlock(BLOCK_CODE_KE);
+        REQUIRE(key);
+        REQUIRE(ExtractShapeKeys(*blend, *key).error() == ShapeKeyError::MismatchedElementCount);
+    }
+}
+
+// NOLINTBEGIN
+TEST_CASE("vertex attributes can be packed", "[mesh]")
+// NOLINTEND
+{
+    auto mesh = CreateCube();
+    const auto normals = ComputeNormals(mesh);
+    const std::vector<u32> colors(mesh.GetVertexCount(), 0xFF8000FFU);
+
+    const auto as_memory = [](const auto& values)
+    {
+        const auto bytes = std::as_bytes(std::span(values));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return MemorySpan(reinterpret_cast<const u8*>(bytes.data()), bytes.size());
+    };
+
+    const auto color_source = MakeAttributeSource({ .type = CustomDataType::PropByteColor, .data = as_memory(colors) }, colors.size());
+    REQUIRE(color_source);
+    REQUIRE(color_source->format == SourceFormat::Unorm8);
+
+    const AttributeSource position_source = {
+        .data = as_memory(mesh.positions), .stride = sizeof(Float3), .component_count = 3, .indices = mesh.corner_verts
+    };
+    const AttributeSource normal_source = { .data = as_memory(normals.corner_normals), .stride = sizeof(Float3), .component_count = 3 };
+    AttributeSource corner_colors = *color_source;
+    corner_colors.indices = mesh.corner_verts;
+
+    const std::vector<PackedAttribute> attributes = {
+        { .source = position_source, .format = PackedFormat::BoundedSnorm16 },
+        { .source = normal_source, .format = PackedFormat::OctahedralSnorm16 },
+        { .source = corner_colors, .format = PackedFormat::Unorm8 },
+        { .source = position_source, .format = PackedFormat::Float16 },
+    };
+
+    const auto interleaved = PackAttributes(attributes, PackLayout::Interleaved);
+    REQUIRE(interleaved);
+    REQUIRE(interleaved->vertex_count == mesh.GetCornerCount());
+    REQUIRE(interleaved->streams.size() == 1);
+    REQUIRE(interleaved->streams[0].stride == 8 + 4 + 4 + 8);
+    REQUIRE(interleaved->attributes[1].component_count == 2);
+    REQUIRE(interleaved->attributes[0].bounds.min[0] == -1.F);
+    REQUIRE(interleaved->attributes[0].bounds.max[2] == 1.F);
+
+    const auto planar = PackAttributes(attributes, PackLayout::Planar);
+    REQUIRE(planar);
+    REQUIRE(planar->streams.size() == attributes.size());
+
+    for (usize corner = 0; corner < mesh.GetCornerCount(); ++corner)
+    {
+        const u8* vertex = interleaved->streams[0].data.data() + corner * interleaved->streams[0].stride;
+        const auto& position = mesh.positions[mesh.corner_verts[corner]];
+
+        std::array<s16, 3> quantized = {};
+        std::memcpy(quantized.data(), vertex, sizeof(quantized));
+        REQUIRE(std::memcmp(vertex, planar->streams[0].data.data() + corner * planar->streams[0].stride, 6) == 0);
+        for (usize axis = 0; axis < 3; ++axis)
+        {
+            REQUIRE(quantized[axis] == (position[axis] > 0.F ? 32767 : -32767));
+        }
+
+        std::array<s16, 2> octahedral = {};
+        std::memcpy(octahedral.data(), vertex + 8, sizeof(octahedral));
+        Float3 decoded = { f32(octahedral[0]) / 32767.F, f32(octahedral[1]) / 32767.F, 0.F };
+        decoded[2] = 1.F - std::abs(decoded[0]) - std::abs(decoded[1]);
+        if (decoded[2] < 0.F)
+        {
+            const f32 u = decoded[0];
+            decoded[0] = (1.F - std::abs(decoded[1])) * (u >= 0.F ? 1.F : -1.F);
+            decoded[1] = (1.F - std::abs(u)) * (decoded[1] >= 0.F ? 1.F : -1.F);
+        }
+        REQUIRE(Dot(Normalize(decoded), normals.corner_normals[corner]) == Catch::Approx(1.F).margin(1e-4));
+
+        REQUIRE(std::memcmp(vertex + 12, &colors[0], sizeof(u32)) == 0);
+
+        std::array<u16, 3> halves = {};
+        std::memcpy(halves.data(), vertex + 16, sizeof(halves));
+        REQUIRE(halves[0] == (position[0] > 0.F ? 0x3C00 : 0xBC00));
+    }
+
+    REQUIRE(simd::FloatToHalf(65504.F) == 0x7BFF);
+    REQUIRE(simd::FloatToHalf(1e6F) == 0x7C00);
+    REQUIRE(simd::FloatToHalf(5.9604645e-8F) == 0x0001);
+    REQUIRE(simd::FloatToHalf(-0.F) == 0x8000);
+    REQUIRE(simd::FloatToHalf(1.F + 1.F / 2048.F) == 0x3C00);
+
+    AttributeSource mismatched = normal_source;
+    mismatched.data = mismatched.data.subspan(0, sizeof(Float3) * 4);
+    REQUIRE(PackAttributes(std::vector<PackedAttribute>{ attributes[0], { .source = mismatched } }, PackLayout::Planar).error()
+            == PackError::MismatchedElementCount);
+}
+
+// NOLINTBEGIN
+TEST_CASE("mesh triangles can be partitioned into a bvh", "[mesh]")
+// NOLINTEND
+{
+    // A bumpy grid, large enough for the build to fork into parallel subtrees
+    constexpr u32 GRID_SIZE = 96;
+    Mesh mesh;
+    mesh.face_offsets.push_back(0);
+    for (u32 y = 0; y <= GRID_SIZE; ++y)
+    {
+        for (u32 x = 0; x <= GRID_SIZE; ++x)
+        {
+            mesh.positions.push_back({ f32(x), f32(y), std::sin(f32(x * y) * 0.1F) });
+        }
+    }
+
+    for (u32 y = 0; y < GRID_SIZE; ++y)
+    {
+        for (u32 x = 0; x < GRID_SIZE; ++x)
+        {
+            const u32 corner = y * (GRID_SIZE + 1) + x;
+            mesh.corner_verts.insert(mesh.corner_verts.end(), { corner, corner + 1, corner + GRID_SIZE + 2, corner + GRID_SIZE + 1 });
+            mesh.face_offsets.push_back(u32(mesh.corner_verts.size()));
+        }
+    }
+
+    const auto triangles = TriangulateFaces(mesh);
+    REQUIRE(triangles.size() == 2 * GRID_SIZE * GRID_SIZE);
+    REQUIRE(triangles[1] == std::array<u32, 3>{ 0, GRID_SIZE + 2, GRID_SIZE + 1 });
+
+    const auto bvh = BuildBvh(mesh.positions, triangles);
+    REQUIRE(bvh);
+    REQUIRE(bvh->GetPrimitiveCount() == triangles.size());
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    REQUIRE(reinterpret_cast<uintptr_t>(bvh->nodes.data()) % CACHE_LINE_SIZE == 0);
+
+    const auto contains = [](const BvhNode& node, const Float3& point)
+    {
+        return point[0] >= node.min[0] && point[1] >= node.min[1] && point[2] >= node.min[2] && point[0] <= node.max[0]
+            && point[1] <= node.max[1] && point[2] <= node.max[2];
+    };
+
+    std::vector<u32> visits(triangles.size(), 0);
+    for (usize node = 0; node < bvh->GetNodeCount(); node += node == 0 ? 2 : 1)
+    {
+        const auto& current = bvh->nodes[node];
+        if (!current.IsLeaf())
+        {
+            REQUIRE(current.index % 2 == 0);
+            REQUIRE(contains(current, bvh->nodes[current.index].min));
+            REQUIRE(contains(current, bvh->nodes[current.index + 1].max));
+            continue;
+        }
+
+        REQUIRE(current.count <= BvhSettings{}.max_leaf_size);
+        for (u32 primitive = current.index; primitive < current.index + current.count; ++primitive)
+        {
+            const u32 triangle = bvh->primitive_indices[primitive];
+            ++visits[triangle];
+            for (const u32 vertex : triangles[triangle])
+            {
+                REQUIRE(contains(current, mesh.positions[vertex]));
+            }
+        }
+    }
+    REQUIRE(std::all_of(visits.begin(), visits.end(), [](u32 count) { return count == 1; }));
+
+    auto bytes = SerializeBvh(*bvh);
+    const auto restored = DeserializeBvh(bytes);
+    REQUIRE(restored);
+    REQUIRE(restored->primitive_indices == bvh->primitive_indices);
+    REQUIRE(std::memcmp(restored->nodes.data(), bvh->nodes.data(), bvh->GetNodeCount() * sizeof(BvhNode)) == 0);
+    REQUIRE(SerializeBvh(*BuildBvh(mesh.positions, triangles)) == bytes);
+
+    REQUIRE(DeserializeBvh(MemorySpan(bytes).first(bytes.size() - 1)).error() == BvhError::TruncatedData);
+    bytes[0] = 'X';
+    REQUIRE(DeserializeBvh(bytes).error() == BvhError::InvalidHeader);
+    const std::vector<std::array<u32, 3>> invalid = { { 0, 1, u32(mesh.positions.size()) } };
+    REQUIRE(BuildBvh(mesh.positions, invalid).error() == BvhError::InvalidTriangle);
+}
+
+// NOLINTBEGIN
+TEST_CASE("default blend file mesh can be extracted", "[default]")
+// NOLINTEND
+{
+    auto blend = Blend::Open("default.blend");
+    REQUIRE(blend);
+
+    const auto mesh_block = blend->GetBlock(BLOCK_CODE_ME);
+    REQUIRE(mesh_block != NULL_OPTION);
+
+    const auto mesh = ExtractMesh(*blend, *mesh_block);
+    REQUIRE(mesh);
+    REQUIRE(mesh->GetVertexCount() == 8);
+    REQUIRE(mesh->GetFaceCount() == 6);
+    REQUIRE(mesh->GetCornerCount() == 24);
+
+    const auto normals = ComputeNormals(*mesh);
+    for (usize vertex = 0; vertex < mesh->GetVertexCount(); ++vertex)
+    {
+        REQUIRE(IsApprox(normals.vertex_normals[vertex], Normalize(mesh->positions[vertex])));
+    }
+}
@@ -0,0 +1,240 @@
+#include "blend_builder.hpp"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cblend_native.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+
+using namespace cblend;
+
+struct NativeObject
+{
+    std::array<f32, 3> location;
+    std::array<f64, 3> scale;
+    s32 type;
+    u64 parent;
+    std::array<s32, 2> missing;
+};
+
+struct NativeThing
+{
+    std::array<f32, 3> location;
+    s16 type;
+    s16 flag;
+    s64 count;
+    f32 weight;
+    u64 next;
+    std::array<s32, 2> missing;
+};
+
+// NOLINTBEGIN
+TEST_CASE("native structs can be converted from synthetic files", "[native]")
+// NOLINTEND
+{
+    BlendBuilder builder;
+    builder.AddStruct(
+        "Thing",
+        {
+            { "float", "loc[3]" },
+            { "short", "type" },
+            { "short", "flag" },
+            { "int", "count" },
+            { "double", "weight" },
+            { "Thing", "*next" },
+            { "char", "name[8]" },
+        }
+    );
+
+    const usize thing_size = builder.GetSize("Thing");
+    auto things = builder.MakeStruct("Thing", 2);
+    for (usize thing = 0; thing < 2; ++thing)
+    {
+        const usize offset = thing * thing_size;
+        BlendBuilder::Write(things, offset + builder.GetOffset("Thing", "loc"), std::array<f32, 3>{ 1.F, 2.F, f32(thing) });
+        BlendBuilder::Write(things, offset + builder.GetOffset("Thing", "type"), s16(7 + thing));
+        BlendBuilder::Write(things, offset + builder.GetOffset("Thing", "flag"), s16(-1));
+        BlendBuilder::Write(things, offset + builder.GetOffset("Thing", "count"), -100 - s32(thing));
+        BlendBuilder::Write(things, offset + builder.GetOffset("Thing", "weight"), 0.25 + f64(thing));
+        BlendBuilder::Write(things, offset + builder.GetOffset("Thing", "next"), 0x1000 * (thing + 1));
+    }
+    builder.AddBlock(BLOCK_CODE_DATA, "Thing", std::move(things));
+
+    const auto buffer = builder.Build();
+    const auto blend = Blend::Read(buffer);
+    REQUIRE(blend);
+
+    const NativeStruct native = {
+        .name = "Thing",
+        .size = sizeof(NativeThing),
+        .fields = {
+            { .name = "loc", .offset = offsetof(NativeThing, location), .type = GetNativeType<f32>(), .count = 3 },
+            { .name = "type", .offset = offsetof(NativeThing, type), .type = GetNativeType<s16>() },
+            { .name = "flag", .offset = offsetof(NativeThing, flag), .type = GetNativeType<s16>() },
+            { .name = "count", .offset = offsetof(NativeThing, count), .type = GetNativeType<s64>() },
+            { .name = "weight", .offset = offsetof(NativeThing, weight), .type = GetNativeType<f32>() },
+            { .name = "next", .offset = offsetof(NativeThing, next), .type = GetNativeType<u64>() },
+            { .name = "missing", .offset = offsetof(NativeThing, missing), .type = GetNativeType<s32>(), .count = 2 },
+        },
+    };
+
+    SECTION("matching fields are merged and differing fields converted")
+    {
+        const auto plan = CompileCopyPlan(*blend, native);
+        REQUIRE(plan);
+        REQUIRE(plan->steps.size() == 5);
+
+        // loc, type and flag are adjacent on both sides and collapse into one copy
+        REQUIRE(plan->steps[0].operation == CopyOperation::Copy);
+        REQUIRE(plan->steps[0].count == offsetof(NativeThing, count));
+        REQUIRE(plan->steps[1].operation == CopyOperation::Convert);
+        REQUIRE(plan->steps[1].source_type == NativeType::S32);
+        REQUIRE(plan->steps[1].target_type == NativeType::S64);
+        REQUIRE(plan->steps[2].operation == CopyOperation::Convert);
+        REQUIRE(plan->steps[2].source_type == NativeType::F64);
+        REQUIRE(plan->steps[2].target_type == NativeType::F32);
+        REQUIRE(plan->steps[3].operation == CopyOperation::Copy);
+        REQUIRE(plan->steps[3].target_offset == offsetof(NativeThing, next));
+        REQUIRE(plan->steps[4].operation == CopyOperation::Zero);
+        REQUIRE(plan->steps[4].count == sizeof(NativeThing::missing));
+
+        const auto converted = ConvertStructs<NativeThing>(*plan, blend->GetBlock(BLOCK_CODE_DATA)->body);
+        REQUIRE(converted);
+        REQUIRE(converted->size() == 2);
+        for (usize thing = 0; thing < 2; ++thing)
+        {
+            const auto& value = (*converted)[thing];
+            REQUIRE(value.location == std::array<f32, 3>{ 1.F, 2.F, f32(thing) });
+            REQUIRE(value.type == s16(7 + thing));
+            REQUIRE(value.flag == -1);
+            REQUIRE(value.count == -100 - s64(thing));
+            REQUIRE(value.weight == Catch::Approx(0.25 + f64(thing)));
+            REQUIRE(value.next == 0x1000 * (thing + 1));
+            REQUIRE(value.missing == std::array<s32, 2>{ 0, 0 });
+        }
+    }
+
+    SECTION("plans are cached by the contents of the description")
+    {
+        CopyPlanCache cache;
+        const auto plan = cache.GetPlan(*blend, native);
+        REQUIRE(plan);
+
+        const NativeStruct copy = native;
+        REQUIRE(*cache.GetPlan(*blend, copy) == *plan);
+        REQUIRE(cache.GetPlanCount() == 1);
+
+        // A different description constructed at the same address must not reuse the stale plan
+        std::optional<NativeStruct> temporary = native;
+        REQUIRE(*cache.GetPlan(*blend, *temporary) == *plan);
+        temporary.reset();
+        temporary.emplace(NativeStruct{
+            .name = "Thing",
+            .size = sizeof(NativeThing),
+            .fields = { { .name = "count", .offset = offsetof(NativeThing, count), .type = GetNativeType<s64>() } },
+        });
+        const auto other_plan = cache.GetPlan(*blend, *temporary);
+        REQUIRE(other_plan);
+        REQUIRE(*other_plan != *plan);
+        REQUIRE((*other_plan)->steps.size() == 1);
+        REQUIRE(cache.GetPlanCount() == 2);
+    }
+}
+
+struct NativeSwapped
+{
+    s32 integer;
+    f64 real;
+};
+
+// NOLINTBEGIN
+TEST_CASE("byte swapped fields are converted", "[native]")
+// NOLINTEND
+{
+    // Test files are written in the native byte order, so the plan a foreign endian file compiles to is written by hand
+    const CopyPlan plan = {
+        .source_size = 8,
+        .target_size = sizeof(NativeSwapped),
+        .steps = {
+            {
+                .operation = CopyOperation::Convert,
+                .source_type = NativeType::S32,
+                .target_type = NativeType::S32,
+                .is_byte_swapped = true,
+                .source_offset = 0,
+                .target_offset = offsetof(NativeSwapped, integer),
+                .count = 1,
+            },
+            {
+                .operation = CopyOperation::Convert,
+                .source_type = NativeType::F32,
+                .target_type = NativeType::F64,
+                .is_byte_swapped = true,
+                .source_offset = 4,
+                .target_offset = offsetof(NativeSwapped, real),
+                .count = 1,
+            },
+        },
+    };
+
+    std::array<u8, 8> source = std::bit_cast<std::array<u8, 8>>(std::array<s32, 2>{ 0x01020304, std::bit_cast<s32>(-2.5F) });
+    std::reverse(source.begin(), source.begin() + 4);
+    std::reverse(source.begin() + 4, source.end());
+
+    const auto converted = ConvertStructs<NativeSwapped>(plan, source);
+    REQUIRE(converted);
+    REQUIRE(converted->size() == 1);
+    REQUIRE(converted->front().integer == 0x01020304);
+    REQUIRE(converted->front().real == -2.5);
+}
+
+// NOLINTBEGIN
+TEST_CASE("native structs can be converted", "[default]")
+// NOLINTEND
+{
+    auto blend = Blend::Open("default.blend");
+    REQUIRE(blend);
+
+    const NativeStruct native = {
+        .name = "Object",
+        .size = sizeof(NativeObject),
+        .fields = {
+            { .name = "loc", .offset = offsetof(NativeObject, location), .type = GetNativeType<f32>(), .count = 3 },
+            { .name = "scale", .offset = offsetof(NativeObject, scale), .type = GetNativeType<f64>(), .count = 3 },
+            { .name = "type", .offset = offsetof(NativeObject, type), .type = GetNativeType<s32>() },
+            { .name = "parent", .offset = offsetof(NativeObject, parent), .type = GetNativeType<u64>() },
+            { .name = "missing", .offset = offsetof(NativeObject, missing), .type = GetNativeType<s32>(), .count = 2 },
+        },
+    };
+
+    CopyPlanCache cache;
+    const auto plan = cache.GetPlan(*blend, native);
+    REQUIRE(plan);
+    REQUIRE(*cache.GetPlan(*blend, native) == *plan);
+    REQUIRE(cache.GetPlanCount() == 1);
+    REQUIRE((*plan)->steps.back().operation == CopyOperation::Zero);
+
+    for (const auto& block : blend->GetBlocks(BLOCK_CODE_OB))
+    {
+        const auto objects = ConvertStructs<NativeObject>(**plan, block.body);
+        REQUIRE(objects);
+        REQUIRE(objects->size() == 1);
+
+        const auto& object = objects->front();
+        const auto object_type = blend->GetBlockType(block);
+        REQUIRE(object.location[2] == object_type->QueryValue<f32, "loc[2]">(block));
+        REQUIRE(object.scale[0] == Catch::Approx(object_type->QueryValue<f32, "scale[0]">(block).value()));
+        REQUIRE(object.type == object_type->QueryValue<s16, "type">(block));
+        REQUIRE(object.parent == object_type->GetField("parent")->GetPointerAddress(block.body));
+        REQUIRE(object.missing == std::array<s32, 2>{ 0, 0 });
+    }
+
+    const NativeStruct invalid = { .name = "Object", .size = 4, .fields = { { .name = "loc", .type = NativeType::F64 } } };
+    REQUIRE(CompileCopyPlan(*blend, invalid).error() == NativeStructError::InvalidNativeField);
+    REQUIRE(CompileCopyPlan(*blend, { .name = "NotAStruct" }).error() == NativeStructError::StructNotFound);
+}
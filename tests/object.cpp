@@ -0,0 +1,598 @@
+#include "blend_builder.hpp"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cblend_collection.hpp>
+#include <cblend_object.hpp>
+#include <cblend_skeleton.hpp>
+
+#include <cstring>
+#include <numbers>
+
+using namespace cblend;
+
+[[nodiscard]] bool IsApprox(const Float4x4& lhs, const Float4x4& rhs)
+{
+    for (usize column = 0; column < 4; ++column)
+    {
+        for (usize row = 0; row < 4; ++row)
+        {
+            if (lhs[column][row] != Catch::Approx(rhs[column][row]).margin(1e-4))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// NOLINTBEGIN
+TEST_CASE("matrix helpers match blender conventions", "[object]")
+// NOLINTEND
+{
+    static constexpr f32 HALF_PI = std::numbers::pi_v<f32> / 2.F;
+
+    SECTION("euler rotations apply the first axis first")
+    {
+        const auto rotation = EulerToMatrix({ HALF_PI, 0.F, HALF_PI }, RotationOrder::XYZ);
+        const auto point = TransformPoint(rotation, { 0.F, 1.F, 0.F });
+        REQUIRE(point[0] == Catch::Approx(0.F).margin(1e-5));
+        REQUIRE(point[1] == Catch::Approx(0.F).margin(1e-5));
+        REQUIRE(point[2] == Catch::Approx(1.F).margin(1e-5));
+
+        const auto reversed = TransformPoint(EulerToMatrix({ HALF_PI, 0.F, HALF_PI }, RotationOrder::ZYX), { 0.F, 1.F, 0.F });
+        REQUIRE(reversed[0] == Catch::Approx(-1.F).margin(1e-5));
+        REQUIRE(reversed[1] == Catch::Approx(0.F).margin(1e-5));
+        REQUIRE(reversed[2] == Catch::Approx(0.F).margin(1e-5));
+    }
+
+    SECTION("quaternions and axis angles agree with eulers")
+    {
+        const auto euler = EulerToMatrix({ 0.F, 0.F, HALF_PI }, RotationOrder::XYZ);
+        const f32 half_sine = std::sin(HALF_PI / 2.F);
+        REQUIRE(IsApprox(QuaternionToMatrix({ std::cos(HALF_PI / 2.F), 0.F, 0.F, half_sine }), euler));
+        REQUIRE(IsApprox(AxisAngleToMatrix({ 0.F, 0.F, 2.F }, HALF_PI), euler));
+
+        // Blender rotation modes select between the three representations
+        const Float4 quaternion = { std::cos(HALF_PI / 2.F), 0.F, 0.F, half_sine };
+        REQUIRE(IsApprox(RotationToMatrix(0, {}, quaternion, {}, 0.F), euler));
+        REQUIRE(IsApprox(RotationToMatrix(-1, {}, {}, { 0.F, 0.F, 1.F }, HALF_PI), euler));
+        REQUIRE(IsApprox(RotationToMatrix(6, { 0.F, 0.F, HALF_PI }, {}, {}, 0.F), euler));
+    }
+
+    SECTION("composed transforms can be inverted")
+    {
+        const auto rotation = EulerToMatrix({ 0.3F, 0.2F, 0.1F }, RotationOrder::YZX);
+        const auto transform = ComposeTransform({ 1.F, 2.F, 3.F }, rotation, { 2.F, 1.F, 0.5F });
+        const auto inverse = Invert(transform);
+        REQUIRE(inverse);
+        REQUIRE(IsApprox(Multiply(transform, *inverse), IDENTITY_MATRIX));
+        REQUIRE(IsApprox(Multiply(*inverse, transform), IDENTITY_MATRIX));
+
+        const Float4x4 singular = {};
+        REQUIRE(Invert(singular) == NULL_OPTION);
+    }
+}
+
+[[nodiscard]] Float4x4 MakeTranslation(const Float3& translation)
+{
+    return ComposeTransform(translation, IDENTITY_MATRIX, { 1.F, 1.F, 1.F });
+}
+
+void WriteString(std::vector<u8>& data, usize offset, std::string_view string)
+{
+    std::memcpy(data.data() + offset, string.data(), string.size());
+}
+
+// NOLINTBEGIN
+TEST_CASE("skeleton pose matrices chain through the hierarchy", "[object]")
+// NOLINTEND
+{
+    static constexpr f32 HALF_PI = std::numbers::pi_v<f32> / 2.F;
+    const auto root_rotation = EulerToMatrix({ 0.F, 0.F, HALF_PI }, RotationOrder::XYZ);
+
+    SECTION("hand built skeletons chain parent relative rest offsets")
+    {
+        Skeleton skeleton;
+        skeleton.names = { "Root", "Child", "Tip", "Other" };
+        skeleton.parents = { NO_PARENT, 0, 1, NO_PARENT };
+        skeleton.rest_matrices = {
+            MakeTranslation({ 0.F, 0.F, 0.F }),
+            MakeTranslation({ 0.F, 1.F, 0.F }),
+            MakeTranslation({ 0.F, 2.F, 0.F }),
+            MakeTranslation({ 5.F, 0.F, 0.F }),
+        };
+
+        // Without pose channels every bone stays at its rest matrix
+        skeleton.pose_local_matrices.assign(skeleton.GetBoneCount(), IDENTITY_MATRIX);
+        ComputePoseMatrices(skeleton);
+        REQUIRE(skeleton.pose_matrices.size() == skeleton.GetBoneCount());
+        for (usize bone = 0; bone < skeleton.GetBoneCount(); ++bone)
+        {
+            REQUIRE(IsApprox(skeleton.pose_matrices[bone], skeleton.rest_matrices[bone]));
+        }
+
+        // Rotating the root carries both descendants, the tip adds its own offset on top
+        skeleton.pose_local_matrices[0] = root_rotation;
+        skeleton.pose_local_matrices[2] = MakeTranslation({ 0.F, 0.F, 1.F });
+        ComputePoseMatrices(skeleton);
+        REQUIRE(IsApprox(skeleton.pose_matrices[0], root_rotation));
+        REQUIRE(IsApprox(skeleton.pose_matrices[1], Multiply(root_rotation, MakeTranslation({ 0.F, 1.F, 0.F }))));
+        REQUIRE(IsApprox(skeleton.pose_matrices[2], Multiply(root_rotation, MakeTranslation({ 0.F, 2.F, 1.F }))));
+        REQUIRE(IsApprox(skeleton.pose_matrices[3], skeleton.rest_matrices[3]));
+
+        const auto tip = TransformPoint(skeleton.pose_matrices[2], { 0.F, 0.F, 0.F });
+        REQUIRE(tip[0] == Catch::Approx(-2.F).margin(1e-5));
+        REQUIRE(tip[1] == Catch::Approx(0.F).margin(1e-5));
+        REQUIRE(tip[2] == Catch::Approx(1.F).margin(1e-5));
+    }
+
+    SECTION("extracted bones are ordered depth first")
+    {
+        BlendBuilder builder;
+        builder.AddIdStructs();
+        builder.AddStruct(
+            "Bone",
+            {
+                { "Bone", "*next" },
+                { "Bone", "*prev" },
+                { "void", "*prop" },
+                { "Bone", "*parent" },
+                { "ListBase", "childbase" },
+                { "char", "name[64]" },
+                { "float", "roll" },
+                { "float", "head[3]" },
+                { "float", "tail[3]" },
+                { "float", "arm_mat[4][4]" },
+            }
+        );
+        builder.AddStruct("bArmature", { { "ID", "id" }, { "void", "*adt" }, { "ListBase", "bonebase" } });
+        builder.AddStruct(
+            "bPoseChannel",
+            {
+                { "bPoseChannel", "*next" },
+                { "bPoseChannel", "*prev" },
+                { "char", "name[64]" },
+                { "Bone", "*bone" },
+                { "float", "loc[3]" },
+                { "float", "size[3]" },
+                { "float", "eul[3]" },
+                { "float", "quat[4]" },
+                { "float", "rotAxis[3]" },
+                { "float", "rotAngle" },
+                { "short", "rotmode" },
+                { "short", "pad" },
+            }
+        );
+        builder.AddStruct("bPose", { { "ListBase", "chanbase" } });
+        builder.AddStruct(
+            "Object",
+            {
+                { "ID", "id" },
+                { "Object", "*parent" },
+                { "float", "obmat[4][4]" },
+                { "short", "type" },
+                { "short", "pad[3]" },
+                { "void", "*data" },
+                { "bPose", "*pose" },
+            }
+        );
+
+        // The second root is linked before the first root's children are visited
+        const u64 root = builder.Allocate();
+        const u64 child = builder.Allocate();
+        const u64 tip = builder.Allocate();
+        const u64 other = builder.Allocate();
+        const auto add_bone = [&builder](u64 address, std::string_view name, u64 next, u64 first_child, const Float3& head)
+        {
+            auto bone = builder.MakeStruct("Bone");
+            builder.Set(bone, "Bone", "next", next);
+            builder.Set(bone, "Bone", "childbase", std::array<u64, 2>{ first_child, first_child });
+            WriteString(bone, builder.GetOffset("Bone", "name"), name);
+            builder.Set(bone, "Bone", "arm_mat", MakeTranslation(head));
+            builder.AddBlock(BLOCK_CODE_DATA, "Bone", std::move(bone), address);
+        };
+        add_bone(root, "Root", other, child, { 0.F, 0.F, 0.F });
+        add_bone(other, "Other", 0, 0, { 5.F, 0.F, 0.F });
+        add_bone(child, "Child", 0, tip, { 0.F, 1.F, 0.F });
+        add_bone(tip, "Tip", 0, 0, { 0.F, 2.F, 0.F });
+
+        auto armature = builder.MakeStruct("bArmature");
+        builder.Set(armature, "bArmature", "bonebase", std::array<u64, 2>{ root, other });
+        const u64 armature_address = builder.AddBlock(BLOCK_CODE_AR, "bArmature", std::move(armature));
+
+        // The root channel is matched by its bone pointer, the tip channel by name
+        const u64 root_channel = builder.Allocate();
+        const u64 tip_channel = builder.Allocate();
+        const auto add_channel =
+            [&builder](u64 address, std::string_view name, u64 next, u64 bone, const Float3& location, const Float3& euler)
+        {
+            auto channel = builder.MakeStruct("bPoseChannel");
+            builder.Set(channel, "bPoseChannel", "next", next);
+            WriteString(channel, builder.GetOffset("bPoseChannel", "name"), name);
+            builder.Set(channel, "bPoseChannel", "bone", bone);
+            builder.Set(channel, "bPoseChannel", "loc", location);
+            builder.Set(channel, "bPoseChannel", "size", Float3{ 1.F, 1.F, 1.F });
+            builder.Set(channel, "bPoseChannel", "eul", euler);
+            builder.Set(channel, "bPoseChannel", "quat", Float4{ 1.F, 0.F, 0.F, 0.F });
+            builder.Set(channel, "bPoseChannel", "rotmode", s16(euler == Float3{} ? 0 : 1));
+            builder.AddBlock(BLOCK_CODE_DATA, "bPoseChannel", std::move(channel), address);
+        };
+        add_channel(root_channel, "Root", tip_channel, root, {}, { 0.F, 0.F, HALF_PI });
+        add_channel(tip_channel, "Tip", 0, 0, { 0.F, 0.F, 1.F }, {});
+
+        auto pose = builder.MakeStruct("bPose");
+        builder.Set(pose, "bPose", "chanbase", std::array<u64, 2>{ root_channel, tip_channel });
+        const u64 pose_address = builder.AddBlock(BLOCK_CODE_DATA, "bPose", std::move(pose));
+
+        static constexpr s16 OBJECT_TYPE_ARMATURE = 25;
+        auto object = builder.MakeStruct("Object");
+        builder.SetName(object, "OBArmature");
+        builder.Set(object, "Object", "type", OBJECT_TYPE_ARMATURE);
+        builder.Set(object, "Object", "data", armature_address);
+        builder.Set(object, "Object", "pose", pose_address);
+        builder.AddBlock(BLOCK_CODE_OB, "Object", std::move(object));
+
+        const auto buffer = builder.Build();
+        const auto blend = Blend::Read(buffer);
+        REQUIRE(blend);
+
+        const auto rest = ExtractSkeleton(*blend, *blend->GetBlock(BLOCK_CODE_AR));
+        REQUIRE(rest);
+        REQUIRE(rest->names == std::vector<std::string_view>{ "Root", "Child", "Tip", "Other" });
+        REQUIRE(rest->parents == std::vector<u32>{ NO_PARENT, 0, 1, NO_PARENT });
+        for (usize bone = 0; bone < rest->GetBoneCount(); ++bone)
+        {
+            REQUIRE(IsApprox(rest->pose_matrices[bone], rest->rest_matrices[bone]));
+        }
+
+        const auto posed = ExtractSkeleton(*blend, *blend->GetBlock(BLOCK_CODE_OB));
+        REQUIRE(posed);
+        REQUIRE(posed->names == rest->names);
+        REQUIRE(IsApprox(posed->pose_matrices[0], root_rotation));
+        REQUIRE(IsApprox(posed->pose_matrices[1], Multiply(root_rotation, MakeTranslation({ 0.F, 1.F, 0.F }))));
+        REQUIRE(IsApprox(posed->pose_matrices[2], Multiply(root_rotation, MakeTranslation({ 0.F, 2.F, 1.F }))));
+        REQUIRE(IsApprox(posed->pose_matrices[3], MakeTranslation({ 5.F, 0.F, 0.F })));
+    }
+}
+
+void AddObjectStructs(BlendBuilder& builder)
+{
+    builder.AddIdStructs();
+    builder.AddStruct(
+        "Object",
+        {
+            { "ID", "id" },
+            { "Object", "*parent" },
+            { "float", "parentinv[4][4]" },
+            { "float", "obmat[4][4]" },
+            { "float", "loc[3]" },
+            { "float", "rot[3]" },
+            { "float", "scale[3]" },
+            { "short", "type" },
+            { "short", "transflag" },
+            { "void", "*data" },
+            { "Collection", "*instance_collection" },
+        }
+    );
+}
+
+[[nodiscard]] std::vector<u8> MakeObject(const BlendBuilder& builder, std::string_view name, const Float3& location)
+{
+    auto object = builder.MakeStruct("Object");
+    builder.SetName(object, name);
+    builder.Set(object, "Object", "parentinv", IDENTITY_MATRIX);
+    builder.Set(object, "Object", "loc", location);
+    builder.Set(object, "Object", "scale", Float3{ 1.F, 1.F, 1.F });
+    return object;
+}
+
+// NOLINTBEGIN
+TEST_CASE("object world matrices chain through every level", "[object]")
+// NOLINTEND
+{
+    static constexpr f32 HALF_PI = std::numbers::pi_v<f32> / 2.F;
+
+    BlendBuilder builder;
+    AddObjectStructs(builder);
+
+    // Children are written before their parents, so extraction has to reorder them by depth
+    const u64 root = builder.Allocate();
+    const u64 child = builder.Allocate();
+    const u64 grandchild = builder.Allocate();
+
+    auto grandchild_object = MakeObject(builder, "OBGrandchild", { 0.F, 0.F, 1.F });
+    builder.Set(grandchild_object, "Object", "parent", child);
+    builder.Set(grandchild_object, "Object", "parentinv", MakeTranslation({ -1.F, 0.F, 0.F }));
+    builder.AddBlock(BLOCK_CODE_OB, "Object", std::move(grandchild_object), grandchild);
+
+    auto child_object = MakeObject(builder, "OBChild", { 1.F, 0.F, 0.F });
+    builder.Set(child_object, "Object", "parent", root);
+    builder.AddBlock(BLOCK_CODE_OB, "Object", std::move(child_object), child);
+
+    auto root_object = MakeObject(builder, "OBRoot", { 1.F, 2.F, 3.F });
+    builder.Set(root_object, "Object", "rot", Float3{ 0.F, 0.F, HALF_PI });
+    builder.Set(root_object, "Object", "scale", Float3{ 2.F, 2.F, 2.F });
+    builder.AddBlock(BLOCK_CODE_OB, "Object", std::move(root_object), root);
+
+    builder.AddBlock(BLOCK_CODE_OB, "Object", MakeObject(builder, "OBOther", { 0.F, 0.F, -1.F }));
+
+    const auto buffer = builder.Build();
+    const auto blend = Blend::Read(buffer);
+    REQUIRE(blend);
+
+    auto hierarchy = ExtractObjectHierarchy(*blend);
+    REQUIRE(hierarchy);
+    REQUIRE(hierarchy->GetObjectCount() == 4);
+    REQUIRE(hierarchy->GetLevelCount() == 3);
+    REQUIRE(hierarchy->level_offsets == std::vector<u32>{ 0, 2, 3, 4 });
+
+    const auto root_index = hierarchy->FindObject("Root");
+    const auto child_index = hierarchy->FindObject("Child");
+    const auto grandchild_index = hierarchy->FindObject("Grandchild");
+    REQUIRE(root_index != NULL_OPTION);
+    REQUIRE(child_index != NULL_OPTION);
+    REQUIRE(grandchild_index != NULL_OPTION);
+    REQUIRE(hierarchy->parents[*root_index] == NO_PARENT);
+    REQUIRE(hierarchy->parents[*child_index] == *root_index);
+    REQUIRE(hierarchy->parents[*grandchild_index] == *child_index);
+
+    const auto root_rotation = EulerToMatrix({ 0.F, 0.F, HALF_PI }, RotationOrder::XYZ);
+    const auto root_world = ComposeTransform({ 1.F, 2.F, 3.F }, root_rotation, { 2.F, 2.F, 2.F });
+    REQUIRE(IsApprox(hierarchy->world_matrices[*root_index], root_world));
+    REQUIRE(IsApprox(hierarchy->world_matrices[*child_index], Multiply(root_world, MakeTranslation({ 1.F, 0.F, 0.F }))));
+
+    // The grandchild's parent inverse cancels the child's offset, leaving one unit up in the rotated and scaled root
+    REQUIRE(IsApprox(hierarchy->world_matrices[*grandchild_index], Multiply(root_world, MakeTranslation({ 0.F, 0.F, 1.F }))));
+    const auto position = TransformPoint(hierarchy->world_matrices[*grandchild_index], { 0.F, 0.F, 0.F });
+    REQUIRE(position[0] == Catch::Approx(1.F).margin(1e-5));
+    REQUIRE(position[1] == Catch::Approx(2.F).margin(1e-5));
+    REQUIRE(position[2] == Catch::Approx(5.F).margin(1e-5));
+
+    // Moving the root propagates through both levels below it
+    hierarchy->local_matrices[*root_index] = MakeTranslation({ 0.F, 10.F, 0.F });
+    ComputeWorldMatrices(*hierarchy);
+    REQUIRE(IsApprox(hierarchy->world_matrices[*child_index], MakeTranslation({ 1.F, 10.F, 0.F })));
+    REQUIRE(IsApprox(hierarchy->world_matrices[*grandchild_index], MakeTranslation({ 0.F, 10.F, 1.F })));
+    REQUIRE(IsApprox(hierarchy->world_matrices[hierarchy->FindObject("Other").value()], MakeTranslation({ 0.F, 0.F, -1.F })));
+}
+
+// NOLINTBEGIN
+TEST_CASE("collection instances are flattened through nested collections", "[object]")
+// NOLINTEND
+{
+    static constexpr s16 OBJECT_TYPE_MESH = 1;
+    static constexpr s16 OBJECT_FLAG_INSTANCE_COLLECTION = 1 << 8;
+
+    BlendBuilder builder;
+    AddObjectStructs(builder);
+    builder.AddStruct("Mesh", { { "ID", "id" }, { "int", "totvert" } });
+    builder.AddStruct(
+        "Collection", { { "ID", "id" }, { "ListBase", "gobject" }, { "ListBase", "children" }, { "float", "instance_offset[3]" } }
+    );
+    builder.AddStruct("CollectionObject", { { "CollectionObject", "*next" }, { "CollectionObject", "*prev" }, { "Object", "*ob" } });
+    builder.AddStruct(
+        "CollectionChild", { { "CollectionChild", "*next" }, { "CollectionChild", "*prev" }, { "Collection", "*collection" } }
+    );
+    builder.AddStruct("Scene", { { "ID", "id" }, { "Collection", "*master_collection" } });
+
+    const auto add_mesh = [&builder](std::string_view name)
+    {
+        auto mesh = builder.MakeStruct("Mesh");
+        builder.SetName(mesh, name);
+        return builder.AddBlock(BLOCK_CODE_ME, "Mesh", std::move(mesh));
+    };
+
+    const auto add_object = [&builder](std::string_view name, const Float3& location, u64 mesh, u64 instance_collection)
+    {
+        auto object = MakeObject(builder, name, location);
+        builder.Set(object, "Object", "type", mesh != 0 ? OBJECT_TYPE_MESH : s16(0));
+        builder.Set(object, "Object", "transflag", instance_collection != 0 ? OBJECT_FLAG_INSTANCE_COLLECTION : s16(0));
+        builder.Set(object, "Object", "data", mesh);
+        builder.Set(object, "Object", "instance_collection", instance_collection);
+        return builder.AddBlock(BLOCK_CODE_OB, "Object", std::move(object));
+    };
+
+    // Writes the links of a ListBase and returns its first and last pointers
+    const auto add_list = [&builder](std::string_view link_struct, std::string_view target, const std::vector<u64>& targets)
+    {
+        std::vector<u64> links(targets.size());
+        for (auto& link : links)
+        {
+            link = builder.Allocate();
+        }
+
+        for (usize index = 0; index < links.size(); ++index)
+        {
+            auto link = builder.MakeStruct(link_struct);
+            builder.Set(link, link_struct, "next", index + 1 < links.size() ? links[index + 1] : u64(0));
+            builder.Set(link, link_struct, "prev", index > 0 ? links[index - 1] : u64(0));
+            builder.Set(link, link_struct, target, targets[index]);
+            builder.AddBlock(BLOCK_CODE_DATA, link_struct, std::move(link), links[index]);
+        }
+        return links.empty() ? std::array<u64, 2>{} : std::array<u64, 2>{ links.front(), links.back() };
+    };
+
+    const auto add_collection = [&](
+                                    const BlockCode& code,
+                                    u64 address,
+                                    std::string_view name,
+                                    const std::vector<u64>& objects,
+                                    const std::vector<u64>& children,
+                                    const Float3& offset
+                                )
+    {
+        auto collection = builder.MakeStruct("Collection");
+        builder.SetName(collection, name);
+        builder.Set(collection, "Collection", "gobject", add_list("CollectionObject", "ob", objects));
+        builder.Set(collection, "Collection", "children", add_list("CollectionChild", "collection", children));
+        builder.Set(collection, "Collection", "instance_offset", offset);
+        builder.AddBlock(code, "Collection", std::move(collection), address);
+        return address;
+    };
+
+    const u64 mesh_one = add_mesh("MEone");
+    const u64 mesh_two = add_mesh("MEtwo");
+    const u64 mesh_three = add_mesh("MEthree");
+
+    // Tree, which is instanced twice, holds two objects, a child collection and an instance of another collection
+    const u64 leaf = add_collection(
+        BLOCK_CODE_GR, builder.Allocate(), "GRLeaf", { add_object("OBLeaf", { 0.F, 0.F, 0.F }, mesh_three, 0) }, {}, {}
+    );
+    const u64 child = add_collection(
+        BLOCK_CODE_GR, builder.Allocate(), "GRChild", { add_object("OBChild", { 2.F, 0.F, 0.F }, mesh_two, 0) }, {}, {}
+    );
+    const u64 tree = add_collection(
+        BLOCK_CODE_GR,
+        builder.Allocate(),
+        "GRTree",
+        {
+            add_object("OBTop", { 0.F, 0.F, 1.F }, mesh_one, 0),
+            add_object("OBOrigin", { 0.F, 0.F, 0.F }, mesh_two, 0),
+            add_object("OBLeafInstance", { 5.F, 0.F, 0.F }, 0, leaf),
+        },
+        { child },
+        { 0.F, 0.F, 1.F }
+    );
+
+    const u64 master = add_collection(
+        BLOCK_CODE_DATA,
+        builder.Allocate(),
+        "GRMaster",
+        {
+            add_object("OBPlain", { 1.F, 0.F, 0.F }, mesh_one, 0),
+            add_object("OBTreeA", { 0.F, 10.F, 0.F }, 0, tree),
+            add_object("OBTreeB", { 0.F, 20.F, 0.F }, 0, tree),
+        },
+        {},
+        {}
+    );
+
+    auto scene = builder.MakeStruct("Scene");
+    builder.SetName(scene, "SCScene");
+    builder.Set(scene, "Scene", "master_collection", master);
+    builder.AddBlock(BLOCK_CODE_SC, "Scene", std::move(scene));
+
+    // Two collections instancing each other
+    const u64 cycle_first = builder.Allocate();
+    const u64 cycle_second = builder.Allocate();
+    add_collection(BLOCK_CODE_GR, cycle_first, "GRCycleA", { add_object("OBCycleA", {}, 0, cycle_second) }, {}, {});
+    add_collection(BLOCK_CODE_GR, cycle_second, "GRCycleB", { add_object("OBCycleB", {}, 0, cycle_first) }, {}, {});
+
+    const auto buffer = builder.Build();
+    const auto blend = Blend::Read(buffer);
+    REQUIRE(blend);
+
+    const auto hierarchy = ExtractObjectHierarchy(*blend);
+    REQUIRE(hierarchy);
+
+    const auto require_instances
+        = [&hierarchy](const MeshInstances& instances, std::initializer_list<std::pair<std::string_view, Float3>> expected)
+    {
+        REQUIRE(instances.world_matrices.size() == expected.size());
+        usize index = 0;
+        for (const auto& [name, translation] : expected)
+        {
+            REQUIRE(hierarchy->names[instances.source_objects[index]] == name);
+            REQUIRE(IsApprox(instances.world_matrices[index], MakeTranslation(translation)));
+            ++index;
+        }
+    };
+
+    SECTION("scenes instance nested collections with their offsets")
+    {
+        const auto instances = FlattenSceneInstances(*blend, *hierarchy, *blend->GetBlock(BLOCK_CODE_SC));
+        REQUIRE(instances);
+        REQUIRE(instances->GetInstanceCount() == 9);
+        REQUIRE(instances->meshes.size() == 3);
+
+        // Both instances of the tree reuse its expansion, moved by the instancer and the tree's instance offset
+        REQUIRE(instances->meshes[0].mesh == &*blend->GetBlockAt(mesh_one));
+        require_instances(
+            instances->meshes[0], { { "Plain", { 1.F, 0.F, 0.F } }, { "Top", { 0.F, 10.F, 0.F } }, { "Top", { 0.F, 20.F, 0.F } } }
+        );
+        REQUIRE(instances->meshes[1].mesh == &*blend->GetBlockAt(mesh_two));
+        require_instances(
+            instances->meshes[1],
+            {
+                { "Origin", { 0.F, 10.F, -1.F } },
+                { "Child", { 2.F, 10.F, -1.F } },
+                { "Origin", { 0.F, 20.F, -1.F } },
+                { "Child", { 2.F, 20.F, -1.F } },
+            }
+        );
+        REQUIRE(instances->meshes[2].mesh == &*blend->GetBlockAt(mesh_three));
+        require_instances(instances->meshes[2], { { "Leaf", { 5.F, 10.F, -1.F } }, { "Leaf", { 5.F, 20.F, -1.F } } });
+    }
+
+    SECTION("collections can be flattened on their own")
+    {
+        const auto instances = FlattenCollectionInstances(*blend, *hierarchy, *blend->GetBlockAt(tree));
+        REQUIRE(instances);
+        REQUIRE(instances->GetInstanceCount() == 4);
+        require_instances(instances->meshes[0], { { "Top", { 0.F, 0.F, 1.F } } });
+        require_instances(instances->meshes[1], { { "Origin", { 0.F, 0.F, 0.F } }, { "Child", { 2.F, 0.F, 0.F } } });
+        require_instances(instances->meshes[2], { { "Leaf", { 5.F, 0.F, 0.F } } });
+    }
+
+    SECTION("collections instancing each other are rejected")
+    {
+        const auto instances = FlattenCollectionInstances(*blend, *hierarchy, *blend->GetBlockAt(cycle_first));
+        REQUIRE(instances.error() == CollectionError::CyclicCollection);
+    }
+}
+
+// NOLINTBEGIN
+TEST_CASE("default blend file object hierarchy can be extracted", "[default]")
+// NOLINTEND
+{
+    auto blend = Blend::Open("default.blend");
+    REQUIRE(blend);
+
+    const auto hierarchy = ExtractObjectHierarchy(*blend);
+    REQUIRE(hierarchy);
+    REQUIRE(hierarchy->GetObjectCount() == 3);
+    REQUIRE(hierarchy->GetLevelCount() == 1);
+
+    const auto cube = hierarchy->FindObject("Cube");
+    REQUIRE(cube != NULL_OPTION);
+    REQUIRE(hierarchy->parents[*cube] == NO_PARENT);
+    REQUIRE(IsApprox(hierarchy->world_matrices[*cube], IDENTITY_MATRIX));
+
+    // Evaluated transforms must match the matrices Blender stored on save
+    const auto object_type = blend->GetType("Object");
+    REQUIRE(object_type != NULL_OPTION);
+    const auto object_matrix = object_type->GetField("obmat");
+    REQUIRE(object_matrix != NULL_OPTION);
+
+    for (usize object = 0; object < hierarchy->GetObjectCount(); ++object)
+    {
+        const auto stored = object_matrix->GetValue<Float4x4>(*hierarchy->objects[object]);
+        REQUIRE(stored != NULL_OPTION);
+        REQUIRE(IsApprox(hierarchy->world_matrices[object], *stored));
+    }
+}
+
+// NOLINTBEGIN
+TEST_CASE("default blend file scene instances can be flattened", "[default]")
+// NOLINTEND
+{
+    auto blend = Blend::Open("default.blend");
+    REQUIRE(blend);
+
+    const auto hierarchy = ExtractObjectHierarchy(*blend);
+    REQUIRE(hierarchy);
+
+    const auto scene = blend->GetBlock(BLOCK_CODE_SC);
+    REQUIRE(scene != NULL_OPTION);
+
+    const auto instances = FlattenSceneInstances(*blend, *hierarchy, *scene);
+    REQUIRE(instances);
+    REQUIRE(instances->meshes.size() == 1);
+    REQUIRE(instances->GetInstanceCount() == 1);
+
+    const auto& cube = instances->meshes.front();
+    REQUIRE(cube.mesh == &*blend->GetBlock(BLOCK_CODE_ME));
+    REQUIRE(hierarchy->names[cube.source_objects.front()] == "Cube");
+    REQUIRE(IsApprox(cube.world_matrices.front(), IDENTITY_MATRIX));
+}
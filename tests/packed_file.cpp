@@ -0,0 +1,137 @@
+#include "blend_builder.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cblend_packed_file.hpp>
+
+#include <array>
+#include <cstring>
+#include <string_view>
+
+using namespace cblend;
+
+[[nodiscard]] bool ContainsPayload(const std::vector<u8>& buffer, const PackedFileEntry& entry, std::string_view payload)
+{
+    return entry.GetSize() == payload.size() && std::memcmp(entry.data.data(), payload.data(), payload.size()) == 0
+        && entry.file_offset + payload.size() <= buffer.size()
+        && std::memcmp(buffer.data() + entry.file_offset, payload.data(), payload.size()) == 0;
+}
+
+// NOLINTBEGIN
+TEST_CASE("packed files can be enumerated", "[packed]")
+// NOLINTEND
+{
+    BlendBuilder builder;
+    builder.AddIdStructs();
+    builder.AddStruct("PackedFile", { { "int", "size" }, { "int", "seek" }, { "void", "*data" } });
+    builder.AddStruct(
+        "ImagePackedFile",
+        {
+            { "ImagePackedFile", "*next" },
+            { "ImagePackedFile", "*prev" },
+            { "PackedFile", "*packedfile" },
+            { "char", "filepath[1024]" },
+            { "int", "view" },
+            { "int", "tile_number" },
+        }
+    );
+    builder.AddStruct(
+        "Image", { { "ID", "id" }, { "char", "filepath[1024]" }, { "PackedFile", "*packedfile" }, { "ListBase", "packedfiles" } }
+    );
+    builder.AddStruct("bSound", { { "ID", "id" }, { "char", "filepath[1024]" }, { "PackedFile", "*packedfile" } });
+
+    static constexpr std::string_view TILE_PAYLOAD = "PNGDATA-one";
+    static constexpr std::string_view SOUND_PAYLOAD = "0123456789abcdef0123456789abcdef";
+
+    // The first payload starts inside its block to check the offset into the body
+    std::vector<u8> tile_data(2 + TILE_PAYLOAD.size(), 'x');
+    std::memcpy(tile_data.data() + 2, TILE_PAYLOAD.data(), TILE_PAYLOAD.size());
+    const u64 tile_address = builder.AddData(std::move(tile_data)) + 2;
+    const u64 sound_address = builder.AddData(std::vector<u8>(SOUND_PAYLOAD.begin(), SOUND_PAYLOAD.end()));
+
+    const auto add_packed_file = [&builder](usize size, u64 address)
+    {
+        auto packed_file = builder.MakeStruct("PackedFile");
+        builder.Set(packed_file, "PackedFile", "size", s32(size));
+        builder.Set(packed_file, "PackedFile", "data", address);
+        return builder.AddBlock(BLOCK_CODE_DATA, "PackedFile", std::move(packed_file));
+    };
+    const u64 tile_packed_file = add_packed_file(TILE_PAYLOAD.size(), tile_address);
+    const u64 sound_packed_file = add_packed_file(SOUND_PAYLOAD.size(), sound_address);
+    const u64 missing_packed_file = add_packed_file(SOUND_PAYLOAD.size(), 0xDEAD0000);
+
+    const auto add_owner = [&builder](std::string_view struct_name, std::string_view name, std::string_view file_path, u64 packed_file)
+    {
+        auto owner = builder.MakeStruct(struct_name);
+        builder.SetName(owner, name);
+        std::memcpy(owner.data() + builder.GetOffset(struct_name, "filepath"), file_path.data(), file_path.size());
+        builder.Set(owner, struct_name, "packedfile", packed_file);
+        return owner;
+    };
+
+    // Tiled image which still mirrors its first tile into the legacy pointer
+    const u64 first_tile = builder.Allocate();
+    const u64 second_tile = builder.Allocate();
+    const std::array<std::pair<u64, std::string_view>, 2> tiles = { {
+        { tile_packed_file, "//tile.1001.png" },
+        { sound_packed_file, "//tile.1002.png" },
+    } };
+    for (usize tile = 0; tile < tiles.size(); ++tile)
+    {
+        auto link = builder.MakeStruct("ImagePackedFile");
+        builder.Set(link, "ImagePackedFile", "next", tile == 0 ? second_tile : u64(0));
+        builder.Set(link, "ImagePackedFile", "prev", tile == 0 ? u64(0) : first_tile);
+        builder.Set(link, "ImagePackedFile", "packedfile", tiles[tile].first);
+        const auto path = tiles[tile].second;
+        std::memcpy(link.data() + builder.GetOffset("ImagePackedFile", "filepath"), path.data(), path.size());
+        builder.AddBlock(BLOCK_CODE_DATA, "ImagePackedFile", std::move(link), tile == 0 ? first_tile : second_tile);
+    }
+
+    auto tiled_image = add_owner("Image", "IMtiled", "//tile.<UDIM>.png", tile_packed_file);
+    builder.Set(tiled_image, "Image", "packedfiles", std::array<u64, 2>{ first_tile, second_tile });
+    builder.AddBlock(BLOCK_CODE_IM, "Image", std::move(tiled_image));
+    builder.AddBlock(BLOCK_CODE_IM, "Image", add_owner("Image", "IMlegacy", "//legacy.png", tile_packed_file));
+    builder.AddBlock(BLOCK_CODE_SO, "bSound", add_owner("bSound", "SOsound", "//sound.wav", sound_packed_file));
+    builder.AddBlock(BLOCK_CODE_SO, "bSound", add_owner("bSound", "SOmissing", "//missing.wav", missing_packed_file));
+    builder.AddBlock(BLOCK_CODE_SO, "bSound", add_owner("bSound", "SOnone", "//none.wav", 0));
+
+    const auto buffer = builder.Build();
+    const auto blend = Blend::Read(buffer);
+    REQUIRE(blend);
+
+    const auto entries = GetPackedFiles(*blend);
+    REQUIRE(entries);
+    REQUIRE(entries->size() == 4);
+
+    SECTION("tiles are read from the packed file list instead of the legacy pointer")
+    {
+        REQUIRE((*entries)[0].owner_name == "IMtiled");
+        REQUIRE((*entries)[0].file_path == "//tile.1001.png");
+        REQUIRE(ContainsPayload(buffer, (*entries)[0], TILE_PAYLOAD));
+        REQUIRE((*entries)[1].owner_name == "IMtiled");
+        REQUIRE((*entries)[1].file_path == "//tile.1002.png");
+        REQUIRE(ContainsPayload(buffer, (*entries)[1], SOUND_PAYLOAD));
+    }
+
+    SECTION("owners without a packed file list fall back to the legacy pointer")
+    {
+        REQUIRE((*entries)[2].owner_name == "IMlegacy");
+        REQUIRE((*entries)[2].file_path == "//legacy.png");
+        REQUIRE(ContainsPayload(buffer, (*entries)[2], TILE_PAYLOAD));
+        REQUIRE((*entries)[3].owner_name == "SOsound");
+        REQUIRE((*entries)[3].file_path == "//sound.wav");
+        REQUIRE(ContainsPayload(buffer, (*entries)[3], SOUND_PAYLOAD));
+    }
+
+    SECTION("unresolvable packed files are skipped")
+    {
+        usize sound_count = 0;
+        for (const auto& sound : blend->GetBlocks(BLOCK_CODE_SO))
+        {
+            const auto sound_entries = GetPackedFiles(*blend, sound);
+            REQUIRE(sound_entries);
+            REQUIRE(sound_entries->size() == (sound_count == 0 ? 1U : 0U));
+            ++sound_count;
+        }
+        REQUIRE(sound_count == 3);
+    }
+}
@@ -1,6 +1,11 @@
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <cblend.hpp>
+#include <cblend_id_index.hpp>
+#include <cblend_main.hpp>
+#include <cblend_packed_file.hpp>
+#include <cblend_reference_graph.hpp>
+#include <cblend_stream.hpp>
 
 #include <filesystem>
 
@@ -54,6 +59,171 @@ TEST_CASE("default blend file can be opened via buffer")
     REQUIRE(blend);
 }
 
+void AppendBlock(std::vector<u8>& buffer, const std::array<char, 4>& code, std::initializer_list<u8> body)
+{
+    const std::array<u32, 6> header = { std::bit_cast<u32>(code), u32(body.size()), 0U, 0U, 0U, 1U };
+    const auto header_bytes = std::bit_cast<std::array<u8, sizeof(header)>>(header);
+    buffer.insert(buffer.end(), header_bytes.begin(), header_bytes.end());
+    buffer.insert(buffer.end(), body);
+}
+
+// NOLINTBEGIN
+TEST_CASE("default blend file can be opened from reachable roots", "[default]")
+// NOLINTEND
+{
+    const auto full = Blend::Open("default.blend");
+    REQUIRE(full);
+
+    const std::array<BlockRoot, 1> roots = { BlockRoot{ .code = BLOCK_CODE_OB, .name = "OBCube" } };
+    const auto blend = Blend::OpenReachable("default.blend", roots);
+    REQUIRE(blend);
+    REQUIRE(blend->GetBlockCount() < full->GetBlockCount());
+    REQUIRE(blend->GetBlockCount(BLOCK_CODE_OB) == 1);
+    REQUIRE(blend->GetBlockCount(BLOCK_CODE_ME) == 1);
+    REQUIRE(blend->GetBlockCount(BLOCK_CODE_SR) == 0);
+    REQUIRE(blend->GetBlockCount(BLOCK_CODE_WM) == 0);
+
+    const auto object_type = blend->GetType("Object");
+    REQUIRE(object_type);
+    const auto mesh_data = object_type->QueryValue<MemorySpan, "data[0]">(*blend->GetBlock(BLOCK_CODE_OB));
+    REQUIRE((mesh_data && !mesh_data->empty()));
+}
+
+// NOLINTBEGIN
+TEST_CASE("default blend file can be opened with a block filter", "[default]")
+// NOLINTEND
+{
+    const BlockCodeFilter filter = {
+        .mode = BlockFilterMode::Deny,
+        .codes = { BLOCK_CODE_SR, BLOCK_CODE_WM, BLOCK_CODE_WS, BLOCK_CODE_TEST, BLOCK_CODE_USER },
+    };
+    const auto blend = Blend::Open("default.blend", filter);
+    REQUIRE(blend);
+    REQUIRE(blend->GetBlockCount(BLOCK_CODE_SR) == 0);
+    REQUIRE(blend->GetBlockCount(BLOCK_CODE_WM) == 0);
+    REQUIRE(blend->GetBlockCount(BLOCK_CODE_DNA1) == 1);
+    REQUIRE(blend->GetBlockCount(BLOCK_CODE_ME) == 1);
+
+    const auto mesh_type = blend->GetType("Mesh");
+    REQUIRE(mesh_type);
+    REQUIRE(mesh_type->QueryValue<int, "totvert">(*blend->GetBlock(BLOCK_CODE_ME)) == 8);
+
+    const auto objects = Blend::Open("default.blend", { .mode = BlockFilterMode::Allow, .codes = { BLOCK_CODE_OB } });
+    REQUIRE(objects);
+    REQUIRE(objects->GetBlockCount(BLOCK_CODE_ME) == 0);
+    REQUIRE(objects->GetBlockCount(BLOCK_CODE_OB) > 0);
+}
+
+// NOLINTBEGIN
+TEST_CASE("thumbnails can be read without parsing the file")
+// NOLINTEND
+{
+    if constexpr (std::endian::native == std::endian::big)
+    {
+        return;
+    }
+
+    const std::string_view magic = "BLENDER-v300";
+    std::vector<u8> buffer(magic.begin(), magic.end());
+    AppendBlock(buffer, { 'R', 'E', 'N', 'D' }, { 1, 2, 3, 4 });
+    AppendBlock(buffer, { 'T', 'E', 'S', 'T' }, { 2, 0, 0, 0, 1, 0, 0, 0, 255, 0, 0, 255, 0, 255, 0, 255 });
+    // Truncated on purpose, nothing past the thumbnail may be read
+    AppendBlock(buffer, { 'G', 'L', 'O', 'B' }, {});
+    buffer.resize(buffer.size() - 4);
+
+    const auto thumbnail = Blend::ReadThumbnail(buffer);
+    REQUIRE(thumbnail);
+    REQUIRE(thumbnail->width == 2);
+    REQUIRE(thumbnail->height == 1);
+    REQUIRE(thumbnail->pixels == std::vector<u8>{ 255, 0, 0, 255, 0, 255, 0, 255 });
+
+    std::vector<u8> missing(magic.begin(), magic.end());
+    AppendBlock(missing, { 'G', 'L', 'O', 'B' }, { 0, 0, 0, 0 });
+    AppendBlock(missing, { 'T', 'E', 'S', 'T' }, { 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0 });
+    REQUIRE(Blend::ReadThumbnail(missing).error() == BlendError(FormatError::ThumbnailNotFound));
+}
+
+void AppendLargeBlockHeader(std::vector<u8>& buffer, const std::array<char, 4>& code, u64 length)
+{
+    const std::array<u32, 2> code_and_index = { std::bit_cast<u32>(code), 0U };
+    const std::array<u64, 3> header = { 0x1000U, length, 1U };
+    const auto code_bytes = std::bit_cast<std::array<u8, sizeof(code_and_index)>>(code_and_index);
+    const auto header_bytes = std::bit_cast<std::array<u8, sizeof(header)>>(header);
+    buffer.insert(buffer.end(), code_bytes.begin(), code_bytes.end());
+    buffer.insert(buffer.end(), header_bytes.begin(), header_bytes.end());
+}
+
+void AppendLargeBlock(std::vector<u8>& buffer, const std::array<char, 4>& code, std::initializer_list<u8> body)
+{
+    AppendLargeBlockHeader(buffer, code, body.size());
+    buffer.insert(buffer.end(), body);
+}
+
+// NOLINTBEGIN
+TEST_CASE("large file headers can be read")
+// NOLINTEND
+{
+    if constexpr (std::endian::native == std::endian::big)
+    {
+        return;
+    }
+
+    const std::string_view magic = "BLENDER17-01v0500";
+    std::vector<u8> buffer(magic.begin(), magic.end());
+    AppendLargeBlock(buffer, { 'R', 'E', 'N', 'D' }, { 1, 2, 3, 4 });
+    AppendLargeBlock(buffer, { 'T', 'E', 'S', 'T' }, { 1, 0, 0, 0, 1, 0, 0, 0, 0, 255, 0, 255 });
+    AppendLargeBlock(buffer, { 'E', 'N', 'D', 'B' }, {});
+
+    MemoryStream stream(buffer);
+    const auto header = ReadHeader(stream);
+    REQUIRE(header);
+    REQUIRE(header->layout == HeaderLayout::Large);
+    REQUIRE(header->pointer == Pointer::U64);
+    REQUIRE(header->version == 500);
+
+    const auto file = ReadFile(stream, *header);
+    REQUIRE(file);
+    REQUIRE(file->blocks.size() == 3);
+    REQUIRE(file->blocks[0].header.address == 0x1000U);
+    REQUIRE(file->blocks[0].header.length == 4);
+    REQUIRE(file->blocks[0].header.count == 1);
+    REQUIRE(file->blocks[1].body.size() == 12);
+
+    const auto thumbnail = Blend::ReadThumbnail(buffer);
+    REQUIRE(thumbnail);
+    REQUIRE(thumbnail->pixels == std::vector<u8>{ 0, 255, 0, 255 });
+
+    // A corrupt length runs out of file before its body is allocated
+    std::vector<u8> oversized(magic.begin(), magic.end());
+    AppendLargeBlockHeader(oversized, { 'G', 'L', 'O', 'B' }, u64(1) << 62U);
+    MemoryStream oversized_stream(oversized);
+    const auto oversized_header = ReadHeader(oversized_stream);
+    REQUIRE(oversized_header);
+    const usize first_block = oversized_stream.GetPosition();
+    REQUIRE(ReadFile(oversized_stream, *oversized_header).error() == FormatError::UnexpectedEndOfFile);
+    REQUIRE(oversized_stream.Seek(first_block));
+    REQUIRE(FindBlock(oversized_stream, *oversized_header, BLOCK_CODE_GLOB).error() == FormatError::UnexpectedEndOfFile);
+    REQUIRE(oversized_stream.Seek(first_block));
+    REQUIRE(VisitFile(oversized_stream, *oversized_header, [](const Block& /*block*/) {}).error() == FormatError::UnexpectedEndOfFile);
+
+    for (const std::string_view invalid : { "BLENDER16-01v0500", "BLENDER17_01v0500", "BLENDER17-02v0500", "BLENDER17-01v05x0" })
+    {
+        const std::vector<u8> invalid_buffer(invalid.begin(), invalid.end());
+        MemoryStream invalid_stream(invalid_buffer);
+        REQUIRE(ReadHeader(invalid_stream).error() == FormatError::InvalidFileHeader);
+    }
+
+    const std::string_view legacy = "BLENDER_V279";
+    const std::vector<u8> legacy_buffer(legacy.begin(), legacy.end());
+    MemoryStream legacy_stream(legacy_buffer);
+    const auto legacy_header = ReadHeader(legacy_stream);
+    REQUIRE(legacy_header);
+    REQUIRE(legacy_header->layout == HeaderLayout::Legacy);
+    REQUIRE(legacy_header->pointer == Pointer::U32);
+    REQUIRE(legacy_header->endian == Endian::Big);
+    REQUIRE(legacy_header->version == 279);
+}
+
 struct Vertex
 {
     float x;
@@ -150,12 +320,145 @@ TEST_CASE("default blend file can be read", "[default]")
         }
     }
 
+    SECTION("ids can be found by name")
+    {
+        const auto id_index = CreateIdIndex(*blend);
+        REQUIRE(id_index);
+
+        const auto cube = id_index->FindId("OBCube");
+        REQUIRE(cube != NULL_OPTION);
+        REQUIRE(cube->header.code == BLOCK_CODE_OB);
+        REQUIRE(id_index->FindId("OBMissing") == NULL_OPTION);
+
+        const auto objects = id_index->GetIds("OB");
+        REQUIRE(objects.size() == blend->GetBlockCount(BLOCK_CODE_OB));
+        REQUIRE(std::is_sorted(objects.begin(), objects.end(), [](const auto& lhs, const auto& rhs) { return lhs.name < rhs.name; }));
+    }
+
+    SECTION("ids are grouped by block code")
+    {
+        const auto main = CreateMainDatabase(*blend);
+        REQUIRE(main);
+
+        const auto meshes = main->GetIds(BLOCK_CODE_ME);
+        REQUIRE(meshes.size() == blend->GetBlockCount(BLOCK_CODE_ME));
+        REQUIRE(meshes.front().block == &*blend->GetBlock(BLOCK_CODE_ME));
+        REQUIRE(*meshes.front().type == *blend->GetType("Mesh"));
+        REQUIRE(meshes.front().name.starts_with("ME"));
+        REQUIRE(main->GetIds(BLOCK_CODE_DATA).empty());
+    }
+
+    SECTION("references are ordered in waves")
+    {
+        const auto graph = BuildReferenceGraph(*blend);
+        REQUIRE(graph);
+        REQUIRE(graph->order.size() == graph->GetNodeCount());
+        REQUIRE(graph->references.size() == graph->referrers.size());
+
+        std::vector<usize> waves(graph->GetNodeCount(), 0);
+        for (usize wave = 0; wave < graph->GetWaveCount(); ++wave)
+        {
+            for (const u32 node : graph->GetWave(wave))
+            {
+                waves[node] = wave;
+            }
+        }
+
+        for (u32 node = 0; node < graph->GetNodeCount(); ++node)
+        {
+            for (const u32 target : graph->GetReferences(node))
+            {
+                REQUIRE(waves[target] <= waves[node]);
+            }
+        }
+
+        const auto object = graph->FindNode(*blend->GetBlock(BLOCK_CODE_OB));
+        REQUIRE(object);
+        REQUIRE(!graph->GetReferences(*object).empty());
+    }
+
+    SECTION("blocks can be streamed without retaining the file")
+    {
+        usize block_count = 0;
+        Option<int> totvert = NULL_OPTION;
+        const auto result = Blend::VisitFile(
+            "default.blend",
+            [&](const Block& block, const Option<BlendType>& type)
+            {
+                ++block_count;
+                if (block.header.code == BLOCK_CODE_ME && type)
+                {
+                    totvert = type->QueryValue<int, "totvert">(block).value_or(0);
+                }
+            }
+        );
+        REQUIRE(result);
+        REQUIRE(block_count == blend->GetBlockCount());
+        REQUIRE(totvert == 8);
+    }
+
+    SECTION("blocks can be resolved from addresses")
+    {
+        const auto mesh_block = blend->GetBlock(BLOCK_CODE_ME);
+        REQUIRE(mesh_block != NULL_OPTION);
+        REQUIRE(&*blend->GetBlockAt(mesh_block->header.address) == &*mesh_block);
+        REQUIRE(&*blend->GetBlockAt(mesh_block->header.address + mesh_block->header.length - 1) == &*mesh_block);
+        REQUIRE(blend->GetBlockAt(0) == NULL_OPTION);
+
+        const auto packed_files = GetPackedFiles(*blend);
+        REQUIRE(packed_files);
+        REQUIRE(packed_files->empty());
+    }
+
     const auto mesh_block = blend->GetBlock(BLOCK_CODE_ME);
     REQUIRE(mesh_block != NULL_OPTION);
 
     const auto mesh_type = blend->GetBlockType(*mesh_block);
     REQUIRE(mesh_type != NULL_OPTION);
 
+    SECTION("identical field types are shared")
+    {
+        const auto object_type = blend->GetType("Object");
+        REQUIRE(object_type != NULL_OPTION);
+
+        const auto parent = object_type->GetField("parent");
+        const auto track = object_type->GetField("track");
+        REQUIRE(parent != NULL_OPTION);
+        REQUIRE(track != NULL_OPTION);
+        REQUIRE(parent->GetFieldType() == track->GetFieldType());
+    }
+
+    SECTION("type descriptors mirror the types")
+    {
+        const auto& descriptor = mesh_type->GetDescriptor();
+        REQUIRE(descriptor.kind == CanonicalType::Aggregate);
+        REQUIRE(descriptor.size == mesh_type->GetType().GetSize());
+        REQUIRE(descriptor.field_count == mesh_type->GetFields().size());
+
+        const auto id = mesh_type->GetField("id");
+        REQUIRE(id != NULL_OPTION);
+        const auto name = id->GetFieldType().GetField("name");
+        REQUIRE(name != NULL_OPTION);
+        REQUIRE(name->GetFieldType().IsArray());
+        REQUIRE(name->GetFieldType().GetDescriptor().size == name->GetFieldType().GetType().GetSize());
+        REQUIRE(name->GetFieldType().GetElementType()->GetDescriptor().kind == CanonicalType::Fundamental);
+    }
+
+    SECTION("fields are found by their interned names")
+    {
+        for (const auto& field : mesh_type->GetFields())
+        {
+            const auto found = mesh_type->GetField(std::string(field.GetName()));
+            REQUIRE(found != NULL_OPTION);
+            REQUIRE(found->GetOffset() == field.GetOffset());
+        }
+        REQUIRE(mesh_type->GetField("missing") == NULL_OPTION);
+
+        const auto object_type = blend->GetType("Object");
+        REQUIRE(object_type != NULL_OPTION);
+        REQUIRE(object_type->GetField("id")->GetName().data() == mesh_type->GetField("id")->GetName().data());
+    }
+
     SECTION("mesh data can be read via reflection")
     {
         const auto fields = mesh_type->GetFields();
@@ -0,0 +1,40 @@
+#include "blend_builder.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace cblend;
+
+// NOLINTBEGIN
+TEST_CASE("sdna array fields are parsed", "[sdna]")
+// NOLINTEND
+{
+    BlendBuilder builder;
+    builder.AddStruct("Material", { { "int", "flag" } });
+    builder.AddStruct("Object", { { "float", "obmat[4][4]" }, { "Material", "*mtex[18]" }, { "short", "type" } });
+
+    const auto buffer = builder.Build();
+    const auto blend = Blend::Read(buffer);
+    REQUIRE(blend);
+
+    const auto object_type = blend->GetType("Object");
+    REQUIRE(object_type);
+    REQUIRE(object_type->GetSize() == 64 + 18 * sizeof(u64) + sizeof(s16));
+
+    // Both dimensions of a multidimensional array are kept, with the last one innermost
+    const auto matrix = object_type->GetField("obmat");
+    REQUIRE(matrix);
+    REQUIRE(matrix->GetSize() == 64);
+    REQUIRE(matrix->GetFieldType().GetArrayRank() == 4);
+    REQUIRE(matrix->GetFieldType().GetElementType()->GetArrayRank() == 4);
+    REQUIRE(matrix->GetFieldType().GetElementType()->GetElementType()->GetSize() == sizeof(f32));
+
+    // Pointer arrays are arrays of pointers rather than pointers to arrays
+    const auto textures = object_type->GetField("mtex");
+    REQUIRE(textures);
+    REQUIRE(textures->GetOffset() == 64);
+    REQUIRE(textures->GetSize() == 18 * sizeof(u64));
+    REQUIRE(textures->GetFieldType().IsArray());
+    REQUIRE(textures->GetFieldType().GetElementType()->IsPointer());
+
+    REQUIRE(object_type->GetField("type")->GetOffset() == 64 + 18 * sizeof(u64));
+}
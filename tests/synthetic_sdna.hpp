@@ -0,0 +1,59 @@
+// Generated by cblend-codegen, do not edit
+#pragma once
+
+#include <cblend_types.hpp>
+
+#include <cstddef>
+#include <string_view>
+
+namespace synthetic
+{
+// Fingerprint of the DNA1 block, see cblend::Blend::GetSdnaHash
+static constexpr cblend::u64 SDNA_HASH = 0xc63fac51dcb59dfaU;
+
+struct Vec
+{
+    static constexpr cblend::u64 SDNA_HASH = ::synthetic::SDNA_HASH;
+    static constexpr std::string_view SDNA_NAME = "Vec";
+
+    cblend::f32 co[3];
+};
+static_assert(sizeof(Vec) == 12);
+static_assert(offsetof(Vec, co) == 0);
+
+#pragma pack(push, 1)
+struct Thing
+{
+    static constexpr cblend::u64 SDNA_HASH = ::synthetic::SDNA_HASH;
+    static constexpr std::string_view SDNA_NAME = "Thing";
+
+    cblend::s32 class_;
+    cblend::s16 Thing_;
+    cblend::s32 value;
+    struct Vec Vec;
+    cblend::f32 matrix[2][2];
+    cblend::u64 next;
+};
+#pragma pack(pop)
+static_assert(sizeof(Thing) == 46);
+static_assert(offsetof(Thing, class_) == 0);
+static_assert(offsetof(Thing, Thing_) == 4);
+static_assert(offsetof(Thing, value) == 6);
+static_assert(offsetof(Thing, Vec) == 10);
+static_assert(offsetof(Thing, matrix) == 22);
+static_assert(offsetof(Thing, next) == 38);
+
+struct Aligned
+{
+    static constexpr cblend::u64 SDNA_HASH = ::synthetic::SDNA_HASH;
+    static constexpr std::string_view SDNA_NAME = "Aligned";
+
+    cblend::s32 new_;
+    cblend::s32 count;
+    cblend::u64 thing;
+};
+static_assert(sizeof(Aligned) == 16);
+static_assert(offsetof(Aligned, new_) == 0);
+static_assert(offsetof(Aligned, count) == 4);
+static_assert(offsetof(Aligned, thing) == 8);
+} // namespace synthetic
@@ -0,0 +1,34 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cblend_view.hpp>
+
+using namespace cblend;
+
+using ObjectView = StructView<"Object", "loc[2]", "id.name", "parent", "not_a_field", "loc[3]">;
+
+// NOLINTBEGIN
+TEST_CASE("struct views can be bound", "[default]")
+// NOLINTEND
+{
+    auto blend = Blend::Open("default.blend");
+    REQUIRE(blend);
+
+    const auto view = ObjectView::Bind(*blend);
+    REQUIRE(view);
+    REQUIRE(view->GetSize() == blend->GetType("Object")->GetSize());
+    REQUIRE(view->GetField<1>()->size == blend->GetType("ID")->GetField("name")->GetSize());
+    REQUIRE(view->GetField<2>()->is_pointer);
+    REQUIRE(!view->GetField<3>());
+    REQUIRE(!view->GetField<4>());
+
+    for (const auto& block : blend->GetBlocks(BLOCK_CODE_OB))
+    {
+        const auto object_type = blend->GetBlockType(block);
+        REQUIRE(view->Get<0, f32>(block).value() == object_type->QueryValue<f32, "loc[2]">(block));
+        REQUIRE(view->GetPointerAddress<2>(block.body) == object_type->GetField("parent")->GetPointerAddress(block.body));
+        REQUIRE(!view->Get<0, f64>(block));
+        REQUIRE(!view->Get<3, s32>(block));
+    }
+
+    REQUIRE(StructView<"NotAStruct", "loc">::Bind(*blend).error() == QueryValueError::InvalidType);
+    REQUIRE(StructView<"Object", "2loc">::Bind(*blend).error() == QueryValueError::InvalidQuery);
+}
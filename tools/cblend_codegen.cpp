@@ -0,0 +1,57 @@
+#include <cblend_codegen.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <string_view>
+
+using namespace cblend;
+
+int main(int argc, char** argv)
+{
+    const std::span<char*> args(argv, usize(argc));
+    if (args.size() < 3)
+    {
+        std::cerr << "usage: cblend-codegen <input.blend> <output.hpp> [--namespace name] [struct...]\n";
+        return 1;
+    }
+
+    CodegenSettings settings;
+    for (usize index = 3; index < args.size(); ++index)
+    {
+        const std::string_view arg = args[index];
+        if (arg == "--namespace" && index + 1 < args.size())
+        {
+            settings.namespace_name = args[++index];
+        }
+        else
+        {
+            settings.struct_names.push_back(arg);
+        }
+    }
+
+    const auto blend = Blend::Open(args[1]);
+    if (!blend)
+    {
+        std::cerr << "cblend-codegen: could not open " << args[1] << "\n";
+        return 1;
+    }
+
+    const auto header = GenerateHeader(*blend, settings);
+    if (!header)
+    {
+        const bool is_struct_missing = header.error() == CodegenError::StructNotFound;
+        std::cerr << "cblend-codegen: " << (is_struct_missing ? "unknown struct name" : "invalid namespace name") << "\n";
+        return 1;
+    }
+
+    std::ofstream output(args[2], std::ios::binary);
+    output << *header;
+    if (!output)
+    {
+        std::cerr << "cblend-codegen: could not write " << args[2] << "\n";
+        return 1;
+    }
+
+    return 0;
+}